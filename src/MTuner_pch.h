@@ -38,6 +38,7 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QFileSystemWatcher>
 #include <QtCore/QFuture>
+#include <QtCore/QHash>
 #include <QtCore/QtGlobal>
 #include <QtCore/QList>
 #include <QtCore/QLocale>
@@ -60,7 +61,7 @@
 #include <QtGui/QDropEvent>
 #include <QtGui/QPainter>
 #include <QtGui/QStandardItem>
-#include <QtGui/QSyntaxHighlighter>
+#include <QtGui/QTextLayout>
 #include <QtGui/QTextCharFormat>
 
 #include <QtWidgets/QApplication>
@@ -73,6 +74,7 @@
 #include <QtWidgets/QGraphicsWidget>
 #include <QtWidgets/QItemDelegate>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QLineEdit>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QPlainTextEdit>
@@ -140,6 +140,8 @@ void BigTable::updateTable()
 	if ((m_selectedRows >= m_firstVisible) && (m_selectedRows < m_firstVisible + m_visibleRows))
 		m_tree->selectRow(m_selectedRows - m_firstVisible);
 	m_tree->setUpdatesEnabled(true);
+
+	emit visibleRowsChanged(m_firstVisible, m_visibleRows);
 }
 
 void BigTable::resetView()
@@ -56,6 +56,7 @@ public:
 Q_SIGNALS:
 	void itemSelected(void*);
 	void itemRightClicked(void*, const QPoint&);
+	void visibleRowsChanged(uint32_t _first, uint32_t _count);
 
 public Q_SLOTS:
 	void scroll(int);
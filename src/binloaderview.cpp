@@ -7,6 +7,9 @@
 #include <MTuner/src/binloaderview.h>
 #include <MTuner/src/operationslist.h>
 #include <MTuner/src/capturecontext.h>
+#include <MTuner/src/filterengine.h>
+#include <MTuner/src/flamegraph.h>
+#include <MTuner/src/bottomupwidget.h>
 
 BinLoaderView::BinLoaderView(QWidget* _parent, Qt::WindowFlags _flags) :
 	QWidget(_parent, _flags)
@@ -25,18 +28,24 @@ BinLoaderView::BinLoaderView(QWidget* _parent, Qt::WindowFlags _flags) :
 	m_tab			= findChild<QTabWidget*>("tabWidget");
 	m_treeMap		= m_tab->findChild<TreeMapWidget*>("treeMapWidget");
 	m_stackTree		= findChild<StackTreeWidget*>("stackTree");
+	m_flameGraph	= findChild<FlameGraphWidget*>("flameGraphWidget");
+	m_bottomUp		= findChild<BottomUpWidget*>("bottomUpWidget");
 	m_groupList		= findChild<GroupList*>("groupListWidget");
 	m_operationList = findChild<OperationsList*>("operationsListWidget");
 	m_hotspots		= findChild<HotspotsWidget*>("hotspotsWidget");
 	m_operationListInvalid = findChild<OperationsList*>("invalidOpsWidget");
 	m_operationListInvalid->setSearchVisible(false);
 
+	m_filterEngine = new FilterEngine(this);
+	connect(m_filterEngine, SIGNAL(filteredDataReady()), this, SLOT(filteredDataReady()));
+
 	connect(m_groupList, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SIGNAL(setStackTrace(rtm::StackTrace**,int)));
 	connect(m_operationList, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SIGNAL(setStackTrace(rtm::StackTrace**,int)));
 	connect(m_operationListInvalid, SIGNAL(setStackTrace(rtm::StackTrace**, int)), this, SIGNAL(setStackTrace(rtm::StackTrace**, int)));
 	connect(m_treeMap, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SIGNAL(setStackTrace(rtm::StackTrace**,int)));
 	connect(m_hotspots, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SIGNAL(setStackTrace(rtm::StackTrace**,int)));
 	connect(m_stackTree, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SIGNAL(setStackTrace(rtm::StackTrace**,int)));
+	connect(m_flameGraph, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SIGNAL(setStackTrace(rtm::StackTrace**,int)));
 	connect(this, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SLOT(saveStackTrace(rtm::StackTrace**,int)));
 
 	connect(m_groupList, SIGNAL(usageSortingDone(GroupMapping*)), m_hotspots, SLOT(usageSortingDone(GroupMapping*)));
@@ -65,6 +74,9 @@ void BinLoaderView::changeEvent(QEvent* _event)
 
 BinLoaderView::~BinLoaderView()
 {
+	// background filtering and call graph build read capture data
+	m_filterEngine->stop();
+	m_bottomUp->stop();
 	delete m_context;
 }
 
@@ -73,9 +85,12 @@ void BinLoaderView::setContext(CaptureContext* _context)
 	m_context = _context;
 	m_treeMap->setContext(_context);
 	m_stackTree->setContext(_context);
+	m_flameGraph->setContext(_context);
+	m_bottomUp->setContext(_context);
 	m_operationList->setContext(_context, true);
 	m_operationListInvalid->setContext(_context, false);
 	m_groupList->setContext(_context);
+	m_filterEngine->setContext(_context);
 	m_minTime = m_context->m_capture->getMinTime();
 	m_maxTime = m_context->m_capture->getMaxTime();
 }
@@ -83,12 +98,39 @@ void BinLoaderView::setContext(CaptureContext* _context)
 void BinLoaderView::setFilteringEnabled(bool _filter)
 {
 	m_filteringEnabled = _filter;
-	m_context->m_capture->setFilteringEnabled(_filter);
+	m_context->m_capture->setFilteringEnabled(_filter, false);
+
+	// views switch to filtered data once it is built in background
+	if (_filter)
+		m_filterEngine->requestUpdate();
+	else
+	{
+		m_filterEngine->cancel();
+		setViewsFilteringState(false);
+	}
+}
+
+void BinLoaderView::updateFilteredData()
+{
+	if (m_filteringEnabled)
+		m_filterEngine->requestUpdate();
+}
+
+void BinLoaderView::filteredDataReady()
+{
+	if (m_filteringEnabled)
+		setViewsFilteringState(true);
+}
+
+void BinLoaderView::setViewsFilteringState(bool _filter)
+{
 	m_operationList->setFilteringState(_filter);
 	m_operationListInvalid->setFilteringState(_filter);
 	m_groupList->setFilteringState(_filter);
 	m_stackTree->setFilteringState(_filter);
 	m_treeMap->setFilteringState(_filter);
+	m_flameGraph->setFilteringState(_filter);
+	m_bottomUp->setFilteringState(_filter);
 }
 
 void BinLoaderView::saveStackTrace(rtm::StackTrace** _stackTrace, int _num)
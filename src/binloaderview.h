@@ -10,9 +10,12 @@
 #include <MTuner/src/treemap.h>
 
 class Hotspots;
+class FilterEngine;
 class OperationsList;
 class HotspotsWidget;
 class StackTreeWidget;
+class FlameGraphWidget;
+class BottomUpWidget;
 struct CaptureContext;
 
 class BinLoaderView : public QWidget
@@ -27,7 +30,10 @@ private:
 	GroupList*			m_groupList;
 	HotspotsWidget*		m_hotspots;
 	StackTreeWidget*	m_stackTree;
+	FlameGraphWidget*	m_flameGraph;
+	BottomUpWidget*		m_bottomUp;
 	OperationsList*		m_operationListInvalid;
+	FilterEngine*		m_filterEngine;
 	uint64_t			m_minTime;
 	uint64_t			m_maxTime;
 	uint64_t			m_currentHeap;
@@ -66,12 +72,14 @@ public:
 	void		setCurrentModule(rdebug::ModuleInfo* _module) { m_currentModule = _module; }
 	void		setFilteringEnabled(bool _filter);
 	bool		getFilteringEnabled() const { return m_filteringEnabled; }
+	void		updateFilteredData();
 
 	void readSettings();
 	void saveSettings();
 
 public Q_SLOTS:
 	void saveStackTrace(rtm::StackTrace**, int);
+	void filteredDataReady();
 
 Q_SIGNALS:
 	void setStackTrace(rtm::StackTrace**, int);
@@ -80,6 +88,8 @@ Q_SIGNALS:
 	void selectRange(uint64_t, uint64_t);
 
 private:
+	void setViewsFilteringState(bool _filter);
+
 	Ui::BinLoaderView ui;
 };
 
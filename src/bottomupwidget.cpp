@@ -0,0 +1,298 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/bottomupwidget.h>
+#include <MTuner/src/capturecontext.h>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+
+static QString formatWeight(int64_t _value, int64_t _total)
+{
+	QLocale locale;
+	const float pct = _total ? (float(_value) * 100.0f) / float(_total) : 0.0f;
+	return locale.toString((qlonglong)_value) + " (" + QString::number(pct, 'f', 2) + "%)";
+}
+
+BottomUpWidget::BottomUpWidget(QWidget* _parent, Qt::WindowFlags _flags) :
+	QWidget(_parent, _flags)
+{
+	ui.setupUi(this);
+
+	m_context			= NULL;
+	m_job				= NULL;
+	m_version			= 0;
+	m_metric			= 0;
+	m_enableFiltering	= false;
+	m_dirty				= false;
+
+	m_tree		= findChild<QTreeWidget*>("treeBottomUp");
+	m_callers	= findChild<QTreeWidget*>("treeCallers");
+	m_callees	= findChild<QTreeWidget*>("treeCallees");
+	m_function	= findChild<QLabel*>("labelFunction");
+
+	m_tree->header()->resizeSection(Column::Name, 240);
+	m_callers->setRootIsDecorated(false);
+	m_callees->setRootIsDecorated(false);
+
+	QComboBox* metric = findChild<QComboBox*>("comboBoxMetric");
+	connect(metric, SIGNAL(currentIndexChanged(int)), this, SLOT(metricChanged(int)));
+	connect(m_tree, SIGNAL(itemExpanded(QTreeWidgetItem*)), this, SLOT(itemExpanded(QTreeWidgetItem*)));
+	connect(m_tree, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)), this, SLOT(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)));
+	connect(m_callers, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(edgeActivated(QTreeWidgetItem*,int)));
+	connect(m_callees, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(edgeActivated(QTreeWidgetItem*,int)));
+	connect(&m_watcher, SIGNAL(finished()), this, SLOT(buildFinished()));
+}
+
+BottomUpWidget::~BottomUpWidget()
+{
+	stop();
+}
+
+void BottomUpWidget::changeEvent(QEvent* _event)
+{
+	QWidget::changeEvent(_event);
+	if (_event->type() == QEvent::LanguageChange)
+		ui.retranslateUi(this);
+}
+
+void BottomUpWidget::showEvent(QShowEvent* _event)
+{
+	QWidget::showEvent(_event);
+	if (m_dirty)
+		rebuild();
+}
+
+void BottomUpWidget::setContext(CaptureContext* _context)
+{
+	m_context = _context;
+	rebuild();
+}
+
+void BottomUpWidget::setFilteringState(bool _state)
+{
+	m_enableFiltering = _state;
+	rebuild();
+}
+
+void BottomUpWidget::stop()
+{
+	++m_version;
+	m_watcher.waitForFinished();
+
+	delete m_job;
+	m_job = NULL;
+}
+
+void BottomUpWidget::metricChanged(int _metric)
+{
+	m_metric = _metric;
+	fillTree();
+}
+
+//--------------------------------------------------------------------------
+/// Building walks all stack traces, it is postponed until the view is shown
+/// and a running build becomes stale immediately
+//--------------------------------------------------------------------------
+void BottomUpWidget::rebuild()
+{
+	++m_version;
+
+	if (!isVisible())
+	{
+		m_dirty = true;
+		return;
+	}
+
+	m_dirty = false;
+	m_callGraph.clear();
+	fillTree();
+
+	if (!m_context)
+		return;
+
+	m_function->setText(tr("Building call graph..."));
+	if (!m_watcher.isRunning())
+		startBuild();
+}
+
+void BottomUpWidget::startBuild()
+{
+	if (!(m_context && m_context->m_capture))
+		return;
+
+	// groups are swapped on filtering change so traces are gathered here, background job only builds
+	rtm::Capture* capture = m_context->m_capture;
+	Job* job = new Job();
+	job->m_version = m_version;
+	rtm::CallGraph::collectTraces(m_enableFiltering ? capture->getMemoryGroupsFiltered() : capture->getMemoryGroups(), job->m_traces);
+
+	m_job = job;
+	m_watcher.setFuture(QtConcurrent::run([job]()
+	{
+		job->m_callGraph.build(job->m_traces);
+	}));
+}
+
+void BottomUpWidget::buildFinished()
+{
+	Job* job = m_job;
+	m_job = NULL;
+
+	if (!job)
+		return;
+
+	if (job->m_version != m_version)
+	{
+		delete job;
+
+		// hidden view builds once shown again
+		if (!m_dirty)
+			startBuild();
+		return;
+	}
+
+	m_callGraph = std::move(job->m_callGraph);
+	delete job;
+
+	fillTree();
+}
+
+void BottomUpWidget::fillTree()
+{
+	m_tree->clear();
+	m_callers->clear();
+	m_callees->clear();
+	m_function->setText(tr("Select a function to see its callers and callees"));
+
+	addNodeItems(m_tree->invisibleRootItem(), m_callGraph.getRoot());
+}
+
+//--------------------------------------------------------------------------
+/// Creates items for children of a node, sorted by selected metric
+//--------------------------------------------------------------------------
+void BottomUpWidget::addNodeItems(QTreeWidgetItem* _parent, const rtm::CallGraph::Node& _node)
+{
+	rtm_vector<const rtm::CallGraph::Node*> children;
+	children.reserve(_node.m_children.size());
+	for (const rtm::CallGraph::Node& child : _node.m_children)
+		children.push_back(&child);
+
+	std::sort(children.begin(), children.end(), [this](const rtm::CallGraph::Node* _n1, const rtm::CallGraph::Node* _n2)
+	{
+		return getValue(_n1->m_weight) > getValue(_n2->m_weight);
+	});
+
+	QList<QTreeWidgetItem*> items;
+	for (const rtm::CallGraph::Node* child : children)
+	{
+		QTreeWidgetItem* item = new QTreeWidgetItem();
+		setItemData(item, child->m_address, child->m_weight, m_callGraph.getRoot().m_weight);
+		item->setData(Column::Name, NodeRole, QVariant::fromValue((quintptr)child));
+		item->setData(Column::Name, FunctionRole, QVariant::fromValue((qulonglong)child->m_id));
+
+		if (!child->m_children.empty())
+			item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+
+		items.append(item);
+	}
+
+	_parent->addChildren(items);
+}
+
+void BottomUpWidget::itemExpanded(QTreeWidgetItem* _item)
+{
+	if (_item->childCount())
+		return;
+
+	const rtm::CallGraph::Node* node = (const rtm::CallGraph::Node*)_item->data(Column::Name, NodeRole).value<quintptr>();
+	if (node)
+		addNodeItems(_item, *node);
+}
+
+void BottomUpWidget::currentItemChanged(QTreeWidgetItem* _current, QTreeWidgetItem* _previous)
+{
+	RTM_UNUSED(_previous);
+
+	if (_current)
+		showFunction(_current->data(Column::Name, FunctionRole).toULongLong());
+}
+
+void BottomUpWidget::edgeActivated(QTreeWidgetItem* _item, int _column)
+{
+	RTM_UNUSED(_column);
+	showFunction(_item->data(Column::Name, FunctionRole).toULongLong());
+}
+
+void BottomUpWidget::showFunction(uint64_t _id)
+{
+	m_callers->clear();
+	m_callees->clear();
+
+	const rtm::CallGraph::Function* function = m_callGraph.findFunction(_id);
+	if (!function || !m_context)
+		return;
+
+	rdebug::StackFrame frame;
+	m_context->resolveStackFrame(function->m_address, frame);
+
+	const rtm::CallGraph::Weight& total = m_callGraph.getRoot().m_weight;
+	m_function->setText(QString::fromUtf8(frame.m_func) + "   " +
+						tr("Self: ") + formatWeight(getValue(function->m_self), getValue(total)) + "   " +
+						tr("Total: ") + formatWeight(getValue(function->m_total), getValue(total)));
+
+	fillEdges(m_callers, function->m_callers, function->m_total);
+	fillEdges(m_callees, function->m_callees, function->m_total);
+}
+
+void BottomUpWidget::fillEdges(QTreeWidget* _list, const rtm::CallGraph::EdgeMap& _edges, const rtm::CallGraph::Weight& _total)
+{
+	rtm_vector<rtm::CallGraph::EdgeMap::const_iterator> edges;
+	edges.reserve(_edges.size());
+	for (rtm::CallGraph::EdgeMap::const_iterator it = _edges.begin(); it != _edges.end(); ++it)
+		edges.push_back(it);
+
+	std::sort(edges.begin(), edges.end(), [this](rtm::CallGraph::EdgeMap::const_iterator _e1, rtm::CallGraph::EdgeMap::const_iterator _e2)
+	{
+		return getValue(_e1->second.m_weight) > getValue(_e2->second.m_weight);
+	});
+
+	QList<QTreeWidgetItem*> items;
+	for (rtm::CallGraph::EdgeMap::const_iterator edge : edges)
+	{
+		QTreeWidgetItem* item = new QTreeWidgetItem();
+		setItemData(item, edge->second.m_address, edge->second.m_weight, _total);
+		item->setData(Column::Name, FunctionRole, QVariant::fromValue((qulonglong)edge->first));
+		items.append(item);
+	}
+
+	_list->addTopLevelItems(items);
+}
+
+void BottomUpWidget::setItemData(QTreeWidgetItem* _item, uint64_t _address, const rtm::CallGraph::Weight& _weight, const rtm::CallGraph::Weight& _total)
+{
+	rdebug::StackFrame frame;
+	m_context->resolveStackFrame(_address, frame);
+
+	_item->setText(Column::Name,		QString::fromUtf8(frame.m_func));
+	_item->setText(Column::Module,		QString::fromUtf8(frame.m_moduleName));
+	_item->setText(Column::Usage,		formatWeight(_weight.m_usage, _total.m_usage));
+	_item->setText(Column::PeakUsage,	formatWeight(_weight.m_peakUsage, _total.m_peakUsage));
+	_item->setText(Column::Operations,	formatWeight((int64_t)_weight.m_count, (int64_t)_total.m_count));
+
+	for (int c=Column::Usage; c<=Column::Operations; ++c)
+		_item->setTextAlignment(c, Qt::AlignRight | Qt::AlignVCenter);
+}
+
+int64_t BottomUpWidget::getValue(const rtm::CallGraph::Weight& _weight) const
+{
+	switch (m_metric)
+	{
+		case 0:		return _weight.m_usage;
+		case 1:		return _weight.m_peakUsage;
+		default:	return (int64_t)_weight.m_count;
+	};
+}
@@ -0,0 +1,97 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_BOTTOMUPWIDGET_H
+#define RTM_MTUNER_BOTTOMUPWIDGET_H
+
+#include <MTuner/src/loader/callgraph.h>
+#include <MTuner/.qt/qt_ui/bottomup_ui.h>
+
+struct CaptureContext;
+
+//--------------------------------------------------------------------------
+/// Inverted call tree with allocating functions at the top level and a
+/// caller/callee breakdown of the selected function. Data is rebuilt in
+/// background only when the view is visible, tree items are created on
+/// expand.
+//--------------------------------------------------------------------------
+class BottomUpWidget : public QWidget
+{
+	Q_OBJECT
+
+	struct Job
+	{
+		uint32_t				m_version;
+		rtm::CallGraph::Traces	m_traces;
+		rtm::CallGraph			m_callGraph;
+	};
+
+	struct Column
+	{
+		enum Enum
+		{
+			Name,
+			Module,
+			Usage,
+			PeakUsage,
+			Operations
+		};
+	};
+
+	enum
+	{
+		NodeRole		= Qt::UserRole,
+		FunctionRole	= Qt::UserRole + 1
+	};
+
+	CaptureContext*		m_context;
+	rtm::CallGraph		m_callGraph;		///< Shown call graph
+	Job*				m_job;				///< Call graph being built in background
+	QFutureWatcher<void> m_watcher;
+	uint32_t			m_version;			///< Incremented when shown data changes
+	QTreeWidget*		m_tree;
+	QTreeWidget*		m_callers;
+	QTreeWidget*		m_callees;
+	QLabel*				m_function;
+	int					m_metric;
+	bool				m_enableFiltering;
+	bool				m_dirty;
+
+public:
+	BottomUpWidget(QWidget* _parent = 0, Qt::WindowFlags _flags = (Qt::WindowFlags)0);
+	virtual ~BottomUpWidget();
+
+	void changeEvent(QEvent* _event);
+	void showEvent(QShowEvent* _event);
+
+	void setContext(CaptureContext* _context);
+	void setFilteringState(bool _state);
+
+	/// Waits for the running build, capture can be released after this
+	void stop();
+
+public Q_SLOTS:
+	void metricChanged(int _metric);
+	void itemExpanded(QTreeWidgetItem* _item);
+	void currentItemChanged(QTreeWidgetItem* _current, QTreeWidgetItem* _previous);
+	void edgeActivated(QTreeWidgetItem* _item, int _column);
+
+private Q_SLOTS:
+	void buildFinished();
+
+private:
+	void	rebuild();
+	void	startBuild();
+	void	fillTree();
+	void	addNodeItems(QTreeWidgetItem* _parent, const rtm::CallGraph::Node& _node);
+	void	showFunction(uint64_t _id);
+	void	fillEdges(QTreeWidget* _list, const rtm::CallGraph::EdgeMap& _edges, const rtm::CallGraph::Weight& _total);
+	void	setItemData(QTreeWidgetItem* _item, uint64_t _address, const rtm::CallGraph::Weight& _weight, const rtm::CallGraph::Weight& _total);
+	int64_t	getValue(const rtm::CallGraph::Weight& _weight) const;
+
+	Ui::BottomUp ui;
+};
+
+#endif // RTM_MTUNER_BOTTOMUPWIDGET_H
@@ -5,12 +5,17 @@
 
 #include <MTuner_pch.h>
 #include <MTuner/src/capturecontext.h>
+#include <MTuner/src/symbolprefetcher.h>
 #include <rbase/inc/winchar.h>
 #include <rdebug/inc/rdebug.h>
+#include <QtCore/QStandardPaths>
 
 CaptureContext::CaptureContext()
 {
 	m_symbolResolver	= 0;
+	m_symbolCache		= 0;
+	m_symbolizer		= 0;
+	m_prefetcher		= 0;
 	m_capture			= new rtm::Capture();
 	m_toolchain			= rmem::ToolChain::Unknown;
 	m_binLoaderView		= 0;
@@ -18,6 +23,25 @@ CaptureContext::CaptureContext()
 
 CaptureContext::~CaptureContext()
 {
+	// prefetching thread uses the resolver
+	delete m_prefetcher;
+	m_prefetcher = 0;
+
+	if (m_symbolCache)
+	{
+		m_symbolCache->save();
+		m_capture->setSymbolCache(NULL);
+		delete m_symbolCache;
+		m_symbolCache = 0;
+	}
+
+	if (m_symbolizer)
+	{
+		m_capture->setSymbolizer(NULL);
+		delete m_symbolizer;
+		m_symbolizer = 0;
+	}
+
 	if (m_symbolResolver)
 	{
 		rdebug::symbolResolverDelete((uintptr_t)m_symbolResolver);
@@ -61,10 +85,53 @@ void CaptureContext::setupResolver(rdebug::Toolchain& _tc, rtm_string& _executab
 	};
 
 	m_symbolResolver = rdebug::symbolResolverCreate(m_capture->getModuleInfos().data(), (uint32_t)m_capture->getModuleInfos().size(), _executable.c_str());
+	if (!m_symbolResolver)
+		return;
+
+	// cached symbols are valid only for the same resolver setup
+	const QString symbolSource = QString("%1|%2|%3|%4")
+									.arg((int)_tc.m_type)
+									.arg(QString::fromUtf8(_tc.m_toolchainPath))
+									.arg(QString::fromUtf8(_executable.c_str()))
+									.arg(QString::fromLocal8Bit(qgetenv("_NT_SYMBOL_PATH")));
+
+	const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/MTuner/SymbolCache";
+
+	delete m_symbolCache;
+	m_symbolCache = new rtm::SymbolCache();
+	m_symbolCache->init(cacheDir.toUtf8().constData(), symbolSource.toUtf8().constData(), m_capture->getModuleInfos().data(), (uint32_t)m_capture->getModuleInfos().size());
+	m_capture->setSymbolCache(m_symbolCache);
+
+	// GNU toolchains resolve whole modules in batches, ELF binaries are read in process and
+	// addr2line, too slow to run per address, is used for the rest
+	delete m_symbolizer;
+	m_symbolizer = new rtm::GNUSymbolizer();
+	if (!m_symbolizer->init(_tc, _executable.c_str(), m_capture->getModuleInfos().data(), (uint32_t)m_capture->getModuleInfos().size()))
+	{
+		delete m_symbolizer;
+		m_symbolizer = 0;
+	}
+	m_capture->setSymbolizer(m_symbolizer);
 }
 
 void CaptureContext::resolveStackFrame(uint64_t _address, rdebug::StackFrame& _frame)
 {
 	if (m_symbolResolver)
-		rdebug::symbolResolverGetFrame(m_symbolResolver, _address, &_frame);
+		m_capture->getStackFrame(m_symbolResolver, _address, _frame);
+}
+
+void CaptureContext::startPrefetching()
+{
+	if (!m_symbolResolver || m_prefetcher)
+		return;
+
+	m_prefetcher = new SymbolPrefetcher(this);
+	m_prefetcher->prefetchTopGroups();
+	m_prefetcher->start(QThread::LowPriority);
+}
+
+void CaptureContext::prefetchFrames(const uint64_t* _addresses, uint32_t _numAddresses)
+{
+	if (m_prefetcher)
+		m_prefetcher->prefetch(_addresses, _numAddresses, SymbolPrefetcher::Visible);
 }
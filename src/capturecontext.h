@@ -9,11 +9,15 @@
 #include <MTuner/src/loader/capture.h>
 
 class BinLoaderView;
+class SymbolPrefetcher;
 
 struct CaptureContext
 {
 	rtm::Capture*			m_capture;
 	uintptr_t				m_symbolResolver;
+	rtm::SymbolCache*		m_symbolCache;
+	rtm::GNUSymbolizer*		m_symbolizer;
+	SymbolPrefetcher*		m_prefetcher;			///< Only with lazy symbols
 	rtm_string				m_symbolStoreDName;
 	rmem::ToolChain::Enum	m_toolchain;
 	BinLoaderView*			m_binLoaderView;
@@ -24,6 +28,12 @@ struct CaptureContext
 	void		setupResolver(rdebug::Toolchain& _tc, rtm_string& _executable);
 	rtm_string	getSymbolStoreDir() const { return m_symbolStoreDName; }
 	void		resolveStackFrame(uint64_t _address, rdebug::StackFrame& ioFrame);
+
+	/// Starts resolving frames of the largest groups in the background
+	void		startPrefetching();
+
+	/// Frames about to be shown are resolved ahead of other prefetched frames
+	void		prefetchFrames(const uint64_t* _addresses, uint32_t _numAddresses);
 };
 
 #endif // RTM_MTUNER_CAPTURE_CONTEXT_H
@@ -118,5 +118,5 @@ void CentralWidget::updateFilterDataIfNeeded()
 	if (!ctx->m_capture->getFilteringEnabled())
 		return;
 
-	toggleFilteringForCurrentView(true);
+	view->updateFilteredData();
 }
@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/filterengine.h>
+#include <MTuner/src/capturecontext.h>
+#include <QtConcurrent/QtConcurrent>
+
+/// Time to wait for more filter changes before starting a job, in milliseconds
+static const int FILTER_DEBOUNCE_MS = 120;
+
+FilterEngine::FilterEngine(QObject* _parent) :
+	QObject(_parent)
+{
+	m_context		= NULL;
+	m_result		= NULL;
+	m_version		= 0;
+	m_jobVersion	= 0;
+	m_restart		= false;
+
+	m_debounceTimer.setSingleShot(true);
+	m_debounceTimer.setInterval(FILTER_DEBOUNCE_MS);
+
+	connect(&m_debounceTimer, SIGNAL(timeout()), this, SLOT(startJob()));
+	connect(&m_watcher, SIGNAL(finished()), this, SLOT(jobFinished()));
+}
+
+FilterEngine::~FilterEngine()
+{
+	stop();
+}
+
+//--------------------------------------------------------------------------
+/// Schedules filtered data update, running job becomes stale immediately
+//--------------------------------------------------------------------------
+void FilterEngine::requestUpdate()
+{
+	++m_version;
+	m_debounceTimer.start();
+}
+
+//--------------------------------------------------------------------------
+/// Drops pending requests and stops the running job as soon as possible
+//--------------------------------------------------------------------------
+void FilterEngine::cancel()
+{
+	++m_version;
+	m_debounceTimer.stop();
+	m_restart = false;
+}
+
+//--------------------------------------------------------------------------
+/// Cancels and waits for the running job, capture can be released after this
+//--------------------------------------------------------------------------
+void FilterEngine::stop()
+{
+	cancel();
+	m_watcher.waitForFinished();
+
+	delete m_result;
+	m_result = NULL;
+}
+
+void FilterEngine::startJob()
+{
+	if (!m_context)
+		return;
+
+	// only one job at a time, filtered data of the running one may still be applied
+	if (m_watcher.isRunning())
+	{
+		m_restart = true;
+		return;
+	}
+
+	rtm::Capture* capture = m_context->m_capture;
+	if (!capture->getFilteringEnabled())
+		return;
+
+	delete m_result;
+	m_result = new rtm::FilterResult;
+	m_jobVersion = m_version;
+
+	capture->beginFilteredData(*m_result);
+
+	rtm::FilterResult* result = m_result;
+	const uint32_t version = m_jobVersion;
+	const std::atomic<uint32_t>* latestVersion = &m_version;
+
+	m_watcher.setFuture(QtConcurrent::run([capture, result, latestVersion, version]()
+	{
+		return capture->prepareFilteredData(*result, latestVersion, version);
+	}));
+}
+
+void FilterEngine::jobFinished()
+{
+	const bool completed = m_watcher.result();
+
+	if (m_result && completed && (m_jobVersion == m_version) && m_context->m_capture->getFilteringEnabled())
+	{
+		// swap in on the GUI thread so views never see partially built data
+		m_context->m_capture->applyFilteredData(*m_result);
+		emit filteredDataReady();
+	}
+
+	delete m_result;
+	m_result = NULL;
+
+	if (m_restart)
+	{
+		m_restart = false;
+		if (!m_debounceTimer.isActive())
+			startJob();
+	}
+}
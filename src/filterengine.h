@@ -0,0 +1,49 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_FILTERENGINE_H
+#define RTM_MTUNER_FILTERENGINE_H
+
+#include <QtCore/QFutureWatcher>
+
+struct CaptureContext;
+
+//--------------------------------------------------------------------------
+/// Builds filtered data on a background thread. Requests are debounced and
+/// versioned, a newer request cancels the running one and only the result
+/// of the latest request is applied to the capture.
+//--------------------------------------------------------------------------
+class FilterEngine : public QObject
+{
+	Q_OBJECT
+
+private:
+	CaptureContext*			m_context;
+	QTimer					m_debounceTimer;
+	QFutureWatcher<bool>	m_watcher;
+	rtm::FilterResult*		m_result;			///< Result of the running job
+	std::atomic<uint32_t>	m_version;			///< Incremented by every request
+	uint32_t				m_jobVersion;		///< Request version of the running job
+	bool					m_restart;			///< Start a new job once the running one stops
+
+public:
+	FilterEngine(QObject* _parent = 0);
+	virtual ~FilterEngine();
+
+	void	setContext(CaptureContext* _context) { m_context = _context; }
+	void	requestUpdate();
+	void	cancel();
+	void	stop();
+	bool	isBusy() const { return m_watcher.isRunning() || m_debounceTimer.isActive(); }
+
+Q_SIGNALS:
+	void	filteredDataReady();
+
+private Q_SLOTS:
+	void	startJob();
+	void	jobFinished();
+};
+
+#endif // RTM_MTUNER_FILTERENGINE_H
@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/flamegraph.h>
+
+FlameGraphWidget::FlameGraphWidget(QWidget* _parent, Qt::WindowFlags _flags) :
+	QWidget(_parent, _flags)
+{
+	ui.setupUi(this);
+	m_view = findChild<FlameGraphView*>("flameGraphView");
+
+	QComboBox* metric = findChild<QComboBox*>("comboBoxMetric");
+	QComboBox* mode = findChild<QComboBox*>("comboBoxMode");
+	connect(metric, SIGNAL(currentIndexChanged(int)), this, SLOT(metricChanged(int)));
+	connect(mode, SIGNAL(currentIndexChanged(int)), this, SLOT(modeChanged(int)));
+
+	connect(m_view, SIGNAL(setStackTrace(rtm::StackTrace**,int)), this, SIGNAL(setStackTrace(rtm::StackTrace**,int)));
+}
+
+void FlameGraphWidget::changeEvent(QEvent* _event)
+{
+	QWidget::changeEvent(_event);
+	if (_event->type() == QEvent::LanguageChange)
+		ui.retranslateUi(this);
+}
+
+void FlameGraphWidget::setContext(CaptureContext* _context)
+{
+	m_view->setContext(_context);
+}
+
+void FlameGraphWidget::setFilteringState(bool _state)
+{
+	m_view->setFilteringState(_state);
+}
+
+void FlameGraphWidget::metricChanged(int _metric)
+{
+	m_view->setMetric((FlameGraphView::Metric::Enum)_metric);
+}
+
+void FlameGraphWidget::modeChanged(int _mode)
+{
+	m_view->setMode((FlameGraphView::Mode::Enum)_mode);
+}
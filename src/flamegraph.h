@@ -0,0 +1,38 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_FLAMEGRAPH_H
+#define RTM_MTUNER_FLAMEGRAPH_H
+
+#include <MTuner/src/flamegraphview.h>
+#include <MTuner/.qt/qt_ui/flamegraph_ui.h>
+
+class FlameGraphWidget : public QWidget
+{
+	Q_OBJECT
+
+private:
+	FlameGraphView*		m_view;
+
+public:
+	FlameGraphWidget(QWidget* _parent = 0, Qt::WindowFlags _flags = (Qt::WindowFlags)0);
+
+	void changeEvent(QEvent* _event);
+
+	void setContext(CaptureContext* _context);
+	void setFilteringState(bool _state);
+
+public Q_SLOTS:
+	void metricChanged(int _metric);
+	void modeChanged(int _mode);
+
+Q_SIGNALS:
+	void setStackTrace(rtm::StackTrace**, int);
+
+private:
+	Ui::FlameGraph ui;
+};
+
+#endif // RTM_MTUNER_FLAMEGRAPH_H
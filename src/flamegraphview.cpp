@@ -0,0 +1,412 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/flamegraphview.h>
+#include <MTuner/src/capturecontext.h>
+#include <QtWidgets/QScrollBar>
+
+#include <algorithm>
+
+FlameGraphView::FlameGraphView(QWidget* _parent) :
+	QAbstractScrollArea(_parent)
+{
+	m_context			= NULL;
+	m_tree				= NULL;
+	m_layoutWidth		= 0;
+	m_metric			= Metric::Usage;
+	m_mode				= Mode::Flame;
+	m_enableFiltering	= false;
+	m_highlightLevel	= -1;
+	m_highlightFrame	= -1;
+
+	setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+	viewport()->setMouseTracking(true);
+}
+
+void FlameGraphView::setContext(CaptureContext* _context)
+{
+	m_context = _context;
+	setTree();
+}
+
+void FlameGraphView::setFilteringState(bool _state)
+{
+	m_enableFiltering = _state;
+	setTree();
+}
+
+void FlameGraphView::setMetric(Metric::Enum _metric)
+{
+	m_metric = _metric;
+	invalidateLayout();
+}
+
+void FlameGraphView::setMode(Mode::Enum _mode)
+{
+	m_mode = _mode;
+	invalidateLayout();
+}
+
+void FlameGraphView::setTree()
+{
+	m_tree = NULL;
+	if (m_context && m_context->m_capture)
+	{
+		m_tree = m_enableFiltering ? &m_context->m_capture->getStackTraceTreeFiltered() : &m_context->m_capture->getStackTraceTree();
+	}
+
+	// nodes of the previous tree are gone
+	m_names.clear();
+	m_zoomPath.clear();
+	if (m_tree)
+		m_zoomPath.push_back(m_tree);
+
+	invalidateLayout();
+}
+
+void FlameGraphView::invalidateLayout()
+{
+	m_layoutWidth		= 0;
+	m_highlightLevel	= -1;
+	m_highlightFrame	= -1;
+	viewport()->update();
+}
+
+//--------------------------------------------------------------------------
+/// Lays out the zoomed subtree one level at a time, children share the width
+/// of their parent in proportion to their value
+//--------------------------------------------------------------------------
+void FlameGraphView::layout()
+{
+	m_levels.clear();
+	m_layoutWidth		= qMax(1, viewport()->width());
+	m_highlightLevel	= -1;
+	m_highlightFrame	= -1;
+
+	if (m_zoomPath.empty())
+	{
+		updateScrollBar(true);
+		return;
+	}
+
+	for (size_t i=0; i<m_zoomPath.size(); ++i)
+	{
+		Frame frame;
+		frame.m_node	= m_zoomPath[i];
+		frame.m_x		= 0.0;
+		frame.m_width	= 1.0;
+		frame.m_parent	= i ? 0 : (uint32_t)NO_PARENT;
+
+		m_levels.push_back(rtm_vector<Frame>(1, frame));
+	}
+
+	const double minWidth = double(MIN_FRAME_PIXELS) / double(m_layoutWidth);
+
+	for (;;)
+	{
+		const rtm_vector<Frame>& parents = m_levels.back();
+
+		rtm_vector<Frame> level;
+		for (size_t p=0; p<parents.size(); ++p)
+		{
+			const Frame& parent = parents[p];
+			const rtm::StackTraceTree::ChildNodes& children = parent.m_node->m_children;
+
+			// peak values of children do not add up to peak of the parent
+			uint64_t total = getValue(parent.m_node);
+			uint64_t sum = 0;
+			for (const rtm::StackTraceTree& child : children)
+				sum += getValue(&child);
+			total = qMax(total, sum);
+
+			if (!total)
+				continue;
+
+			const double scale = parent.m_width / double(total);
+			double x = parent.m_x;
+			for (const rtm::StackTraceTree& child : children)
+			{
+				const double width = double(getValue(&child)) * scale;
+				if (width >= minWidth)
+				{
+					Frame frame;
+					frame.m_node	= &child;
+					frame.m_x		= x;
+					frame.m_width	= width;
+					frame.m_parent	= (uint32_t)p;
+					level.push_back(frame);
+				}
+				x += width;
+			}
+		}
+
+		if (level.empty())
+			break;
+
+		m_levels.push_back(std::move(level));
+	}
+
+	updateScrollBar(true);
+}
+
+void FlameGraphView::updateScrollBar(bool _resetPosition)
+{
+	const int contentHeight	= (int)m_levels.size() * getRowHeight();
+	const int viewHeight	= viewport()->height();
+
+	QScrollBar* scrollBar = verticalScrollBar();
+	scrollBar->setRange(0, qMax(0, contentHeight - viewHeight));
+	scrollBar->setPageStep(viewHeight);
+	scrollBar->setSingleStep(getRowHeight());
+
+	// root is where the graph is read from
+	if (_resetPosition)
+		scrollBar->setValue(m_mode == Mode::Flame ? scrollBar->maximum() : 0);
+}
+
+int FlameGraphView::getRowHeight() const
+{
+	return fontMetrics().height() + 4;
+}
+
+int FlameGraphView::getLevelY(int _level) const
+{
+	const int rowHeight = getRowHeight();
+	const int scroll = verticalScrollBar()->value();
+
+	if (m_mode == Mode::Icicle)
+		return _level * rowHeight - scroll;
+
+	const int contentHeight = qMax(viewport()->height(), (int)m_levels.size() * rowHeight);
+	return contentHeight - (_level + 1) * rowHeight - scroll;
+}
+
+bool FlameGraphView::findFrame(const QPoint& _pos, int& _level, int& _frame)
+{
+	if (!m_layoutWidth)
+		return false;
+
+	const int rowHeight = getRowHeight();
+	for (int l=0; l<(int)m_levels.size(); ++l)
+	{
+		const int y = getLevelY(l);
+		if ((_pos.y() < y) || (_pos.y() >= y + rowHeight))
+			continue;
+
+		const double x = double(_pos.x()) / double(m_layoutWidth);
+		const rtm_vector<Frame>& level = m_levels[l];
+
+		rtm_vector<Frame>::const_iterator it = std::upper_bound(level.begin(), level.end(), x, [](double _x, const Frame& _f)
+		{
+			return _x < _f.m_x;
+		});
+
+		if (it == level.begin())
+			return false;
+
+		--it;
+		if (x >= it->m_x + it->m_width)
+			return false;
+
+		_level = l;
+		_frame = (int)(it - level.begin());
+		return true;
+	}
+
+	return false;
+}
+
+uint64_t FlameGraphView::getValue(const rtm::StackTraceTree* _node) const
+{
+	switch (m_metric)
+	{
+		case Metric::Usage:			return (uint64_t)qMax<int64_t>(0, _node->m_memUsage);
+		case Metric::PeakUsage:		return (uint64_t)qMax<int64_t>(0, _node->m_memUsagePeak);
+		case Metric::Operations:	return	(uint64_t)_node->m_opCount[rtm::StackTraceTree::Alloc] +
+											(uint64_t)_node->m_opCount[rtm::StackTraceTree::Free] +
+											(uint64_t)_node->m_opCount[rtm::StackTraceTree::Realloc];
+		default:					return 0;
+	};
+}
+
+const QString& FlameGraphView::getName(const rtm::StackTraceTree* _node)
+{
+	NameMap::iterator it = m_names.find(_node);
+	if (it != m_names.end())
+		return it->second;
+
+	QString name;
+	if (_node == m_tree)
+		name = tr("All");
+	else
+	{
+		const rtm::StackTrace* trace = _node->m_stackTraceList;
+
+		rdebug::StackFrame frame;
+		m_context->resolveStackFrame(trace->m_entries[trace->m_numEntries - _node->m_depth], frame);
+		name = QString::fromUtf8(frame.m_func);
+	}
+
+	return m_names[_node] = name;
+}
+
+void FlameGraphView::paintEvent(QPaintEvent* _event)
+{
+	RTM_UNUSED(_event);
+
+	if (m_layoutWidth != qMax(1, viewport()->width()))
+		layout();
+
+	QPainter painter(viewport());
+	painter.fillRect(viewport()->rect(), palette().color(QPalette::Base));
+
+	const int rowHeight		= getRowHeight();
+	const int viewHeight	= viewport()->height();
+	const double width		= double(m_layoutWidth);
+	const int zoomLevel		= (int)m_zoomPath.size() - 1;
+
+	painter.setPen(palette().color(QPalette::Base));
+
+	for (int l=0; l<(int)m_levels.size(); ++l)
+	{
+		const int y = getLevelY(l);
+		if ((y + rowHeight <= 0) || (y >= viewHeight))
+			continue;
+
+		const rtm_vector<Frame>& level = m_levels[l];
+		for (int f=0; f<(int)level.size(); ++f)
+		{
+			const Frame& frame = level[f];
+			const QRectF rect(frame.m_x * width, y, frame.m_width * width, rowHeight - 1);
+
+			// hue is stable for a function in any zoom or metric
+			const uint32_t hash = (uint32_t)(frame.m_node->m_addressID ^ (frame.m_node->m_addressID >> 32)) * 2654435761U;
+			QColor color = QColor::fromHsv(hash % 50, 150 + (hash >> 8) % 80, 235);
+			if (l < zoomLevel)
+				color = color.lighter(130);
+			if ((l == m_highlightLevel) && (f == m_highlightFrame))
+				color = color.darker(120);
+
+			painter.fillRect(rect, color);
+
+			if (rect.width() < MIN_TEXT_PIXELS)
+				continue;
+
+			const QRectF textRect = rect.adjusted(3, 0, -3, 0);
+			const QString text = fontMetrics().elidedText(getName(frame.m_node), Qt::ElideRight, (int)textRect.width());
+			painter.setPen(Qt::black);
+			painter.drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, text);
+		}
+	}
+}
+
+void FlameGraphView::resizeEvent(QResizeEvent* _event)
+{
+	QAbstractScrollArea::resizeEvent(_event);
+	updateScrollBar(false);
+}
+
+void FlameGraphView::mouseMoveEvent(QMouseEvent* _event)
+{
+	int level = -1;
+	int frame = -1;
+	findFrame(_event->pos(), level, frame);
+
+	if ((level != m_highlightLevel) || (frame != m_highlightFrame))
+	{
+		m_highlightLevel = level;
+		m_highlightFrame = frame;
+		viewport()->update();
+	}
+
+	if (level == -1)
+	{
+		QToolTip::hideText();
+		return;
+	}
+
+	const rtm::StackTraceTree* node = m_levels[level][frame].m_node;
+	const uint64_t total = getValue(m_tree);
+	const uint64_t value = getValue(node);
+	const float pct = total ? float(value) * 100.0f / float(total) : 0.0f;
+
+	QLocale locale;
+	QToolTip::showText(_event->globalPos(),	getName(node) + QString("\n----------------\n") +
+											QObject::tr("     Usage: ") + locale.toString(qlonglong(node->m_memUsage)) + QString("\n") +
+											QObject::tr("Peak usage: ") + locale.toString(qlonglong(node->m_memUsagePeak)) + QString("\n") +
+											QObject::tr("    Allocs: ") + locale.toString(node->m_opCount[rtm::StackTraceTree::Alloc]) + QString("\n") +
+											QObject::tr("  Reallocs: ") + locale.toString(node->m_opCount[rtm::StackTraceTree::Realloc]) + QString("\n") +
+											QObject::tr("     Frees: ") + locale.toString(node->m_opCount[rtm::StackTraceTree::Free]) + QString("\n----------------\n") +
+											QString::number(pct, 'f', 2) + QObject::tr("% of total\n") +
+											QObject::tr("Click to see call stack, double click to zoom"), this);
+}
+
+void FlameGraphView::mouseReleaseEvent(QMouseEvent* _event)
+{
+	if (_event->button() != Qt::LeftButton)
+		return;
+
+	int level, frame;
+	if (!findFrame(_event->pos(), level, frame))
+	{
+		emit setStackTrace(NULL, 0);
+		return;
+	}
+
+	// same traversal as stack tree view, every trace that passes through the node
+	const rtm::StackTraceTree* node = m_levels[level][frame].m_node;
+	const int depth = node->m_depth;
+
+	m_stackTraces.clear();
+	rtm::StackTrace* trace = node->m_stackTraceList;
+	while (trace)
+	{
+		m_stackTraces.push_back(trace);
+		trace = trace->m_next[depth];
+	}
+
+	emit setStackTrace(m_stackTraces.data(), (int)m_stackTraces.size());
+}
+
+//--------------------------------------------------------------------------
+/// Zooms into a frame, or out to one of the ancestors of the zoomed frame
+//--------------------------------------------------------------------------
+void FlameGraphView::mouseDoubleClickEvent(QMouseEvent* _event)
+{
+	int level, frame;
+	if ((_event->button() != Qt::LeftButton) || !findFrame(_event->pos(), level, frame))
+		return;
+
+	const int zoomLevel = (int)m_zoomPath.size() - 1;
+	if (level <= zoomLevel)
+		m_zoomPath.resize(level + 1);
+	else
+	{
+		rtm_vector<const rtm::StackTraceTree*> path;
+		for (int l=level; l>zoomLevel; --l)
+		{
+			const Frame& f = m_levels[l][frame];
+			path.push_back(f.m_node);
+			frame = (int)f.m_parent;
+		}
+
+		m_zoomPath.insert(m_zoomPath.end(), path.rbegin(), path.rend());
+	}
+
+	invalidateLayout();
+}
+
+void FlameGraphView::leaveEvent(QEvent* _event)
+{
+	RTM_UNUSED(_event);
+
+	if (m_highlightLevel != -1)
+	{
+		m_highlightLevel = -1;
+		m_highlightFrame = -1;
+		viewport()->update();
+	}
+}
@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_FLAMEGRAPHVIEW_H
+#define RTM_MTUNER_FLAMEGRAPHVIEW_H
+
+#include <QtWidgets/QAbstractScrollArea>
+
+struct CaptureContext;
+
+//--------------------------------------------------------------------------
+/// Flame graph (root at the bottom) or icicle graph (root at the top) of the
+/// stack trace tree. Frames are laid out level by level starting from the
+/// zoomed node, frames narrower than a pixel are culled together with their
+/// subtrees. Layout is cached and rebuilt only when zoom, metric, tree or
+/// view width changes, painting touches visible levels only.
+//--------------------------------------------------------------------------
+class FlameGraphView : public QAbstractScrollArea
+{
+	Q_OBJECT
+
+public:
+	struct Metric
+	{
+		enum Enum
+		{
+			Usage,
+			PeakUsage,
+			Operations,
+
+			Count
+		};
+	};
+
+	struct Mode
+	{
+		enum Enum
+		{
+			Flame,
+			Icicle
+		};
+	};
+
+	enum
+	{
+		MIN_FRAME_PIXELS	= 1,				///< Narrower frames and their subtrees are not laid out
+		MIN_TEXT_PIXELS		= 24,				///< Narrower frames are drawn without a name
+		NO_PARENT			= 0xffffffff
+	};
+
+	struct Frame
+	{
+		const rtm::StackTraceTree*	m_node;
+		double						m_x;		///< Left edge, fraction of view width
+		double						m_width;	///< Fraction of view width
+		uint32_t					m_parent;	///< Index into previous level
+	};
+
+	typedef rtm_unordered_map<const rtm::StackTraceTree*, QString> NameMap;
+
+private:
+	CaptureContext*							m_context;
+	const rtm::StackTraceTree*				m_tree;			///< Global or filtered tree root
+	rtm_vector<const rtm::StackTraceTree*>	m_zoomPath;		///< Root to zoomed node, ancestors are drawn full width
+	rtm_vector<rtm_vector<Frame>>			m_levels;		///< Frames of each depth, sorted by position
+	int										m_layoutWidth;	///< Width levels were laid out for, 0 if layout is invalid
+	NameMap									m_names;
+	rtm_vector<rtm::StackTrace*>			m_stackTraces;
+	Metric::Enum							m_metric;
+	Mode::Enum								m_mode;
+	bool									m_enableFiltering;	///< Filtered data is built and applied
+	int										m_highlightLevel;
+	int										m_highlightFrame;
+
+public:
+	FlameGraphView(QWidget* _parent = 0);
+
+	void	setContext(CaptureContext* _context);
+	void	setFilteringState(bool _state);
+	void	setMetric(Metric::Enum _metric);
+	void	setMode(Mode::Enum _mode);
+
+	/// QWidget
+	void	paintEvent(QPaintEvent* _event);
+	void	resizeEvent(QResizeEvent* _event);
+	void	mouseMoveEvent(QMouseEvent* _event);
+	void	mouseReleaseEvent(QMouseEvent* _event);
+	void	mouseDoubleClickEvent(QMouseEvent* _event);
+	void	leaveEvent(QEvent* _event);
+
+Q_SIGNALS:
+	void	setStackTrace(rtm::StackTrace**, int);
+
+private:
+	void			setTree();
+	void			invalidateLayout();
+	void			layout();
+	void			updateScrollBar(bool _resetPosition);
+	int				getRowHeight() const;
+	int				getLevelY(int _level) const;
+	bool			findFrame(const QPoint& _pos, int& _level, int& _frame);
+	uint64_t		getValue(const rtm::StackTraceTree* _node) const;
+	const QString&	getName(const rtm::StackTraceTree* _node);
+};
+
+#endif // RTM_MTUNER_FLAMEGRAPHVIEW_H
@@ -33,6 +33,21 @@ Graph::Graph(QWidget* _parent, Qt::WindowFlags _flags) :
 	m_buttonAutoZoom = findChild<QToolButton*>("buttonZoomAuto");
 	connect(m_buttonAutoZoom, SIGNAL(clicked()), m_graph, SLOT(zoomAnimEvent()));
 
+	m_buttonThreads = findChild<QToolButton*>("buttonThreads");
+	connect(m_buttonThreads, SIGNAL(clicked()), m_graph, SLOT(zoomAnimEvent()));
+
+	m_buttonHeaps = findChild<QToolButton*>("buttonHeaps");
+	connect(m_buttonHeaps, SIGNAL(clicked()), m_graph, SLOT(zoomAnimEvent()));
+
+	m_buttonTags = findChild<QToolButton*>("buttonTags");
+	connect(m_buttonTags, SIGNAL(clicked()), m_graph, SLOT(zoomAnimEvent()));
+
+	m_buttonHeatmapSize = findChild<QToolButton*>("buttonHeatmapSize");
+	connect(m_buttonHeatmapSize, SIGNAL(clicked()), this, SLOT(heatmapSizeClicked()));
+
+	m_buttonHeatmapCount = findChild<QToolButton*>("buttonHeatmapCount");
+	connect(m_buttonHeatmapCount, SIGNAL(clicked()), this, SLOT(heatmapCountClicked()));
+
 	m_scroll = findChild<QScrollBar*>("scrollBar");
 	connect(m_scroll, SIGNAL(sliderMoved(int)), this, SLOT(scrollMoved(int)));
 
@@ -60,6 +75,11 @@ void Graph::setContext(CaptureContext* _context, BinLoaderView* _binView)
 		m_buttonZoomSelect->setEnabled(false);
 		m_scroll->setEnabled(false);
 		m_buttonAutoZoom->setEnabled(false);
+		m_buttonThreads->setEnabled(false);
+		m_buttonHeaps->setEnabled(false);
+		m_buttonTags->setEnabled(false);
+		m_buttonHeatmapSize->setEnabled(false);
+		m_buttonHeatmapCount->setEnabled(false);
 	}
 	else
 	{
@@ -69,6 +89,11 @@ void Graph::setContext(CaptureContext* _context, BinLoaderView* _binView)
 		m_buttonZoomSelect->setEnabled(false);
 		m_scroll->setEnabled(false);
 		m_buttonAutoZoom->setEnabled(true);
+		m_buttonThreads->setEnabled(true);
+		m_buttonHeaps->setEnabled(true);
+		m_buttonTags->setEnabled(true);
+		m_buttonHeatmapSize->setEnabled(true);
+		m_buttonHeatmapCount->setEnabled(true);
 	}
 	
 	m_scroll->setEnabled(false);
@@ -79,6 +104,45 @@ bool Graph::isAutoZoomSet() const
 	return m_buttonAutoZoom ? m_buttonAutoZoom->isChecked() : true;
 }
 
+bool Graph::isThreadsViewSet() const
+{
+	return m_buttonThreads ? m_buttonThreads->isChecked() : false;
+}
+
+bool Graph::isHeapsViewSet() const
+{
+	return m_buttonHeaps ? m_buttonHeaps->isChecked() : false;
+}
+
+bool Graph::isTagsViewSet() const
+{
+	return m_buttonTags ? m_buttonTags->isChecked() : false;
+}
+
+bool Graph::isHeatmapSizeSet() const
+{
+	return m_buttonHeatmapSize ? m_buttonHeatmapSize->isChecked() : false;
+}
+
+bool Graph::isHeatmapCountSet() const
+{
+	return m_buttonHeatmapCount ? m_buttonHeatmapCount->isChecked() : false;
+}
+
+void Graph::heatmapSizeClicked()
+{
+	if (m_buttonHeatmapSize->isChecked())
+		m_buttonHeatmapCount->setChecked(false);
+	m_graph->zoomAnimEvent();
+}
+
+void Graph::heatmapCountClicked()
+{
+	if (m_buttonHeatmapCount->isChecked())
+		m_buttonHeatmapSize->setChecked(false);
+	m_graph->zoomAnimEvent();
+}
+
 void Graph::snapshotSelected()
 {
 	if ((m_context->m_capture->getMinTime() != m_context->m_capture->getSnapshotTimeMin()) ||
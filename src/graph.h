@@ -23,6 +23,11 @@ private:
 	QToolButton*	m_buttonZoomReset;
 	QToolButton*	m_buttonZoomSelect;
 	QToolButton*	m_buttonAutoZoom;
+	QToolButton*	m_buttonThreads;
+	QToolButton*	m_buttonHeaps;
+	QToolButton*	m_buttonTags;
+	QToolButton*	m_buttonHeatmapSize;
+	QToolButton*	m_buttonHeatmapCount;
 	QScrollBar*		m_scroll;
 	CaptureContext*	m_context;
 
@@ -32,6 +37,11 @@ public:
 	void changeEvent(QEvent* _event);
 	void setContext(CaptureContext* _context, BinLoaderView* _binView);
 	bool isAutoZoomSet() const;
+	bool isThreadsViewSet() const;
+	bool isHeapsViewSet() const;
+	bool isTagsViewSet() const;
+	bool isHeatmapSizeSet() const;
+	bool isHeatmapCountSet() const;
 	inline GraphWidget* getGraphWidget() { return m_graph; }
 
 public Q_SLOTS:
@@ -40,6 +50,8 @@ public Q_SLOTS:
 	void scrollMoved(int);
 	void highlightTime(uint64_t);
 	void highlightRange(uint64_t, uint64_t);
+	void heatmapSizeClicked();
+	void heatmapCountClicked();
 
 private:
 	Ui::Graph ui;
@@ -11,24 +11,33 @@
 
 GraphCurve::GraphCurve(GraphWidget* _graphWidget)
 {
-	m_graphWidget	= _graphWidget;
-
-	m_minUsage		= 0;
-	m_maxUsage		= 0;
-	m_prevMinTime	= 0;
-	m_prevMaxTime	= 0;
-	m_prevLeft		= 0;
-	m_prevRight		= 0;
-	m_prevPeakUsage = 0;
-	m_prevMinUsage	= 0;
-	m_prevPeakLive	= 0;
-	m_prevMinLive	= 0;
+	m_graph				= NULL;
+	m_graphWidget		= _graphWidget;
+	m_exactTimePerPixel	= 0.0;
+	m_frame				= 0;
+	m_prevPeakUsage		= 0;
+	m_prevMinUsage		= 0;
+	m_prevPeakLive		= 0;
+	m_prevMinLive		= 0;
+}
+
+GraphCurve::~GraphCurve()
+{
+	invalidate();
 }
 
 void GraphCurve::setGraph(Graph* _graph)
 {
-	m_graph			= _graph;
-	m_prevAutoZoom	= !m_graph->isAutoZoomSet();
+	m_graph = _graph;
+	invalidate();
+}
+
+void GraphCurve::invalidate()
+{
+	for (size_t i=0; i<m_tiles.size(); ++i)
+		delete m_tiles[i];
+	m_tiles.clear();
+	m_exactTimePerPixel = 0.0;
 }
 
 QRectF GraphCurve::boundingRect() const
@@ -44,164 +53,249 @@ QPainterPath GraphCurve::shape() const
     return path;
 }
 
-void GraphCurve::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget)
+qreal GraphCurve::mapUsageToY(uint64_t _usage, const QRect& _rect) const
 {
-	RTM_UNUSED(_option);
-	RTM_UNUSED(_widget);
-	CaptureContext* ctx = m_graphWidget->getContext();
-	if (!(ctx && ctx->m_capture))
-		return;
+	const qreal bottom = _rect.y() + _rect.height();
+	if (m_prevPeakUsage <= m_prevMinUsage)
+		return bottom;
 
-	bool autoZoom = m_graph->isAutoZoomSet();
+	const qreal y = bottom - (qreal(qMax(_usage, m_prevMinUsage) - m_prevMinUsage) * _rect.height()) / qreal(m_prevPeakUsage - m_prevMinUsage);
+	return qMax(y, qreal(_rect.y()));
+}
 
-	_painter->setRenderHint(QPainter::Antialiasing, true);
+GraphCurve::Tile* GraphCurve::getTile(rtm::Capture* _capture, double _timePerPixel, int64_t _index)
+{
+	Tile* tile = NULL;
+	for (size_t i=0; i<m_tiles.size(); ++i)
+	{
+		if ((m_tiles[i]->m_timePerPixel == _timePerPixel) && (m_tiles[i]->m_index == _index))
+		{
+			m_tiles[i]->m_lastUsed = m_frame;
+			return m_tiles[i];
+		}
 
-	QRect rect = m_graphWidget->getDrawRect();
-	int left = rect.x();
-	int top = rect.y();
-	int right = rect.width() + rect.x();
-	int bottom = rect.height() + rect.y();
+		// reuse least recently used tile that is not drawn in this frame
+		if ((m_tiles.size() >= MAX_TILES) && (m_tiles[i]->m_lastUsed != m_frame))
+			if (!tile || (m_tiles[i]->m_lastUsed < tile->m_lastUsed))
+				tile = m_tiles[i];
+	}
 
-	uint64_t minTime = m_graphWidget->minTime();
-	uint64_t maxTime = m_graphWidget->maxTime();
+	if (!tile)
+	{
+		tile = new Tile();
+		m_tiles.push_back(tile);
+	}
 
-	uint64_t displayTime = maxTime - minTime;
+	tile->m_timePerPixel	= _timePerPixel;
+	tile->m_index			= _index;
+	tile->m_lastUsed		= m_frame;
+	tile->m_scale.m_height	= 0;
+	tile->m_image			= QImage();
+	tile->m_samples.resize(TILE_WIDTH + 1);
 
-	int xcoord = left;
-	rtm::GraphEntry entry;
-	ctx->m_capture->getGraphAtTime(minTime, entry);
-	const uint64_t startUsage	= entry.m_usage;
-	const uint64_t startLive	= entry.m_numLiveBlocks;
+	const double minTime = double(_capture->getMinTime());
+	const double maxTime = double(_capture->getMaxTime());
+	for (int i=0; i<=TILE_WIDTH; ++i)
+	{
+		const int64_t column = _index * TILE_WIDTH + i - 1;
+		const double time = qBound(minTime, minTime + double(column) * _timePerPixel, maxTime);
+		_capture->getGraphAtTime((uint64_t)time, tile->m_samples[i]);
+	}
+
+	return tile;
+}
 
-	uint64_t peakUsage	= startUsage;
-	uint64_t minUsage	= startUsage;
+static inline qreal getCurveY(uint64_t _value, uint64_t _min, uint64_t _peak, int _height)
+{
+	if (_peak <= _min)
+		return qreal(_height / 2);
+	return qreal(_height) - (qreal(_value - _min) * qreal(_height)) / qreal(_peak - _min);
+}
 
-	uint64_t peakLive	= startLive;
-	uint64_t minLive	= startLive;
+void GraphCurve::renderTile(Tile* _tile, const Scale& _scale)
+{
+	const int height = _scale.m_height;
 
-	int32_t index;
+	_tile->m_scale = _scale;
+	_tile->m_image = QImage(int(std::ceil(TILE_WIDTH * _scale.m_pixelRatio)), int(std::ceil(height * _scale.m_pixelRatio)), QImage::Format_ARGB32_Premultiplied);
+	_tile->m_image.setDevicePixelRatio(_scale.m_pixelRatio);
+	_tile->m_image.fill(Qt::transparent);
 
-	if ((m_prevMinTime != minTime) ||
-		(m_prevMaxTime != maxTime) ||
-		(m_prevLeft != left) ||
-		(m_prevRight != right) || 
-		(m_prevAutoZoom != autoZoom))
+	QPainter painter(&_tile->m_image);
+	painter.setRenderHint(QPainter::Antialiasing, true);
+
+	// first sample belongs to previous tile so the curve continues over the seam
+	QPainterPath pathUsageCurve;
+	QPainterPath pathLiveCurve;
+	for (int i=0; i<=TILE_WIDTH; ++i)
 	{
-		m_graphValues.resize(right-left);
+		const rtm::GraphEntry& entry = _tile->m_samples[i];
+		QPointF usage(i - 1, getCurveY(entry.m_usage, _scale.m_minUsage, _scale.m_peakUsage, height));
+		QPointF live(i - 1, getCurveY(entry.m_numLiveBlocks, _scale.m_minLive, _scale.m_peakLive, height));
 
-		if (!autoZoom)
+		if (i == 0)
 		{
-			peakUsage	= ctx->m_capture->getGlobalStats().m_memoryUsagePeak;
-			minUsage	= 0;
-
-			peakLive	= ctx->m_capture->getGlobalStats().m_numberOfLiveBlocksPeak;
-			minLive		= 0;
+			pathUsageCurve.moveTo(usage);
+			pathLiveCurve.moveTo(live);
 		}
-
-		index = 0;
-		double timeDelta =  double(displayTime) / double(right-left);
-		double time = double(minTime);
-
-		for (;xcoord<right;)
+		else
 		{
-			ctx->m_capture->getGraphAtTime((uint64_t)time, entry);
-			
-			m_graphValues[index++]	= entry;
+			pathUsageCurve.lineTo(usage);
+			pathLiveCurve.lineTo(live);
+		}
+	}
 
-			if (autoZoom)
-			{
-				peakUsage	= qMax(entry.m_usage, peakUsage);
-				minUsage	= qMin(entry.m_usage, minUsage);
+	painter.setBrush(Qt::NoBrush);
+	painter.setPen(QPen(QColor(131, 207, 183, 150), 2.0, Qt::SolidLine));
+	painter.drawPath(pathLiveCurve);
+	painter.setPen(QPen(QColor(50, 150, 170), 2.0, Qt::SolidLine));
+	painter.drawPath(pathUsageCurve);
 
-				peakLive	= qMax(entry.m_numLiveBlocks, peakLive);
-				minLive		= qMin(entry.m_numLiveBlocks, minLive);
-			}
+	// close 'em
+	pathUsageCurve.lineTo(TILE_WIDTH, height);
+	pathLiveCurve.lineTo(TILE_WIDTH, height);
+	pathUsageCurve.lineTo(-1, height);
+	pathLiveCurve.lineTo(-1, height);
 
-			xcoord += 1;
-			time += timeDelta;
-			if (time > maxTime)
-				time = maxTime;
-		}
+	QLinearGradient gradLive(QPoint(0, 0), QPoint(0, height));
+	gradLive.setColorAt(0, QColor(131, 207, 183, 0));
+	gradLive.setColorAt(1, QColor(131, 207, 183, 46));
+	painter.setPen(Qt::NoPen);
+	painter.fillPath(pathLiveCurve, gradLive);
 
-		m_prevPeakUsage = peakUsage;
-		m_prevMinUsage	= minUsage;
+	QLinearGradient gradUsage(QPoint(0, 0), QPoint(0, height));
+	gradUsage.setColorAt(0, QColor(50, 150, 170, 0));
+	gradUsage.setColorAt(1, QColor(50, 150, 170, 46));
+	painter.setPen(Qt::NoPen);
+	painter.fillPath(pathUsageCurve, gradUsage);
+}
 
-		m_prevPeakLive	= peakLive;
-		m_prevMinLive	= minLive;
-	}
-	else
-	{
-		peakUsage	= m_prevPeakUsage;
-		minUsage	= m_prevMinUsage;
+void GraphCurve::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget)
+{
+	RTM_UNUSED(_option);
+	RTM_UNUSED(_widget);
+	CaptureContext* ctx = m_graphWidget->getContext();
+	if (!(ctx && ctx->m_capture && m_graph))
+		return;
 
-		peakLive	= m_prevPeakLive;
-		minLive		= m_prevMinLive;
-	}
+	rtm::Capture* capture = ctx->m_capture;
+	bool autoZoom = m_graph->isAutoZoomSet();
+
+	QRect rect = m_graphWidget->getDrawRect();
+	int left	= rect.x();
+	int top		= rect.y();
+	int width	= rect.width();
+	int height	= rect.height();
 
-	m_prevAutoZoom	= autoZoom;
-	m_prevMinTime	= minTime;
-	m_prevMaxTime	= maxTime;
-	m_prevLeft		= left;
-	m_prevRight		= right;
+	uint64_t minTime = qMax(m_graphWidget->minTime(), capture->getMinTime());
+	uint64_t maxTime = m_graphWidget->maxTime();
 
-	xcoord = left;
-	index = 0;
+	if ((width <= 0) || (height <= 0) || (maxTime <= minTime))
+		return;
 
-	int yUsage	= bottom - (bottom-top)/2;
-	int yLive	= yUsage;
+	const double exactTimePerPixel = double(maxTime - minTime) / double(width);
 
-	if (peakUsage != minUsage)
+	// while zoom animates, tiles of the last exact zoom level are stretched
+	// unless far more of them would be needed than for an exact render
+	double timePerPixel = exactTimePerPixel;
+	if (m_graphWidget->isAnimating() && (m_exactTimePerPixel > 0.0))
 	{
-		peakUsage -= minUsage;
-		yUsage	= bottom - ((startUsage - minUsage) * (bottom-top))/peakUsage;
+		const double numTiles		= (exactTimePerPixel * width) / (m_exactTimePerPixel * TILE_WIDTH);
+		const double numExactTiles	= double(width) / TILE_WIDTH + 1.0;
+		if (numTiles <= numExactTiles * 2.0)
+			timePerPixel = m_exactTimePerPixel;
 	}
 
-	if (peakLive != minLive)
+	const bool scaled = timePerPixel != exactTimePerPixel;
+	if (!scaled)
+		m_exactTimePerPixel = exactTimePerPixel;
+
+	++m_frame;
+
+	const double captureMinTime	= double(capture->getMinTime());
+	const double tileTime		= timePerPixel * TILE_WIDTH;
+	const int64_t firstTile		= (int64_t)std::floor((double(minTime) - captureMinTime) / tileTime);
+	const int64_t lastTile		= (int64_t)std::floor((double(maxTime) - captureMinTime) / tileTime);
+
+	rtm_vector<Tile*> tiles;
+	tiles.reserve(size_t(lastTile - firstTile + 1));
+	for (int64_t i=firstTile; i<=lastTile; ++i)
+		tiles.push_back(getTile(capture, timePerPixel, i));
+
+	Scale scale;
+	scale.m_height		= height;
+	scale.m_pixelRatio	= _painter->device()->devicePixelRatioF();
+
+	if (!autoZoom)
 	{
-		peakLive -= minLive;
-		yLive	= bottom - ((startLive - minLive) * (bottom-top))/peakLive;
+		scale.m_peakUsage	= capture->getGlobalStats().m_memoryUsagePeak;
+		scale.m_minUsage	= 0;
+
+		scale.m_peakLive	= capture->getGlobalStats().m_numberOfLiveBlocksPeak;
+		scale.m_minLive		= 0;
 	}
+	else
+	if (scaled)
+	{
+		scale.m_peakUsage	= m_prevPeakUsage;
+		scale.m_minUsage	= m_prevMinUsage;
 
-	QPainterPath pathUsageCurve;
-	pathUsageCurve.moveTo(xcoord, yUsage);
+		scale.m_peakLive	= m_prevPeakLive;
+		scale.m_minLive		= m_prevMinLive;
+	}
+	else
+	{
+		rtm::GraphEntry entry;
+		capture->getGraphAtTime(minTime, entry);
 
-	QPainterPath pathLiveCurve;
-	pathLiveCurve.moveTo(xcoord, yLive);
+		scale.m_peakUsage	= entry.m_usage;
+		scale.m_minUsage	= entry.m_usage;
 
-	for (;xcoord<right;)
-	{
-		rtm::GraphEntry& entry_graph = m_graphValues[index++];
+		scale.m_peakLive	= entry.m_numLiveBlocks;
+		scale.m_minLive		= entry.m_numLiveBlocks;
 
-		yUsage	= bottom - ((entry_graph.m_usage		 - minUsage) * (bottom-top))/peakUsage;
-		yLive	= bottom - ((entry_graph.m_numLiveBlocks - minLive)  * (bottom-top))/peakLive;
+		for (size_t t=0; t<tiles.size(); ++t)
+		{
+			const Tile* tile = tiles[t];
+			for (int i=1; i<=TILE_WIDTH; ++i)
+			{
+				const double time = captureMinTime + double(tile->m_index * TILE_WIDTH + i - 1) * timePerPixel;
+				if ((time < double(minTime)) || (time > double(maxTime)))
+					continue;
 
-		pathUsageCurve.lineTo(xcoord, yUsage);
-		pathLiveCurve.lineTo(xcoord, yLive);
+				const rtm::GraphEntry& sample = tile->m_samples[i];
+				scale.m_peakUsage	= qMax(sample.m_usage, scale.m_peakUsage);
+				scale.m_minUsage	= qMin(sample.m_usage, scale.m_minUsage);
 
-		xcoord += 1;
+				scale.m_peakLive	= qMax(sample.m_numLiveBlocks, scale.m_peakLive);
+				scale.m_minLive		= qMin(sample.m_numLiveBlocks, scale.m_minLive);
+			}
+		}
 	}
 
-	_painter->setBrush(Qt::NoBrush);
-	_painter->setPen(QPen(QColor(131, 207, 183, 150), 2.0, Qt::SolidLine));
-	_painter->drawPath(pathLiveCurve);
-	_painter->setPen(QPen(QColor(50, 150, 170), 2.0, Qt::SolidLine));
-	_painter->drawPath(pathUsageCurve);
+	m_prevPeakUsage	= scale.m_peakUsage;
+	m_prevMinUsage	= scale.m_minUsage;
 
-	// close 'em
-	pathUsageCurve.lineTo(right, bottom);
-	pathLiveCurve.lineTo(right, bottom);
-	pathUsageCurve.lineTo(left, bottom);
-	pathLiveCurve.lineTo(left, bottom);
+	m_prevPeakLive	= scale.m_peakLive;
+	m_prevMinLive	= scale.m_minLive;
 
-	QLinearGradient gradLive(QPoint(left, top), QPoint(left, bottom));
-	gradLive.setColorAt(0, QColor(131, 207, 183, 0));
-	gradLive.setColorAt(1, QColor(131, 207, 183, 46));
-	_painter->setPen(Qt::NoPen);
-	_painter->fillPath(pathLiveCurve, gradLive);
+	_painter->save();
+	_painter->setClipRect(rect);
+	_painter->setRenderHint(QPainter::SmoothPixmapTransform, scaled);
 
-	QLinearGradient gradUsage(QPoint(left, top), QPoint(left, bottom));
-	gradUsage.setColorAt(0, QColor(50, 150, 170, 0));
-	gradUsage.setColorAt(1, QColor(50, 150, 170, 46));
-	_painter->setPen(Qt::NoPen);
-	_painter->fillPath(pathUsageCurve, gradUsage);
+	const double tileWidth = tileTime / exactTimePerPixel;
+	for (size_t t=0; t<tiles.size(); ++t)
+	{
+		Tile* tile = tiles[t];
+		if (!(tile->m_scale == scale))
+			renderTile(tile, scale);
+
+		double x = left + (captureMinTime + double(tile->m_index) * tileTime - double(minTime)) / exactTimePerPixel;
+		if (!scaled)
+			x = std::floor(x + 0.5);
+
+		_painter->drawImage(QRectF(x, top, tileWidth, height), tile->m_image);
+	}
+
+	_painter->restore();
 }
@@ -9,39 +9,80 @@
 class Graph;
 class GraphWidget;
 
+//--------------------------------------------------------------------------
+/// Usage and live blocks curves. Rendered into fixed width image tiles
+/// aligned to capture time, keyed by zoom level (time per pixel) and tile
+/// index, so panning only renders newly exposed tiles and zoom animation
+/// scales tiles of the last exact zoom level until the animation ends.
+//--------------------------------------------------------------------------
 class GraphCurve : public QGraphicsItem
 {
+public:
+	enum
+	{
+		TILE_WIDTH	= 256,
+		MAX_TILES	= 96
+	};
+
 private:
 	typedef rtm_vector<rtm::GraphEntry> GraphVec;
 
-	Graph*			m_graph;
-	GraphWidget*	m_graphWidget;
-	uint64_t		m_minUsage;
-	uint64_t		m_maxUsage;
-	GraphVec		m_graphValues;
-	bool			m_prevAutoZoom;
-	uint64_t		m_prevMinTime;
-	uint64_t		m_prevMaxTime;
-	int64_t			m_prevLeft;
-	int64_t			m_prevRight;
-	uint64_t		m_prevPeakUsage;
-	uint64_t		m_prevMinUsage;
-	uint64_t		m_prevPeakLive;
-	uint64_t		m_prevMinLive;
+	struct Scale
+	{
+		uint64_t	m_minUsage;
+		uint64_t	m_peakUsage;
+		uint64_t	m_minLive;
+		uint64_t	m_peakLive;
+		int			m_height;
+		qreal		m_pixelRatio;
+
+		bool operator == (const Scale& _other) const
+		{
+			return	(m_minUsage	== _other.m_minUsage)	&& (m_peakUsage	== _other.m_peakUsage) &&
+					(m_minLive	== _other.m_minLive)	&& (m_peakLive	== _other.m_peakLive) &&
+					(m_height	== _other.m_height)		&& (m_pixelRatio == _other.m_pixelRatio);
+		}
+	};
+
+	struct Tile
+	{
+		double		m_timePerPixel;
+		int64_t		m_index;
+		GraphVec	m_samples;		///< TILE_WIDTH + 1 samples, first one is the last column of previous tile
+		Scale		m_scale;		///< Scale m_image was rendered with
+		QImage		m_image;
+		uint32_t	m_lastUsed;
+	};
+
+	Graph*				m_graph;
+	GraphWidget*		m_graphWidget;
+	rtm_vector<Tile*>	m_tiles;
+	double				m_exactTimePerPixel;	///< Zoom level of last exact render, scaled while animating
+	uint32_t			m_frame;
+	uint64_t			m_prevPeakUsage;
+	uint64_t			m_prevMinUsage;
+	uint64_t			m_prevPeakLive;
+	uint64_t			m_prevMinLive;
 
 public:
 	GraphCurve(GraphWidget* _graphWidget);
+	~GraphCurve();
 
 	void		setGraph(Graph* _graph);
 	uint64_t	getMinUsage() const { return m_prevMinUsage; }
 	uint64_t	getMaxUsage() const { return m_prevPeakUsage; }
-	void		parentResized() { prepareGeometryChange(); }
+	qreal		mapUsageToY(uint64_t _usage, const QRect& _rect) const;
+	void		parentResized() { prepareGeometryChange(); invalidate(); }
+	void		invalidate();
 
 	/// QWidget
 	virtual QRectF			boundingRect() const;
 	virtual QPainterPath	shape() const;
 	virtual void			paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget);
-	
+
+private:
+	Tile*		getTile(rtm::Capture* _capture, double _timePerPixel, int64_t _index);
+	void		renderTile(Tile* _tile, const Scale& _scale);
 };
 
 #endif // RTM_MTUNER_GRAPHCURVE_H
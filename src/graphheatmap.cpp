@@ -0,0 +1,193 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/graph.h>
+#include <MTuner/src/graphheatmap.h>
+#include <MTuner/src/graphwidget.h>
+#include <MTuner/src/capturecontext.h>
+
+static QString sizeString(uint64_t _size)
+{
+	if (_size < 1024)
+		return QString::number(_size) + " b";
+	if (_size < 1024*1024)
+		return QString::number(_size/1024) + " Kb";
+	return QString::number(_size/(1024*1024)) + " Mb";
+}
+
+GraphHeatmap::GraphHeatmap(GraphWidget* _graphWidget)
+{
+	m_graph			= NULL;
+	m_graphWidget	= _graphWidget;
+	invalidate();
+}
+
+void GraphHeatmap::invalidate()
+{
+	m_capture	= NULL;
+	m_minTime	= 0;
+	m_maxTime	= 0;
+	m_counts	= false;
+	m_bins.clear();
+	m_image		= QImage();
+}
+
+bool GraphHeatmap::isShown() const
+{
+	CaptureContext* ctx = m_graphWidget->getContext();
+	if (!m_graph || !ctx || !ctx->m_capture)
+		return false;
+
+	return m_graph->isHeatmapSizeSet() || m_graph->isHeatmapCountSet();
+}
+
+QString GraphHeatmap::getBinString(int _bin)
+{
+	const int numBins = rtm::MemoryStats::NUM_HISTOGRAM_BINS;
+	const uint64_t maxSize = uint64_t(rtm::MemoryStats::MIN_HISTOGRAM_SIZE) << _bin;
+
+	if (_bin == 0)
+		return "0 - " + sizeString(maxSize);
+	if (_bin == numBins - 1)
+		return sizeString(maxSize / 2) + "+";
+	return sizeString(maxSize / 2) + " - " + sizeString(maxSize);
+}
+
+QRectF GraphHeatmap::boundingRect() const
+{
+	QSize sz = m_graphWidget->size();
+	return QRectF(-sz.width()/2, -sz.height()/2, sz.width(), sz.height());
+}
+
+QPainterPath GraphHeatmap::shape() const
+{
+    QPainterPath path;
+	path.addRect( QRectF(0, 0, 0, 0) );
+    return path;
+}
+
+void GraphHeatmap::updateImage(rtm::Capture* _capture, int _width, uint64_t _minTime, uint64_t _maxTime, bool _counts)
+{
+	const int numBins = rtm::MemoryStats::NUM_HISTOGRAM_BINS;
+
+	const bool sameRange = (m_capture == _capture) && (m_minTime == _minTime) && (m_maxTime == _maxTime) &&
+						   ((int)m_bins.size() == _width * numBins);
+	if (sameRange && (m_counts == _counts) && !m_image.isNull())
+		return;
+
+	if (!sameRange)
+	{
+		m_bins.resize(_width * numBins);
+		_capture->getHistogramSlices(_minTime, _maxTime, _width, &m_bins[0]);
+	}
+
+	m_capture	= _capture;
+	m_minTime	= _minTime;
+	m_maxTime	= _maxTime;
+	m_counts	= _counts;
+
+	uint64_t maxValue = 0;
+	for (size_t i=0; i<m_bins.size(); ++i)
+		maxValue = qMax(maxValue, _counts ? (uint64_t)m_bins[i].m_countPeak : m_bins[i].m_sizePeak);
+
+	m_image = QImage(_width, numBins, QImage::Format_ARGB32);
+	m_image.fill(Qt::transparent);
+
+	if (!maxValue)
+		return;
+
+	// log scale so that small size classes are visible next to the dominant one
+	const double scale = 1.0 / std::log(1.0 + double(maxValue));
+
+	for (int x=0; x<_width; ++x)
+	{
+		const rtm::HistogramBin* bins = &m_bins[x * numBins];
+		for (int b=0; b<numBins; ++b)
+		{
+			const uint64_t value = _counts ? (uint64_t)bins[b].m_countPeak : bins[b].m_sizePeak;
+			if (!value)
+				continue;
+
+			const double t = std::log(1.0 + double(value)) * scale;
+			m_image.setPixel(x, numBins - 1 - b, QColor::fromHsvF(0.66 * (1.0 - t), 0.9, 1.0, 0.25 + 0.5 * t).rgba());
+		}
+	}
+}
+
+bool GraphHeatmap::findBin(const QPointF& _pos, int& _bin, uint64_t& _value, bool& _counts) const
+{
+	const int numBins = rtm::MemoryStats::NUM_HISTOGRAM_BINS;
+
+	if (!isShown() || m_bins.empty() || m_graphWidget->isAnimating())
+		return false;
+
+	QRect rect = m_graphWidget->getDrawRect();
+	const int x = int(_pos.x()) - rect.x();
+	const int y = int(_pos.y()) - rect.y();
+	if ((x < 0) || (x * numBins >= (int)m_bins.size()) || (y < 0) || (y >= rect.height()))
+		return false;
+
+	_bin	= numBins - 1 - (y * numBins) / rect.height();
+	_counts	= m_counts;
+
+	const rtm::HistogramBin& bin = m_bins[x * numBins + _bin];
+	_value	= m_counts ? (uint64_t)bin.m_countPeak : bin.m_sizePeak;
+	return true;
+}
+
+void GraphHeatmap::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget)
+{
+	RTM_UNUSED(_option);
+	RTM_UNUSED(_widget);
+
+	if (!isShown())
+		return;
+
+	CaptureContext* ctx = m_graphWidget->getContext();
+	QRect rect = m_graphWidget->getDrawRect();
+	uint64_t minTime = m_graphWidget->minTime();
+	uint64_t maxTime = m_graphWidget->maxTime();
+	if ((rect.width() <= 0) || (rect.height() <= 0) || (maxTime <= minTime))
+		return;
+
+	const bool counts = m_graph->isHeatmapCountSet();
+
+	// while zoom animates the last image is stretched, slices are computed once it settles
+	const bool stretch = m_graphWidget->isAnimating() && !m_image.isNull() && (m_capture == ctx->m_capture) && (m_counts == counts);
+	if (!stretch)
+		updateImage(ctx->m_capture, rect.width(), minTime, maxTime, counts);
+
+	if (m_image.isNull())
+		return;
+
+	const double pixelsPerTime = double(rect.width()) / double(maxTime - minTime);
+	const double x0 = rect.x() + (double(m_minTime) - double(minTime)) * pixelsPerTime;
+	const double x1 = rect.x() + (double(m_maxTime) - double(minTime)) * pixelsPerTime;
+
+	_painter->save();
+	_painter->setClipRect(rect);
+	_painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+	_painter->drawImage(QRectF(x0, rect.y(), x1 - x0, rect.height()), m_image);
+
+	// size class labels along the right edge
+	const int numBins = rtm::MemoryStats::NUM_HISTOGRAM_BINS;
+	const qreal binHeight = qreal(rect.height()) / numBins;
+
+	QFont font("Consolas", 7, QFont::Normal);
+	_painter->setFont(font);
+	_painter->setPen(QColor(255, 255, 255, 160));
+
+	QFontMetrics fm(font);
+	const int step = qMax(1, int(std::ceil(fm.height() / binHeight)));
+	for (int b=0; b<numBins; b+=step)
+	{
+		const QString label = sizeString(uint64_t(rtm::MemoryStats::MIN_HISTOGRAM_SIZE) << b);
+		const qreal y = rect.y() + (numBins - b - 0.5) * binHeight + fm.ascent() / 2.0;
+		_painter->drawText(QPointF(rect.x() + rect.width() - fm.horizontalAdvance(label) - 4, y), label);
+	}
+
+	_painter->restore();
+}
@@ -0,0 +1,51 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_GRAPHHEATMAP_H
+#define RTM_MTUNER_GRAPHHEATMAP_H
+
+class Graph;
+class GraphWidget;
+
+//--------------------------------------------------------------------------
+/// Live bytes or blocks per histogram size class over time, drawn under the
+/// usage curve. Each pixel column is a time slice with its peak per class,
+/// colour intensity is on a log scale of the largest visible value.
+//--------------------------------------------------------------------------
+class GraphHeatmap : public QGraphicsItem
+{
+	Graph*						m_graph;
+	GraphWidget*				m_graphWidget;
+	rtm::Capture*				m_capture;
+	uint64_t					m_minTime;
+	uint64_t					m_maxTime;
+	bool						m_counts;
+	rtm_vector<rtm::HistogramBin> m_bins;		///< Histogram per column
+	QImage						m_image;		///< One pixel per column and size class
+
+public:
+	GraphHeatmap(GraphWidget* _graphWidget);
+
+	void	setGraph(Graph* _graph) { m_graph = _graph; }
+	void	parentResized() { prepareGeometryChange(); invalidate(); }
+	void	invalidate();
+	bool	isShown() const;
+
+	/// Finds size class under scene position, value is the peak of the column
+	bool	findBin(const QPointF& _pos, int& _bin, uint64_t& _value, bool& _counts) const;
+
+	/// Returns size range of a histogram bin as text
+	static QString getBinString(int _bin);
+
+	/// QWidget
+	virtual QRectF			boundingRect() const;
+	virtual QPainterPath	shape() const;
+	virtual void			paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget);
+
+private:
+	void	updateImage(rtm::Capture* _capture, int _width, uint64_t _minTime, uint64_t _maxTime, bool _counts);
+};
+
+#endif // RTM_MTUNER_GRAPHHEATMAP_H
@@ -0,0 +1,249 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/graph.h>
+#include <MTuner/src/graphoverlay.h>
+#include <MTuner/src/graphcurve.h>
+#include <MTuner/src/graphwidget.h>
+#include <MTuner/src/capturecontext.h>
+
+#include <algorithm>
+
+static const rtm::MemoryTagTree* findTag(const rtm::MemoryTagTree* _tree, uint32_t _key)
+{
+	if (_tree->m_hash == _key)
+		return _tree;
+
+	rtm::MemoryTagTree::ChildMap::const_iterator it  = _tree->m_children.begin();
+	rtm::MemoryTagTree::ChildMap::const_iterator end = _tree->m_children.end();
+	for (; it != end; ++it)
+	{
+		const rtm::MemoryTagTree* tag = findTag(it->second, _key);
+		if (tag)
+			return tag;
+	}
+	return NULL;
+}
+
+GraphOverlay::GraphOverlay(GraphWidget* _graphWidget, GraphCurve* _curve, Source::Enum _source)
+{
+	m_graph			= NULL;
+	m_graphWidget	= _graphWidget;
+	m_curve			= _curve;
+	m_source		= _source;
+	invalidate();
+}
+
+void GraphOverlay::invalidate()
+{
+	m_timeline		= NULL;
+	m_minTime		= 0;
+	m_maxTime		= 0;
+	m_left			= 0;
+	m_selectedKey	= 0;
+	m_keys.clear();
+	m_names.clear();
+	m_ranges.clear();
+}
+
+bool GraphOverlay::isShown() const
+{
+	CaptureContext* ctx = m_graphWidget->getContext();
+	if (!m_graph || !ctx || !ctx->m_capture)
+		return false;
+
+	return m_source == Source::Heaps ? m_graph->isHeapsViewSet() : m_graph->isTagsViewSet();
+}
+
+QRectF GraphOverlay::boundingRect() const
+{
+	QSize sz = m_graphWidget->size();
+	return QRectF(-sz.width()/2, -sz.height()/2, sz.width(), sz.height());
+}
+
+QPainterPath GraphOverlay::shape() const
+{
+    QPainterPath path;
+	path.addRect( QRectF(0, 0, 0, 0) );
+    return path;
+}
+
+const rtm::UsageTimeline& GraphOverlay::getTimeline(rtm::Capture* _capture) const
+{
+	return m_source == Source::Heaps ? _capture->getHeapTimeline() : _capture->getTagTimeline();
+}
+
+uint64_t GraphOverlay::getSelectedKey(rtm::Capture* _capture, bool& _selected) const
+{
+	const rtm::FilterCriteria& criteria = _capture->getFilterCriteria();
+
+	if (m_source == Source::Heaps)
+	{
+		_selected = criteria.m_heap != (uint64_t)-1;
+		return criteria.m_heap;
+	}
+
+	_selected = (criteria.m_tagHash != 0) && (criteria.m_tagHash != 0xffffffff);
+	return criteria.m_tagHash;
+}
+
+QString GraphOverlay::getName(rtm::Capture* _capture, uint64_t _key) const
+{
+	if (m_source == Source::Heaps)
+	{
+		rtm::HeapsType& heaps = _capture->getHeaps();
+		rtm::HeapsType::iterator it = heaps.find(_key);
+		if (it != heaps.end())
+			return QString::fromUtf8(it->second.c_str());
+		return QString("0x") + QString::number(_key, 16);
+	}
+
+	if (_key == 0)
+		return QObject::tr("Untagged");
+
+	const rtm::MemoryTagTree* tag = findTag(&_capture->getTagTree(), (uint32_t)_key);
+	if (tag)
+		return QString::fromUtf8(tag->m_name.c_str());
+	return QString("0x") + QString::number(_key, 16);
+}
+
+void GraphOverlay::updateCurves(rtm::Capture* _capture, const QRect& _rect, uint64_t _minTime, uint64_t _maxTime)
+{
+	const rtm::UsageTimeline* timeline = &getTimeline(_capture);
+
+	bool selected;
+	const uint64_t selectedKey = getSelectedKey(_capture, selected);
+
+	const int width = _rect.width();
+	if ((m_timeline == timeline) && (m_minTime == _minTime) && (m_maxTime == _maxTime) &&
+		(m_left == _rect.x()) && (m_selectedKey == selectedKey) &&
+		!m_ranges.empty() && ((int)m_ranges[0].size() == width))
+		return;
+
+	m_timeline		= timeline;
+	m_minTime		= _minTime;
+	m_maxTime		= _maxTime;
+	m_left			= _rect.x();
+	m_selectedKey	= selectedKey;
+
+	// series are sorted by peak, selected one is added if it didn't make the cut
+	const rtm_vector<rtm::UsageTimeline::Series>& series = timeline->getSeries();
+	const size_t numTop = qMin(series.size(), (size_t)MAX_CURVES);
+
+	m_keys.clear();
+	for (size_t s=0; s<numTop; ++s)
+		m_keys.push_back(series[s].m_key);
+
+	if (selected && timeline->findSeries(selectedKey) && (std::find(m_keys.begin(), m_keys.end(), selectedKey) == m_keys.end()))
+		m_keys.push_back(selectedKey);
+
+	m_names.resize(m_keys.size());
+	m_ranges.resize(m_keys.size());
+	for (size_t c=0; c<m_keys.size(); ++c)
+	{
+		m_names[c] = getName(_capture, m_keys[c]);
+		m_ranges[c].resize(width);
+		if (width > 0)
+			timeline->getRanges(*timeline->findSeries(m_keys[c]), _minTime, _maxTime, width, &m_ranges[c][0]);
+	}
+}
+
+void GraphOverlay::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget)
+{
+	RTM_UNUSED(_option);
+	RTM_UNUSED(_widget);
+
+	if (!isShown())
+		return;
+
+	CaptureContext* ctx = m_graphWidget->getContext();
+	if (getTimeline(ctx->m_capture).isEmpty())
+		return;
+
+	QRect rect = m_graphWidget->getDrawRect();
+	uint64_t minTime = m_graphWidget->minTime();
+	uint64_t maxTime = m_graphWidget->maxTime();
+	if ((rect.width() <= 0) || (maxTime <= minTime))
+		return;
+
+	updateCurves(ctx->m_capture, rect, minTime, maxTime);
+
+	bool selected;
+	getSelectedKey(ctx->m_capture, selected);
+
+	_painter->save();
+	_painter->setClipRect(rect);
+
+	const int width = rect.width();
+	const int hueOffset = m_source == Source::Heaps ? 0 : 60;
+
+	for (size_t c=0; c<m_keys.size(); ++c)
+	{
+		const Ranges& ranges = m_ranges[c];
+		const bool isSelected = selected && (m_keys[c] == m_selectedKey);
+
+		QColor color = QColor::fromHsv(int(hueOffset + c * 137) % 360, 200, 230);
+
+		QPolygonF envelope;
+		QPolygonF line;
+		envelope.reserve(width * 2);
+		line.reserve(width);
+
+		for (int x=0; x<width; ++x)
+		{
+			const qreal y = m_curve->mapUsageToY(ranges[x].m_maxUsage, rect);
+			envelope.append(QPointF(m_left + x, y));
+			line.append(QPointF(m_left + x, y));
+		}
+
+		for (int x=width-1; x>=0; --x)
+			envelope.append(QPointF(m_left + x, m_curve->mapUsageToY(ranges[x].m_minUsage, rect)));
+
+		_painter->setRenderHint(QPainter::Antialiasing, false);
+		_painter->setPen(Qt::NoPen);
+		color.setAlpha(isSelected ? 90 : 50);
+		_painter->setBrush(color);
+		_painter->drawPolygon(envelope);
+
+		_painter->setRenderHint(QPainter::Antialiasing, true);
+		color.setAlpha(255);
+		_painter->setPen(QPen(color, isSelected ? 3.0 : 1.5));
+		_painter->setBrush(Qt::NoBrush);
+		_painter->drawPolyline(line);
+	}
+
+	// legend, heaps on the left and tags on the right so both fit when shown together
+	QFontMetrics fm(_painter->font());
+	const int lineHeight	= fm.height();
+	const int swatch		= lineHeight - 4;
+
+	int legendWidth = 0;
+	for (size_t c=0; c<m_names.size(); ++c)
+		legendWidth = qMax(legendWidth, fm.horizontalAdvance(m_names[c]));
+	legendWidth += swatch + 6;
+
+	const int legendX = m_source == Source::Heaps ? rect.x() + 8 : rect.x() + rect.width() - legendWidth - 8;
+	int legendY = rect.y() + 4;
+
+	_painter->setRenderHint(QPainter::Antialiasing, false);
+	for (size_t c=0; c<m_names.size(); ++c)
+	{
+		QColor color = QColor::fromHsv(int(hueOffset + c * 137) % 360, 200, 230);
+		_painter->setPen(Qt::NoPen);
+		_painter->setBrush(color);
+		_painter->drawRect(legendX, legendY + 2, swatch, swatch);
+
+		QFont font = _painter->font();
+		font.setBold(selected && (m_keys[c] == m_selectedKey));
+		_painter->setFont(font);
+		_painter->setPen(Qt::white);
+		_painter->drawText(legendX + swatch + 6, legendY + fm.ascent(), m_names[c]);
+
+		legendY += lineHeight;
+	}
+
+	_painter->restore();
+}
@@ -0,0 +1,71 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_GRAPHOVERLAY_H
+#define RTM_MTUNER_GRAPHOVERLAY_H
+
+class Graph;
+class GraphWidget;
+class GraphCurve;
+
+//--------------------------------------------------------------------------
+/// Usage curves of heaps or memory tags with the highest peaks drawn over
+/// the total usage curve, together with the currently selected one. Each
+/// curve is the maximum of its bucket with min/max envelope behind it.
+//--------------------------------------------------------------------------
+class GraphOverlay : public QGraphicsItem
+{
+public:
+	struct Source
+	{
+		enum Enum
+		{
+			Heaps,
+			Tags
+		};
+	};
+
+	enum
+	{
+		MAX_CURVES = 8
+	};
+
+private:
+	typedef rtm_vector<rtm::UsageTimeline::Range> Ranges;
+
+	Graph*						m_graph;
+	GraphWidget*				m_graphWidget;
+	GraphCurve*					m_curve;
+	Source::Enum				m_source;
+	const rtm::UsageTimeline*	m_timeline;
+	uint64_t					m_minTime;
+	uint64_t					m_maxTime;
+	int							m_left;
+	uint64_t					m_selectedKey;
+	rtm_vector<uint64_t>		m_keys;
+	rtm_vector<QString>			m_names;
+	rtm_vector<Ranges>			m_ranges;		///< Value range of each curve, per column
+
+public:
+	GraphOverlay(GraphWidget* _graphWidget, GraphCurve* _curve, Source::Enum _source);
+
+	void	setGraph(Graph* _graph) { m_graph = _graph; }
+	void	parentResized() { prepareGeometryChange(); invalidate(); }
+	void	invalidate();
+	bool	isShown() const;
+
+	/// QWidget
+	virtual QRectF			boundingRect() const;
+	virtual QPainterPath	shape() const;
+	virtual void			paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget);
+
+private:
+	const rtm::UsageTimeline&	getTimeline(rtm::Capture* _capture) const;
+	uint64_t					getSelectedKey(rtm::Capture* _capture, bool& _selected) const;
+	QString						getName(rtm::Capture* _capture, uint64_t _key) const;
+	void						updateCurves(rtm::Capture* _capture, const QRect& _rect, uint64_t _minTime, uint64_t _maxTime);
+};
+
+#endif // RTM_MTUNER_GRAPHOVERLAY_H
@@ -0,0 +1,166 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/graph.h>
+#include <MTuner/src/graphthreads.h>
+#include <MTuner/src/graphcurve.h>
+#include <MTuner/src/graphwidget.h>
+#include <MTuner/src/capturecontext.h>
+
+GraphThreads::GraphThreads(GraphWidget* _graphWidget, GraphCurve* _curve)
+{
+	m_graph			= NULL;
+	m_graphWidget	= _graphWidget;
+	m_curve			= _curve;
+	invalidate();
+}
+
+void GraphThreads::invalidate()
+{
+	m_timeline	= NULL;
+	m_minTime	= 0;
+	m_maxTime	= 0;
+	m_left		= 0;
+	m_threads.clear();
+	m_tops.clear();
+}
+
+bool GraphThreads::isShown() const
+{
+	CaptureContext* ctx = m_graphWidget->getContext();
+	return m_graph && m_graph->isThreadsViewSet() && ctx && ctx->m_capture;
+}
+
+QRectF GraphThreads::boundingRect() const
+{
+	QSize sz = m_graphWidget->size();
+	return QRectF(-sz.width()/2, -sz.height()/2, sz.width(), sz.height());
+}
+
+QPainterPath GraphThreads::shape() const
+{
+    QPainterPath path;
+	path.addRect( QRectF(0, 0, 0, 0) );
+    return path;
+}
+
+void GraphThreads::updateBands(const rtm::UsageTimeline* _timeline, const QRect& _rect, uint64_t _minTime, uint64_t _maxTime)
+{
+	const int width = _rect.width();
+	if ((m_timeline == _timeline) && (m_minTime == _minTime) && (m_maxTime == _maxTime) &&
+		(m_left == _rect.x()) && !m_tops.empty() && ((int)m_tops[0].size() == width))
+		return;
+
+	m_timeline	= _timeline;
+	m_minTime	= _minTime;
+	m_maxTime	= _maxTime;
+	m_left		= _rect.x();
+
+	const rtm_vector<rtm::UsageTimeline::Series>& series = _timeline->getSeries();
+	const size_t numSeries	= series.size();
+	const size_t numOwn		= numSeries > MAX_BANDS ? MAX_BANDS - 1 : numSeries;
+	const size_t numBands	= numSeries > MAX_BANDS ? MAX_BANDS : numSeries;
+
+	m_threads.resize(numOwn);
+	for (size_t s=0; s<numOwn; ++s)
+		m_threads[s] = series[s].m_key;
+
+	m_tops.resize(numBands);
+	for (size_t b=0; b<numBands; ++b)
+		m_tops[b].assign(width, 0);
+
+	if (width <= 0)
+		return;
+
+	rtm_vector<rtm::UsageTimeline::Range> ranges(width);
+	for (size_t s=0; s<numSeries; ++s)
+	{
+		_timeline->getRanges(series[s], _minTime, _maxTime, width, &ranges[0]);
+
+		rtm_vector<uint64_t>& tops = m_tops[qMin(s, numBands - 1)];
+		for (int x=0; x<width; ++x)
+			tops[x] += ranges[x].m_maxUsage;
+	}
+
+	for (size_t b=1; b<numBands; ++b)
+		for (int x=0; x<width; ++x)
+			m_tops[b][x] += m_tops[b - 1][x];
+}
+
+bool GraphThreads::findThread(const QPointF& _pos, uint64_t& _threadID, uint64_t& _usage) const
+{
+	if (!isShown() || m_tops.empty())
+		return false;
+
+	QRect rect = m_graphWidget->getDrawRect();
+	const int x = int(_pos.x()) - m_left;
+	if ((x < 0) || (x >= (int)m_tops[0].size()))
+		return false;
+
+	for (size_t b=0; b<m_threads.size(); ++b)
+	{
+		if (_pos.y() < m_curve->mapUsageToY(m_tops[b][x], rect))
+			continue;
+
+		_threadID	= m_threads[b];
+		_usage		= m_tops[b][x] - (b ? m_tops[b - 1][x] : 0);
+		return true;
+	}
+
+	return false;
+}
+
+void GraphThreads::paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget)
+{
+	RTM_UNUSED(_option);
+	RTM_UNUSED(_widget);
+
+	if (!isShown())
+		return;
+
+	CaptureContext* ctx = m_graphWidget->getContext();
+	const rtm::UsageTimeline& timeline = ctx->m_capture->getThreadTimeline();
+	if (timeline.isEmpty())
+		return;
+
+	QRect rect = m_graphWidget->getDrawRect();
+	uint64_t minTime = m_graphWidget->minTime();
+	uint64_t maxTime = m_graphWidget->maxTime();
+	if ((rect.width() <= 0) || (maxTime <= minTime))
+		return;
+
+	updateBands(&timeline, rect, minTime, maxTime);
+
+	const uint64_t selectedThread = ctx->m_capture->getFilteringEnabled() ? ctx->m_capture->getFilterCriteria().m_threadID : 0;
+
+	_painter->save();
+	_painter->setClipRect(rect);
+	_painter->setRenderHint(QPainter::Antialiasing, false);
+	_painter->setPen(Qt::NoPen);
+
+	const int width = rect.width();
+	for (size_t b=0; b<m_tops.size(); ++b)
+	{
+		QPolygonF band;
+		band.reserve(width * 2);
+
+		for (int x=0; x<width; ++x)
+			band.append(QPointF(m_left + x, m_curve->mapUsageToY(m_tops[b][x], rect)));
+
+		for (int x=width-1; x>=0; --x)
+			band.append(QPointF(m_left + x, b ? m_curve->mapUsageToY(m_tops[b - 1][x], rect) : qreal(rect.y() + rect.height())));
+
+		const bool other	= b >= m_threads.size();
+		const bool selected	= !other && (m_threads[b] == selectedThread);
+
+		QColor color = other ? QColor(Qt::gray) : QColor::fromHsv(int(b * 137) % 360, 150, 210);
+		color.setAlpha(selected ? 190 : 90);
+		_painter->setBrush(color);
+		_painter->drawPolygon(band);
+	}
+
+	_painter->restore();
+}
@@ -0,0 +1,58 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_GRAPHTHREADS_H
+#define RTM_MTUNER_GRAPHTHREADS_H
+
+class Graph;
+class GraphWidget;
+class GraphCurve;
+
+//--------------------------------------------------------------------------
+/// Stacked bands of memory usage per allocating thread, drawn from the
+/// capture thread timeline over the usage curve. Threads with the highest
+/// peaks get their own band, the rest are stacked in one. Band heights are
+/// bucket maximums, recomputed only when the visible range changes.
+//--------------------------------------------------------------------------
+class GraphThreads : public QGraphicsItem
+{
+public:
+	enum
+	{
+		MAX_BANDS = 12
+	};
+
+private:
+	Graph*							m_graph;
+	GraphWidget*					m_graphWidget;
+	GraphCurve*						m_curve;
+	const rtm::UsageTimeline*		m_timeline;
+	uint64_t						m_minTime;
+	uint64_t						m_maxTime;
+	int								m_left;
+	rtm_vector<uint64_t>			m_threads;		///< Thread of each band, other threads band has none
+	rtm_vector<rtm_vector<uint64_t>>m_tops;			///< Stacked usage at the top of each band, per column
+
+public:
+	GraphThreads(GraphWidget* _graphWidget, GraphCurve* _curve);
+
+	void	setGraph(Graph* _graph) { m_graph = _graph; }
+	void	parentResized() { prepareGeometryChange(); invalidate(); }
+	void	invalidate();
+	bool	isShown() const;
+
+	/// Finds band under scene position, returns false if there is none or it is the band of other threads
+	bool	findThread(const QPointF& _pos, uint64_t& _threadID, uint64_t& _usage) const;
+
+	/// QWidget
+	virtual QRectF			boundingRect() const;
+	virtual QPainterPath	shape() const;
+	virtual void			paint(QPainter* _painter, const QStyleOptionGraphicsItem* _option, QWidget* _widget);
+
+private:
+	void	updateBands(const rtm::UsageTimeline* _timeline, const QRect& _rect, uint64_t _minTime, uint64_t _maxTime);
+};
+
+#endif // RTM_MTUNER_GRAPHTHREADS_H
@@ -10,6 +10,9 @@
 #include <MTuner/src/graphcurve.h>
 #include <MTuner/src/graphselect.h>
 #include <MTuner/src/graphmarkers.h>
+#include <MTuner/src/graphthreads.h>
+#include <MTuner/src/graphoverlay.h>
+#include <MTuner/src/graphheatmap.h>
 #include <MTuner/src/capturecontext.h>
 
 GraphWidget::GraphWidget(QWidget* _parent) :
@@ -35,6 +38,7 @@ GraphWidget::GraphWidget(QWidget* _parent) :
 	m_hightlightTimeEnd		= (uint64_t)-1;
 	m_hightlightIntensity	= 0.f;
 	m_highlightAnimation	= NULL;
+	m_numZoomAnimations		= 0;
 	m_LButtonDown			= false;
 	m_isDragging			= false;
 	m_RButtonDown			= false;
@@ -45,11 +49,28 @@ GraphWidget::GraphWidget(QWidget* _parent) :
 	m_context				= NULL;
 	m_inContextMenu			= false;
 
+	// added first so that the usage curve is drawn over it
+	m_heatmap = new GraphHeatmap(this);
+	m_heatmap->parentResized();
+	m_scene->addItem(m_heatmap);
+
 	GraphCurve* curve = new GraphCurve(this);
 	curve->parentResized();
 	m_curves.append(curve);
 	m_scene->addItem(curve);
 
+	m_threads = new GraphThreads(this, curve);
+	m_threads->parentResized();
+	m_scene->addItem(m_threads);
+
+	m_heapOverlay = new GraphOverlay(this, curve, GraphOverlay::Source::Heaps);
+	m_heapOverlay->parentResized();
+	m_scene->addItem(m_heapOverlay);
+
+	m_tagOverlay = new GraphOverlay(this, curve, GraphOverlay::Source::Tags);
+	m_tagOverlay->parentResized();
+	m_scene->addItem(m_tagOverlay);
+
 	m_markers = new GraphMarkers(this);
 	m_markers->parentResized();
 	m_scene->addItem(m_markers);
@@ -82,6 +103,10 @@ void GraphWidget::setGraph(Graph* _graph)
 	Q_FOREACH( GraphCurve* it, m_curves ) {
 		it->setGraph(m_graph); 
 	}
+	m_threads->setGraph(m_graph);
+	m_heapOverlay->setGraph(m_graph);
+	m_tagOverlay->setGraph(m_graph);
+	m_heatmap->setGraph(m_graph);
 }
 
 void GraphWidget::setMinTime(uint64_t _minTime)
@@ -115,6 +140,14 @@ bool GraphWidget::event(QEvent* _event)
 void GraphWidget::setContext(CaptureContext* _context, BinLoaderView* _view)
 {
 	m_context = _context;
+	Q_FOREACH( GraphCurve* it, m_curves ) {
+		it->invalidate();
+	}
+	m_threads->invalidate();
+	m_heapOverlay->invalidate();
+	m_tagOverlay->invalidate();
+	m_heatmap->invalidate();
+
 	if (!_context == NULL)
 	{
 		//setToolTip(tr("Click inside the graph area and drag\nleft mouse button to select a time slice"));
@@ -270,6 +303,10 @@ void GraphWidget::animateRange(uint64_t _min, uint64_t _max)
 	animation->setStartValue(qulonglong(m_maxTime));
 	animation->setEndValue(qulonglong(_max));
 	animation->start();
+
+	// curve stretches cached tiles until the last step is rendered exactly
+	++m_numZoomAnimations;
+	connect(animation, SIGNAL(finished()), this, SLOT(zoomAnimFinished()));
 }
 
 void GraphWidget::myShowTooltip()
@@ -373,6 +410,12 @@ void GraphWidget::zoomAnimEvent()
 	invalidateScene();
 }
 
+void GraphWidget::zoomAnimFinished()
+{
+	--m_numZoomAnimations;
+	invalidateScene();
+}
+
 void GraphWidget::markerSnapTo()
 {
 	uint64_t f = m_hoverMarkerTime;
@@ -428,6 +471,18 @@ void GraphWidget::resizeEvent(QResizeEvent* _event)
 	if (m_grid)
 		m_grid->parentResized();
 
+	if (m_threads)
+		m_threads->parentResized();
+
+	if (m_heapOverlay)
+		m_heapOverlay->parentResized();
+
+	if (m_tagOverlay)
+		m_tagOverlay->parentResized();
+
+	if (m_heatmap)
+		m_heatmap->parentResized();
+
 	Q_FOREACH( GraphCurve* it, m_curves ) {
 		it->parentResized();
 	}
@@ -624,6 +679,19 @@ uint64_t GraphWidget::currentPos()
 						   "<nobr>" + QStringColor(tr("Usage") + ":", "ff83cf67") + m_locale.toString(qulonglong(entry.m_usage)) + "</nobr>\n" +
 						   "<nobr>" + QStringColor(tr("Live blocks") + ":", "ff42a6ba") + m_locale.toString(qulonglong(entry.m_numLiveBlocks)) + "</nobr>\n";
 
+		uint64_t threadID;
+		uint64_t threadUsage;
+		if (m_threads->findThread(pt, threadID, threadUsage))
+			ttip += "<nobr>" + QStringColor(tr("Thread") + ":", "ffffffff") + "0x" + QString::number(threadID, 16) + "</nobr>\n" +
+					"<nobr>" + QStringColor(tr("Thread usage") + ":", "ffffffff") + m_locale.toString(qulonglong(threadUsage)) + "</nobr>\n";
+
+		int bin;
+		uint64_t binValue;
+		bool binCounts;
+		if (m_heatmap->findBin(pt, bin, binValue, binCounts))
+			ttip += "<nobr>" + QStringColor(tr("Size class") + ":", "ffffffff") + GraphHeatmap::getBinString(bin) + "</nobr>\n" +
+					"<nobr>" + QStringColor((binCounts ? tr("Peak live blocks") : tr("Peak live bytes")) + ":", "ffffffff") + m_locale.toString(qulonglong(binValue)) + "</nobr>\n";
+
 		m_toolTip = ttip;
 		m_toolTipPos = gpt;
 		QTimer::singleShot(60, this, &GraphWidget::myShowTooltip);
@@ -684,6 +752,30 @@ void GraphWidget::mouseReleaseEvent(QMouseEvent* _event)
 	QGraphicsView::mouseReleaseEvent(_event);
 }
 
+void GraphWidget::mouseDoubleClickEvent(QMouseEvent* _event)
+{
+	if (!m_context || !m_threads->isShown() || (_event->button() != Qt::LeftButton))
+	{
+		QGraphicsView::mouseDoubleClickEvent(_event);
+		return;
+	}
+
+	// double click on a thread band toggles the thread filter, elsewhere it changes nothing
+	uint64_t threadID;
+	uint64_t threadUsage;
+	if (!m_threads->findThread(mapToScene(_event->pos()), threadID, threadUsage))
+	{
+		QGraphicsView::mouseDoubleClickEvent(_event);
+		return;
+	}
+
+	if (threadID == m_context->m_capture->getFilterCriteria().m_threadID)
+		threadID = 0;
+
+	emit threadSelected(threadID);
+	invalidateScene();
+}
+
 void GraphWidget::contextMenuEvent(QContextMenuEvent* _event)
 {
 	if (!m_context)
@@ -11,6 +11,9 @@ class GraphCurve;
 class GraphGrid;
 class GraphSelect;
 class GraphMarkers;
+class GraphThreads;
+class GraphOverlay;
+class GraphHeatmap;
 class BinLoaderView;
 struct CaptureContext;
 
@@ -32,6 +35,7 @@ private:
 	uint64_t				m_hightlightTimeEnd;
 	float					m_hightlightIntensity;
 	QPropertyAnimation*		m_highlightAnimation;
+	int						m_numZoomAnimations;
 	bool					m_LButtonDown;
 	bool					m_isDragging;
 	bool					m_RButtonDown;
@@ -44,6 +48,10 @@ private:
 	GraphGrid*				m_grid;
 	GraphSelect*			m_select;
 	GraphMarkers*			m_markers;
+	GraphThreads*			m_threads;
+	GraphOverlay*			m_heapOverlay;
+	GraphOverlay*			m_tagOverlay;
+	GraphHeatmap*			m_heatmap;
 	QMenu*					m_contextMenu;
 	QAction*				m_actionZoomToSelection;
 	QAction*				m_actionZoomReset;
@@ -88,6 +96,7 @@ public:
 	uint64_t		getHighlightTimeEnd() const { return m_hightlightTimeEnd; }
 	void			zoomIn(uint64_t _time);
 	void			zoomOut(uint64_t _time);
+	bool			isAnimating() const { return m_numZoomAnimations > 0; }
 	uint64_t		currentPos();
 
 	/// QGraphicsView
@@ -99,6 +108,7 @@ public:
 	void mousePressEvent(QMouseEvent* _event);
 	void mouseMoveEvent(QMouseEvent* _event);
 	void mouseReleaseEvent(QMouseEvent* _event);
+	void mouseDoubleClickEvent(QMouseEvent* _event);
 	void contextMenuEvent(QContextMenuEvent* _event);
 
 protected:
@@ -115,6 +125,7 @@ public Q_SLOTS:
 	void zoomReset();
 	void zoomSelect();
 	void zoomAnimEvent();
+	void zoomAnimFinished();
 	void markerSnapTo();
 	void markerSelectFrom();
 	void markerSelectTo();
@@ -125,6 +136,7 @@ public Q_SLOTS:
 Q_SIGNALS:
 	void snapshotSelected();
 	void minMaxChanged();
+	void threadSelected(uint64_t);
 };
 
 #endif // RTM_MTUNER_GRAPHWIDGET_H
@@ -6,6 +6,7 @@
 #include <MTuner_pch.h>
 #include <MTuner/src/grouplistwidget.h>
 #include <MTuner/src/capturecontext.h>
+#include <MTuner/src/loader/radixsort.h>
 
 struct GroupColumn
 {
@@ -30,15 +31,21 @@ struct GroupColumn
 class GroupTableSource : public BigTableSource
 {
 	private:
+		struct GroupData
+		{
+			rtm_vector<rtm::MemoryOperationGroup*>	m_allGroups;
+			GroupMapping							m_groupMappings[GroupColumn::ColumnCount];
+			const rtm::MemoryStats*					m_stats;
+			uint32_t								m_version;		///< Incremented every time groups are collected
+		};
+
 		CaptureContext*	m_context;
 		GroupList*		m_list;
 		uint32_t		m_numColumns;
 		uint32_t		m_numRows;
 
-		rtm_vector<rtm::MemoryOperationGroup*>	m_allGroups;
-		const rtm::MemoryStats*					m_stats;
-
-		GroupMapping	m_groupMappings[GroupColumn::ColumnCount];
+		GroupData		m_data[2];				///< Global and filtered groups
+		GroupData*		m_currentData;
 		GroupMapping*	m_currentGroupMapping;
 
 		uint32_t		m_currentColumn;
@@ -57,423 +64,174 @@ class GroupTableSource : public BigTableSource
 		virtual Qt::AlignmentFlag	getAlignment(uint32_t _index);
 		virtual uint32_t	getItemIndex(void* _item);
 		virtual void 		sortColumn(uint32_t _columnIndex, Qt::SortOrder _sortOrder);
-		GroupMapping*		getGroupMapping(int _index) { return &m_groupMappings[_index]; }
+		GroupMapping*		getGroupMapping(int _index);
 
 		void saveState(QSettings& _settings);
-};
-
-#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
-
-#pragma warning (push)
-#pragma warning (disable:4211) // redefined extern to static
-static bool __uncaught_exception() { return true; }
-#pragma warning (pop)
-
-#include <ppl.h>
-
-// concurrency::parallel_radixsort Type
-struct pSortType
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortType(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint8_t operator()(const uint32_t _val) const { return (*m_allGroups)[_val]->m_operations[0]->m_operationType; } 
-};
-
-// concurrency::parallel_radixsort Heap
-struct pSortHeap
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortHeap(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint64_t operator()(const uint32_t _val) const { return (*m_allGroups)[_val]->m_operations[0]->m_allocatorHandle; } 
-};
-
-// concurrency::parallel_radixsort Size
-struct pSortSize
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortSize(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const { return (*m_allGroups)[_val]->m_maxSize; } 
-};
-
-// concurrency::parallel_radixsort Count
-struct pSortCount
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortCount(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const { return (*m_allGroups)[_val]->m_count; } 
-};
-
-// concurrency::parallel_radixsort Count peak
-struct pSortCountPeak
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortCountPeak(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const { return (*m_allGroups)[_val]->m_liveCountPeak; } 
-};
-
-// concurrency::parallel_radixsort Count peak percent
-struct pSortCountPeakPercent
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortCountPeakPercent(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const
-	{
-		rtm::MemoryOperationGroup* grp = (*m_allGroups)[_val];
-		if (grp->m_liveCountPeakGlobal)
-			return float(grp->m_liveCountPeak * 10000) / float(grp->m_liveCountPeakGlobal);
-		else
-			return 0;
-	}
-};
-
-// concurrency::parallel_radixsort Alignment
-struct pSortAlignment
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortAlignment(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint8_t operator()(const uint32_t _val) const { return (*m_allGroups)[_val]->m_operations[0]->m_alignment; } 
-};
-
-// concurrency::parallel_radixsort Group size
-struct pSortGroupSize
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortGroupSize(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const
-	{
-		rtm::MemoryOperationGroup* grp = (*m_allGroups)[_val];
-		return grp->m_liveSize;
-	} 
-};
-
-// concurrency::parallel_radixsort Group size
-struct pSortGroupSizePeak
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortGroupSizePeak(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const
-	{
-		rtm::MemoryOperationGroup* grp = (*m_allGroups)[_val];
-		return grp->m_peakSize;
-	} 
-};
 
-// concurrency::parallel_radixsort Group size peak percent
-struct pSortGroupSizePeakPercent
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortGroupSizePeakPercent(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const
-	{
-		rtm::MemoryOperationGroup* grp = (*m_allGroups)[_val];
-		if (grp->m_peakSizeGlobal)
-			return float(grp->m_peakSize * 10000) / float(grp->m_peakSizeGlobal);
-		else
-			return 0;
-	}
-};
-
-// concurrency::parallel_radixsort Live count
-struct pSortLive 
-{
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortLive(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline uint32_t operator()(const uint32_t _val) const { return (*m_allGroups)[_val]->m_liveCount; } 
+	private:
+		void collectGroups(GroupData& _data, const rtm::MemoryGroupsHashType& _groups, const rtm::MemoryStats* _stats);
+		void sortGroups(GroupData& _data, uint32_t _column);
 };
 
-// concurrency::parallel_radixsort Live count
-struct pSetGroupMappings
+static inline const rtm::MemoryOperationGroup* getGroup(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSetGroupMappings(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline void operator()(const GroupMapping* inGroupMapping) const
-	{
-		const uint32_t col = inGroupMapping->m_columnIndex;
-		const uint32_t num = (uint32_t)(*m_allGroups).size();
-		for (uint32_t i=0; i<num; ++i)
-		{
-			uint32_t idx = inGroupMapping->m_sortedIdx[i];
-			rtm::MemoryOperationGroup* group = (*m_allGroups)[idx];
-			group->m_indexMappings[col] = i;
-		}
-	} 
-};
-
-#else
+	return (*(const rtm_vector<rtm::MemoryOperationGroup*>*)_groups)[_index];
+}
 
-struct pSortTypeNVC
+static uint64_t sortKeyType(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortTypeNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const { return (*m_allGroups)[_val1]->m_operations[0]->m_operationType < (*m_allGroups)[_val2]->m_operations[0]->m_operationType; }
-};
+	return getGroup(_groups, _index)->m_operations[0]->m_operationType;
+}
 
-struct pSortHeapNVC
+static uint64_t sortKeyHeap(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortHeapNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const { return (*m_allGroups)[_val1]->m_operations[0]->m_allocatorHandle < (*m_allGroups)[_val2]->m_operations[0]->m_allocatorHandle; }
-};
+	return getGroup(_groups, _index)->m_operations[0]->m_allocatorHandle;
+}
 
-struct pSortSizeNVC
+static uint64_t sortKeySize(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortSizeNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const { return (*m_allGroups)[_val1]->m_maxSize< (*m_allGroups)[_val2]->m_maxSize; }
-};
+	return getGroup(_groups, _index)->m_maxSize;
+}
 
-struct pSortCountNVC
+static uint64_t sortKeyCount(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortCountNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const { return (*m_allGroups)[_val1]->m_count < (*m_allGroups)[_val2]->m_count; }
-};
+	return getGroup(_groups, _index)->m_count;
+}
 
-struct pSortCountPeakNVC
+static uint64_t sortKeyCountPeak(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortCountPeakNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const { return (*m_allGroups)[_val1]->m_liveCountPeak < (*m_allGroups)[_val2]->m_liveCountPeak; }
-};
+	return getGroup(_groups, _index)->m_liveCountPeak;
+}
 
-struct pSortCountPeakPercentNVC
+static uint64_t sortKeyCountPeakPercent(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortCountPeakPercentNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		rtm::MemoryOperationGroup* grp1 = (*m_allGroups)[_val1];
-		rtm::MemoryOperationGroup* grp2 = (*m_allGroups)[_val2];
-
-		return float(grp1->m_liveCountPeak * grp2->m_liveCountPeakGlobal) < float(grp2->m_liveCountPeak * grp1->m_liveCountPeakGlobal);
-	}
-};
+	const rtm::MemoryOperationGroup* group = getGroup(_groups, _index);
+	return rtm::radixKeyRatio(group->m_liveCountPeak, group->m_liveCountPeakGlobal);
+}
 
-struct pSortAlignmentNVC
+static uint64_t sortKeyAlignment(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortAlignmentNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const { return (*m_allGroups)[_val1]->m_operations[0]->m_alignment < (*m_allGroups)[_val2]->m_operations[0]->m_alignment; }
-};
+	return getGroup(_groups, _index)->m_operations[0]->m_alignment;
+}
 
-struct pSortGroupSizeNVC
+static uint64_t sortKeyGroupSize(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortGroupSizeNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		rtm::MemoryOperationGroup* grp1 = (*m_allGroups)[_val1];
-		rtm::MemoryOperationGroup* grp2 = (*m_allGroups)[_val2];
-		return (grp1->m_liveSize) < (grp2->m_liveSize);
-	}
-};
+	return rtm::radixKeySigned(getGroup(_groups, _index)->m_liveSize);
+}
 
-struct pSortGroupSizePeakNVC
+static uint64_t sortKeyGroupPeakSize(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortGroupSizePeakNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		rtm::MemoryOperationGroup* grp1 = (*m_allGroups)[_val1];
-		rtm::MemoryOperationGroup* grp2 = (*m_allGroups)[_val2];
-		return (grp1->m_peakSize) < (grp2->m_peakSize);
-	}
-};
+	return rtm::radixKeySigned(getGroup(_groups, _index)->m_peakSize);
+}
 
-struct pSortGroupSizePeakPercentNVC
+static uint64_t sortKeyGroupPeakSizePercent(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortGroupSizePeakPercentNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		rtm::MemoryOperationGroup* grp1 = (*m_allGroups)[_val1];
-		rtm::MemoryOperationGroup* grp2 = (*m_allGroups)[_val2];
-
-		return grp1->m_peakSize * grp2->m_peakSizeGlobal < grp2->m_peakSize * grp1->m_peakSizeGlobal;
-	}
-};
+	const rtm::MemoryOperationGroup* group = getGroup(_groups, _index);
+	return rtm::radixKeyRatio(group->m_peakSize, group->m_peakSizeGlobal);
+}
 
-struct pSortLiveNVC
+static uint64_t sortKeyLive(const void* _groups, uint32_t _index)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSortLiveNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
+	return getGroup(_groups, _index)->m_liveCount;
+}
 
-	inline bool operator()(const uint32_t _val1, const uint32_t _val2) const { return (*m_allGroups)[_val1]->m_liveCount < (*m_allGroups)[_val2]->m_liveCount; }
+static const rtm::RadixKeyFunc s_sortKeys[GroupColumn::ColumnCount] =
+{
+	sortKeyType,
+	sortKeyHeap,
+	sortKeySize,
+	sortKeyCount,
+	sortKeyCountPeak,
+	sortKeyCountPeakPercent,
+	sortKeyAlignment,
+	sortKeyGroupSize,
+	sortKeyGroupPeakSize,
+	sortKeyGroupPeakSizePercent,
+	sortKeyLive
 };
 
-struct pSetGroupMappingsNVC
+GroupTableSource::GroupTableSource(CaptureContext* _context, GroupList* _list ) :
+	m_context(_context),
+	m_list(_list),
+	m_currentColumn(GroupColumn::GroupPeakSize),
+	m_sortOrder(Qt::DescendingOrder)
 {
-	rtm_vector<rtm::MemoryOperationGroup*>* m_allGroups;
-	pSetGroupMappingsNVC(rtm_vector<rtm::MemoryOperationGroup*>& _groups) : m_allGroups(&_groups) {}
-
-	inline void operator()(const GroupMapping* inGroupMapping) const
+	for (GroupData& data : m_data)
 	{
-		const uint32_t col = inGroupMapping->m_columnIndex;
-		const uint32_t num = (uint32_t)(*m_allGroups).size();
-		for (uint32_t i = 0; i<num; ++i)
+		data.m_stats	= NULL;
+		data.m_version	= 0;
+		for (uint32_t i=0; i<GroupColumn::ColumnCount; ++i)
 		{
-			uint32_t idx = inGroupMapping->m_sortedIdx[i];
-			rtm::MemoryOperationGroup* group = (*m_allGroups)[idx];
-			group->m_indexMappings[col] = i;
+			data.m_groupMappings[i].m_columnIndex	= i;
+			data.m_groupMappings[i].m_allGroups		= &data.m_allGroups;
+			data.m_groupMappings[i].m_version		= 0;
 		}
 	}
-};
 
-#endif
-
-GroupTableSource::GroupTableSource(CaptureContext* _context, GroupList* _list ) :
-	m_context(_context),
-	m_list(_list)
-{
 	prepareData();
 }
 
+//--------------------------------------------------------------------------
+/// Global groups are collected once per capture, filtered groups on every
+/// filter update. Columns are sorted when first displayed or requested.
+//--------------------------------------------------------------------------
 void GroupTableSource::prepareData()
 {
 	bool filterEnabled = m_list->getFilteringState();
-	
-	m_stats = &m_context->m_capture->getGlobalStats();
-	const rtm::MemoryGroupsHashType* groups = &m_context->m_capture->getMemoryGroups();
+
+	rtm::Capture* capture = m_context->m_capture;
 	if (filterEnabled)
-	{
-		m_stats = &m_context->m_capture->getSnapshotStats();
-		groups	= &m_context->m_capture->getMemoryGroupsFiltered();
-	}
+		collectGroups(m_data[1], capture->getMemoryGroupsFiltered(), &capture->getSnapshotStats());
+	else
+	if (!m_data[0].m_version)
+		collectGroups(m_data[0], capture->getMemoryGroups(), &capture->getGlobalStats());
 
+	m_currentData	= &m_data[filterEnabled ? 1 : 0];
 	m_numColumns	= GroupColumn::ColumnCount;
-	m_numRows		= (uint32_t)groups->size();
-	m_currentGroupMapping	= NULL;
-	m_sortOrder				= Qt::DescendingOrder;
-
-	// populate array of groups
-	uint32_t numItems = getNumberOfRows();
-	m_allGroups.clear();
-	m_allGroups.reserve(numItems);
-	rtm::MemoryGroupsHashType::const_iterator it = groups->begin();
-	rtm::MemoryGroupsHashType::const_iterator end = groups->end();
+	m_numRows		= (uint32_t)m_currentData->m_allGroups.size();
+
+	m_currentGroupMapping = getGroupMapping(m_currentColumn);
+}
+
+void GroupTableSource::collectGroups(GroupData& _data, const rtm::MemoryGroupsHashType& _groups, const rtm::MemoryStats* _stats)
+{
+	_data.m_stats = _stats;
+	_data.m_allGroups.clear();
+	_data.m_allGroups.reserve(_groups.size());
+
+	rtm::MemoryGroupsHashType::const_iterator it = _groups.begin();
+	rtm::MemoryGroupsHashType::const_iterator end = _groups.end();
 	while (it != end)
 	{
 		rtm::MemoryOperationGroup* ptr = (rtm::MemoryOperationGroup*)&it->second;
-		m_allGroups.push_back(ptr);
+		_data.m_allGroups.push_back(ptr);
 		++it;
 	}
 
-	// init index arrays for columns
-	const uint32_t numCols = m_numColumns;
-	
-	for (uint32_t i=0; i<numCols; ++i)
-	{
-		m_groupMappings[i].m_sortedIdx.clear();
-		m_groupMappings[i].m_sortedIdx.resize(numItems);
-		m_groupMappings[i].m_columnIndex = i;
-		m_groupMappings[i].m_allGroups = &m_allGroups;
-	}
-
-	uint32_t* dst = m_groupMappings[0].m_sortedIdx.data();
-	for (uint32_t i=0; i<numItems; ++i)
-		dst[i] = i;
-
-	for (uint32_t i=1; i<numCols; ++i)
-		memcpy(m_groupMappings[i].m_sortedIdx.data(), m_groupMappings[0].m_sortedIdx.data(), sizeof(uint32_t)*numItems);
-
-	// sort index arrays
-#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
-
-	pSortType psType(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Type].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Type].m_sortedIdx.end(), psType );
-	
-	pSortHeap psHeap(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Heap].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Heap].m_sortedIdx.end(), psHeap );
-	
-	pSortSize psSize(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Size].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Size].m_sortedIdx.end(), psSize );
-
-	pSortCount psCount(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Count].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Count].m_sortedIdx.end(), psCount );
-
-	pSortCountPeak psCountPeak(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::CountPeak].m_sortedIdx.begin(), m_groupMappings[GroupColumn::CountPeak].m_sortedIdx.end(), psCountPeak );
-
-	pSortCountPeakPercent psCountPeakPercent(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::CountPeakPercent].m_sortedIdx.begin(), m_groupMappings[GroupColumn::CountPeakPercent].m_sortedIdx.end(), psCountPeakPercent);
-
-	pSortAlignment psAlignment(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Alignment].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Alignment].m_sortedIdx.end(), psAlignment );
-
-	pSortGroupSize psGroupSize(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::GroupSize].m_sortedIdx.begin(), m_groupMappings[GroupColumn::GroupSize].m_sortedIdx.end(), psGroupSize );
-
-	pSortGroupSizePeak psGroupSizePeak(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::GroupPeakSize].m_sortedIdx.begin(), m_groupMappings[GroupColumn::GroupPeakSize].m_sortedIdx.end(), psGroupSizePeak );
-
-	pSortGroupSizePeakPercent psGroupSizePeakPercent(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::GroupPeakSizePercent].m_sortedIdx.begin(), m_groupMappings[GroupColumn::GroupPeakSizePercent].m_sortedIdx.end(), psGroupSizePeakPercent);
-
-	pSortLive psLive(m_allGroups);
-	concurrency::parallel_radixsort(m_groupMappings[GroupColumn::Live].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Live].m_sortedIdx.end(), psLive );
-
-	pSetGroupMappings psSetMappings(m_allGroups);
-	rtm_vector<GroupMapping*> mappings;
-	mappings.reserve(GroupColumn::ColumnCount);
-	for (uint32_t i=0; i<GroupColumn::ColumnCount; ++i)
-		mappings.push_back(&m_groupMappings[i]);
-	Concurrency::parallel_for_each(mappings.begin(), mappings.end(), psSetMappings);
-
-#else
-	std::stable_sort(m_groupMappings[GroupColumn::Type].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Type].m_sortedIdx.end(), pSortTypeNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::Heap].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Heap].m_sortedIdx.end(), pSortHeapNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::Size].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Size].m_sortedIdx.end(), pSortSizeNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::Count].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Count].m_sortedIdx.end(), pSortCountNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::CountPeak].m_sortedIdx.begin(), m_groupMappings[GroupColumn::CountPeak].m_sortedIdx.end(), pSortCountPeakNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::CountPeakPercent].m_sortedIdx.begin(), m_groupMappings[GroupColumn::CountPeakPercent].m_sortedIdx.end(), pSortCountPeakPercentNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::Alignment].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Alignment].m_sortedIdx.end(), pSortAlignmentNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::GroupSize].m_sortedIdx.begin(), m_groupMappings[GroupColumn::GroupSize].m_sortedIdx.end(), pSortGroupSizeNVC(m_allGroups));
-
-	std::stable_sort(m_groupMappings[GroupColumn::GroupPeakSize].m_sortedIdx.begin(), m_groupMappings[GroupColumn::GroupPeakSize].m_sortedIdx.end(), pSortGroupSizePeakNVC(m_allGroups));
+	// invalidates all sorted index arrays
+	++_data.m_version;
+}
 
-	std::stable_sort(m_groupMappings[GroupColumn::GroupPeakSizePercent].m_sortedIdx.begin(), m_groupMappings[GroupColumn::GroupPeakSizePercent].m_sortedIdx.end(), pSortGroupSizePeakPercentNVC(m_allGroups));
+void GroupTableSource::sortGroups(GroupData& _data, uint32_t _column)
+{
+	GroupMapping& mapping = _data.m_groupMappings[_column];
 
-	std::stable_sort(m_groupMappings[GroupColumn::Live].m_sortedIdx.begin(), m_groupMappings[GroupColumn::Live].m_sortedIdx.end(), pSortLiveNVC(m_allGroups));
+	const uint32_t numItems = (uint32_t)_data.m_allGroups.size();
+	mapping.m_sortedIdx.resize(numItems);
+	rtm::radixSort(mapping.m_sortedIdx.data(), numItems, s_sortKeys[_column], &_data.m_allGroups);
 
-	pSetGroupMappingsNVC psSetMappings(m_allGroups);
-	rtm_vector<GroupMapping*> mappings;
-	mappings.reserve(GroupColumn::ColumnCount);
-	for (uint32_t i = 0; i<GroupColumn::ColumnCount; ++i)
-		mappings.push_back(&m_groupMappings[i]);
-	std::for_each(mappings.begin(), mappings.end(), psSetMappings);
+	for (uint32_t i=0; i<numItems; ++i)
+		_data.m_allGroups[mapping.m_sortedIdx[i]]->m_indexMappings[_column] = i;
 
-#endif
+	mapping.m_version = _data.m_version;
+}
 
-	m_currentGroupMapping = &m_groupMappings[GroupColumn::GroupPeakSize];
+GroupMapping* GroupTableSource::getGroupMapping(int _index)
+{
+	GroupMapping* mapping = &m_currentData->m_groupMappings[_index];
+	if (mapping->m_version != m_currentData->m_version)
+		sortGroups(*m_currentData, _index);
+	return mapping;
 }
 
 QStringList	GroupTableSource::getHeaderInfo(int32_t& _sortCol, Qt::SortOrder& _sortOrder, QList<int>& _widths)
@@ -519,7 +277,8 @@ QString GroupTableSource::getItem(uint32_t _index, int32_t _column, QColor*, boo
 	if (m_sortOrder == Qt::DescendingOrder)
 		index = m_numRows - index - 1;
 	uint32_t idx = m_currentGroupMapping->m_sortedIdx[index];
-	rtm::MemoryOperationGroup* group = m_allGroups[idx];
+	rtm::MemoryOperationGroup* group = m_currentData->m_allGroups[idx];
+	const rtm::MemoryStats* stats = m_currentData->m_stats;
 
 	QLocale locale;
 
@@ -556,7 +315,7 @@ QString GroupTableSource::getItem(uint32_t _index, int32_t _column, QColor*, boo
 				return locale.toString(group->m_minSize);
 	
 		case GroupColumn::Count:
-			return formatPercentageView(group->m_count, m_stats->m_numberOfOperations);
+			return formatPercentageView(group->m_count, stats->m_numberOfOperations);
 	
 		case GroupColumn::CountPeak:
 			return locale.toString(group->m_liveCountPeak);
@@ -573,7 +332,7 @@ QString GroupTableSource::getItem(uint32_t _index, int32_t _column, QColor*, boo
 		}
 
 		case GroupColumn::GroupSize:
-			return formatPercentageView(group->m_liveSize, m_stats->m_memoryUsage);
+			return formatPercentageView(group->m_liveSize, stats->m_memoryUsage);
 	
 		case GroupColumn::GroupPeakSize:
 			return locale.toString(group->m_peakSize);
@@ -582,7 +341,7 @@ QString GroupTableSource::getItem(uint32_t _index, int32_t _column, QColor*, boo
 			return formatPercentageView(group->m_peakSize, group->m_peakSizeGlobal, false);
 
 		case GroupColumn::Live:
-			return formatPercentageView(group->m_liveCount, m_stats->m_numberOfLiveBlocks);
+			return formatPercentageView(group->m_liveCount, stats->m_numberOfLiveBlocks);
 	};
 
 	return "";
@@ -597,7 +356,7 @@ void GroupTableSource::getItem(uint32_t _index, void** _pointer)
 	if (m_sortOrder == Qt::DescendingOrder)
 		index = m_numRows - index - 1;
 	uint32_t idx = m_currentGroupMapping->m_sortedIdx[index];
-	*_pointer = m_allGroups[idx];
+	*_pointer = m_currentData->m_allGroups[idx];
 }
 
 Qt::AlignmentFlag GroupTableSource::getAlignment(uint32_t _index)
@@ -632,7 +391,7 @@ void GroupTableSource::sortColumn(uint32_t _columnIndex, Qt::SortOrder _sortOrde
 	m_currentColumn	= _columnIndex;
 	m_sortOrder		= _sortOrder;
 
-	m_currentGroupMapping = &m_groupMappings[_columnIndex];
+	m_currentGroupMapping = getGroupMapping(_columnIndex);
 }
 
 void GroupTableSource::saveState(QSettings& _settings)
@@ -654,6 +413,7 @@ GroupList::GroupList(QWidget* _parent, Qt::WindowFlags _flags) :
 	m_groupList			= findChild<BigTable*>("bigTableWidget");
 	connect(m_groupList, SIGNAL(itemSelected(void*)), this, SLOT(selectionChanged(void*)));
 	connect(m_groupList, SIGNAL(itemRightClicked(void*,const QPoint&)), this, SLOT(groupRightClick(void*,const QPoint&)));
+	connect(m_groupList, SIGNAL(visibleRowsChanged(uint32_t,uint32_t)), this, SLOT(visibleRowsChanged(uint32_t,uint32_t)));
 }
 
 GroupList::~GroupList()
@@ -752,6 +512,30 @@ void GroupList::selectionChanged(void* _item)
 	emit setStackTrace(&(group->m_operations[0]->m_stackTrace), 1);
 }
 
+//--------------------------------------------------------------------------
+/// Stack traces of visible groups are the next ones to be selected
+//--------------------------------------------------------------------------
+void GroupList::visibleRowsChanged(uint32_t _first, uint32_t _count)
+{
+	if (!m_context || !m_tableSource)
+		return;
+
+	rtm_vector<uint64_t> addresses;
+	const uint32_t last = qMin(_first + _count, m_tableSource->getNumberOfRows());
+	for (uint32_t i=_first; i<last; ++i)
+	{
+		rtm::MemoryOperationGroup* group = NULL;
+		m_tableSource->getItem(i, (void**)&group);
+		if (!group || group->m_operations.empty())
+			continue;
+
+		const rtm::StackTrace* trace = group->m_operations[0]->m_stackTrace;
+		addresses.insert(addresses.end(), trace->m_entries, trace->m_entries + trace->m_numEntries);
+	}
+
+	m_context->prefetchFrames(addresses.data(), (uint32_t)addresses.size());
+}
+
 void GroupList::groupRightClick(void* _item, const QPoint& _pos)
 {
 	rtm::MemoryOperationGroup* group = (rtm::MemoryOperationGroup*)_item;
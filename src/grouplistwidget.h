@@ -15,7 +15,8 @@ struct GroupMapping
 {
 	uint32_t								m_columnIndex;
 	rtm_vector<rtm::MemoryOperationGroup*>*	m_allGroups;
-	rtm_vector<uint32_t>					m_sortedIdx;
+	rtm_vector<uint32_t>					m_sortedIdx;		///< Ascending order of the column
+	uint32_t								m_version;			///< Group data version the indices were sorted for
 };
 
 class GroupList : public QWidget
@@ -61,6 +62,7 @@ Q_SIGNALS:
 public Q_SLOTS:
 	void selectionChanged(void*);
 	void groupRightClick(void*, const QPoint&);
+	void visibleRowsChanged(uint32_t, uint32_t);
 	void sortingDoneUsage();
 	void sortingDonePeakUsage();
 	void sortingDonePeakCount();
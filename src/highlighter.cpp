@@ -6,8 +6,8 @@
 #include <MTuner_pch.h>
 #include <MTuner/src/highlighter.h>
 
-Highlighter::Highlighter(QTextDocument* _parent)
-    : QSyntaxHighlighter(_parent)
+Highlighter::Highlighter(QObject* _parent)
+    : QObject(_parent)
 {
 	HighlightingRule rule;
 
@@ -93,7 +93,30 @@ Highlighter::Highlighter(QTextDocument* _parent)
 	m_multiLineCommentFormat.setForeground(QColor(86, 164, 51));
 }
 
-void Highlighter::highlightBlock(const QString& _text)
+static void addFormat(QVector<QTextLayout::FormatRange>& _formats, int _start, int _length, const QTextCharFormat& _format)
+{
+	QTextLayout::FormatRange range;
+	range.start		= _start;
+	range.length	= _length;
+	range.format	= _format;
+	_formats.append(range);
+}
+
+void Highlighter::highlightBlock(QTextBlock& _block)
+{
+	if (!_block.isValid() || (_block.userState() == BLOCK_HIGHLIGHTED))
+		return;
+
+	QVector<QTextLayout::FormatRange> formats;
+	getFormats(_block.text(), formats);
+
+	// later ranges take precedence, same as consecutive QSyntaxHighlighter::setFormat calls
+	_block.layout()->setFormats(formats);
+	_block.setUserState(BLOCK_HIGHLIGHTED);
+	_block.document()->markContentsDirty(_block.position(), _block.length());
+}
+
+void Highlighter::getFormats(const QString& _text, QVector<QTextLayout::FormatRange>& _formats)
 {
     foreach (const HighlightingRule &rule, m_highlightingRules) {
 		QRegularExpression expression(rule.m_pattern);
@@ -103,7 +126,7 @@ void Highlighter::highlightBlock(const QString& _text)
         while (last >= 0) {
             int length = match.capturedLength(last);
 			int index = match.capturedStart(last);
-			setFormat(index, length, rule.m_format);
+			addFormat(_formats, index, length, rule.m_format);
             --last;
         }
 	}
@@ -114,7 +137,6 @@ void Highlighter::highlightBlock(const QString& _text)
 	for (int i=0; i<matches.lastCapturedIndex(); i++) {
 		int length = matches.capturedLength(i);
 		int index = matches.capturedStart(i);
-		setFormat(index, length, m_multiLineCommentFormat);
+		addFormat(_formats, index, length, m_multiLineCommentFormat);
 	}
-	setCurrentBlockState(0);
 }
@@ -6,19 +6,28 @@
 #ifndef RTM_MTUNER_HIGHLIGHTER_H
 #define RTM_MTUNER_HIGHLIGHTER_H
 
-class QTextDocument;
-
-class Highlighter : public QSyntaxHighlighter
+//--------------------------------------------------------------------------
+/// C/C++ syntax highlighting applied on demand to single blocks, so that
+/// only the visible part of a large source file is ever highlighted.
+//--------------------------------------------------------------------------
+class Highlighter : public QObject
 {
     Q_OBJECT
 
 public:
-    Highlighter(QTextDocument* _parent = 0);
+	enum
+	{
+		BLOCK_HIGHLIGHTED = 1		///< QTextBlock::userState of highlighted blocks
+	};
+
+    Highlighter(QObject* _parent = 0);
 
-protected:
-    void highlightBlock(const QString& _text);
+	/// Highlights the block unless it was highlighted already
+	void highlightBlock(QTextBlock& _block);
 
 private:
+	void getFormats(const QString& _text, QVector<QTextLayout::FormatRange>& _formats);
+
     struct HighlightingRule
     {
 		QRegularExpression	m_pattern;
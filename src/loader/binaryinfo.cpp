@@ -0,0 +1,209 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/binaryinfo.h>
+#include <QtCore/QtEndian>
+
+namespace rtm {
+
+/// Upper limits used to reject corrupted binaries
+static const uint32_t MAX_NOTE_SECTION_SIZE	= 64*1024;
+static const uint32_t MAX_DEBUG_ENTRIES		= 16;
+
+template <typename T>
+static inline T readLE(const QByteArray& _data, uint32_t _offset)
+{
+	if (_offset + sizeof(T) > (uint32_t)_data.size())
+		return 0;
+	return qFromLittleEndian<T>((const uchar*)_data.constData() + _offset);
+}
+
+static inline QByteArray readAt(QFile& _file, uint64_t _offset, uint32_t _size)
+{
+	if (!_file.seek((qint64)_offset))
+		return QByteArray();
+	return _file.read(_size);
+}
+
+//--------------------------------------------------------------------------
+/// Reads GNU build ID note from a little endian ELF binary
+//--------------------------------------------------------------------------
+static rtm_string getELFBuildID(QFile& _file, const QByteArray& _header)
+{
+	const bool is64bit = _header[4] == 2;
+	if (_header[5] != 1)
+		return "";
+
+	const uint64_t	sectionOffset	= is64bit ? readLE<quint64>(_header, 0x28) : readLE<quint32>(_header, 0x20);
+	const uint32_t	sectionSize		= readLE<quint16>(_header, is64bit ? 0x3a : 0x2e);
+	const uint32_t	numSections		= readLE<quint16>(_header, is64bit ? 0x3c : 0x30);
+
+	for (uint32_t s=0; s<numSections; ++s)
+	{
+		QByteArray section = readAt(_file, sectionOffset + s*sectionSize, sectionSize);
+		if (readLE<quint32>(section, 4) != 7)	// SHT_NOTE
+			continue;
+
+		const uint64_t offset	= is64bit ? readLE<quint64>(section, 0x18) : readLE<quint32>(section, 0x10);
+		const uint64_t size		= is64bit ? readLE<quint64>(section, 0x20) : readLE<quint32>(section, 0x14);
+		if (size > MAX_NOTE_SECTION_SIZE)
+			continue;
+
+		QByteArray notes = readAt(_file, offset, (uint32_t)size);
+		uint32_t pos = 0;
+		while (pos + 12 <= (uint32_t)notes.size())
+		{
+			const uint32_t nameSize	= readLE<quint32>(notes, pos);
+			const uint32_t descSize	= readLE<quint32>(notes, pos + 4);
+			const uint32_t type		= readLE<quint32>(notes, pos + 8);
+			const uint32_t name		= pos + 12;
+			const uint32_t desc		= name + ((nameSize + 3) & ~3);
+
+			if ((nameSize > size) || (descSize > size) || (desc + descSize > (uint32_t)notes.size()))
+				break;
+
+			if ((type == 3) && (nameSize == 4) && (memcmp(notes.constData() + name, "GNU", 4) == 0))	// NT_GNU_BUILD_ID
+				return notes.mid(desc, descSize).toHex().constData();
+
+			pos = desc + ((descSize + 3) & ~3);
+		}
+	}
+
+	return "";
+}
+
+//--------------------------------------------------------------------------
+/// Reads CodeView PDB signature (GUID and age) from a PE binary
+//--------------------------------------------------------------------------
+static rtm_string getPEBuildID(QFile& _file, const QByteArray& _header)
+{
+	const uint32_t peOffset = readLE<quint32>(_header, 0x3c);
+
+	QByteArray coff = readAt(_file, peOffset, 24);
+	if (!coff.startsWith(QByteArray("PE\0\0", 4)))
+		return "";
+
+	const uint32_t numSections		= readLE<quint16>(coff, 6);
+	const uint32_t optionalSize		= readLE<quint16>(coff, 20);
+	const uint32_t optionalOffset	= peOffset + 24;
+
+	QByteArray optional = readAt(_file, optionalOffset, optionalSize);
+	const uint32_t magic = readLE<quint16>(optional, 0);
+	if ((magic != 0x10b) && (magic != 0x20b))
+		return "";
+
+	const uint32_t dataDirectories = magic == 0x10b ? 96 : 112;
+	if (readLE<quint32>(optional, dataDirectories - 4) <= 6)
+		return "";
+
+	const uint32_t debugRVA		= readLE<quint32>(optional, dataDirectories + 6*8);
+	const uint32_t debugSize	= readLE<quint32>(optional, dataDirectories + 6*8 + 4);
+	if (!debugRVA)
+		return "";
+
+	// map debug directory RVA to file offset
+	QByteArray sections = readAt(_file, optionalOffset + optionalSize, numSections * 40);
+	uint64_t debugOffset = 0;
+	for (uint32_t s=0; s<numSections; ++s)
+	{
+		const uint32_t virtualSize		= readLE<quint32>(sections, s*40 + 8);
+		const uint32_t virtualAddress	= readLE<quint32>(sections, s*40 + 12);
+		const uint32_t rawData			= readLE<quint32>(sections, s*40 + 20);
+
+		if ((debugRVA >= virtualAddress) && (debugRVA < virtualAddress + virtualSize))
+		{
+			debugOffset = rawData + (debugRVA - virtualAddress);
+			break;
+		}
+	}
+
+	if (!debugOffset)
+		return "";
+
+	const uint32_t numEntries = qMin(debugSize / 28, MAX_DEBUG_ENTRIES);
+	QByteArray entries = readAt(_file, debugOffset, numEntries * 28);
+	for (uint32_t e=0; e<numEntries; ++e)
+	{
+		if (readLE<quint32>(entries, e*28 + 12) != 2)	// IMAGE_DEBUG_TYPE_CODEVIEW
+			continue;
+
+		QByteArray codeView = readAt(_file, readLE<quint32>(entries, e*28 + 24), 24);
+		if (codeView.startsWith("RSDS") && (codeView.size() == 24))
+			return codeView.mid(4).toHex().constData();
+	}
+
+	return "";
+}
+
+rtm_string getBinaryBuildID(const char* _path)
+{
+	QFile file(QString::fromUtf8(_path));
+	if (!file.open(QIODevice::ReadOnly))
+		return "";
+
+	QByteArray header = file.read(64);
+	if (header.size() < 64)
+		return "";
+
+	if (header.startsWith("\x7f" "ELF"))
+		return getELFBuildID(file, header);
+
+	if (header.startsWith("MZ"))
+		return getPEBuildID(file, header);
+
+	return "";
+}
+
+bool getBinaryLinkBase(const char* _path, uint64_t _loadBase, uint64_t& _linkBase)
+{
+	QFile file(QString::fromUtf8(_path));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QByteArray header = file.read(64);
+	if (header.size() < 64)
+		return false;
+
+	if (header.startsWith("\x7f" "ELF"))
+	{
+		if (header[5] != 1)
+			return false;
+
+		// executables are linked at their load address, shared objects (and PIE) at zero
+		const uint32_t type = readLE<quint16>(header, 0x10);
+		if (type == 2)			// ET_EXEC
+			_linkBase = _loadBase;
+		else
+		if (type == 3)			// ET_DYN
+			_linkBase = 0;
+		else
+			return false;
+		return true;
+	}
+
+	if (header.startsWith("MZ"))
+	{
+		const uint32_t peOffset = readLE<quint32>(header, 0x3c);
+
+		QByteArray optional = readAt(file, peOffset + 24, 32);
+		if (optional.size() < 32)
+			return false;
+
+		const uint32_t magic = readLE<quint16>(optional, 0);
+		if (magic == 0x10b)
+			_linkBase = readLE<quint32>(optional, 28);
+		else
+		if (magic == 0x20b)
+			_linkBase = readLE<quint64>(optional, 24);
+		else
+			return false;
+		return true;
+	}
+
+	return false;
+}
+
+} // namespace rtm
@@ -0,0 +1,21 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_BINARYINFO_H__
+#define __RTM_MTUNER_BINARYINFO_H__
+
+namespace rtm {
+
+/// Returns build ID of a PE (CodeView GUID and age) or ELF (GNU build ID)
+/// binary as a hex string, empty string if the file has no build ID
+rtm_string getBinaryBuildID(const char* _path);
+
+/// Returns the address binary was linked at for a module loaded at _loadBase.
+/// Runtime addresses are translated for binutils as address - _loadBase + _linkBase.
+bool getBinaryLinkBase(const char* _path, uint64_t _loadBase, uint64_t& _linkBase);
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_BINARYINFO_H__
@@ -142,7 +142,7 @@ bool Capture::saveLog(const char* _path, uintptr_t _symResolver )
 		for (uint32_t e=0; e<numFrames; e++)
 		{
 			rdebug::StackFrame st;
-			symbolResolverGetFrame(_symResolver, trace->m_entries[e], &st);
+			getStackFrame(_symResolver, trace->m_entries[e], st);
 			WriteStackFrame(f, st);
 		}
 	}
@@ -231,7 +231,7 @@ bool Capture::saveGroupsLog(const char* _path, eGroupSort _sorting, uintptr_t _s
 		for (uint32_t e=0; e<numFrames; e++)
 		{
 			rdebug::StackFrame st;
-			symbolResolverGetFrame(_symResolver, trace->m_entries[e], &st);
+			getStackFrame(_symResolver, trace->m_entries[e], st);
 			WriteStackFrame(f, st);
 		}
 	}
@@ -342,7 +342,7 @@ bool Capture::saveGroupsLogXML(const char* _path, eGroupSort _sorting, uintptr_t
 		for (uint32_t e=0; e<numFrames; e++)
 		{
 			rdebug::StackFrame st;
-			symbolResolverGetFrame(_symResolver, trace->m_entries[e], &st);
+			getStackFrame(_symResolver, trace->m_entries[e], st);
 
 			fprintf(f, "        <Frame>\n");
 			fprintf(f, "            <Module>%s</Module>\n", st.m_moduleName);
@@ -0,0 +1,274 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/callgraph.h>
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QThread>
+
+#include <algorithm>
+
+namespace rtm {
+
+struct CallGraphCall
+{
+	uint64_t	m_caller;
+	uint64_t	m_callee;
+	uint64_t	m_callerAddress;
+	uint64_t	m_calleeAddress;
+
+	bool operator < (const CallGraphCall& _other) const
+	{
+		return (m_caller < _other.m_caller) || ((m_caller == _other.m_caller) && (m_callee < _other.m_callee));
+	}
+
+	bool operator == (const CallGraphCall& _other) const
+	{
+		return (m_caller == _other.m_caller) && (m_callee == _other.m_callee);
+	}
+};
+
+//--------------------------------------------------------------------------
+/// Bottom-up tree node while building, children are looked up by symbol ID
+/// so hot frames with many callers don't need a scan per trace
+//--------------------------------------------------------------------------
+struct CallGraphBuildNode
+{
+	typedef rtm_unordered_map<uint64_t, uint32_t> ChildMap;
+
+	uint64_t			m_id;
+	uint64_t			m_address;
+	CallGraph::Weight	m_weight;
+	ChildMap			m_children;		///< Symbol ID to index of the node in worker
+
+	CallGraphBuildNode() : m_id(0), m_address(0) {}
+};
+
+//--------------------------------------------------------------------------
+/// Private results of a single worker thread, merged once all are done
+//--------------------------------------------------------------------------
+struct CallGraphWorker
+{
+	uint32_t						m_first;
+	uint32_t						m_last;
+	rtm_vector<CallGraphBuildNode>	m_nodes;		///< Flat bottom-up tree, root is the first node
+	CallGraph::Node					m_root;
+	CallGraph::FunctionMap		m_functions;
+	rtm_vector<uint64_t>		m_ids;			///< Scratch, unique functions of a trace
+	rtm_vector<CallGraphCall>	m_calls;		///< Scratch, unique calls of a trace
+};
+
+static void addTrace(CallGraphWorker& _worker, const StackTrace* _trace, const CallGraph::Weight& _weight)
+{
+	const uint32_t numFrames = (uint32_t)_trace->m_numEntries;
+	if (!numFrames)
+		return;
+
+	const uint64_t* addresses	= &_trace->m_entries[0];
+	const uint64_t* ids			= &_trace->m_entries[numFrames];
+
+	// bottom-up path starts at the innermost frame
+	uint32_t node = 0;
+	_worker.m_nodes[node].m_weight.add(_weight);
+	for (uint32_t i=0; i<numFrames; ++i)
+	{
+		CallGraphBuildNode::ChildMap& children = _worker.m_nodes[node].m_children;
+		CallGraphBuildNode::ChildMap::iterator it = children.find(ids[i]);
+		if (it != children.end())
+		{
+			node = it->second;
+		}
+		else
+		{
+			// adding the node may reallocate nodes, parent's map is updated first
+			const uint32_t child = (uint32_t)_worker.m_nodes.size();
+			children[ids[i]] = child;
+			_worker.m_nodes.emplace_back();
+			_worker.m_nodes[child].m_id			= ids[i];
+			_worker.m_nodes[child].m_address	= addresses[i];
+			node = child;
+		}
+
+		_worker.m_nodes[node].m_weight.add(_weight);
+	}
+
+	CallGraph::FunctionMap& functions = _worker.m_functions;
+	functions[ids[0]].m_self.add(_weight);
+
+	// recursive functions and calls are counted once per trace
+	_worker.m_ids.clear();
+	_worker.m_calls.clear();
+	for (uint32_t i=0; i<numFrames; ++i)
+	{
+		CallGraph::Function& function = functions[ids[i]];
+		if (!function.m_address)
+			function.m_address = addresses[i];
+
+		_worker.m_ids.push_back(ids[i]);
+
+		if (i + 1 < numFrames)
+		{
+			CallGraphCall call;
+			call.m_caller			= ids[i + 1];
+			call.m_callee			= ids[i];
+			call.m_callerAddress	= addresses[i + 1];
+			call.m_calleeAddress	= addresses[i];
+			_worker.m_calls.push_back(call);
+		}
+	}
+
+	std::sort(_worker.m_ids.begin(), _worker.m_ids.end());
+	_worker.m_ids.erase(std::unique(_worker.m_ids.begin(), _worker.m_ids.end()), _worker.m_ids.end());
+	for (uint64_t id : _worker.m_ids)
+		functions[id].m_total.add(_weight);
+
+	std::sort(_worker.m_calls.begin(), _worker.m_calls.end());
+	_worker.m_calls.erase(std::unique(_worker.m_calls.begin(), _worker.m_calls.end()), _worker.m_calls.end());
+	for (const CallGraphCall& call : _worker.m_calls)
+	{
+		CallGraph::Edge& caller = functions[call.m_callee].m_callers[call.m_caller];
+		caller.m_address = call.m_callerAddress;
+		caller.m_weight.add(_weight);
+
+		CallGraph::Edge& callee = functions[call.m_caller].m_callees[call.m_callee];
+		callee.m_address = call.m_calleeAddress;
+		callee.m_weight.add(_weight);
+	}
+}
+
+static void makeNode(const CallGraphWorker& _worker, uint32_t _index, CallGraph::Node& _node)
+{
+	const CallGraphBuildNode& src = _worker.m_nodes[_index];
+	_node.m_id		= src.m_id;
+	_node.m_address	= src.m_address;
+	_node.m_weight	= src.m_weight;
+
+	_node.m_children.resize(src.m_children.size());
+	size_t c = 0;
+	for (const CallGraphBuildNode::ChildMap::value_type& child : src.m_children)
+		makeNode(_worker, child.second, _node.m_children[c++]);
+}
+
+static void mergeNode(CallGraph::Node& _dst, CallGraph::Node& _src)
+{
+	_dst.m_weight.add(_src.m_weight);
+
+	if (_src.m_children.empty())
+		return;
+
+	rtm_unordered_map<uint64_t, size_t> dstChildren;
+	const size_t numDstChildren = _dst.m_children.size();
+	for (size_t i=0; i<numDstChildren; ++i)
+		dstChildren[_dst.m_children[i].m_id] = i;
+
+	for (CallGraph::Node& srcChild : _src.m_children)
+	{
+		rtm_unordered_map<uint64_t, size_t>::iterator it = dstChildren.find(srcChild.m_id);
+		if (it == dstChildren.end())
+			_dst.m_children.emplace_back(std::move(srcChild));
+		else
+			mergeNode(_dst.m_children[it->second], srcChild);
+	}
+}
+
+static void mergeEdges(CallGraph::EdgeMap& _dst, const CallGraph::EdgeMap& _src)
+{
+	for (const CallGraph::EdgeMap::value_type& edge : _src)
+	{
+		CallGraph::Edge& dst = _dst[edge.first];
+		dst.m_address = edge.second.m_address;
+		dst.m_weight.add(edge.second.m_weight);
+	}
+}
+
+static void mergeFunctions(CallGraph::FunctionMap& _dst, CallGraph::FunctionMap& _src)
+{
+	for (CallGraph::FunctionMap::value_type& function : _src)
+	{
+		CallGraph::FunctionMap::iterator it = _dst.find(function.first);
+		if (it == _dst.end())
+		{
+			_dst.emplace(function.first, std::move(function.second));
+			continue;
+		}
+
+		CallGraph::Function& dst = it->second;
+		dst.m_self.add(function.second.m_self);
+		dst.m_total.add(function.second.m_total);
+		mergeEdges(dst.m_callers, function.second.m_callers);
+		mergeEdges(dst.m_callees, function.second.m_callees);
+	}
+}
+
+void CallGraph::collectTraces(const MemoryGroupsHashType& _groups, Traces& _traces)
+{
+	// groups of the same stack trace differ only in allocation size
+	rtm_unordered_map<StackTrace*, Weight> traceWeights;
+	for (const MemoryGroupsHashType::value_type& group : _groups)
+	{
+		const MemoryOperationGroup& g = group.second;
+		if (g.m_operations.empty() || !g.m_operations[0]->m_stackTrace)
+			continue;
+
+		Weight& weight = traceWeights[g.m_operations[0]->m_stackTrace];
+		weight.m_usage		+= g.m_liveSize;
+		weight.m_peakUsage	+= g.m_peakSize;
+		weight.m_count		+= g.m_count;
+	}
+
+	_traces.assign(traceWeights.begin(), traceWeights.end());
+}
+
+void CallGraph::build(const Traces& _traces)
+{
+	clear();
+
+	const uint32_t numTraces = (uint32_t)_traces.size();
+	if (!numTraces)
+		return;
+
+	const uint32_t maxWorkers	= (uint32_t)qMax(1, QThread::idealThreadCount());
+	const uint32_t numWorkers	= qBound(1U, numTraces / MIN_TRACES_PER_WORKER, maxWorkers);
+	const uint32_t tracesPerWorker = (numTraces + numWorkers - 1) / numWorkers;
+
+	rtm_vector<CallGraphWorker> workers(numWorkers);
+	for (uint32_t w=0; w<numWorkers; ++w)
+	{
+		workers[w].m_first	= w * tracesPerWorker;
+		workers[w].m_last	= qMin(numTraces, (w + 1) * tracesPerWorker);
+	}
+
+	QtConcurrent::blockingMap(workers.begin(), workers.end(), [&_traces](CallGraphWorker& _worker)
+	{
+		_worker.m_nodes.emplace_back();
+		for (uint32_t i=_worker.m_first; i<_worker.m_last; ++i)
+			addTrace(_worker, _traces[i].first, _traces[i].second);
+
+		makeNode(_worker, 0, _worker.m_root);
+		rtm_vector<CallGraphBuildNode>().swap(_worker.m_nodes);
+	});
+
+	m_root		= std::move(workers[0].m_root);
+	m_functions	= std::move(workers[0].m_functions);
+	for (uint32_t w=1; w<numWorkers; ++w)
+	{
+		mergeNode(m_root, workers[w].m_root);
+		mergeFunctions(m_functions, workers[w].m_functions);
+	}
+}
+
+void CallGraph::clear()
+{
+	m_root = Node();
+	m_functions.clear();
+}
+
+const CallGraph::Function* CallGraph::findFunction(uint64_t _id) const
+{
+	FunctionMap::const_iterator it = m_functions.find(_id);
+	return it == m_functions.end() ? NULL : &it->second;
+}
+
+} // namespace rtm
@@ -0,0 +1,97 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_CALLGRAPH_H__
+#define __RTM_MTUNER_CALLGRAPH_H__
+
+#include <MTuner/src/loader/capture.h>
+
+namespace rtm {
+
+//--------------------------------------------------------------------------
+/// Bottom-up call tree and per function caller/callee aggregation. Built
+/// from unique stack traces weighted by their operation groups, so cost
+/// depends on number of stack traces and their depth, not on number of
+/// operations. Frames are merged by symbol ID like in StackTraceTree.
+//--------------------------------------------------------------------------
+class CallGraph
+{
+	public:
+		enum
+		{
+			MIN_TRACES_PER_WORKER = 1024
+		};
+
+		struct Weight
+		{
+			int64_t		m_usage;
+			int64_t		m_peakUsage;			///< Sum of group peaks, upper bound of the real peak
+			uint64_t	m_count;				///< Number of operations
+
+			Weight() : m_usage(0), m_peakUsage(0), m_count(0) {}
+
+			void add(const Weight& _weight)
+			{
+				m_usage		+= _weight.m_usage;
+				m_peakUsage	+= _weight.m_peakUsage;
+				m_count		+= _weight.m_count;
+			}
+		};
+
+		/// Bottom-up tree node, children of the root are the innermost frames
+		struct Node
+		{
+			typedef rtm_vector<Node> ChildNodes;
+
+			uint64_t	m_id;
+			uint64_t	m_address;				///< Any address of the function, used for resolving
+			Weight		m_weight;
+			ChildNodes	m_children;				///< Callers
+
+			Node() : m_id(0), m_address(0) {}
+		};
+
+		struct Edge
+		{
+			uint64_t	m_address;
+			Weight		m_weight;
+		};
+
+		typedef rtm_unordered_map<uint64_t, Edge> EdgeMap;
+
+		struct Function
+		{
+			uint64_t	m_address;
+			Weight		m_self;					///< Traces where function is the innermost frame
+			Weight		m_total;				///< Traces that contain the function, recursion counted once
+			EdgeMap		m_callers;
+			EdgeMap		m_callees;
+		};
+
+		typedef rtm_unordered_map<uint64_t, Function> FunctionMap;
+
+		typedef std::pair<StackTrace*, Weight>	TraceWeight;
+		typedef rtm_vector<TraceWeight>			Traces;
+
+	private:
+		Node			m_root;
+		FunctionMap		m_functions;
+
+	public:
+		/// Aggregates groups per stack trace, cheap enough to do while groups can't change
+		static void			collectTraces(const MemoryGroupsHashType& _groups, Traces& _traces);
+
+		/// Builds both views on all cores, traces must stay valid until done
+		void				build(const Traces& _traces);
+		void				clear();
+
+		const Node&			getRoot() const { return m_root; }
+		const FunctionMap&	getFunctions() const { return m_functions; }
+		const Function*		findFunction(uint64_t _id) const;
+};
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_CALLGRAPH_H__
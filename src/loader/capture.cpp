@@ -12,6 +12,7 @@
 #include <rbase/inc/winchar.h>
 #include <rdebug/inc/rdebug.h>
 #include <QtConcurrent/QtConcurrent>
+#include <QtCore/QThread>
 
 #include <type_traits>
 
@@ -60,6 +61,15 @@ static inline bool stackTraceCompare(uint64_t* _e1, uint64_t _c1, uint64_t* _e2,
 	return true;
 }
 
+/// Minimum number of candidate operations for building filtered data on multiple threads
+static const uint32_t PARALLEL_FILTER_MIN_OPS = 1024*1024;
+
+/// Number of operations in a filtered data chunk, workers check for cancellation between chunks
+static const uint32_t FILTER_CHUNK_OPS = 64*1024;
+
+/// Maximum number of chunks kept for reuse by the next filtering pass
+static const uint32_t MAX_FILTER_CHUNKS = 256;
+
 static uint32_t getGranularityMask(uint64_t _ops)
 {
 	uint32_t granularity = 2048;
@@ -132,14 +142,6 @@ static inline void addHeap(HeapsType& _heaps, uint64_t _heap)
 		_heaps[_heap] = "";
 }
 
-static inline bool isLeaked(MemoryOperation* _op)
-{
-	bool isFreed = _op->m_operationType == rmem::LogMarkers::OpFree;
-	isFreed = isFreed || ((_op->m_operationType == rmem::LogMarkers::OpRealloc) && (_op->m_allocSize == 0));
-	isFreed = isFreed || ((_op->m_operationType == rmem::LogMarkers::OpReallocAligned) && (_op->m_allocSize == 0));
-	return !isFreed;
-}
-
 static inline void updateLiveBlocks(MemoryOperation* _op, uint64_t& _liveBlocks)
 {
 	switch (_op->m_operationType)
@@ -181,6 +183,104 @@ static inline void updateLiveSize(MemoryOperation* _op, uint64_t& _liveSize)
 	};
 }
 
+//--------------------------------------------------------------------------
+/// Returns true if valid operation matches the criteria
+//--------------------------------------------------------------------------
+static inline bool matchesFilter(MemoryOperation* _op, const FilterCriteria& _criteria)
+{
+	if ((_criteria.m_heap != (uint64_t)-1) && (_op->m_allocatorHandle != _criteria.m_heap))
+		return false;
+
+	if ((_criteria.m_histogramIndex != (uint32_t)-1) && (_criteria.m_histogramIndex != getHistogramBinIndex(_op->m_allocSize)))
+		return false;
+
+	if ((_criteria.m_tagHash != 0) && (_criteria.m_tagHash != _op->m_tag))
+		return false;
+
+	if ((_criteria.m_threadID != 0) && (_criteria.m_threadID != _op->m_threadID))
+		return false;
+
+	if ((_op->m_operationTime < _criteria.m_minTimeSnapshot) ||
+		(_op->m_operationTime > _criteria.m_maxTimeSnapshot))
+		return false;
+
+	if (_criteria.m_module)
+	{
+		const uint64_t* mask = _op->m_stackTrace->m_moduleMask;
+		if ((mask[_criteria.m_moduleIndex >> 6] & (UINT64_C(1) << (_criteria.m_moduleIndex & 63))) == 0)
+			return false;
+	}
+
+	if (_criteria.m_leakedOnly && !isLeaked(_op))
+		return false;
+
+	if (_criteria.m_query && !_criteria.m_query->matches(_op))
+		return false;
+
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/// Returns true if criteria other than time range are the same
+//--------------------------------------------------------------------------
+static inline bool sameCriteriaExceptTime(const FilterCriteria& _c1, const FilterCriteria& _c2)
+{
+	return	(_c1.m_histogramIndex	== _c2.m_histogramIndex) &&
+			(_c1.m_tagHash			== _c2.m_tagHash) &&
+			(_c1.m_threadID			== _c2.m_threadID) &&
+			(_c1.m_heap				== _c2.m_heap) &&
+			(_c1.m_module			== _c2.m_module) &&
+			(_c1.m_leakedOnly		== _c2.m_leakedOnly) &&
+			(_c1.m_query			== _c2.m_query);
+}
+
+//--------------------------------------------------------------------------
+/// Returns true if chunks filtered with one criteria can be reused with the other
+//--------------------------------------------------------------------------
+static inline bool sameChunkCriteria(const FilterCriteria& _c1, const FilterCriteria& _c2)
+{
+	return	sameCriteriaExceptTime(_c1, _c2) &&
+			(_c1.m_minTimeSnapshot == _c2.m_minTimeSnapshot);
+}
+
+//--------------------------------------------------------------------------
+/// Returns true if operation passes the criteria, NULL criteria accepts all valid operations
+//--------------------------------------------------------------------------
+static inline bool isOpInFilter(MemoryOperation* _op, const FilterCriteria* _criteria)
+{
+	if (!_op->m_isValid)
+		return false;
+
+	return !_criteria || matchesFilter(_op, *_criteria);
+}
+
+//--------------------------------------------------------------------------
+/// Clears all operation bitmaps
+//--------------------------------------------------------------------------
+void OperationIndex::clear()
+{
+	m_threads.clear();
+	m_heaps.clear();
+	m_tags.clear();
+	for (uint32_t i=0; i<MemoryStats::NUM_HISTOGRAM_BINS; ++i)
+		m_histogramBins[i].clear();
+	m_leaked.clear();
+}
+
+//--------------------------------------------------------------------------
+/// Adds operation to bitmaps, must be called in increasing index order
+//--------------------------------------------------------------------------
+void OperationIndex::addOp(MemoryOperation* _op, uint32_t _index)
+{
+	m_threads[_op->m_threadID].append(_index);
+	m_heaps[_op->m_allocatorHandle].append(_index);
+	m_tags[_op->m_tag].append(_index);
+	m_histogramBins[getHistogramBinIndex(_op->m_allocSize)].append(_index);
+
+	if (isLeaked(_op))
+		m_leaked.append(_index);
+}
+
 //--------------------------------------------------------------------------
 /// Capture constructor
 //--------------------------------------------------------------------------
@@ -191,6 +291,9 @@ Capture::Capture()
 
 	m_loadProgressCallback		= NULL;
 	m_loadProgressCustomData	= NULL;
+	m_symbolCache				= NULL;
+	m_symbolizer				= NULL;
+	m_lazySymbols				= false;
 
 	clearData();
 }
@@ -230,6 +333,7 @@ void Capture::clearData()
 	}
 
 	m_modulePathBufferPtr = 0;
+	m_frameCache.clear();
 
 	// -----
 
@@ -240,21 +344,35 @@ void Capture::clearData()
 	m_minTime = 0;
 	m_maxTime = 0;
 
-	m_filter.m_minTimeSnapshot	= 0;
-	m_filter.m_maxTimeSnapshot	= 0;
-	m_filter.m_histogramIndex	= 0xffffffff;
-	m_filter.m_tagHash			= 0;
-	m_filter.m_threadID			= 0;
-	m_filter.m_leakedOnly		= false;
+	m_pendingCriteria.m_minTimeSnapshot	= 0;
+	m_pendingCriteria.m_maxTimeSnapshot	= 0;
+	m_pendingCriteria.m_histogramIndex	= 0xffffffff;
+	m_pendingCriteria.m_tagHash			= 0;
+	m_pendingCriteria.m_threadID		= 0;
+	m_pendingCriteria.m_heap			= (uint64_t)-1;
+	m_pendingCriteria.m_module		= 0;
+	m_pendingCriteria.m_moduleIndex	= 0;
+	m_pendingCriteria.m_leakedOnly		= false;
+	m_pendingCriteria.m_query.reset();
+	m_criteria							= m_pendingCriteria;
+	m_pendingQuery.reset();
+	m_pendingQueryResolver				= 0;
+	m_filterBuildState.m_valid		= false;
+	m_filterChunks.m_valid			= false;
+	m_filterChunks.m_chunks.clear();
 
 	m_usageGraph.clear();
+	m_threadTimeline.clear();
+	m_heapTimeline.clear();
+	m_tagTimeline.clear();
 
 	m_memoryMarkers.clear();
 	m_memoryMarkerTimes.clear();
 
 	m_Heaps.clear();
-	m_currentHeap = (uint64_t)-1;
-	m_currentModule  = 0;
+	m_operationIndex.clear();
+	m_symbolIndex.clear();
+	m_moduleMaskWords = 0;
 
 	tagTreeDestroy(m_tagTree);
 	destroyStackTree(m_stackTraceTree);
@@ -656,6 +774,7 @@ Capture::LoadResult Capture::loadBin(const char* _path)
 							st = (StackTrace*)m_stackPool.alloc((uint32_t)(sizeof(StackTrace) + (numFrames32*4-1)*sizeof(uint64_t)));
 							st->m_next = (StackTrace**)m_stackPool.alloc((uint32_t)(sizeof(StackTrace*) * (numFrames32+1)));
 							memset(st->m_next, 0, sizeof(StackTrace*) * (numFrames32+1));
+							st->m_moduleMask = NULL;
 							memcpy(&st->m_entries[0], backTrace64, numFrames32*sizeof(uint64_t));
 							st->m_numEntries = (uint64_t)numFrames32;
 							m_stackTracesHash[stackTraceHash] = st;
@@ -937,10 +1056,10 @@ Capture::LoadResult Capture::loadBin(const char* _path)
 //--------------------------------------------------------------------------
 ///
 //--------------------------------------------------------------------------
-void Capture::setFilteringEnabled(bool inState)
+void Capture::setFilteringEnabled(bool inState, bool _calculate)
 {
 	m_filteringEnabled = inState;
-	if (m_filteringEnabled)
+	if (m_filteringEnabled && _calculate)
 		calculateFilteredData();
 }
 
@@ -949,50 +1068,7 @@ void Capture::setFilteringEnabled(bool inState)
 //--------------------------------------------------------------------------
 bool Capture::isInFilter(MemoryOperation* _op)
 {
-	if (!_op->m_isValid)
-		return false;
-
-	if (!m_filteringEnabled)
-		return true;
-
-	if ((m_currentHeap != (uint64_t)-1) && (_op->m_allocatorHandle != m_currentHeap))
-		return false;
-
-	if ((m_filter.m_histogramIndex != (uint32_t)-1) && (m_filter.m_histogramIndex != getHistogramBinIndex(_op->m_allocSize)))
-		return false;
-
-	if ((m_filter.m_tagHash != 0) && (m_filter.m_tagHash != _op->m_tag))
-		return false;
-
-	if ((m_filter.m_threadID != 0) && (m_filter.m_threadID != _op->m_threadID))
-		return false;
-
-	if ((_op->m_operationTime < m_filter.m_minTimeSnapshot) ||
-		(_op->m_operationTime > m_filter.m_maxTimeSnapshot))
-		return false;
-
-	if (m_currentModule)
-	{
-		bool moduleInStack = false;
-		const uint32_t numEntries = (uint32_t)_op->m_stackTrace->m_numEntries;
-		for (uint32_t i=0; i<numEntries; ++i)
-		{
-			rdebug::ModuleInfo info;
-			if (m_currentModule->checkAddress(_op->m_stackTrace->m_entries[i]))
-			{
-				moduleInStack = true;
-				break;
-			}
-		}
-
-		if (!moduleInStack)
-			return false;
-	}
-
-	if (m_filter.m_leakedOnly && !isLeaked(_op))
-		return false;
-
-	return true;
+	return isOpInFilter(_op, m_filteringEnabled ? &m_criteria : NULL);
 }
 
 //--------------------------------------------------------------------------
@@ -1000,9 +1076,9 @@ bool Capture::isInFilter(MemoryOperation* _op)
 //--------------------------------------------------------------------------
 void Capture::selectHistogramBin(uint32_t _index)
 {
-	if (_index != m_filter.m_histogramIndex)
+	if (_index != m_pendingCriteria.m_histogramIndex)
 	{
-		m_filter.m_histogramIndex = _index;
+		m_pendingCriteria.m_histogramIndex = _index;
 		calculateSnapshotStats();
 	}
 }
@@ -1012,9 +1088,9 @@ void Capture::selectHistogramBin(uint32_t _index)
 //--------------------------------------------------------------------------
 void Capture::deselectHistogramBin()
 {
-	if (m_filter.m_histogramIndex != 0xffffffff)
+	if (m_pendingCriteria.m_histogramIndex != 0xffffffff)
 	{
-		m_filter.m_histogramIndex = 0xffffffff;
+		m_pendingCriteria.m_histogramIndex = 0xffffffff;
 		calculateSnapshotStats();
 	}
 }
@@ -1024,9 +1100,9 @@ void Capture::deselectHistogramBin()
 //--------------------------------------------------------------------------
 void Capture::selectTag(uint32_t _tagHash)
 {
-	if (_tagHash != m_filter.m_tagHash)
+	if (_tagHash != m_pendingCriteria.m_tagHash)
 	{
-		m_filter.m_tagHash = _tagHash;
+		m_pendingCriteria.m_tagHash = _tagHash;
 		calculateSnapshotStats();
 	}
 }
@@ -1036,9 +1112,9 @@ void Capture::selectTag(uint32_t _tagHash)
 //--------------------------------------------------------------------------
 void Capture::deselectTag()
 {
-	if (m_filter.m_tagHash != 0xffffffff)
+	if (m_pendingCriteria.m_tagHash != 0xffffffff)
 	{
-		m_filter.m_tagHash = 0xffffffff;
+		m_pendingCriteria.m_tagHash = 0xffffffff;
 		calculateSnapshotStats();
 	}
 }
@@ -1048,9 +1124,9 @@ void Capture::deselectTag()
 //--------------------------------------------------------------------------
 void Capture::selectThread( uint64_t inThread )
 {
-	if (inThread != m_filter.m_threadID)
+	if (inThread != m_pendingCriteria.m_threadID)
 	{
-		m_filter.m_threadID = inThread;
+		m_pendingCriteria.m_threadID = inThread;
 		calculateSnapshotStats();
 	}
 }
@@ -1060,9 +1136,9 @@ void Capture::selectThread( uint64_t inThread )
 //--------------------------------------------------------------------------
 void Capture::deselectThread()
 {
-	if (m_filter.m_threadID != 0)
+	if (m_pendingCriteria.m_threadID != 0)
 	{
-		m_filter.m_threadID = 0;
+		m_pendingCriteria.m_threadID = 0;
 		calculateSnapshotStats();
 	}
 }
@@ -1072,7 +1148,49 @@ void Capture::deselectThread()
 //--------------------------------------------------------------------------
 void Capture::setLeakedOnly(bool _leaked)
 {
-	m_filter.m_leakedOnly = _leaked;
+	m_pendingCriteria.m_leakedOnly = _leaked;
+}
+
+//--------------------------------------------------------------------------
+/// Compiles the query, empty query removes the query filter. Syntax errors
+/// are reported right away while binding stack patterns and evaluating the
+/// query is left to the next filtering pass, see prepareQuery.
+//--------------------------------------------------------------------------
+bool Capture::setQuery(const char* _query, uintptr_t _symResolver, rtm_string& _error)
+{
+	if (!_query || !*_query)
+	{
+		m_pendingCriteria.m_query.reset();
+		m_pendingQuery.reset();
+		return true;
+	}
+
+	std::shared_ptr<OpQuery> query = std::make_shared<OpQuery>();
+	if (!query->compile(_query, _error))
+		return false;
+
+	m_pendingQuery			= query;
+	m_pendingQueryResolver	= _symResolver;
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/// Returns text of the last entered query
+//--------------------------------------------------------------------------
+const char* Capture::getQuery() const
+{
+	if (m_pendingQuery)
+		return m_pendingQuery->getText().c_str();
+	return m_pendingCriteria.m_query ? m_pendingCriteria.m_query->getText().c_str() : "";
+}
+
+//--------------------------------------------------------------------------
+/// Selects the module for filtering, NULL removes the module filter
+//--------------------------------------------------------------------------
+void Capture::setCurrentModule(rdebug::ModuleInfo* _module)
+{
+	m_pendingCriteria.m_module		= _module;
+	m_pendingCriteria.m_moduleIndex	= _module ? (uint32_t)(_module - m_moduleInfos.data()) : 0;
 }
 
 //--------------------------------------------------------------------------
@@ -1086,11 +1204,11 @@ void Capture::setSnapshot(uint64_t _minTime, uint64_t _maxTime)
 	if (_maxTime > m_maxTime)
 		return;
 
-	if ((m_filter.m_minTimeSnapshot != _minTime) ||
-		(m_filter.m_maxTimeSnapshot != _maxTime))
+	if ((m_pendingCriteria.m_minTimeSnapshot != _minTime) ||
+		(m_pendingCriteria.m_maxTimeSnapshot != _maxTime))
 	{
-		m_filter.m_minTimeSnapshot = _minTime;
-		m_filter.m_maxTimeSnapshot = _maxTime;
+		m_pendingCriteria.m_minTimeSnapshot = _minTime;
+		m_pendingCriteria.m_maxTimeSnapshot = _maxTime;
 
 		calculateSnapshotStats();
 	}
@@ -1106,6 +1224,104 @@ void Capture::getGraphAtTime(uint64_t _time, GraphEntry& _entry)
 	_entry = m_usageGraph[idx];
 }
 
+//--------------------------------------------------------------------------
+/// Fills histograms for equal slices of time range. Slices spanning several
+/// timed stats end at the last one and take peaks from their local peaks,
+/// shorter slices are replayed operation by operation.
+//--------------------------------------------------------------------------
+void Capture::getHistogramSlices(uint64_t _minTime, uint64_t _maxTime, uint32_t _count, HistogramBin* _bins)
+{
+	const uint32_t numBins		= MemoryStats::NUM_HISTOGRAM_BINS;
+	const uint32_t numTimed		= (uint32_t)m_timedStats.size();
+	const uint32_t numOps		= (uint32_t)m_operations.size();
+
+	if (!_count || !numTimed || (_maxTime < _minTime))
+		return;
+
+	// last timed stats is taken after all operations
+	auto timedIndex = [&](uint32_t _t) { return _t == numTimed - 1 ? numOps : m_timedStats[_t].m_operationIndex; };
+
+	auto opIndex = [&](uint64_t _time) -> uint32_t
+	{
+		rtm_vector<MemoryOperation*>::const_iterator it = std::lower_bound(m_operations.begin(), m_operations.end(), _time,
+			[](const MemoryOperation* _op, uint64_t _t) { return _op->m_operationTime < _t; });
+		return (uint32_t)(it - m_operations.begin());
+	};
+
+	// last timed stats at or before the operation index
+	auto timedBefore = [&](uint32_t _opIdx) -> uint32_t
+	{
+		uint32_t lo = 0;
+		uint32_t hi = numTimed;
+		while (hi - lo > 1)
+		{
+			const uint32_t mid = (lo + hi) / 2;
+			if (timedIndex(mid) <= _opIdx)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		return lo;
+	};
+
+	const uint32_t startIdx = opIndex(_minTime);
+	uint32_t timed = timedBefore(startIdx);
+	uint32_t opIdx = timedIndex(timed);
+
+	MemoryStats stats = m_timedStats[timed].m_stats;
+	GetRangedStats(stats, opIdx, startIdx);
+	opIdx = startIdx;
+
+	const double sliceDuration = double(_maxTime - _minTime) / double(_count);
+
+	for (uint32_t s=0; s<_count; ++s)
+	{
+		const uint64_t endTime = (s == _count - 1) ? _maxTime + 1 : _minTime + uint64_t(sliceDuration * (s + 1));
+		const uint32_t endIdx = qMax(opIdx, opIndex(endTime));
+
+		stats.setPeaksToCurrent();
+
+		const uint32_t firstTimed	= timedBefore(opIdx) + 1;
+		const uint32_t lastTimed	= timedBefore(endIdx);
+		if (lastTimed > firstTimed)
+		{
+			// replay up to the first timed stats inside the slice, local peaks cover the rest
+			GetRangedStats(stats, opIdx, timedIndex(firstTimed));
+
+			for (uint32_t t=firstTimed+1; t<=lastTimed; ++t)
+			{
+				const HistogramBinPeak* peaks = m_timedStats[t].m_localPeak.m_HistogramPeak;
+				for (uint32_t b=0; b<numBins; ++b)
+				{
+					stats.m_histogram[b].m_sizePeak		= qMax(stats.m_histogram[b].m_sizePeak, peaks[b].m_sizePeak);
+					stats.m_histogram[b].m_overheadPeak	= qMax(stats.m_histogram[b].m_overheadPeak, peaks[b].m_overheadPeak);
+					stats.m_histogram[b].m_countPeak	= qMax(stats.m_histogram[b].m_countPeak, peaks[b].m_countPeak);
+				}
+			}
+
+			HistogramBin peaks[MemoryStats::NUM_HISTOGRAM_BINS];
+			memcpy(peaks, stats.m_histogram, sizeof(peaks));
+
+			stats = m_timedStats[lastTimed].m_stats;
+			opIdx = timedIndex(lastTimed);
+
+			for (uint32_t b=0; b<numBins; ++b)
+			{
+				stats.m_histogram[b].m_sizePeak		= qMax(stats.m_histogram[b].m_size, peaks[b].m_sizePeak);
+				stats.m_histogram[b].m_overheadPeak	= qMax(stats.m_histogram[b].m_overhead, peaks[b].m_overheadPeak);
+				stats.m_histogram[b].m_countPeak	= qMax(stats.m_histogram[b].m_count, peaks[b].m_countPeak);
+			}
+		}
+		else
+		{
+			GetRangedStats(stats, opIdx, endIdx);
+			opIdx = endIdx;
+		}
+
+		memcpy(&_bins[s * numBins], stats.m_histogram, sizeof(stats.m_histogram));
+	}
+}
+
 //--------------------------------------------------------------------------
 /// Loads symbol information
 //--------------------------------------------------------------------------
@@ -1194,6 +1410,52 @@ struct SymbolAddressIDInfo
 typedef std::unordered_map<uint64_t, SymbolAddressIDInfo> SymbolAddressIDInfoMap;
 typedef std::pair<uint64_t, SymbolAddressIDInfo> SymbolAddressIDInfoMutablePair;
 
+//--------------------------------------------------------------------------
+/// Resolves symbol IDs of a single module in batches, cached addresses are skipped
+//--------------------------------------------------------------------------
+static bool resolveModuleAddressIDs(GNUSymbolizer* _symbolizer, SymbolCache* _cache, int32_t _moduleIndex, std::vector<SymbolAddressIDInfoMutablePair>& _infos)
+{
+	if (!_symbolizer->canResolve(_moduleIndex))
+		return false;
+
+	rtm_vector<uint32_t> missing;
+	rtm_vector<uint64_t> addresses;
+
+	const uint32_t numInfos = (uint32_t)_infos.size();
+	for (uint32_t i=0; i<numInfos; ++i)
+	{
+		SymbolAddressIDInfoMutablePair& info = _infos[i];
+		if (_cache && _cache->findAddressID(info.first, info.second.id, info.second.isMTunerDLL))
+			continue;
+
+		missing.push_back(i);
+		addresses.push_back(info.first);
+	}
+
+	if (missing.empty())
+		return true;
+
+	rtm_vector<GNUSymbolizer::Symbol> symbols(missing.size());
+	if (!_symbolizer->resolve(_moduleIndex, addresses.data(), (uint32_t)addresses.size(), symbols.data()))
+		return false;
+
+	const char* moduleName = _symbolizer->getModuleName(_moduleIndex);
+
+	for (size_t i=0; i<missing.size(); ++i)
+	{
+		const GNUSymbolizer::Symbol& symbol = symbols[i];
+
+		SymbolAddressIDInfo& info = _infos[missing[i]].second;
+		info.id				= symbol.m_id;
+		info.isMTunerDLL	= symbol.m_isMTunerDLL;
+
+		if (_cache)
+			_cache->addSymbol(addresses[i], symbol.m_id, symbol.m_isMTunerDLL, moduleName, symbol.m_func.c_str(), symbol.m_file.c_str(), symbol.m_line);
+	}
+
+	return true;
+}
+
 //--------------------------------------------------------------------------
 /// Builds stack trace trees and group operations by type/call stack/size
 //--------------------------------------------------------------------------
@@ -1224,15 +1486,49 @@ void Capture::buildAnalyzeData(uintptr_t _symResolver)
 		int32_t moduleIndex = rdebug::symbolResolverGetAddressModuleIndex(_symResolver, infoPair.first);
 		addressIDInfoCacheList[moduleIndex+1].push_back(infoPair);
 	}
-	QtConcurrent::blockingMap(addressIDInfoCacheList.begin(), addressIDInfoCacheList.end(), [_symResolver](std::vector<SymbolAddressIDInfoMutablePair>& singleModuleInfoList)
+	// with lazy symbols only MTunerDLL frames need to be known, module path is enough for that
+	rtm_vector<uint8_t> moduleIsMTunerDLL(m_moduleInfos.size());
+	for (size_t i=0; i<m_moduleInfos.size(); ++i)
+		moduleIsMTunerDLL[i] = QString::fromUtf8(m_moduleInfos[i].m_modulePath).contains("MTunerDLL", Qt::CaseInsensitive) ? 1 : 0;
+
+	SymbolCache* symbolCache = m_symbolCache;
+	GNUSymbolizer* symbolizer = m_symbolizer;
+	const bool lazySymbols = m_lazySymbols;
+	const std::vector<SymbolAddressIDInfoMutablePair>* firstModuleInfoList = addressIDInfoCacheList.data();
+	QtConcurrent::blockingMap(addressIDInfoCacheList.begin(), addressIDInfoCacheList.end(), [_symResolver, symbolCache, symbolizer, lazySymbols, &moduleIsMTunerDLL, firstModuleInfoList](std::vector<SymbolAddressIDInfoMutablePair>& singleModuleInfoList)
 	{
+		const int32_t moduleIndex = (int32_t)(&singleModuleInfoList - firstModuleInfoList) - 1;
+
+		// address is unique for module and offset, frames are merged per call site until names are needed
+		if (lazySymbols)
+		{
+			const bool isMTunerDLL = (moduleIndex >= 0) && (moduleIndex < (int32_t)moduleIsMTunerDLL.size()) && moduleIsMTunerDLL[moduleIndex];
+			for (SymbolAddressIDInfoMutablePair& infoPair : singleModuleInfoList)
+			{
+				infoPair.second.id			= infoPair.first;
+				infoPair.second.isMTunerDLL	= isMTunerDLL;
+			}
+			return;
+		}
+
 		//sort by address, this would probably be faster
 		std::sort(singleModuleInfoList.begin(), singleModuleInfoList.end(), [](auto&& x, auto&& y) { return x.first < y.first; });
+
+		// whole module in batches, in process or through binutils, falls back to per address resolving
+		if (symbolizer && resolveModuleAddressIDs(symbolizer, symbolCache, moduleIndex, singleModuleInfoList))
+			return;
+
 		for (SymbolAddressIDInfoMutablePair& infoPair : singleModuleInfoList)
 		{
-			infoPair.second.id = rdebug::symbolResolverGetAddressID(_symResolver, infoPair.first, &infoPair.second.isMTunerDLL);
+			if (symbolCache)
+				infoPair.second.id = symbolCache->getAddressID(_symResolver, infoPair.first, &infoPair.second.isMTunerDLL);
+			else
+				infoPair.second.id = rdebug::symbolResolverGetAddressID(_symResolver, infoPair.first, &infoPair.second.isMTunerDLL);
 		}
 	});
+
+	if (symbolCache)
+		symbolCache->save();
 	for (const std::vector<SymbolAddressIDInfoMutablePair>& singleModuleInfoList : addressIDInfoCacheList)
 	{
 		for (const SymbolAddressIDInfoMap::value_type& infoPair : singleModuleInfoList)
@@ -1303,6 +1599,9 @@ void Capture::buildAnalyzeData(uintptr_t _symResolver)
 		++idx;
 	}
 
+	buildModuleMasks();
+	m_symbolIndex.build(m_stackTraces);
+
 	MemoryTagTree* prevTag = NULL;
 
 	const uint32_t numOps = (uint32_t)m_operations.size();
@@ -1338,16 +1637,19 @@ void Capture::buildAnalyzeData(uintptr_t _symResolver)
 		updateLiveSize(op, liveSize);
 
 		// add to memory groups
-		addToMemoryGroups(m_operationGroups, op, liveBlocks, liveSize);
+		addToMemoryGroups(m_operationGroups, op, NULL, liveBlocks, liveSize);
 
 		// add to call stack tree
- 		addToStackTraceTree(m_stackTraceTree, op, StackTrace::Global);
+ 		addToStackTraceTree(m_stackTraceTree, op, NULL, StackTrace::Global);
 
 		// add to tag tree
 		tagAddOp(m_tagTree, op, prevTag);
 
 		// add to heaps list
 		addHeap(m_Heaps, op->m_allocatorHandle);
+
+		// add to filtering bitmaps
+		m_operationIndex.addOp(op, i);
 	}
 
 	if (m_loadProgressCallback)
@@ -1475,8 +1777,9 @@ bool Capture::setLinksAndRemoveInvalid(uint64_t inMinMarkerTime)
 		m_minTime = inMinMarkerTime;
 	m_maxTime = m_operations[numOps-1]->m_operationTime;
 
-	m_filter.m_minTimeSnapshot = m_minTime;
-	m_filter.m_maxTimeSnapshot = m_maxTime;
+	m_pendingCriteria.m_minTimeSnapshot = m_minTime;
+	m_pendingCriteria.m_maxTimeSnapshot = m_maxTime;
+	m_criteria = m_pendingCriteria;
 
 	if (m_loadProgressCallback)
 		m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Processing...");
@@ -1552,6 +1855,60 @@ void Capture::addModule(const char* _path, uint64_t inModBase, uint64_t inModSiz
 	m_moduleInfos.push_back(info);
 }
 
+//--------------------------------------------------------------------------
+/// Builds per stack trace module membership masks used by module filtering
+//--------------------------------------------------------------------------
+void Capture::buildModuleMasks()
+{
+	const uint32_t numModules = (uint32_t)m_moduleInfos.size();
+	m_moduleMaskWords = (numModules + 63) / 64;
+	if (m_moduleMaskWords == 0)
+		m_moduleMaskWords = 1;
+
+	// module indices sorted by base address for binary search
+	rtm_vector<uint32_t> sortedModules(numModules);
+	for (uint32_t i=0; i<numModules; ++i)
+		sortedModules[i] = i;
+	std::sort(sortedModules.begin(), sortedModules.end(), [this](uint32_t _m1, uint32_t _m2)
+	{
+		return m_moduleInfos[_m1].m_baseAddress < m_moduleInfos[_m2].m_baseAddress;
+	});
+
+	const size_t maskSize = sizeof(uint64_t) * m_moduleMaskWords;
+
+	for (StackTrace* st : m_stackTraces)
+	{
+		st->m_moduleMask = (uint64_t*)m_stackPool.alloc((uint32_t)maskSize);
+		memset(st->m_moduleMask, 0, maskSize);
+
+		uint32_t prevModule = numModules;
+		const uint32_t numEntries = (uint32_t)st->m_numEntries;
+		for (uint32_t i=0; i<numEntries; ++i)
+		{
+			const uint64_t address = st->m_entries[i];
+
+			// consecutive frames are very often from the same module
+			if ((prevModule != numModules) && m_moduleInfos[prevModule].checkAddress(address))
+				continue;
+
+			rtm_vector<uint32_t>::iterator mod = std::upper_bound(sortedModules.begin(), sortedModules.end(), address, [this](uint64_t _address, uint32_t _m)
+			{
+				return _address < m_moduleInfos[_m].m_baseAddress;
+			});
+
+			if (mod == sortedModules.begin())
+				continue;
+
+			const uint32_t modIdx = *(--mod);
+			if (!m_moduleInfos[modIdx].checkAddress(address))
+				continue;
+
+			st->m_moduleMask[modIdx >> 6] |= UINT64_C(1) << (modIdx & 63);
+			prevModule = modIdx;
+		}
+	}
+}
+
 //--------------------------------------------------------------------------
 /// Calculates statistics for entire binary
 //--------------------------------------------------------------------------
@@ -1569,6 +1926,10 @@ void Capture::calculateGlobalStats()
 
 	uint32_t timedGranularityMask = getGranularityMask(numOps);
 
+	m_threadTimeline.begin(m_minTime, m_maxTime);
+	m_heapTimeline.begin(m_minTime, m_maxTime);
+	m_tagTimeline.begin(m_minTime, m_maxTime);
+
 	for (size_t i=0; i<numOps; i++)
 	{
 		MemoryOperation* op = m_operations[i];
@@ -1632,8 +1993,16 @@ void Capture::calculateGlobalStats()
 		entry.m_usage			= m_statsGlobal.m_memoryUsage;
 		entry.m_numLiveBlocks	= m_statsGlobal.m_numberOfLiveBlocks;
 		m_usageGraph.emplace_back(entry);
+
+		m_threadTimeline.addOperation(op, [](const MemoryOperation* _op) { return _op->m_threadID; });
+		m_heapTimeline.addOperation(op, [](const MemoryOperation* _op) { return _op->m_allocatorHandle; });
+		m_tagTimeline.addOperation(op, [](const MemoryOperation* _op) { return (uint64_t)_op->m_tag; });
 	}
 
+	m_threadTimeline.end();
+	m_heapTimeline.end();
+	m_tagTimeline.end();
+
 	MemoryStatsTimed st;
 	st.m_time		= m_operations[m_operations.size()-1]->m_operationTime;
 	st.m_operationIndex	= (uint32_t)(m_operations.size()-1);
@@ -1677,90 +2046,412 @@ bool Capture::verifyGlobalStats()
 //--------------------------------------------------------------------------
 void Capture::calculateFilteredData()
 {
-	rtm_vector<StackTrace*>::iterator it  = m_stackTraces.begin();
-	rtm_vector<StackTrace*>::iterator end = m_stackTraces.end();
+	FilterResult result;
+	beginFilteredData(result);
+	prepareQuery(result, NULL, 0);
 
-	const uint32_t numStackTraces = (uint32_t)m_stackTraces.size();
-	uint32_t nextProgressPoint = 0;
-	uint32_t numOpsOver100 = numStackTraces/100;
-	uint32_t idx = 0;
+	const uint32_t startOpIndex		= result.m_minIndex;
+	const uint32_t maxTimeOpIndex	= result.m_maxIndex;
+	const uint32_t numOps			= maxTimeOpIndex - startOpIndex;
+	const uint32_t numCandidates	= result.m_useCandidates ? result.m_candidates.getCardinality() : numOps;
 
-	while (it != end)
+	if (!result.m_extending && !result.m_noCandidates && (numCandidates >= PARALLEL_FILTER_MIN_OPS) && (QThread::idealThreadCount() > 1))
 	{
-		StackTrace* st = *it;
-		st->m_addedToTree[StackTrace::Filtered] = 0;
-		memset(&st->m_entries[st->m_numEntries*3], 0xff, (size_t)st->m_numEntries*sizeof(uint64_t));
+		if (m_loadProgressCallback)
+			m_loadProgressCallback(m_loadProgressCustomData, 0.0f, "Building filtered data...");
 
-		++it;
+		prepareFilteredData(result);
 
-		if ((idx > nextProgressPoint) && m_loadProgressCallback)
-		{
-			nextProgressPoint += numOpsOver100;
-			float percent = float(idx) / float(numOpsOver100);
-			m_loadProgressCallback(m_loadProgressCustomData, percent, "Fixing up stack traces...");
-		}
-		++idx;
-	}
+		if (m_loadProgressCallback)
+			m_loadProgressCallback(m_loadProgressCustomData, 50.0f, "Merging filtered data...");
 
+		applyFilteredData(result);
 
-	uint32_t minTimedIdx;
-	uint32_t maxTimedIdx;
-	const uint32_t minTimeOpIndex = getIndexBefore(m_filter.m_minTimeSnapshot,minTimedIdx);
-	uint32_t maxTimeOpIndex = getIndexBefore(m_filter.m_maxTimeSnapshot,maxTimedIdx) + 1;
+		if (m_loadProgressCallback)
+			m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Done!");
+		return;
+	}
 
-	if (maxTimeOpIndex >= m_operations.size())
+	if (!result.m_extending)
 	{
-		maxTimeOpIndex = (uint32_t) m_operations.size() - 1;
-	}
-	
-	m_filter.m_operations.clear();
-	m_filter.m_operations.reserve(maxTimeOpIndex - minTimeOpIndex);
+		if (m_loadProgressCallback)
+			m_loadProgressCallback(m_loadProgressCustomData, 0.0f, "Fixing up stack traces...");
 
-	m_filter.m_operationGroups.clear();
+		resetFilteredData();
+		m_filter.m_operations.reserve(maxTimeOpIndex - startOpIndex);
+	}
 
-	destroyStackTree(m_filter.m_stackTraceTree);
+	uint32_t nextProgressPoint = startOpIndex;
+	uint32_t numOpsOver100 = numOps/100;
 
-	const uint32_t numOps = maxTimeOpIndex - minTimeOpIndex;
-	nextProgressPoint = minTimeOpIndex;
-	numOpsOver100 = numOps/100;
+	MemoryTagTree* prevTag = m_filterBuildState.m_prevTag;
 
-	MemoryTagTree* prevTag = NULL;
+	uint64_t liveBlocks	= m_filterBuildState.m_liveBlocks;
+	uint64_t liveSize	= m_filterBuildState.m_liveSize;
 
-	uint64_t liveBlocks	= 0;
-	uint64_t liveSize	= 0;
+	const FilterCriteria* criteria = &result.m_criteria;
 
-	for (uint32_t i=minTimeOpIndex; i<=maxTimeOpIndex; i++)
+	if (result.m_noCandidates)
 	{
-		MemoryOperation* op = m_operations[i];
-		
-		if ((i > nextProgressPoint) && m_loadProgressCallback)
+		// one of the criteria matches no operation
+	}
+	else
+	if (!result.m_useCandidates)
+	{
+		for (uint32_t i=startOpIndex; i<=maxTimeOpIndex; i++)
 		{
-			float percent = float(i-minTimedIdx) / float(numOpsOver100);
-			m_loadProgressCallback(m_loadProgressCustomData, percent, "Building filtered data...");
-		}
-		
-		if (!isInFilter(op))
-			continue;
-
-		m_filter.m_operations.push_back(op);
+			MemoryOperation* op = m_operations[i];
 
-		updateLiveBlocks(op, liveBlocks);
-		updateLiveSize(op, liveSize);
+			if ((i > nextProgressPoint) && m_loadProgressCallback)
+			{
+				nextProgressPoint += numOpsOver100;
+				float percent = float(i-startOpIndex) / float(numOpsOver100);
+				m_loadProgressCallback(m_loadProgressCustomData, percent, "Building filtered data...");
+			}
 
-		// add to memory groups
-		addToMemoryGroups(m_filter.m_operationGroups, op, liveBlocks, liveSize);
+			if (isOpInFilter(op, criteria))
+				addToFilteredData(op, criteria, liveBlocks, liveSize, prevTag);
+		}
+	}
+	else
+	{
+		result.m_candidates.forEachInRange(startOpIndex, maxTimeOpIndex, [&](uint32_t _index)
+		{
+			MemoryOperation* op = m_operations[_index];
 
-		// add to call stack tree
-		addToStackTraceTree(m_filter.m_stackTraceTree, op, StackTrace::Filtered);
+			if ((_index > nextProgressPoint) && m_loadProgressCallback)
+			{
+				nextProgressPoint += numOpsOver100;
+				float percent = float(_index-startOpIndex) / float(numOpsOver100);
+				m_loadProgressCallback(m_loadProgressCustomData, percent, "Building filtered data...");
+			}
 
-		// add to tag tree
-		tagAddOp(m_filter.m_tagTree, op, prevTag);
+			if (isOpInFilter(op, criteria))
+				addToFilteredData(op, criteria, liveBlocks, liveSize, prevTag);
+		});
 	}
 
+	storeFilterBuildState(result, liveBlocks, liveSize, prevTag);
+	applyCriteria(result);
+
 	if (m_loadProgressCallback)
 		m_loadProgressCallback(m_loadProgressCustomData, 100.0f, "Done!");
 }
 
+//--------------------------------------------------------------------------
+/// Captures current criteria, operation range and candidate operations
+//--------------------------------------------------------------------------
+void Capture::beginFilteredData(FilterResult& _result)
+{
+	_result.m_criteria = m_pendingCriteria;
+	_result.m_workers.clear();
+
+	// query entered since last pass is bound by prepare, every pass works on its own copy
+	_result.m_query.reset();
+	_result.m_querySource	= m_pendingQuery;
+	_result.m_symResolver	= m_pendingQueryResolver;
+	if (m_pendingQuery)
+	{
+		_result.m_query				= std::make_shared<OpQuery>(*m_pendingQuery);
+		_result.m_criteria.m_query	= _result.m_query;
+	}
+
+	const FilterCriteria& criteria = _result.m_criteria;
+
+	uint32_t minTimedIdx;
+	uint32_t maxTimedIdx;
+	const uint32_t minTimeOpIndex = getIndexBefore(criteria.m_minTimeSnapshot,minTimedIdx);
+	uint32_t maxTimeOpIndex = getIndexBefore(criteria.m_maxTimeSnapshot,maxTimedIdx) + 1;
+
+	if (maxTimeOpIndex >= m_operations.size())
+	{
+		maxTimeOpIndex = (uint32_t) m_operations.size() - 1;
+	}
+
+	// if only the end of time range has moved forward, continue from where the last pass stopped
+	_result.m_extending	= canExtendFilteredData(criteria);
+	_result.m_minIndex	= _result.m_extending ? m_filterBuildState.m_nextOpIndex : minTimeOpIndex;
+	_result.m_maxIndex	= maxTimeOpIndex;
+
+	// split the range on chunk boundaries, whole chunks built by an earlier pass from the same start are reused
+	const bool useCache = m_filterChunks.m_valid && sameChunkCriteria(m_filterChunks.m_criteria, criteria);
+	uint32_t first = _result.m_minIndex;
+	while (!m_operations.empty() && (first <= _result.m_maxIndex))
+	{
+		const uint32_t chunk	= first / FILTER_CHUNK_OPS;
+		const uint32_t last		= qMin((chunk + 1) * FILTER_CHUNK_OPS - 1, _result.m_maxIndex);
+
+		std::shared_ptr<FilterWorker> worker;
+		if (useCache && isWholeChunk(first, last, criteria))
+		{
+			FilterChunkCache::ChunkMap::const_iterator it = m_filterChunks.m_chunks.find(chunk);
+			if (it != m_filterChunks.m_chunks.end())
+				worker = it->second;
+		}
+
+		if (!worker)
+		{
+			worker = std::make_shared<FilterWorker>();
+			worker->m_minIndex		= first;
+			worker->m_maxIndex		= last;
+			worker->m_liveBlocks	= 0;
+			worker->m_liveSize		= 0;
+			worker->m_cached		= false;
+		}
+
+		_result.m_workers.push_back(worker);
+		first = last + 1;
+	}
+
+	// collect bitmaps of active criteria, time range and module are checked per candidate
+	const OpBitmap* bitmaps[6];
+	uint32_t numBitmaps = 0;
+	bool noCandidates = false;
+
+	if (criteria.m_threadID != 0)
+	{
+		OperationIndex::BitmapMap::const_iterator bit = m_operationIndex.m_threads.find(criteria.m_threadID);
+		if (bit != m_operationIndex.m_threads.end())
+			bitmaps[numBitmaps++] = &bit->second;
+		else
+			noCandidates = true;
+	}
+
+	if (criteria.m_heap != (uint64_t)-1)
+	{
+		OperationIndex::BitmapMap::const_iterator bit = m_operationIndex.m_heaps.find(criteria.m_heap);
+		if (bit != m_operationIndex.m_heaps.end())
+			bitmaps[numBitmaps++] = &bit->second;
+		else
+			noCandidates = true;
+	}
+
+	if (criteria.m_tagHash != 0)
+	{
+		OperationIndex::BitmapMap::const_iterator bit = m_operationIndex.m_tags.find(criteria.m_tagHash);
+		if (bit != m_operationIndex.m_tags.end())
+			bitmaps[numBitmaps++] = &bit->second;
+		else
+			noCandidates = true;
+	}
+
+	if (criteria.m_histogramIndex != (uint32_t)-1)
+	{
+		if (criteria.m_histogramIndex < MemoryStats::NUM_HISTOGRAM_BINS)
+			bitmaps[numBitmaps++] = &m_operationIndex.m_histogramBins[criteria.m_histogramIndex];
+		else
+			noCandidates = true;
+	}
+
+	if (criteria.m_leakedOnly)
+		bitmaps[numBitmaps++] = &m_operationIndex.m_leaked;
+
+	// matches of a new query are intersected by prepare once it is evaluated
+	if (criteria.m_query && !_result.m_query)
+		bitmaps[numBitmaps++] = &criteria.m_query->getMatches();
+
+	_result.m_noCandidates	= noCandidates;
+	_result.m_useCandidates	= numBitmaps && !noCandidates;
+	_result.m_candidates.clear();
+
+	if (!_result.m_useCandidates)
+		return;
+
+	// intersect starting from the most selective bitmap
+	std::sort(&bitmaps[0], &bitmaps[numBitmaps], [](const OpBitmap* _b1, const OpBitmap* _b2)
+	{
+		return _b1->getCardinality() < _b2->getCardinality();
+	});
+
+	if (numBitmaps == 1)
+	{
+		_result.m_candidates = *bitmaps[0];
+		return;
+	}
+
+	OpBitmap intersections[2];
+	const OpBitmap* candidates = bitmaps[0];
+	for (uint32_t b=1; b<numBitmaps; ++b)
+	{
+		OpBitmap& out = (b == numBitmaps - 1) ? _result.m_candidates : intersections[b & 1];
+		OpBitmap::intersect(*candidates, *bitmaps[b], out);
+		candidates = &out;
+	}
+}
+
+//--------------------------------------------------------------------------
+/// Binds and evaluates query entered since last pass and narrows candidates
+/// to its matches. Returns false if *_version stops matching _expectedVersion.
+//--------------------------------------------------------------------------
+bool Capture::prepareQuery(FilterResult& _result, const std::atomic<uint32_t>* _version, uint32_t _expectedVersion) const
+{
+	if (!_result.m_query)
+		return true;
+
+	// symbol index resolves names under its own lock through the resolver mutex, safe from any thread
+	Capture* capture = const_cast<Capture*>(this);
+	if (!_result.m_query->bind(m_CPUFrequency, capture->m_symbolIndex, capture, _result.m_symResolver, _version, _expectedVersion))
+		return false;
+
+	_result.m_query->evaluate(m_operations);
+
+	const OpBitmap& matches = _result.m_query->getMatches();
+	if (_result.m_useCandidates)
+	{
+		OpBitmap candidates;
+		OpBitmap::intersect(_result.m_candidates, matches, candidates);
+		_result.m_candidates = candidates;
+	}
+	else
+	if (!_result.m_noCandidates)
+	{
+		_result.m_candidates	= matches;
+		_result.m_useCandidates	= true;
+	}
+
+	_result.m_query.reset();
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/// Installs criteria of the applied pass together with its filtered data,
+/// query bound by the pass becomes part of the selection as well
+//--------------------------------------------------------------------------
+void Capture::applyCriteria(const FilterResult& _result)
+{
+	m_criteria = _result.m_criteria;
+
+	if (!_result.m_querySource)
+		return;
+
+	m_pendingCriteria.m_query = _result.m_criteria.m_query;
+	if (m_pendingQuery == _result.m_querySource)
+		m_pendingQuery.reset();
+}
+
+//--------------------------------------------------------------------------
+/// Returns true if filtered data can be updated by appending operations
+//--------------------------------------------------------------------------
+bool Capture::canExtendFilteredData(const FilterCriteria& _criteria) const
+{
+	// Peak values and group/tree live counters depend on the start of the
+	// range so only growing the end can append to current filtered data.
+	// Shrinking the end merges cached chunks instead.
+	const FilterBuildState& state = m_filterBuildState;
+	return	state.m_valid &&
+			sameCriteriaExceptTime(state.m_criteria, _criteria) &&
+			(state.m_criteria.m_minTimeSnapshot	== _criteria.m_minTimeSnapshot) &&
+			(state.m_criteria.m_maxTimeSnapshot	<= _criteria.m_maxTimeSnapshot);
+}
+
+//--------------------------------------------------------------------------
+/// Returns true if index range is a whole chunk with all operations inside time range
+//--------------------------------------------------------------------------
+bool Capture::isWholeChunk(uint32_t _minIndex, uint32_t _maxIndex, const FilterCriteria& _criteria) const
+{
+	return	((_minIndex % FILTER_CHUNK_OPS) == 0) &&
+			(_maxIndex - _minIndex + 1 == FILTER_CHUNK_OPS) &&
+			(m_operations[_minIndex]->m_operationTime >= _criteria.m_minTimeSnapshot) &&
+			(m_operations[_maxIndex]->m_operationTime <= _criteria.m_maxTimeSnapshot);
+}
+
+//--------------------------------------------------------------------------
+/// Keeps whole chunks of applied result for the next filtering pass
+//--------------------------------------------------------------------------
+void Capture::storeFilterChunks(const FilterResult& _result)
+{
+	if (!m_filterChunks.m_valid || !sameChunkCriteria(m_filterChunks.m_criteria, _result.m_criteria))
+	{
+		m_filterChunks.m_chunks.clear();
+		m_filterChunks.m_criteria	= _result.m_criteria;
+		m_filterChunks.m_valid		= true;
+	}
+
+	for (const std::shared_ptr<FilterWorker>& worker : _result.m_workers)
+	{
+		if (worker->m_cached || !isWholeChunk(worker->m_minIndex, worker->m_maxIndex, _result.m_criteria))
+			continue;
+
+		// path lookup is only needed while building
+		worker->m_pathOffsets.clear();
+		worker->m_paths.clear();
+		worker->m_cached = true;
+		m_filterChunks.m_chunks[worker->m_minIndex / FILTER_CHUNK_OPS] = worker;
+	}
+
+	if (m_filterChunks.m_chunks.size() <= MAX_FILTER_CHUNKS)
+		return;
+
+	// over the limit, drop chunks outside of current time range
+	FilterChunkCache::ChunkMap::iterator it = m_filterChunks.m_chunks.begin();
+	while (it != m_filterChunks.m_chunks.end())
+	{
+		if (isWholeChunk(it->second->m_minIndex, it->second->m_maxIndex, _result.m_criteria))
+			++it;
+		else
+			it = m_filterChunks.m_chunks.erase(it);
+	}
+}
+
+//--------------------------------------------------------------------------
+/// Clears filtered data and per stack trace filtered tree caches
+//--------------------------------------------------------------------------
+void Capture::resetFilteredData()
+{
+	QtConcurrent::blockingMap(m_stackTraces.begin(), m_stackTraces.end(), [](StackTrace* _st)
+	{
+		_st->m_addedToTree[StackTrace::Filtered] = 0;
+		memset(&_st->m_entries[_st->m_numEntries*3], 0xff, (size_t)_st->m_numEntries*sizeof(uint64_t));
+	});
+
+	m_filter.m_operations.clear();
+	m_filter.m_operationGroups.clear();
+
+	destroyStackTree(m_filter.m_stackTraceTree);
+
+	m_filterBuildState.m_liveBlocks	= 0;
+	m_filterBuildState.m_liveSize	= 0;
+	m_filterBuildState.m_prevTag	= NULL;
+}
+
+//--------------------------------------------------------------------------
+/// Remembers criteria and running totals so the next pass can continue
+//--------------------------------------------------------------------------
+void Capture::storeFilterBuildState(const FilterResult& _result, uint64_t _liveBlocks, uint64_t _liveSize, MemoryTagTree* _prevTag)
+{
+	// operations past the end of time range were rejected and must be visited again if the range grows
+	uint32_t nextOpIndex = _result.m_maxIndex + 1;
+	while ((nextOpIndex > _result.m_minIndex) && (m_operations[nextOpIndex-1]->m_operationTime > _result.m_criteria.m_maxTimeSnapshot))
+		--nextOpIndex;
+
+	m_filterBuildState.m_valid			= true;
+	m_filterBuildState.m_criteria		= _result.m_criteria;
+	m_filterBuildState.m_nextOpIndex	= nextOpIndex;
+	m_filterBuildState.m_liveBlocks		= _liveBlocks;
+	m_filterBuildState.m_liveSize		= _liveSize;
+	m_filterBuildState.m_prevTag		= _prevTag;
+}
+
+//--------------------------------------------------------------------------
+/// Adds operation that passed the filter to filtered data
+//--------------------------------------------------------------------------
+void Capture::addToFilteredData(MemoryOperation* _op, const FilterCriteria* _criteria, uint64_t& _liveBlocks, uint64_t& _liveSize, MemoryTagTree*& _prevTag)
+{
+	m_filter.m_operations.push_back(_op);
+
+	updateLiveBlocks(_op, _liveBlocks);
+	updateLiveSize(_op, _liveSize);
+
+	// add to memory groups
+	addToMemoryGroups(m_filter.m_operationGroups, _op, _criteria, _liveBlocks, _liveSize);
+
+	// add to call stack tree
+	addToStackTraceTree(m_filter.m_stackTraceTree, _op, _criteria, StackTrace::Filtered);
+
+	// add to tag tree
+	tagAddOp(m_filter.m_tagTree, _op, _prevTag);
+}
+
 //--------------------------------------------------------------------------
 /// Returns the index of first operation before the given time
 //--------------------------------------------------------------------------
@@ -1874,8 +2565,8 @@ void Capture::calculateSnapshotStats()
 {
 	uint32_t minTimedIdx;
 	uint32_t maxTimedIdx;
-	uint32_t minTimeOpIndex = getIndexBefore(m_filter.m_minTimeSnapshot, minTimedIdx);
-	uint32_t maxTimeOpIndex = getIndexAfter(m_filter.m_maxTimeSnapshot, maxTimedIdx);
+	uint32_t minTimeOpIndex = getIndexBefore(m_pendingCriteria.m_minTimeSnapshot, minTimedIdx);
+	uint32_t maxTimeOpIndex = getIndexAfter(m_pendingCriteria.m_maxTimeSnapshot, maxTimedIdx);
 	
 	if (minTimeOpIndex != 0)
 		minTimeOpIndex++;
@@ -1988,6 +2679,28 @@ void Capture::GetRangedStats(MemoryStats& _stats, uint32_t _minIdx, uint32_t _ma
 	}
 }
 
+//--------------------------------------------------------------------------
+/// Resolves stack frame, recently used frames are served from memory, then
+/// in process symbols go first, then symbol cache if one is set
+//--------------------------------------------------------------------------
+void Capture::getStackFrame(uintptr_t _symResolver, uint64_t _address, rdebug::StackFrame& _frame)
+{
+	if (m_frameCache.find(_address, _frame))
+		return;
+
+	if (!m_symbolizer || !m_symbolizer->getFrame(_address, _frame))
+	{
+		// resolvers are not thread safe (DIA for one), views and prefetching resolve concurrently
+		std::lock_guard<std::mutex> lock(m_resolverMutex);
+		if (m_symbolCache)
+			m_symbolCache->getFrame(_symResolver, _address, &_frame);
+		else
+			rdebug::symbolResolverGetFrame(_symResolver, _address, &_frame);
+	}
+
+	m_frameCache.insert(_address, _frame);
+}
+
 //--------------------------------------------------------------------------
 /// Registers memory tag with the loader
 //--------------------------------------------------------------------------
@@ -2003,7 +2716,7 @@ void Capture::addMemoryTag(char* _tagName, uint32_t _tagHash, uint32_t _parentTa
 //--------------------------------------------------------------------------
 /// Adds operation to memory groups
 //--------------------------------------------------------------------------
-void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation* _op, uint64_t _liveBlocks, uint64_t _liveSize)
+void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation* _op, const FilterCriteria* _criteria, uint64_t _liveBlocks, uint64_t _liveSize) const
 {
 	uintptr_t groupHash;
 
@@ -2031,11 +2744,11 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
 					group.m_peakSizeGlobal	= _liveSize;
 				}
 
-				uint32_t newPeakCount = qMax(group.m_liveCountPeak, group.m_liveCount);
-				if (newPeakCount > group.m_liveCountPeak)
+				// signed compare, live count can be negative in partial groups built by filtering workers
+				if ((int32_t)group.m_liveCount > (int32_t)group.m_liveCountPeak)
 				{
-					group.m_liveCountPeak		= newPeakCount;
-					group.m_liveCountPeakGlobal	= _liveBlocks;
+					group.m_liveCountPeak		= group.m_liveCount;
+					group.m_liveCountPeakGlobal	= (uint32_t)_liveBlocks;
 				}
 			}
 			break;
@@ -2043,7 +2756,7 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
 		case rmem::LogMarkers::OpFree:
 			{
 				MemoryOperation* prevOp = _op->m_chainPrev;
-				if (isInFilter(prevOp))
+				if (isOpInFilter(prevOp, _criteria))
 				{
 					groupHash = calcGroupHash(prevOp);
 
@@ -2072,7 +2785,7 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
 				MemoryOperation* prevOp = _op->m_chainPrev;
 				if (prevOp)
 				{
-					if (isInFilter(prevOp))
+					if (isOpInFilter(prevOp, _criteria))
 					{
 						groupHash = calcGroupHash(prevOp);
 
@@ -2101,11 +2814,10 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
 					group.m_peakSizeGlobal	= _liveSize;
 				}
 
-				uint32_t newPeakCount = qMax(group.m_liveCountPeak, group.m_liveCount);
-				if (newPeakCount > group.m_liveCountPeak)
+				if ((int32_t)group.m_liveCount > (int32_t)group.m_liveCountPeak)
 				{
-					group.m_liveCountPeak		= newPeakCount;
-					group.m_liveCountPeakGlobal = _liveBlocks;
+					group.m_liveCountPeak		= group.m_liveCount;
+					group.m_liveCountPeakGlobal = (uint32_t)_liveBlocks;
 				}
 
 			}
@@ -2113,20 +2825,25 @@ void Capture::addToMemoryGroups(MemoryGroupsHashType& _groups, MemoryOperation*
 	};
 }
 
+static inline void addToNode(StackTraceTree* _node, int64_t _size, int32_t _overhead, StackTraceTree::Enum _opType)
+{
+	_node->m_memUsage		+= _size;
+	_node->m_memUsagePeak	= qMax(_node->m_memUsage, _node->m_memUsagePeak);
+
+	_node->m_overhead		+= _overhead;
+	_node->m_overheadPeak	= qMax(_node->m_overhead, _node->m_overheadPeak);
+
+	if (_opType != StackTraceTree::Count)
+		++_node->m_opCount[_opType];
+}
+
 static void addToTree(StackTraceTree* _root, StackTrace* _trace, int64_t _size, int32_t _overhead, StackTrace::Scope _offset, StackTraceTree::Enum _opType)
 {
 	const int32_t numFrames = (int32_t)_trace->m_numEntries;
 	int32_t currFrame = numFrames;
 	StackTraceTree* currNode = _root;
 
-	currNode->m_memUsage	+= _size;
-	currNode->m_memUsagePeak = qMax(currNode->m_memUsage, currNode->m_memUsagePeak);
-
-	currNode->m_overhead	+= _overhead;
-	currNode->m_overheadPeak = qMax(currNode->m_overhead, currNode->m_overheadPeak);
-
-	if (_opType != StackTraceTree::Count)
-		++currNode->m_opCount[_opType];
+	addToNode(currNode, _size, _overhead, _opType);
 
 	// add stack trace to root node
 	_trace->m_next[0]		= _root->m_stackTraceList;
@@ -2181,18 +2898,15 @@ static void addToTree(StackTraceTree* _root, StackTrace* _trace, int64_t _size,
 			_trace->m_addedToTree[_offset] = depth;
 		}
 
-		currNode->m_memUsage		+= _size;
-		currNode->m_memUsagePeak	= qMax(currNode->m_memUsage, currNode->m_memUsagePeak);
-
-		currNode->m_overhead		+= _overhead;
-		currNode->m_overheadPeak	= qMax(currNode->m_overhead, currNode->m_overheadPeak);
-
-		if (_opType != StackTraceTree::Count)
-			++currNode->m_opCount[_opType];
+		addToNode(currNode, _size, _overhead, _opType);
 	}
 }
 
-void Capture::addToStackTraceTree(StackTraceTree& _tree, MemoryOperation* _op, StackTrace::Scope _offset)
+//--------------------------------------------------------------------------
+/// Calls _add for every stack trace tree update caused by the operation
+//--------------------------------------------------------------------------
+template <typename AddFn>
+void Capture::forEachTreeContribution(MemoryOperation* _op, const FilterCriteria* _criteria, AddFn _add) const
 {
 	switch (_op->m_operationType)
 	{
@@ -2200,7 +2914,7 @@ void Capture::addToStackTraceTree(StackTraceTree& _tree, MemoryOperation* _op, S
 		case rmem::LogMarkers::OpCalloc:
 		case rmem::LogMarkers::OpAllocAligned:
 			{
-				addToTree(&_tree, _op->m_stackTrace, _op->m_allocSize, _op->m_overhead, _offset, StackTraceTree::Alloc);
+				_add(_op->m_stackTrace, _op->m_allocSize, _op->m_overhead, StackTraceTree::Alloc);
 			}
 			break;
 
@@ -2209,11 +2923,11 @@ void Capture::addToStackTraceTree(StackTraceTree& _tree, MemoryOperation* _op, S
 				MemoryOperation* prevOp = _op->m_chainPrev;
 				RTM_ASSERT(prevOp != NULL, "");
 
-				if (isInFilter(prevOp))
-					addToTree(&_tree, prevOp->m_stackTrace, -(int64_t)prevOp->m_allocSize, -(int32_t)prevOp->m_overhead, _offset, StackTraceTree::Free);
+				if (isOpInFilter(prevOp, _criteria))
+					_add(prevOp->m_stackTrace, -(int64_t)prevOp->m_allocSize, -(int32_t)prevOp->m_overhead, StackTraceTree::Free);
 				else
 					// prev op not in filter, do not reduce used memory to avoid going (possibly) negative
-					addToTree(&_tree, prevOp->m_stackTrace, 0, 0, _offset, StackTraceTree::Free);
+					_add(prevOp->m_stackTrace, 0, 0, StackTraceTree::Free);
 			}
 			break;
 
@@ -2223,13 +2937,280 @@ void Capture::addToStackTraceTree(StackTraceTree& _tree, MemoryOperation* _op, S
 				MemoryOperation* prevOp = _op->m_chainPrev;
 				if (prevOp)
 				{
-					if (isInFilter(prevOp))
-						addToTree(&_tree, prevOp->m_stackTrace, -(int64_t)prevOp->m_allocSize, -(int32_t)prevOp->m_overhead, _offset, StackTraceTree::Count);
+					if (isOpInFilter(prevOp, _criteria))
+						_add(prevOp->m_stackTrace, -(int64_t)prevOp->m_allocSize, -(int32_t)prevOp->m_overhead, StackTraceTree::Count);
 				}
-				addToTree(&_tree, _op->m_stackTrace, _op->m_allocSize, _op->m_overhead, _offset, StackTraceTree::Realloc);
+				_add(_op->m_stackTrace, _op->m_allocSize, _op->m_overhead, StackTraceTree::Realloc);
 			}
 			break;
 	};
 }
 
+void Capture::addToStackTraceTree(StackTraceTree& _tree, MemoryOperation* _op, const FilterCriteria* _criteria, StackTrace::Scope _offset) const
+{
+	forEachTreeContribution(_op, _criteria, [&_tree, _offset](StackTrace* _trace, int64_t _size, int32_t _overhead, StackTraceTree::Enum _opType)
+	{
+		addToTree(&_tree, _trace, _size, _overhead, _offset, _opType);
+	});
+}
+
+//--------------------------------------------------------------------------
+/// Adds stack trace to worker tree, shared stack trace data is not modified
+//--------------------------------------------------------------------------
+static void addToPartialTree(FilterWorker& _worker, StackTrace* _trace, int64_t _size, int32_t _overhead, StackTraceTree::Enum _opType)
+{
+	const int32_t numFrames = (int32_t)_trace->m_numEntries;
+	StackTraceTree* currNode = &_worker.m_tree;
+
+	addToNode(currNode, _size, _overhead, _opType);
+
+	FilterWorker::PathMap::iterator it = _worker.m_pathOffsets.find(_trace);
+	if (it != _worker.m_pathOffsets.end())
+	{
+		const uint32_t pathOffset = it->second;
+		for (int32_t i=0; i<numFrames; ++i)
+		{
+			currNode = &currNode->m_children[_worker.m_paths[pathOffset + i]];
+			addToNode(currNode, _size, _overhead, _opType);
+		}
+		return;
+	}
+
+	_worker.m_pathOffsets[_trace] = (uint32_t)_worker.m_paths.size();
+	_worker.m_stackTraces.push_back(_trace);
+
+	int32_t currFrame = numFrames;
+	while (--currFrame >= 0)
+	{
+		const uint64_t currUniqueID = _trace->m_entries[currFrame+numFrames];
+
+		const size_t numChildren = currNode->m_children.size();
+		size_t found = numChildren;
+		for (size_t i=0; i<numChildren; i++)
+		{
+			if (currNode->m_children[i].m_addressID == currUniqueID)
+			{
+				found = i;
+				break;
+			}
+		}
+
+		if (found == numChildren)
+		{
+			StackTraceTree newNode;
+			newNode.m_addressID	= currUniqueID;
+			newNode.m_depth		= numFrames-currFrame;
+			currNode->m_children.emplace_back(newNode);
+		}
+
+		_worker.m_paths.push_back((uint32_t)found);
+		currNode = &currNode->m_children[found];
+
+		addToNode(currNode, _size, _overhead, _opType);
+	}
+}
+
+//--------------------------------------------------------------------------
+/// Appends tree built from later operations, peaks of _src are relative to its start
+//--------------------------------------------------------------------------
+static void mergeStackTree(StackTraceTree& _dst, const StackTraceTree& _src)
+{
+	_dst.m_memUsagePeak	= qMax(_dst.m_memUsagePeak, _dst.m_memUsage + _src.m_memUsagePeak);
+	_dst.m_memUsage		+= _src.m_memUsage;
+
+	_dst.m_overheadPeak	= qMax(_dst.m_overheadPeak, _dst.m_overhead + _src.m_overheadPeak);
+	_dst.m_overhead		+= _src.m_overhead;
+
+	for (int i=0; i<StackTraceTree::Count; ++i)
+		_dst.m_opCount[i] += _src.m_opCount[i];
+
+	if (_src.m_children.empty())
+		return;
+
+	rtm_unordered_map<uint64_t, size_t> dstChildren;
+	const size_t numDstChildren = _dst.m_children.size();
+	for (size_t i=0; i<numDstChildren; ++i)
+		dstChildren[_dst.m_children[i].m_addressID] = i;
+
+	// source can be a cached chunk so it is copied rather than moved
+	for (const StackTraceTree& srcChild : _src.m_children)
+	{
+		rtm_unordered_map<uint64_t, size_t>::iterator it = dstChildren.find(srcChild.m_addressID);
+		if (it == dstChildren.end())
+			_dst.m_children.push_back(srcChild);
+		else
+			mergeStackTree(_dst.m_children[it->second], srcChild);
+	}
+}
+
+static void setStackTreeParents(StackTraceTree& _tree)
+{
+	for (StackTraceTree& child : _tree.m_children)
+	{
+		child.m_parent = &_tree;
+		setStackTreeParents(child);
+	}
+}
+
+//--------------------------------------------------------------------------
+/// Appends group built from later operations, peaks of _src are relative to its start
+//--------------------------------------------------------------------------
+static void mergeMemoryGroup(MemoryOperationGroup& _dst, const MemoryOperationGroup& _src, uint64_t _liveBlocksBase, uint64_t _liveSizeBase)
+{
+	const int64_t peakSize = _dst.m_liveSize + _src.m_peakSize;
+	if (peakSize > _dst.m_peakSize)
+	{
+		_dst.m_peakSize			= peakSize;
+		_dst.m_peakSizeGlobal	= (int64_t)((uint64_t)_src.m_peakSizeGlobal + _liveSizeBase);
+	}
+
+	const int32_t peakCount = (int32_t)_dst.m_liveCount + (int32_t)_src.m_liveCountPeak;
+	if (peakCount > (int32_t)_dst.m_liveCountPeak)
+	{
+		_dst.m_liveCountPeak		= (uint32_t)peakCount;
+		_dst.m_liveCountPeakGlobal	= _src.m_liveCountPeakGlobal + (uint32_t)_liveBlocksBase;
+	}
+
+	_dst.m_liveSize		+= _src.m_liveSize;
+	_dst.m_liveCount	+= _src.m_liveCount;
+	_dst.m_count		+= _src.m_count;
+	_dst.m_minSize		= qMin(_dst.m_minSize, _src.m_minSize);
+	_dst.m_maxSize		= qMax(_dst.m_maxSize, _src.m_maxSize);
+	_dst.m_operations.insert(_dst.m_operations.end(), _src.m_operations.begin(), _src.m_operations.end());
+}
+
+//--------------------------------------------------------------------------
+/// Builds filtered data by splitting the operation range between threads,
+/// only reads shared capture data so it is safe to run in background
+//--------------------------------------------------------------------------
+bool Capture::prepareFilteredData(FilterResult& _result, const std::atomic<uint32_t>* _version, uint32_t _expectedVersion) const
+{
+	if (!prepareQuery(_result, _version, _expectedVersion))
+	{
+		_result.m_workers.clear();
+		return false;
+	}
+
+	if (_result.m_noCandidates)
+	{
+		_result.m_workers.clear();
+		return true;
+	}
+
+	rtm_vector<FilterWorker*> workers;
+	for (const std::shared_ptr<FilterWorker>& worker : _result.m_workers)
+		if (!worker->m_cached)
+			workers.push_back(worker.get());
+
+	std::atomic<bool> cancelled(false);
+	const FilterCriteria* criteria = &_result.m_criteria;
+	const OpBitmap* candidates = _result.m_useCandidates ? &_result.m_candidates : NULL;
+
+	auto buildWorker = [this, criteria, candidates, _version, _expectedVersion, &cancelled](FilterWorker* _worker)
+	{
+		// a newer request stops the work at the next chunk
+		if (cancelled.load(std::memory_order_relaxed))
+			return;
+
+		if (_version && (_version->load(std::memory_order_relaxed) != _expectedVersion))
+		{
+			cancelled.store(true, std::memory_order_relaxed);
+			return;
+		}
+
+		auto addOp = [this, criteria, _worker](uint32_t _index)
+		{
+			MemoryOperation* op = m_operations[_index];
+			if (!isOpInFilter(op, criteria))
+				return;
+
+			_worker->m_operations.push_back(op);
+
+			updateLiveBlocks(op, _worker->m_liveBlocks);
+			updateLiveSize(op, _worker->m_liveSize);
+
+			addToMemoryGroups(_worker->m_groups, op, criteria, _worker->m_liveBlocks, _worker->m_liveSize);
+
+			forEachTreeContribution(op, criteria, [_worker](StackTrace* _trace, int64_t _size, int32_t _overhead, StackTraceTree::Enum _opType)
+			{
+				addToPartialTree(*_worker, _trace, _size, _overhead, _opType);
+			});
+		};
+
+		if (candidates)
+			candidates->forEachInRange(_worker->m_minIndex, _worker->m_maxIndex, addOp);
+		else
+			for (uint32_t i=_worker->m_minIndex; i<=_worker->m_maxIndex; ++i)
+				addOp(i);
+	};
+
+	const uint32_t numOps			= (_result.m_minIndex <= _result.m_maxIndex) ? _result.m_maxIndex - _result.m_minIndex + 1 : 0;
+	const uint32_t numCandidates	= _result.m_useCandidates ? _result.m_candidates.getCardinality() : numOps;
+
+	if ((workers.size() > 1) && (numCandidates >= PARALLEL_FILTER_MIN_OPS))
+		QtConcurrent::blockingMap(workers.begin(), workers.end(), buildWorker);
+	else
+		for (FilterWorker* worker : workers)
+			buildWorker(worker);
+
+	if (cancelled.load())
+	{
+		_result.m_workers.clear();
+		return false;
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/// Replaces (or extends) filtered data with prepared result
+//--------------------------------------------------------------------------
+void Capture::applyFilteredData(FilterResult& _result)
+{
+	if (!_result.m_extending)
+		resetFilteredData();
+
+	MemoryTagTree* prevTag	= m_filterBuildState.m_prevTag;
+	uint64_t liveBlocksBase	= m_filterBuildState.m_liveBlocks;
+	uint64_t liveSizeBase	= m_filterBuildState.m_liveSize;
+
+	// reduce in time order so peaks and global live values can be rebased
+	const size_t firstNewOp = m_filter.m_operations.size();
+	size_t numFilteredOps = firstNewOp;
+	for (const std::shared_ptr<FilterWorker>& worker : _result.m_workers)
+		numFilteredOps += worker->m_operations.size();
+	m_filter.m_operations.reserve(numFilteredOps);
+
+	for (const std::shared_ptr<FilterWorker>& worker : _result.m_workers)
+	{
+		m_filter.m_operations.insert(m_filter.m_operations.end(), worker->m_operations.begin(), worker->m_operations.end());
+
+		for (const MemoryGroupsHashType::value_type& group : worker->m_groups)
+			mergeMemoryGroup(m_filter.m_operationGroups[group.first], group.second, liveBlocksBase, liveSizeBase);
+
+		mergeStackTree(m_filter.m_stackTraceTree, worker->m_tree);
+
+		liveBlocksBase	+= worker->m_liveBlocks;
+		liveSizeBase	+= worker->m_liveSize;
+	}
+
+	setStackTreeParents(m_filter.m_stackTraceTree);
+
+	// link stack traces to tree nodes in order of first use, same as serial build
+	for (const std::shared_ptr<FilterWorker>& worker : _result.m_workers)
+		for (StackTrace* trace : worker->m_stackTraces)
+			if (trace->m_addedToTree[StackTrace::Filtered] == 0)
+				addToTree(&m_filter.m_stackTraceTree, trace, 0, 0, StackTrace::Filtered, StackTraceTree::Count);
+
+	const size_t numOps = m_filter.m_operations.size();
+	for (size_t i=firstNewOp; i<numOps; ++i)
+		tagAddOp(m_filter.m_tagTree, m_filter.m_operations[i], prevTag);
+
+	storeFilterBuildState(_result, liveBlocksBase, liveSizeBase, prevTag);
+	storeFilterChunks(_result);
+	applyCriteria(_result);
+
+	_result.m_workers.clear();
+}
+
 } // namespace rtm
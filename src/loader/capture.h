@@ -8,6 +8,16 @@
 
 #include <rdebug/inc/rdebug.h>
 #include <rbase/inc/cpu.h>
+#include <MTuner/src/loader/opbitmap.h>
+#include <MTuner/src/loader/opquery.h>
+#include <MTuner/src/loader/symbolcache.h>
+#include <MTuner/src/loader/gnusymbolizer.h>
+#include <MTuner/src/loader/framecache.h>
+#include <MTuner/src/loader/usagetimeline.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace rtm {
 
@@ -29,21 +39,116 @@ struct GraphEntry
 	uint64_t	m_numLiveBlocks;
 };
 
+//--------------------------------------------------------------------------
+/// Bitmaps of operation indices for each filtering criteria
+//--------------------------------------------------------------------------
+struct OperationIndex
+{
+	typedef rtm_unordered_map<uint64_t, OpBitmap>	BitmapMap;
+
+	BitmapMap		m_threads;
+	BitmapMap		m_heaps;
+	BitmapMap		m_tags;
+	OpBitmap		m_histogramBins[MemoryStats::NUM_HISTOGRAM_BINS];
+	OpBitmap		m_leaked;
+
+	void clear();
+	void addOp(MemoryOperation* _op, uint32_t _index);
+};
+
+//--------------------------------------------------------------------------
+/// Memory operation filtering criteria
+//--------------------------------------------------------------------------
+struct FilterCriteria
+{
+	uint32_t				m_histogramIndex;
+	uint32_t				m_tagHash;
+	uint64_t				m_threadID;
+	uint64_t				m_heap;
+	rdebug::ModuleInfo*		m_module;
+	uint32_t				m_moduleIndex;		///< Bit index in StackTrace::m_moduleMask
+	uint64_t				m_minTimeSnapshot;
+	uint64_t				m_maxTimeSnapshot;
+	bool					m_leakedOnly;
+	std::shared_ptr<const OpQuery> m_query;	///< Shared with background filtering jobs, never modified once set
+};
+
 //--------------------------------------------------------------------------
 /// Memory operation filter description
 //--------------------------------------------------------------------------
 struct FilterDescription
 {
-	uint32_t						m_histogramIndex;
-	uint32_t						m_tagHash;
-	uint64_t						m_threadID;
-	uint64_t						m_minTimeSnapshot;
-	uint64_t						m_maxTimeSnapshot;
 	MemoryTagTree					m_tagTree;
 	rtm_vector<MemoryOperation*>	m_operations;
 	MemoryGroupsHashType			m_operationGroups;
 	StackTraceTree					m_stackTraceTree;
-	bool							m_leakedOnly;
+};
+
+//--------------------------------------------------------------------------
+/// Criteria and running totals of the last filtered data calculation
+//--------------------------------------------------------------------------
+struct FilterBuildState
+{
+	bool					m_valid;
+	FilterCriteria			m_criteria;
+	uint32_t				m_nextOpIndex;		///< First operation not yet visited
+	uint64_t				m_liveBlocks;
+	uint64_t				m_liveSize;
+	MemoryTagTree*			m_prevTag;
+};
+
+//--------------------------------------------------------------------------
+/// Private filtered data of a single worker thread
+//--------------------------------------------------------------------------
+struct FilterWorker
+{
+	typedef rtm_unordered_map<StackTrace*, uint32_t> PathMap;
+
+	uint32_t						m_minIndex;
+	uint32_t						m_maxIndex;
+	rtm_vector<MemoryOperation*>	m_operations;
+	MemoryGroupsHashType			m_groups;
+	StackTraceTree					m_tree;
+	PathMap							m_pathOffsets;		///< Offset of stack trace path in m_paths
+	rtm_vector<uint32_t>			m_paths;			///< Child indices from root to leaf for each stack trace
+	rtm_vector<StackTrace*>			m_stackTraces;		///< Stack traces in order of first use
+	uint64_t						m_liveBlocks;		///< Relative to start of worker range
+	uint64_t						m_liveSize;			///< Relative to start of worker range
+	bool							m_cached;			///< Taken from chunk cache, already built
+};
+
+//--------------------------------------------------------------------------
+/// Filtered data of whole operation chunks kept between passes so moving the
+/// end of time range only builds the chunks at the edge. Frees of blocks
+/// allocated before the range and live size peaks depend on the start of the
+/// range, so a chunk is reused only while the start stays the same.
+//--------------------------------------------------------------------------
+struct FilterChunkCache
+{
+	typedef rtm_unordered_map<uint32_t, std::shared_ptr<FilterWorker> > ChunkMap;
+
+	bool					m_valid;
+	FilterCriteria			m_criteria;			///< End of time range is not part of the key
+	ChunkMap				m_chunks;			///< Keyed by chunk index
+};
+
+//--------------------------------------------------------------------------
+/// Filtered data prepared without touching shared capture state so it can
+/// be built on a background thread and applied later in one step
+//--------------------------------------------------------------------------
+struct FilterResult
+{
+	FilterCriteria				m_criteria;
+	bool						m_extending;		///< Appended to current filtered data instead of replacing it
+	bool						m_noCandidates;		///< One of the criteria matches no operation
+	bool						m_useCandidates;
+	OpBitmap					m_candidates;		///< Intersection of criteria bitmaps, valid if m_useCandidates
+	uint32_t					m_minIndex;
+	uint32_t					m_maxIndex;
+	rtm_vector<std::shared_ptr<FilterWorker> > m_workers;	///< One per chunk, in operation order
+	std::shared_ptr<OpQuery>	m_query;			///< Copy of query entered since last pass, bound and evaluated by prepare
+	std::shared_ptr<const OpQuery> m_querySource;	///< Pending query m_query was copied from
+	uintptr_t					m_symResolver;		///< Used to resolve stack patterns of m_query
 };
 
 //--------------------------------------------------------------------------
@@ -74,12 +179,14 @@ class Capture
 
 		MemoryGroupsHashType			m_operationGroups;
 		rtm_vector<GraphEntry>			m_usageGraph;			///< memory usage graph data
+		UsageTimeline					m_threadTimeline;		///< usage graph data per allocating thread
+		UsageTimeline					m_heapTimeline;			///< usage graph data per allocator handle
+		UsageTimeline					m_tagTimeline;			///< usage graph data per memory tag
 		StackTraceTree					m_stackTraceTree;		///< stack trace tree
 		MemoryTagTree					m_tagTree;		///< Global tag tree
 		MemoryMarkersHashType			m_memoryMarkers;
 		HeapsType						m_Heaps;
-		uint64_t						m_currentHeap;
-		rdebug::ModuleInfo*				m_currentModule;
+		uint32_t						m_moduleMaskWords;		///< Size of StackTrace::m_moduleMask in 64bit words
 		rtm_vector<MemoryMarkerTime>	m_memoryMarkerTimes;
 		uint64_t						m_CPUFrequency;
 		rtm_vector<MemoryOperation*>	m_memoryLeaks;			/// List of allocations without matching free
@@ -90,7 +197,20 @@ class Capture
 		uint64_t						m_maxTime;
 
 		bool							m_filteringEnabled;
+		FilterCriteria					m_criteria;				///< Criteria of installed filtered data
+		FilterCriteria					m_pendingCriteria;		///< Latest selection, installed with the next filtered data
 		FilterDescription				m_filter;
+		OperationIndex					m_operationIndex;
+		SymbolIndex						m_symbolIndex;
+		SymbolCache*					m_symbolCache;			///< Optional, owned by the capture context
+		GNUSymbolizer*					m_symbolizer;			///< Optional, owned by the capture context
+		std::mutex						m_resolverMutex;		///< Symbol resolver and cache are used from several threads
+		FrameCache						m_frameCache;			///< Resolved frames shared by views and logs
+		bool							m_lazySymbols;			///< Symbol IDs are addresses, names are resolved on demand
+		FilterBuildState				m_filterBuildState;
+		FilterChunkCache				m_filterChunks;
+		std::shared_ptr<const OpQuery>	m_pendingQuery;			///< Compiled, becomes part of criteria once a filtering pass binds it
+		uintptr_t						m_pendingQueryResolver;
 
 	public:
 
@@ -109,6 +229,14 @@ class Capture
 		void clearData();
 		bool is64bit() { return m_64bit; }
 		void buildAnalyzeData(uintptr_t _symResolver);
+		void setSymbolCache(SymbolCache* _cache) { m_symbolCache = _cache; }
+		void setSymbolizer(GNUSymbolizer* _symbolizer) { m_symbolizer = _symbolizer; }
+		void setLazySymbols(bool _lazy) { m_lazySymbols = _lazy; }
+		bool getLazySymbols() const { return m_lazySymbols; }
+
+		/// Resolves stack frame through frame cache, in process symbols, symbol cache and resolver, can be called from any thread
+		void getStackFrame(uintptr_t _symResolver, uint64_t _address, rdebug::StackFrame& _frame);
+		bool isStackFrameCached(uint64_t _address) { return m_frameCache.contains(_address); }
 
 		rtm_vector<rdebug::ModuleInfo>&	getModuleInfos() { return m_moduleInfos; }
 
@@ -118,20 +246,31 @@ class Capture
 		bool			saveGroupsLogXML(const char* _path, eGroupSort _sorting, uintptr_t _symResolver);
 
 		/// Capture file filtering functions
-		void			setFilteringEnabled(bool inState);
+		void			setFilteringEnabled(bool inState, bool _calculate = true);
 		bool			getFilteringEnabled() const { return m_filteringEnabled; }
 		bool			isInFilter(MemoryOperation* _op);
+		const FilterCriteria& getFilterCriteria() const { return m_criteria; }
 		void			selectHistogramBin(uint32_t _index);
-		uint32_t		getSelectHistogramBin() const { return m_filter.m_histogramIndex; }
+		uint32_t		getSelectHistogramBin() const { return m_pendingCriteria.m_histogramIndex; }
 		void			deselectHistogramBin();
 		void			selectTag(uint32_t _tagHash);
 		void			deselectTag();
 		void			selectThread(uint64_t _threadID);
 		void			deselectThread();
 		void			setLeakedOnly(bool _leaked);
+		/// Only compiles the query, it is bound and evaluated by the next filtering pass
+		bool			setQuery(const char* _query, uintptr_t _symResolver, rtm_string& _error);
+		const char*		getQuery() const;
 		void			setSnapshot(uint64_t _minTime, uint64_t _maxTime);
-		uint64_t		getSnapshotTimeMin() const { return m_filter.m_minTimeSnapshot; }
-		uint64_t		getSnapshotTimeMax() const { return m_filter.m_maxTimeSnapshot; }
+		uint64_t		getSnapshotTimeMin() const { return m_pendingCriteria.m_minTimeSnapshot; }
+		uint64_t		getSnapshotTimeMax() const { return m_pendingCriteria.m_maxTimeSnapshot; }
+
+		/// Asynchronous filtering, begin and apply must be called from the thread that
+		/// owns the capture while prepare can run on any thread in between them.
+		/// Prepare returns false if *_version stops matching _expectedVersion.
+		void			beginFilteredData(FilterResult& _result);
+		bool			prepareFilteredData(FilterResult& _result, const std::atomic<uint32_t>* _version = NULL, uint32_t _expectedVersion = 0) const;
+		void			applyFilteredData(FilterResult& _result);
 		
 		uint64_t							getMinTime() const { return m_minTime; }
 		uint64_t							getMaxTime() const { return m_maxTime; }
@@ -140,6 +279,10 @@ class Capture
 		const MemoryStats&					getGlobalStats() const { return m_statsGlobal; }
 		const MemoryStats&					getSnapshotStats() const { return m_statsSnapshot; }
 		void								getGraphAtTime(uint64_t _time, GraphEntry& _entry);
+		void								getHistogramSlices(uint64_t _minTime, uint64_t _maxTime, uint32_t _count, HistogramBin* _bins);
+		const UsageTimeline&				getThreadTimeline() const { return m_threadTimeline; }
+		const UsageTimeline&				getHeapTimeline() const { return m_heapTimeline; }
+		const UsageTimeline&				getTagTimeline() const { return m_tagTimeline; }
 		const rtm_vector<MemoryMarkerTime>& getMemoryMarkers() const { return m_memoryMarkerTimes; }
 		const MemoryTagTree&				getTagTree() const { return m_tagTree; }
 		const StackTraceTree&				getStackTraceTree() const { return m_stackTraceTree; }
@@ -151,23 +294,34 @@ class Capture
 		const MemoryGroupsHashType&			getMemoryGroupsFiltered() const { return m_filter.m_operationGroups; }
 		rmem::ToolChain::Enum				getToolchain() { return m_toolchain; }
 		HeapsType&							getHeaps() { return m_Heaps; }
-		void								setCurrentHeap(uint64_t _handle) { m_currentHeap = _handle; }
-		void								setCurrentModule(rdebug::ModuleInfo* _module) { m_currentModule = _module; }
+		void								setCurrentHeap(uint64_t _handle) { m_pendingCriteria.m_heap = _handle; }
+		void								setCurrentModule(rdebug::ModuleInfo* _module);
 
 	private:
 		bool		loadModuleInfo(BinLoader& _loader, uint64_t inFileSize);
 		bool		setLinksAndRemoveInvalid(uint64_t inMinMarkerTime);
 		void		addModule(const char* inName, uint64_t inModBase, uint64_t inModSize);
+		void		buildModuleMasks();
 		void		calculateGlobalStats();
 		void		calculateSnapshotStats();
 		bool		verifyGlobalStats();
 		void		calculateFilteredData();
+		bool		canExtendFilteredData(const FilterCriteria& _criteria) const;
+		bool		isWholeChunk(uint32_t _minIndex, uint32_t _maxIndex, const FilterCriteria& _criteria) const;
+		void		storeFilterChunks(const FilterResult& _result);
+		bool		prepareQuery(FilterResult& _result, const std::atomic<uint32_t>* _version, uint32_t _expectedVersion) const;
+		void		applyCriteria(const FilterResult& _result);
+		void		resetFilteredData();
+		void		storeFilterBuildState(const FilterResult& _result, uint64_t _liveBlocks, uint64_t _liveSize, MemoryTagTree* _prevTag);
+		void		addToFilteredData(MemoryOperation* _op, const FilterCriteria* _criteria, uint64_t& _liveBlocks, uint64_t& _liveSize, MemoryTagTree*& _prevTag);
 		uint32_t	getIndexBefore(uint64_t _time, uint32_t& outTimedIndex) const;
 		uint32_t	getIndexAfter(uint64_t _time, uint32_t& outTimedIndex) const;
 		void		GetRangedStats(MemoryStats& ioStats, uint32_t inMinIdx, uint32_t inMaxIdx);
 		void		addMemoryTag(char* inTagName, uint32_t _tagHash, uint32_t _parentTagHash);
-		void		addToMemoryGroups(MemoryGroupsHashType& ioGroups, MemoryOperation* _op, uint64_t _liveBlocks, uint64_t _liveSize);
-		void		addToStackTraceTree(StackTraceTree& ioTree, MemoryOperation* _op, StackTrace::Scope _offset);
+		void		addToMemoryGroups(MemoryGroupsHashType& ioGroups, MemoryOperation* _op, const FilterCriteria* _criteria, uint64_t _liveBlocks, uint64_t _liveSize) const;
+		void		addToStackTraceTree(StackTraceTree& ioTree, MemoryOperation* _op, const FilterCriteria* _criteria, StackTrace::Scope _offset) const;
+		template <typename AddFn>
+		void		forEachTreeContribution(MemoryOperation* _op, const FilterCriteria* _criteria, AddFn _add) const;
 		void		writeGlobalStats(FILE* inFile);
 };
 
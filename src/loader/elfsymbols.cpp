@@ -0,0 +1,1204 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/elfsymbols.h>
+
+#include <algorithm>
+
+namespace rtm {
+
+/// Upper limit used to reject corrupted binaries
+static const uint32_t MAX_SPECIFICATION_DEPTH = 8;
+
+struct ELFSection
+{
+	enum Enum
+	{
+		SymTab			= 2,
+		NoBits			= 8,
+		DynSym			= 11,
+
+		Compressed		= 0x800,				///< SHF_COMPRESSED
+		CompressZLIB	= 1
+	};
+};
+
+struct ELFSymbol
+{
+	enum Enum
+	{
+		Func			= 2,
+		GNUIFunc		= 10
+	};
+};
+
+struct DwarfTag
+{
+	enum Enum
+	{
+		CompileUnit		= 0x11,
+		Subprogram		= 0x2e,
+		SkeletonUnit	= 0x4a
+	};
+};
+
+struct DwarfAttr
+{
+	enum Enum
+	{
+		Name				= 0x03,
+		StmtList			= 0x10,
+		LowPC				= 0x11,
+		HighPC				= 0x12,
+		CompDir				= 0x1b,
+		AbstractOrigin		= 0x31,
+		Specification		= 0x47,
+		LinkageName			= 0x6e,
+		StrOffsetsBase		= 0x72,
+		AddrBase			= 0x73,
+		MIPSLinkageName		= 0x2007
+	};
+};
+
+struct DwarfForm
+{
+	enum Enum
+	{
+		Addr			= 0x01,
+		Block2			= 0x03,
+		Block4			= 0x04,
+		Data2			= 0x05,
+		Data4			= 0x06,
+		Data8			= 0x07,
+		String			= 0x08,
+		Block			= 0x09,
+		Block1			= 0x0a,
+		Data1			= 0x0b,
+		Flag			= 0x0c,
+		SData			= 0x0d,
+		Strp			= 0x0e,
+		UData			= 0x0f,
+		RefAddr			= 0x10,
+		Ref1			= 0x11,
+		Ref2			= 0x12,
+		Ref4			= 0x13,
+		Ref8			= 0x14,
+		RefUData		= 0x15,
+		Indirect		= 0x16,
+		SecOffset		= 0x17,
+		ExprLoc			= 0x18,
+		FlagPresent		= 0x19,
+		Strx			= 0x1a,
+		Addrx			= 0x1b,
+		RefSup4			= 0x1c,
+		StrpSup			= 0x1d,
+		Data16			= 0x1e,
+		LineStrp		= 0x1f,
+		RefSig8			= 0x20,
+		ImplicitConst	= 0x21,
+		LocListx		= 0x22,
+		RngListx		= 0x23,
+		RefSup8			= 0x24,
+		Strx1			= 0x25,
+		Strx2			= 0x26,
+		Strx3			= 0x27,
+		Strx4			= 0x28,
+		Addrx1			= 0x29,
+		Addrx2			= 0x2a,
+		Addrx3			= 0x2b,
+		Addrx4			= 0x2c,
+		GNUAddrIndex	= 0x1f01,
+		GNUStrIndex		= 0x1f02,
+		GNURefAlt		= 0x1f20,
+		GNUStrpAlt		= 0x1f21
+	};
+};
+
+struct DwarfLine
+{
+	enum Enum
+	{
+		Copy				= 1,
+		AdvancePC			= 2,
+		AdvanceLine			= 3,
+		SetFile				= 4,
+		ConstAddPC			= 8,
+		FixedAdvancePC		= 9,
+
+		EndSequence			= 1,				///< Extended opcodes
+		SetAddress			= 2,
+		DefineFile			= 3,
+
+		ContentPath			= 1,				///< Version 5 entry formats
+		ContentDirIndex		= 2
+	};
+};
+
+//--------------------------------------------------------------------------
+/// Bounds checked little endian reader, reads past the end return zero
+//--------------------------------------------------------------------------
+struct DataReader
+{
+	const uint8_t*	m_ptr;
+	const uint8_t*	m_end;
+	uint32_t		m_offsetSize;
+	uint32_t		m_addressSize;
+
+	DataReader(const uint8_t* _ptr, const uint8_t* _end)
+		: m_ptr(_ptr)
+		, m_end(_end)
+		, m_offsetSize(4)
+		, m_addressSize(8)
+	{}
+
+	bool has(uint64_t _size) const
+	{
+		return (uint64_t)(m_end - m_ptr) >= _size;
+	}
+
+	void skip(uint64_t _size)
+	{
+		m_ptr = has(_size) ? m_ptr + _size : m_end;
+	}
+
+	uint64_t read(uint32_t _size)
+	{
+		if (!has(_size))
+		{
+			m_ptr = m_end;
+			return 0;
+		}
+
+		uint64_t value = 0;
+		for (uint32_t i=0; i<_size; ++i)
+			value |= (uint64_t)m_ptr[i] << (i*8);
+		m_ptr += _size;
+		return value;
+	}
+
+	uint8_t		read8()			{ return (uint8_t)read(1); }
+	uint16_t	read16()		{ return (uint16_t)read(2); }
+	uint32_t	read32()		{ return (uint32_t)read(4); }
+	uint64_t	read64()		{ return read(8); }
+	uint64_t	readOffset()	{ return read(m_offsetSize); }
+	uint64_t	readAddress()	{ return read(m_addressSize); }
+
+	uint64_t readULEB()
+	{
+		uint64_t value = 0;
+		uint32_t shift = 0;
+		while (m_ptr < m_end)
+		{
+			const uint8_t byte = *m_ptr++;
+			if (shift < 64)
+				value |= (uint64_t)(byte & 0x7f) << shift;
+			shift += 7;
+			if (!(byte & 0x80))
+				break;
+		}
+		return value;
+	}
+
+	int64_t readSLEB()
+	{
+		int64_t value = 0;
+		uint32_t shift = 0;
+		uint8_t byte = 0;
+		while (m_ptr < m_end)
+		{
+			byte = *m_ptr++;
+			if (shift < 64)
+				value |= (int64_t)(byte & 0x7f) << shift;
+			shift += 7;
+			if (!(byte & 0x80))
+				break;
+		}
+		if ((shift < 64) && (byte & 0x40))
+			value |= -((int64_t)1 << shift);
+		return value;
+	}
+
+	/// Returns NULL if string is not terminated before the end
+	const char* readString()
+	{
+		const uint8_t* end = (const uint8_t*)memchr(m_ptr, 0, m_end - m_ptr);
+		if (!end)
+		{
+			m_ptr = m_end;
+			return NULL;
+		}
+		const char* string = (const char*)m_ptr;
+		m_ptr = end + 1;
+		return string;
+	}
+
+	/// Reads initial length of a DWARF unit, sets offset size and returns end of the unit
+	const uint8_t* readUnitLength()
+	{
+		uint64_t length = read32();
+		m_offsetSize = 4;
+		if (length == 0xffffffff)
+		{
+			length = read64();
+			m_offsetSize = 8;
+		}
+		return has(length) ? m_ptr + length : m_end;
+	}
+};
+
+struct DataBlock
+{
+	const uint8_t*	m_data;
+	uint64_t		m_size;
+
+	const char* getString(uint64_t _offset) const
+	{
+		if (_offset >= m_size)
+			return NULL;
+		const char* string = (const char*)m_data + _offset;
+		return memchr(string, 0, m_size - _offset) ? string : NULL;
+	}
+};
+
+//--------------------------------------------------------------------------
+/// Sections and unit state needed to decode attribute values
+//--------------------------------------------------------------------------
+struct DwarfContext
+{
+	DataBlock	m_str;
+	DataBlock	m_lineStr;
+	DataBlock	m_strOffsets;
+	DataBlock	m_addr;
+	uint64_t	m_unitOffset;
+	uint64_t	m_strOffsetsBase;
+	uint64_t	m_addrBase;
+	uint32_t	m_version;
+};
+
+struct FormValue
+{
+	uint64_t	m_value;
+	const char*	m_string;
+	bool		m_isAddress;					///< Value is an address (not an offset from low PC)
+	bool		m_isReference;					///< Value is an offset into .debug_info
+};
+
+//--------------------------------------------------------------------------
+/// Reads a single attribute value, string, address and reference forms are resolved
+//--------------------------------------------------------------------------
+static bool readForm(DataReader& _reader, uint32_t _form, int64_t _implicitConst, const DwarfContext& _ctx, FormValue& _value)
+{
+	_value.m_value			= 0;
+	_value.m_string			= NULL;
+	_value.m_isAddress		= false;
+	_value.m_isReference	= false;
+
+	uint64_t strIndex	= (uint64_t)-1;
+	uint64_t addrIndex	= (uint64_t)-1;
+
+	switch (_form)
+	{
+		case DwarfForm::Addr:			_value.m_value = _reader.readAddress(); _value.m_isAddress = true; break;
+		case DwarfForm::Block2:			_reader.skip(_reader.read16()); break;
+		case DwarfForm::Block4:			_reader.skip(_reader.read32()); break;
+		case DwarfForm::Data2:			_value.m_value = _reader.read16(); break;
+		case DwarfForm::Data4:			_value.m_value = _reader.read32(); break;
+		case DwarfForm::Data8:			_value.m_value = _reader.read64(); break;
+		case DwarfForm::String:			_value.m_string = _reader.readString(); break;
+		case DwarfForm::Block:
+		case DwarfForm::ExprLoc:		_reader.skip(_reader.readULEB()); break;
+		case DwarfForm::Block1:			_reader.skip(_reader.read8()); break;
+		case DwarfForm::Data1:
+		case DwarfForm::Flag:			_value.m_value = _reader.read8(); break;
+		case DwarfForm::SData:			_value.m_value = (uint64_t)_reader.readSLEB(); break;
+		case DwarfForm::Strp:			_value.m_string = _ctx.m_str.getString(_reader.readOffset()); break;
+		case DwarfForm::UData:			_value.m_value = _reader.readULEB(); break;
+		case DwarfForm::RefAddr:		_value.m_value = _ctx.m_version <= 2 ? _reader.readAddress() : _reader.readOffset(); _value.m_isReference = true; break;
+		case DwarfForm::Ref1:			_value.m_value = _ctx.m_unitOffset + _reader.read8(); _value.m_isReference = true; break;
+		case DwarfForm::Ref2:			_value.m_value = _ctx.m_unitOffset + _reader.read16(); _value.m_isReference = true; break;
+		case DwarfForm::Ref4:			_value.m_value = _ctx.m_unitOffset + _reader.read32(); _value.m_isReference = true; break;
+		case DwarfForm::Ref8:			_value.m_value = _ctx.m_unitOffset + _reader.read64(); _value.m_isReference = true; break;
+		case DwarfForm::RefUData:		_value.m_value = _ctx.m_unitOffset + _reader.readULEB(); _value.m_isReference = true; break;
+		case DwarfForm::Indirect:
+			{
+				const uint32_t form = (uint32_t)_reader.readULEB();
+				if (form == DwarfForm::Indirect)
+					return false;
+				return readForm(_reader, form, 0, _ctx, _value);
+			}
+		case DwarfForm::SecOffset:
+		case DwarfForm::StrpSup:
+		case DwarfForm::GNURefAlt:
+		case DwarfForm::GNUStrpAlt:		_value.m_value = _reader.readOffset(); break;
+		case DwarfForm::FlagPresent:	_value.m_value = 1; break;
+		case DwarfForm::Strx:
+		case DwarfForm::GNUStrIndex:	strIndex = _reader.readULEB(); break;
+		case DwarfForm::Addrx:
+		case DwarfForm::GNUAddrIndex:	addrIndex = _reader.readULEB(); break;
+		case DwarfForm::RefSup4:		_value.m_value = _reader.read32(); break;
+		case DwarfForm::Data16:			_reader.skip(16); break;
+		case DwarfForm::LineStrp:		_value.m_string = _ctx.m_lineStr.getString(_reader.readOffset()); break;
+		case DwarfForm::RefSig8:
+		case DwarfForm::RefSup8:		_value.m_value = _reader.read64(); break;
+		case DwarfForm::ImplicitConst:	_value.m_value = (uint64_t)_implicitConst; break;
+		case DwarfForm::LocListx:
+		case DwarfForm::RngListx:		_value.m_value = _reader.readULEB(); break;
+		case DwarfForm::Strx1:			strIndex = _reader.read8(); break;
+		case DwarfForm::Strx2:			strIndex = _reader.read16(); break;
+		case DwarfForm::Strx3:			strIndex = _reader.read(3); break;
+		case DwarfForm::Strx4:			strIndex = _reader.read32(); break;
+		case DwarfForm::Addrx1:			addrIndex = _reader.read8(); break;
+		case DwarfForm::Addrx2:			addrIndex = _reader.read16(); break;
+		case DwarfForm::Addrx3:			addrIndex = _reader.read(3); break;
+		case DwarfForm::Addrx4:			addrIndex = _reader.read32(); break;
+
+		default:
+			// size of unknown forms is unknown so rest of the unit can not be decoded
+			return false;
+	};
+
+	if (strIndex != (uint64_t)-1)
+	{
+		const uint32_t offsetSize = _reader.m_offsetSize;
+		const uint64_t entry = _ctx.m_strOffsetsBase + strIndex * offsetSize;
+		if (entry + offsetSize <= _ctx.m_strOffsets.m_size)
+		{
+			DataReader offsets(_ctx.m_strOffsets.m_data + entry, _ctx.m_strOffsets.m_data + _ctx.m_strOffsets.m_size);
+			_value.m_string = _ctx.m_str.getString(offsets.read(offsetSize));
+		}
+	}
+
+	if (addrIndex != (uint64_t)-1)
+	{
+		const uint32_t addressSize = _reader.m_addressSize;
+		const uint64_t entry = _ctx.m_addrBase + addrIndex * addressSize;
+		if (entry + addressSize <= _ctx.m_addr.m_size)
+		{
+			DataReader addresses(_ctx.m_addr.m_data + entry, _ctx.m_addr.m_data + _ctx.m_addr.m_size);
+			_value.m_value		= addresses.read(addressSize);
+			_value.m_isAddress	= true;
+		}
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/// Abbreviation table of a compilation unit
+//--------------------------------------------------------------------------
+struct AbbrevTable
+{
+	struct Attribute
+	{
+		uint32_t	m_name;
+		uint32_t	m_form;
+		int64_t		m_implicitConst;
+	};
+
+	struct Abbrev
+	{
+		uint64_t	m_code;
+		uint32_t	m_tag;
+		bool		m_hasChildren;
+		uint32_t	m_firstAttribute;
+		uint32_t	m_numAttributes;
+	};
+
+	rtm_vector<Abbrev>		m_abbrevs;			///< Sorted by code
+	rtm_vector<Attribute>	m_attributes;
+
+	void parse(DataReader _reader)
+	{
+		while (_reader.m_ptr < _reader.m_end)
+		{
+			Abbrev abbrev;
+			abbrev.m_code = _reader.readULEB();
+			if (!abbrev.m_code)
+				break;
+
+			abbrev.m_tag			= (uint32_t)_reader.readULEB();
+			abbrev.m_hasChildren	= _reader.read8() != 0;
+			abbrev.m_firstAttribute	= (uint32_t)m_attributes.size();
+
+			for (;;)
+			{
+				Attribute attribute;
+				attribute.m_name			= (uint32_t)_reader.readULEB();
+				attribute.m_form			= (uint32_t)_reader.readULEB();
+				attribute.m_implicitConst	= attribute.m_form == DwarfForm::ImplicitConst ? _reader.readSLEB() : 0;
+				if (!attribute.m_name && !attribute.m_form)
+					break;
+				m_attributes.push_back(attribute);
+			}
+
+			abbrev.m_numAttributes = (uint32_t)m_attributes.size() - abbrev.m_firstAttribute;
+			m_abbrevs.push_back(abbrev);
+		}
+
+		std::sort(m_abbrevs.begin(), m_abbrevs.end(), [](const Abbrev& _a1, const Abbrev& _a2) { return _a1.m_code < _a2.m_code; });
+	}
+
+	const Abbrev* find(uint64_t _code) const
+	{
+		// codes are almost always sequential, starting from one
+		if ((_code - 1 < m_abbrevs.size()) && (m_abbrevs[(size_t)_code - 1].m_code == _code))
+			return &m_abbrevs[(size_t)_code - 1];
+
+		rtm_vector<Abbrev>::const_iterator it = std::lower_bound(m_abbrevs.begin(), m_abbrevs.end(), _code, [](const Abbrev& _abbrev, uint64_t _c) { return _abbrev.m_code < _c; });
+		return ((it != m_abbrevs.end()) && (it->m_code == _code)) ? &(*it) : NULL;
+	}
+};
+
+//--------------------------------------------------------------------------
+/// Subprogram DIE, names of concrete instances are found through specification
+//--------------------------------------------------------------------------
+struct Subprogram
+{
+	uint64_t	m_offset;
+	uint64_t	m_lowPC;
+	uint64_t	m_highPC;
+	uint64_t	m_reference;
+	const char*	m_name;
+	const char*	m_linkageName;
+};
+
+typedef rtm_unordered_map<uint64_t, const char*> CompDirMap;
+
+static void parseDebugInfo(const DataBlock& _info, const DataBlock& _abbrev, DwarfContext _ctx, rtm_vector<ELFSymbols::Range>& _functions, CompDirMap& _compDirs)
+{
+	rtm_unordered_map<uint64_t, AbbrevTable> abbrevTables;
+	rtm_vector<Subprogram> subprograms;
+
+	DataReader reader(_info.m_data, _info.m_data + _info.m_size);
+	while (reader.m_ptr < reader.m_end)
+	{
+		const uint64_t unitOffset = reader.m_ptr - _info.m_data;
+		const uint8_t* unitEnd = reader.readUnitLength();
+
+		DataReader unit(reader.m_ptr, unitEnd);
+		unit.m_offsetSize = reader.m_offsetSize;
+		reader.m_ptr = unitEnd;
+
+		const uint32_t version = unit.read16();
+		if ((version < 2) || (version > 5))
+			continue;
+
+		uint64_t abbrevOffset;
+		if (version >= 5)
+		{
+			const uint32_t unitType = unit.read8();
+			unit.m_addressSize = unit.read8();
+			abbrevOffset = unit.readOffset();
+
+			if ((unitType != 1) && (unitType != 3) && (unitType != 4))	// compile, partial and skeleton units
+				continue;
+			if (unitType == 4)
+				unit.skip(8);											// DWO ID
+		}
+		else
+		{
+			abbrevOffset = unit.readOffset();
+			unit.m_addressSize = unit.read8();
+		}
+
+		if ((unit.m_addressSize != 4) && (unit.m_addressSize != 8))
+			continue;
+
+		AbbrevTable& abbrevs = abbrevTables[abbrevOffset];
+		if (abbrevs.m_abbrevs.empty() && (abbrevOffset < _abbrev.m_size))
+			abbrevs.parse(DataReader(_abbrev.m_data + abbrevOffset, _abbrev.m_data + _abbrev.m_size));
+
+		_ctx.m_unitOffset		= unitOffset;
+		_ctx.m_version			= version;
+		_ctx.m_strOffsetsBase	= 0;
+		_ctx.m_addrBase			= 0;
+
+		uint64_t	stmtList	= (uint64_t)-1;
+		const char*	compDir		= NULL;
+
+		while (unit.m_ptr < unit.m_end)
+		{
+			const uint64_t dieOffset = unit.m_ptr - _info.m_data;
+			const uint64_t code = unit.readULEB();
+			if (!code)
+				continue;
+
+			const AbbrevTable::Abbrev* abbrev = abbrevs.find(code);
+			if (!abbrev)
+				break;
+
+			const bool isUnit		= (abbrev->m_tag == DwarfTag::CompileUnit) || (abbrev->m_tag == DwarfTag::SkeletonUnit);
+			const bool isSubprogram	= abbrev->m_tag == DwarfTag::Subprogram;
+
+			Subprogram sp = {};
+			sp.m_offset = dieOffset;
+			bool highPCIsOffset = false;
+			bool valid = true;
+
+			for (uint32_t a=0; a<abbrev->m_numAttributes; ++a)
+			{
+				const AbbrevTable::Attribute& attribute = abbrevs.m_attributes[abbrev->m_firstAttribute + a];
+
+				FormValue value;
+				if (!readForm(unit, attribute.m_form, attribute.m_implicitConst, _ctx, value))
+				{
+					valid = false;
+					break;
+				}
+
+				if (isUnit)
+				{
+					if (attribute.m_name == DwarfAttr::StrOffsetsBase)	_ctx.m_strOffsetsBase	= value.m_value;
+					if (attribute.m_name == DwarfAttr::AddrBase)		_ctx.m_addrBase			= value.m_value;
+					if (attribute.m_name == DwarfAttr::StmtList)		stmtList				= value.m_value;
+					if (attribute.m_name == DwarfAttr::CompDir)			compDir					= value.m_string;
+					continue;
+				}
+
+				if (!isSubprogram)
+					continue;
+
+				switch (attribute.m_name)
+				{
+					case DwarfAttr::Name:				sp.m_name			= value.m_string; break;
+					case DwarfAttr::LinkageName:
+					case DwarfAttr::MIPSLinkageName:	sp.m_linkageName	= value.m_string; break;
+					case DwarfAttr::LowPC:				sp.m_lowPC			= value.m_value; break;
+					case DwarfAttr::HighPC:				sp.m_highPC			= value.m_value; highPCIsOffset = !value.m_isAddress; break;
+					case DwarfAttr::Specification:
+					case DwarfAttr::AbstractOrigin:		sp.m_reference		= value.m_isReference ? value.m_value : 0; break;
+				};
+			}
+
+			if (!valid)
+				break;
+
+			if (isUnit && compDir && (stmtList != (uint64_t)-1))
+				_compDirs[stmtList] = compDir;
+
+			if (isSubprogram)
+			{
+				if (highPCIsOffset)
+					sp.m_highPC += sp.m_lowPC;
+				subprograms.push_back(sp);
+			}
+		}
+	}
+
+	std::sort(subprograms.begin(), subprograms.end(), [](const Subprogram& _s1, const Subprogram& _s2) { return _s1.m_offset < _s2.m_offset; });
+
+	for (const Subprogram& sp : subprograms)
+	{
+		// functions removed by the linker keep their debug info at address zero
+		if (!sp.m_lowPC || (sp.m_highPC <= sp.m_lowPC))
+			continue;
+
+		ELFSymbols::Range range;
+		range.m_start		= sp.m_lowPC;
+		range.m_end			= sp.m_highPC;
+		range.m_name		= sp.m_linkageName;
+		range.m_plainName	= sp.m_name;
+
+		// out of line and inlined instances are named by their declaration
+		const Subprogram* declaration = &sp;
+		for (uint32_t depth=0; (depth < MAX_SPECIFICATION_DEPTH) && declaration->m_reference && (!range.m_name || !range.m_plainName); ++depth)
+		{
+			const uint64_t reference = declaration->m_reference;
+			rtm_vector<Subprogram>::const_iterator it = std::lower_bound(subprograms.begin(), subprograms.end(), reference, [](const Subprogram& _s, uint64_t _offset) { return _s.m_offset < _offset; });
+			if ((it == subprograms.end()) || (it->m_offset != reference))
+				break;
+
+			declaration = &(*it);
+			if (!range.m_name)		range.m_name		= declaration->m_linkageName;
+			if (!range.m_plainName)	range.m_plainName	= declaration->m_name;
+		}
+
+		if (!range.m_name)
+			range.m_name = range.m_plainName;
+
+		if (range.m_name)
+			_functions.push_back(range);
+	}
+}
+
+//--------------------------------------------------------------------------
+/// Joins directory and file name unless file name is already absolute
+//--------------------------------------------------------------------------
+static rtm_string makePath(const char* _dir, const char* _file)
+{
+	const bool absolute = (_file[0] == '/') || (_file[0] == '\\') || (_file[0] && (_file[1] == ':'));
+	if (absolute || !_dir || !_dir[0])
+		return _file;
+
+	while ((_file[0] == '.') && (_file[1] == '/'))
+		_file += 2;
+
+	rtm_string path = _dir;
+	path += "/";
+	path += _file;
+	return path;
+}
+
+//--------------------------------------------------------------------------
+/// Full path of a line table file, directory zero is the compilation directory
+/// and other relative directories are relative to it
+//--------------------------------------------------------------------------
+static rtm_string makeFilePath(const rtm_vector<const char*>& _dirs, uint64_t _dir, const char* _file)
+{
+	rtm_string path = makePath(_dir < _dirs.size() ? _dirs[(size_t)_dir] : NULL, _file ? _file : "");
+	if (_dir && !_dirs.empty() && _dirs[0])
+		path = makePath(_dirs[0], path.c_str());
+	return path;
+}
+
+static void parseDebugLine(const DataBlock& _line, DwarfContext _ctx, const CompDirMap& _compDirs, rtm_vector<ELFSymbols::LineRow>& _rows, rtm_vector<rtm_string>& _files)
+{
+	DataReader reader(_line.m_data, _line.m_data + _line.m_size);
+	while (reader.m_ptr < reader.m_end)
+	{
+		const uint64_t unitOffset = reader.m_ptr - _line.m_data;
+		const uint8_t* unitEnd = reader.readUnitLength();
+
+		DataReader unit(reader.m_ptr, unitEnd);
+		unit.m_offsetSize = reader.m_offsetSize;
+		reader.m_ptr = unitEnd;
+
+		const uint32_t version = unit.read16();
+		if ((version < 2) || (version > 5))
+			continue;
+
+		if (version >= 5)
+		{
+			unit.m_addressSize = unit.read8();
+			unit.skip(1);												// segment selector size
+		}
+
+		const uint64_t headerLength = unit.readOffset();
+		const uint8_t* program = unit.has(headerLength) ? unit.m_ptr + headerLength : unit.m_end;
+
+		const uint32_t	minInstLength	= unit.read8();
+		if (version >= 4)
+			unit.skip(1);												// maximum operations per instruction, VLIW only
+		unit.skip(1);													// default is_stmt
+		const int32_t	lineBase		= (int8_t)unit.read8();
+		const uint32_t	lineRange		= unit.read8();
+		const uint32_t	opcodeBase		= unit.read8();
+		const uint8_t*	opcodeLengths	= unit.m_ptr;
+
+		if (!lineRange || !opcodeBase || !unit.has(opcodeBase - 1))
+			continue;
+		unit.skip(opcodeBase - 1);
+
+		_ctx.m_version = version;
+
+		// file indices are translated to the shared file table
+		rtm_vector<const char*>	dirs;
+		rtm_vector<uint32_t>	files;
+
+		if (version >= 5)
+		{
+			for (uint32_t table=0; table<2; ++table)
+			{
+				rtm_vector<uint64_t> formats(unit.read8() * 2);
+				for (uint64_t& format : formats)
+					format = unit.readULEB();
+
+				const uint64_t numEntries = unit.readULEB();
+				for (uint64_t e=0; (e < numEntries) && (unit.m_ptr < program); ++e)
+				{
+					const char* path = NULL;
+					uint64_t dir = 0;
+
+					for (size_t f=0; f<formats.size(); f+=2)
+					{
+						FormValue value;
+						if (!readForm(unit, (uint32_t)formats[f+1], 0, _ctx, value))
+							break;
+
+						if (formats[f] == DwarfLine::ContentPath)		path	= value.m_string;
+						if (formats[f] == DwarfLine::ContentDirIndex)	dir		= value.m_value;
+					}
+
+					if (table == 0)
+						dirs.push_back(path);
+					else
+					{
+						files.push_back((uint32_t)_files.size());
+						_files.push_back(makeFilePath(dirs, dir, path));
+					}
+				}
+			}
+		}
+		else
+		{
+			// index zero is the compilation directory, not stored in the line program before version 5
+			CompDirMap::const_iterator compDir = _compDirs.find(unitOffset);
+			dirs.push_back(compDir != _compDirs.end() ? compDir->second : NULL);
+			while (unit.m_ptr < program)
+			{
+				const char* dir = unit.readString();
+				if (!dir || !dir[0])
+					break;
+				dirs.push_back(dir);
+			}
+
+			files.push_back((uint32_t)_files.size());
+			_files.push_back("");
+			while (unit.m_ptr < program)
+			{
+				const char* file = unit.readString();
+				if (!file || !file[0])
+					break;
+
+				const uint64_t dir = unit.readULEB();
+				unit.readULEB();										// modification time
+				unit.readULEB();										// file size
+
+				files.push_back((uint32_t)_files.size());
+				_files.push_back(makeFilePath(dirs, dir, file));
+			}
+		}
+
+		// state machine rows, sequences starting at zero belong to functions removed by the linker
+		unit.m_ptr = program;
+
+		const size_t	sequenceStart	= _rows.size();
+		uint64_t		address			= 0;
+		uint64_t		file			= 1;
+		int64_t			line			= 1;
+
+		auto emitRow = [&](bool _endSequence)
+		{
+			ELFSymbols::LineRow row;
+			row.m_address	= address;
+			row.m_file		= _endSequence ? (uint32_t)ELFSymbols::END_SEQUENCE : (file < files.size() ? files[(size_t)file] : files[0]);
+			row.m_line		= (uint32_t)line;
+			_rows.push_back(row);
+		};
+
+		size_t first = sequenceStart;
+		while (unit.m_ptr < unit.m_end)
+		{
+			const uint32_t opcode = unit.read8();
+
+			if (opcode >= opcodeBase)
+			{
+				const uint32_t adjusted = opcode - opcodeBase;
+				address	+= (adjusted / lineRange) * minInstLength;
+				line	+= lineBase + (int32_t)(adjusted % lineRange);
+				emitRow(false);
+				continue;
+			}
+
+			switch (opcode)
+			{
+				case 0:
+					{
+						const uint64_t length = unit.readULEB();
+						const uint8_t* next = unit.has(length) ? unit.m_ptr + length : unit.m_end;
+						if (!length)
+							break;
+
+						switch (unit.read8())
+						{
+							case DwarfLine::EndSequence:
+								emitRow(true);
+								if (!_rows[first].m_address)
+									_rows.resize(first);
+								first	= _rows.size();
+								address	= 0;
+								file	= 1;
+								line	= 1;
+								break;
+
+							case DwarfLine::SetAddress:
+								address = unit.read((uint32_t)(length - 1));
+								break;
+
+							case DwarfLine::DefineFile:
+								{
+									const char* name = unit.readString();
+									const uint64_t dir = unit.readULEB();
+									files.push_back((uint32_t)_files.size());
+									_files.push_back(makeFilePath(dirs, dir, name));
+								}
+								break;
+						};
+
+						unit.m_ptr = next;
+					}
+					break;
+
+				case DwarfLine::Copy:			emitRow(false); break;
+				case DwarfLine::AdvancePC:		address += unit.readULEB() * minInstLength; break;
+				case DwarfLine::AdvanceLine:	line += unit.readSLEB(); break;
+				case DwarfLine::SetFile:		file = unit.readULEB(); break;
+				case DwarfLine::ConstAddPC:		address += ((255 - opcodeBase) / lineRange) * minInstLength; break;
+				case DwarfLine::FixedAdvancePC:	address += unit.read16(); break;
+
+				default:
+					// column, flags and ISA are not needed, unknown opcodes are skipped by their declared length
+					for (uint32_t i=0; i<opcodeLengths[opcode - 1]; ++i)
+						unit.readULEB();
+					break;
+			};
+		}
+
+		// unterminated sequence is dropped
+		_rows.resize(first);
+	}
+}
+
+//--------------------------------------------------------------------------
+/// Sorts ranges by start, duplicates (aliases) are removed and ranges
+/// without size end at the next range
+//--------------------------------------------------------------------------
+static void finalizeRanges(rtm_vector<ELFSymbols::Range>& _ranges)
+{
+	std::sort(_ranges.begin(), _ranges.end(), [](const ELFSymbols::Range& _r1, const ELFSymbols::Range& _r2)
+	{
+		if (_r1.m_start != _r2.m_start)
+			return _r1.m_start < _r2.m_start;
+		return _r1.m_end > _r2.m_end;
+	});
+
+	_ranges.erase(std::unique(_ranges.begin(), _ranges.end(), [](const ELFSymbols::Range& _r1, const ELFSymbols::Range& _r2)
+	{
+		return _r1.m_start == _r2.m_start;
+	}), _ranges.end());
+
+	for (size_t i=0; i<_ranges.size(); ++i)
+		if (_ranges[i].m_end <= _ranges[i].m_start)
+			_ranges[i].m_end = (i + 1 < _ranges.size()) ? _ranges[i + 1].m_start : _ranges[i].m_start + 1;
+}
+
+static const ELFSymbols::Range* findRange(const rtm_vector<ELFSymbols::Range>& _ranges, uint64_t _address)
+{
+	rtm_vector<ELFSymbols::Range>::const_iterator it = std::upper_bound(_ranges.begin(), _ranges.end(), _address, [](uint64_t _addr, const ELFSymbols::Range& _range)
+	{
+		return _addr < _range.m_start;
+	});
+
+	if (it == _ranges.begin())
+		return NULL;
+
+	--it;
+	return _address < it->m_end ? &(*it) : NULL;
+}
+
+ELFSymbols::ELFSymbols()
+	: m_file(NULL)
+	, m_data(NULL)
+	, m_size(0)
+{
+}
+
+ELFSymbols::~ELFSymbols()
+{
+	clear();
+}
+
+void ELFSymbols::clear()
+{
+	for (QByteArray* section : m_sections)
+		delete section;
+	m_sections.clear();
+
+	delete m_file;
+	m_file	= NULL;
+	m_data	= NULL;
+	m_size	= 0;
+
+	m_symbols.clear();
+	m_functions.clear();
+	m_lines.clear();
+	m_files.clear();
+}
+
+bool ELFSymbols::load(const char* _path)
+{
+	clear();
+
+	m_file = new QFile(QString::fromUtf8(_path));
+	if (!m_file->open(QIODevice::ReadOnly))
+	{
+		clear();
+		return false;
+	}
+
+	const qint64 size = m_file->size();
+	const uchar* data = size ? m_file->map(0, size) : NULL;
+	if (!data || !parse(data, (uint64_t)size))
+	{
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool ELFSymbols::load(const uint8_t* _data, uint64_t _size)
+{
+	clear();
+
+	if (!parse(_data, _size))
+	{
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool ELFSymbols::parse(const uint8_t* _data, uint64_t _size)
+{
+	m_data = _data;
+	m_size = _size;
+
+	if ((_size < 64) || memcmp(_data, "\x7f" "ELF", 4) || (_data[5] != 1))
+		return false;
+
+	const bool is64bit = _data[4] == 2;
+
+	DataReader header(_data, _data + _size);
+	header.skip(is64bit ? 0x28 : 0x20);
+	const uint64_t sectionOffset	= header.read(is64bit ? 8 : 4);
+	header.skip(is64bit ? 0x3a - 0x30 : 0x2e - 0x24);
+	const uint32_t sectionSize		= header.read16();
+	const uint32_t numSections		= header.read16();
+	const uint32_t nameSection		= header.read16();
+
+	if (!numSections || (nameSection >= numSections) || (sectionSize < (is64bit ? 64U : 40U)) ||
+		(sectionOffset > _size) || ((uint64_t)numSections * sectionSize > _size - sectionOffset))
+		return false;
+
+	struct Section
+	{
+		uint32_t	m_name;
+		uint32_t	m_type;
+		uint64_t	m_flags;
+		uint64_t	m_offset;
+		uint64_t	m_size;
+		uint32_t	m_link;
+		uint32_t	m_entrySize;
+	};
+
+	rtm_vector<Section> sections(numSections);
+	for (uint32_t s=0; s<numSections; ++s)
+	{
+		DataReader reader(_data + sectionOffset + s*sectionSize, _data + sectionOffset + (s + 1)*sectionSize);
+		const uint32_t wordSize = is64bit ? 8 : 4;
+
+		Section& section = sections[s];
+		section.m_name		= reader.read32();
+		section.m_type		= reader.read32();
+		section.m_flags		= reader.read(wordSize);
+		reader.skip(wordSize);											// address
+		section.m_offset	= reader.read(wordSize);
+		section.m_size		= reader.read(wordSize);
+		section.m_link		= reader.read32();
+		reader.skip(4 + wordSize);										// info, alignment
+		section.m_entrySize	= (uint32_t)reader.read(wordSize);
+
+		if ((section.m_type == ELFSection::NoBits) || (section.m_offset > _size) || (section.m_size > _size - section.m_offset))
+			section.m_size = 0;
+	}
+
+	auto getData = [&](uint32_t _index) -> DataBlock
+	{
+		DataBlock block = { _data + sections[_index].m_offset, sections[_index].m_size };
+		return block;
+	};
+
+	const DataBlock names = getData(nameSection);
+
+	// debug sections are found by name, compressed ones are inflated once
+	auto findDebugSection = [&](const char* _name) -> DataBlock
+	{
+		DataBlock empty = { NULL, 0 };
+		for (uint32_t s=0; s<numSections; ++s)
+		{
+			const char* name = names.getString(sections[s].m_name);
+			if (!name)
+				continue;
+
+			const bool gnuCompressed = (strncmp(name, ".zdebug", 7) == 0) && (strcmp(name + 7, _name + 6) == 0);
+			if ((strcmp(name, _name) != 0) && !gnuCompressed)
+				continue;
+
+			DataBlock block = getData(s);
+			if (!block.m_size)
+				return empty;
+
+			// both formats are a zlib stream preceded by uncompressed size, qUncompress
+			// expects the size as a 32 bit big endian prefix
+			uint64_t		uncompressedSize	= 0;
+			const uint8_t*	stream				= NULL;
+			uint64_t		streamSize			= 0;
+
+			if (sections[s].m_flags & ELFSection::Compressed)
+			{
+				DataReader chdr(block.m_data, block.m_data + block.m_size);
+				const uint32_t type = chdr.read32();
+				if (is64bit)
+					chdr.skip(4);
+				uncompressedSize = chdr.read(is64bit ? 8 : 4);
+				chdr.skip(is64bit ? 8 : 4);
+				if (type != ELFSection::CompressZLIB)
+					return empty;
+				stream = chdr.m_ptr;
+			}
+			else
+			if (gnuCompressed)
+			{
+				if ((block.m_size < 12) || memcmp(block.m_data, "ZLIB", 4))
+					return empty;
+				for (uint32_t i=4; i<12; ++i)
+					uncompressedSize = (uncompressedSize << 8) | block.m_data[i];
+				stream = block.m_data + 12;
+			}
+			else
+				return block;
+
+			streamSize = block.m_data + block.m_size - stream;
+			if ((uncompressedSize >= 0x7fffffff) || (stream > block.m_data + block.m_size))
+				return empty;
+
+			QByteArray compressed;
+			compressed.reserve((int)(streamSize + 4));
+			compressed.append((char)(uncompressedSize >> 24));
+			compressed.append((char)(uncompressedSize >> 16));
+			compressed.append((char)(uncompressedSize >> 8));
+			compressed.append((char)(uncompressedSize));
+			compressed.append((const char*)stream, (int)streamSize);
+
+			QByteArray* uncompressed = new QByteArray(qUncompress(compressed));
+			m_sections.push_back(uncompressed);
+
+			DataBlock inflated = { (const uint8_t*)uncompressed->constData(), (uint64_t)uncompressed->size() };
+			return inflated;
+		}
+		return empty;
+	};
+
+	// symbol tables, both are read as .dynsym has exported functions of stripped binaries
+	for (uint32_t s=0; s<numSections; ++s)
+	{
+		const Section& section = sections[s];
+		if ((section.m_type != ELFSection::SymTab) && (section.m_type != ELFSection::DynSym))
+			continue;
+
+		const uint32_t entrySize = is64bit ? 24 : 16;
+		if ((section.m_entrySize != entrySize) || (section.m_link >= numSections))
+			continue;
+
+		const DataBlock symbols	= getData(s);
+		const DataBlock strings	= getData(section.m_link);
+		const uint64_t numSymbols = symbols.m_size / entrySize;
+
+		for (uint64_t i=0; i<numSymbols; ++i)
+		{
+			DataReader reader(symbols.m_data + i*entrySize, symbols.m_data + (i + 1)*entrySize);
+
+			uint32_t name, info, sectionIndex;
+			uint64_t value, size;
+			if (is64bit)
+			{
+				name			= reader.read32();
+				info			= reader.read8();
+				reader.skip(1);
+				sectionIndex	= reader.read16();
+				value			= reader.read64();
+				size			= reader.read64();
+			}
+			else
+			{
+				name			= reader.read32();
+				value			= reader.read32();
+				size			= reader.read32();
+				info			= reader.read8();
+				reader.skip(1);
+				sectionIndex	= reader.read16();
+			}
+
+			const uint32_t type = info & 0xf;
+			if (((type != ELFSymbol::Func) && (type != ELFSymbol::GNUIFunc)) || !sectionIndex || !value)
+				continue;
+
+			Range range;
+			range.m_start		= value;
+			range.m_end			= value + size;
+			range.m_name		= strings.getString(name);
+			range.m_plainName	= NULL;
+
+			if (range.m_name && range.m_name[0])
+				m_symbols.push_back(range);
+		}
+	}
+
+	DwarfContext ctx = {};
+	ctx.m_str			= findDebugSection(".debug_str");
+	ctx.m_lineStr		= findDebugSection(".debug_line_str");
+	ctx.m_strOffsets	= findDebugSection(".debug_str_offsets");
+	ctx.m_addr			= findDebugSection(".debug_addr");
+
+	const DataBlock info	= findDebugSection(".debug_info");
+	const DataBlock abbrev	= findDebugSection(".debug_abbrev");
+	const DataBlock line	= findDebugSection(".debug_line");
+
+	CompDirMap compDirs;
+	if (info.m_size && abbrev.m_size)
+		parseDebugInfo(info, abbrev, ctx, m_functions, compDirs);
+
+	if (line.m_size)
+		parseDebugLine(line, ctx, compDirs, m_lines, m_files);
+
+	finalizeRanges(m_symbols);
+	finalizeRanges(m_functions);
+
+	// at equal address end of one sequence goes before start of the next
+	std::stable_sort(m_lines.begin(), m_lines.end(), [](const LineRow& _r1, const LineRow& _r2)
+	{
+		if (_r1.m_address != _r2.m_address)
+			return _r1.m_address < _r2.m_address;
+		return (_r1.m_file == END_SEQUENCE) && (_r2.m_file != END_SEQUENCE);
+	});
+
+	return !m_symbols.empty() || !m_functions.empty();
+}
+
+bool ELFSymbols::find(uint64_t _address, Location& _location) const
+{
+	const Range* symbol		= findRange(m_symbols, _address);
+	const Range* function	= findRange(m_functions, _address);
+
+	if (!symbol && !function)
+		return false;
+
+	_location.m_func		= symbol ? symbol->m_name : function->m_name;
+	_location.m_plainFunc	= function ? function->m_plainName : NULL;
+	_location.m_file		= "";
+	_location.m_line		= 0;
+
+	rtm_vector<LineRow>::const_iterator it = std::upper_bound(m_lines.begin(), m_lines.end(), _address, [](uint64_t _addr, const LineRow& _row)
+	{
+		return _addr < _row.m_address;
+	});
+
+	if (it != m_lines.begin())
+	{
+		--it;
+		if (it->m_file != END_SEQUENCE)
+		{
+			_location.m_file = m_files[it->m_file].c_str();
+			_location.m_line = it->m_line;
+		}
+	}
+
+	return true;
+}
+
+} // namespace rtm
@@ -0,0 +1,86 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_ELFSYMBOLS_H__
+#define __RTM_MTUNER_ELFSYMBOLS_H__
+
+class QFile;
+class QByteArray;
+
+namespace rtm {
+
+//--------------------------------------------------------------------------
+/// In-process symbol reader for little endian ELF binaries. Function ranges
+/// come from .symtab/.dynsym and .debug_info subprograms, source lines from
+/// the .debug_line programs. Binary is memory mapped and names point into
+/// the mapping, lookups are const and can run from any number of threads.
+/// Addresses are link time addresses of the binary.
+//--------------------------------------------------------------------------
+class ELFSymbols
+{
+	public:
+		enum
+		{
+			END_SEQUENCE = 0xffffffff
+		};
+
+		struct Range
+		{
+			uint64_t		m_start;
+			uint64_t		m_end;
+			const char*		m_name;					///< Linkage (mangled) name if known
+			const char*		m_plainName;			///< DW_AT_name, may be NULL
+		};
+
+		struct LineRow
+		{
+			uint64_t		m_address;
+			uint32_t		m_file;					///< Index into file table, END_SEQUENCE after last row of a sequence
+			uint32_t		m_line;
+		};
+
+		struct Location
+		{
+			const char*		m_func;
+			const char*		m_plainFunc;
+			const char*		m_file;
+			uint32_t		m_line;
+		};
+
+	private:
+		QFile*					m_file;
+		const uint8_t*			m_data;
+		uint64_t				m_size;
+		rtm_vector<QByteArray*>	m_sections;		///< Decompressed debug sections
+		rtm_vector<Range>		m_symbols;		///< From symbol tables, sorted by start
+		rtm_vector<Range>		m_functions;	///< From debug info, sorted by start
+		rtm_vector<LineRow>		m_lines;		///< Sorted by address
+		rtm_vector<rtm_string>	m_files;
+
+	public:
+		ELFSymbols();
+		~ELFSymbols();
+
+		/// Maps the binary and builds address indices, returns false if file is not
+		/// a readable ELF binary or has neither symbol tables nor debug info
+		bool	load(const char* _path);
+
+		/// Same as load, for a binary already in memory that outlives this object
+		bool	load(const uint8_t* _data, uint64_t _size);
+
+		/// Returns false if address is not inside any known function
+		bool	find(uint64_t _address, Location& _location) const;
+
+		uint32_t	getNumFunctions() const { return (uint32_t)(m_symbols.size() + m_functions.size()); }
+		uint32_t	getNumLines() const { return (uint32_t)m_lines.size(); }
+
+	private:
+		void	clear();
+		bool	parse(const uint8_t* _data, uint64_t _size);
+};
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_ELFSYMBOLS_H__
@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/framecache.h>
+
+namespace rtm {
+
+void FrameCache::Shard::unlink(uint32_t _entry)
+{
+	Entry& entry = m_entries[_entry];
+
+	if (entry.m_prev != INVALID_ENTRY)
+		m_entries[entry.m_prev].m_next = entry.m_next;
+	else
+		m_head = entry.m_next;
+
+	if (entry.m_next != INVALID_ENTRY)
+		m_entries[entry.m_next].m_prev = entry.m_prev;
+	else
+		m_tail = entry.m_prev;
+}
+
+void FrameCache::Shard::pushFront(uint32_t _entry)
+{
+	Entry& entry = m_entries[_entry];
+	entry.m_prev = INVALID_ENTRY;
+	entry.m_next = m_head;
+
+	if (m_head != INVALID_ENTRY)
+		m_entries[m_head].m_prev = _entry;
+	else
+		m_tail = _entry;
+
+	m_head = _entry;
+}
+
+FrameCache::FrameCache(uint32_t _capacity)
+{
+	m_shardCapacity = qMax(1U, _capacity / NUM_SHARDS);
+
+	for (Shard& shard : m_shards)
+	{
+		shard.m_head = INVALID_ENTRY;
+		shard.m_tail = INVALID_ENTRY;
+	}
+}
+
+void FrameCache::clear()
+{
+	for (Shard& shard : m_shards)
+	{
+		std::lock_guard<std::mutex> lock(shard.m_mutex);
+		shard.m_entryMap.clear();
+		shard.m_entries.clear();
+		shard.m_head = INVALID_ENTRY;
+		shard.m_tail = INVALID_ENTRY;
+	}
+}
+
+bool FrameCache::find(uint64_t _address, rdebug::StackFrame& _frame)
+{
+	Shard& shard = getShard(_address);
+	std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+	Shard::EntryMap::const_iterator it = shard.m_entryMap.find(_address);
+	if (it == shard.m_entryMap.end())
+		return false;
+
+	const uint32_t index = it->second;
+	if (index != shard.m_head)
+	{
+		shard.unlink(index);
+		shard.pushFront(index);
+	}
+
+	const Entry& entry = shard.m_entries[index];
+	rtm::strlCpy(_frame.m_moduleName,	RTM_NUM_ELEMENTS(_frame.m_moduleName),	entry.m_moduleName.c_str());
+	rtm::strlCpy(_frame.m_func,			RTM_NUM_ELEMENTS(_frame.m_func),		entry.m_func.c_str());
+	rtm::strlCpy(_frame.m_file,			RTM_NUM_ELEMENTS(_frame.m_file),		entry.m_file.c_str());
+	_frame.m_line = entry.m_line;
+	return true;
+}
+
+bool FrameCache::contains(uint64_t _address)
+{
+	Shard& shard = getShard(_address);
+	std::lock_guard<std::mutex> lock(shard.m_mutex);
+	return shard.m_entryMap.find(_address) != shard.m_entryMap.end();
+}
+
+void FrameCache::insert(uint64_t _address, const rdebug::StackFrame& _frame)
+{
+	Shard& shard = getShard(_address);
+	std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+	uint32_t index;
+
+	// another thread may have resolved the same address in the meantime
+	Shard::EntryMap::const_iterator it = shard.m_entryMap.find(_address);
+	if (it != shard.m_entryMap.end())
+	{
+		index = it->second;
+		shard.unlink(index);
+	}
+	else
+	if (shard.m_entries.size() < m_shardCapacity)
+	{
+		index = (uint32_t)shard.m_entries.size();
+		shard.m_entries.push_back(Entry());
+	}
+	else
+	{
+		index = shard.m_tail;
+		shard.unlink(index);
+		shard.m_entryMap.erase(shard.m_entries[index].m_address);
+	}
+
+	Entry& entry = shard.m_entries[index];
+	entry.m_address		= _address;
+	entry.m_moduleName	= _frame.m_moduleName;
+	entry.m_func		= _frame.m_func;
+	entry.m_file		= _frame.m_file;
+	entry.m_line		= _frame.m_line;
+
+	shard.m_entryMap[_address] = index;
+	shard.pushFront(index);
+}
+
+FrameCache::Shard& FrameCache::getShard(uint64_t _address)
+{
+	// low bits of return addresses are poorly distributed, top bits of the product are not
+	const uint64_t hash = _address * 0x9e3779b97f4a7c15ULL;
+	return m_shards[(hash >> 32) % NUM_SHARDS];
+}
+
+} // namespace rtm
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_FRAMECACHE_H__
+#define __RTM_MTUNER_FRAMECACHE_H__
+
+#include <mutex>
+
+namespace rtm {
+
+//--------------------------------------------------------------------------
+/// In memory LRU cache of resolved stack frames keyed by address. Entries
+/// are split into shards by address hash, each shard has its own lock so
+/// views, exporters and prefetching threads rarely wait on each other.
+//--------------------------------------------------------------------------
+class FrameCache
+{
+	public:
+		enum
+		{
+			NUM_SHARDS			= 16,
+			DEFAULT_CAPACITY	= 256*1024,		///< Frames over all shards
+			INVALID_ENTRY		= 0xffffffff
+		};
+
+	private:
+		struct Entry
+		{
+			uint64_t	m_address;
+			uint32_t	m_prev;						///< Towards most recently used
+			uint32_t	m_next;						///< Towards least recently used
+			rtm_string	m_moduleName;
+			rtm_string	m_func;
+			rtm_string	m_file;
+			uint32_t	m_line;
+		};
+
+		struct Shard
+		{
+			typedef rtm_unordered_map<uint64_t, uint32_t> EntryMap;
+
+			std::mutex			m_mutex;
+			EntryMap			m_entryMap;			///< Address to index into entries
+			rtm_vector<Entry>	m_entries;			///< Never shrinks, evicted entries are reused
+			uint32_t			m_head;				///< Most recently used
+			uint32_t			m_tail;				///< Least recently used
+
+			void unlink(uint32_t _entry);
+			void pushFront(uint32_t _entry);
+		};
+
+		Shard		m_shards[NUM_SHARDS];
+		uint32_t	m_shardCapacity;
+
+	public:
+		FrameCache(uint32_t _capacity = DEFAULT_CAPACITY);
+
+		/// Drops all frames, capacity is kept
+		void	clear();
+
+		/// Returns false if frame of the address is not cached
+		bool	find(uint64_t _address, rdebug::StackFrame& _frame);
+
+		/// Same as find but doesn't copy the frame or mark it as recently used
+		bool	contains(uint64_t _address);
+
+		/// Stores resolved frame, evicts least recently used frame of the shard when full
+		void	insert(uint64_t _address, const rdebug::StackFrame& _frame);
+
+	private:
+		Shard&	getShard(uint64_t _address);
+};
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_FRAMECACHE_H__
@@ -0,0 +1,538 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/gnusymbolizer.h>
+#include <MTuner/src/loader/binaryinfo.h>
+#include <MTuner/src/loader/elfsymbols.h>
+#include <rbase/inc/hash.h>
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QThread>
+
+#include <algorithm>
+
+#if RTM_COMPILER_GCC || RTM_COMPILER_CLANG
+#include <cxxabi.h>
+#endif
+
+namespace rtm {
+
+#if RTM_PLATFORM_WINDOWS
+static const char* s_addr2lineName = "addr2line.exe";
+#else
+static const char* s_addr2lineName = "addr2line";
+#endif
+
+//--------------------------------------------------------------------------
+/// Parses 'function' and 'file:line' output lines of a single address
+//--------------------------------------------------------------------------
+static void parseAddr2Line(const QByteArray& _func, const QByteArray& _location, GNUSymbolizer::Symbol& _symbol)
+{
+	_symbol.m_func = _func.trimmed().constData();
+
+	QByteArray location = _location.trimmed();
+
+	// newer binutils append discriminator info after line number
+	const int discriminator = location.indexOf(" (discriminator");
+	if (discriminator != -1)
+		location.truncate(discriminator);
+
+	_symbol.m_line = 0;
+
+	// last colon separates line so drive letters in paths are preserved
+	const int colon = location.lastIndexOf(':');
+	if (colon != -1)
+	{
+		_symbol.m_line = location.mid(colon + 1).toUInt();
+		location.truncate(colon);
+	}
+
+	_symbol.m_file = location.constData();
+}
+
+//--------------------------------------------------------------------------
+/// Demangles linkage name, without a demangler DWARF name is used instead
+//--------------------------------------------------------------------------
+static rtm_string demangle(const char* _name, const char* _plainName)
+{
+#if RTM_COMPILER_GCC || RTM_COMPILER_CLANG
+	int status = 0;
+	char* demangled = abi::__cxa_demangle(_name, NULL, NULL, &status);
+	if (demangled)
+	{
+		rtm_string name = demangled;
+		free(demangled);
+		return name;
+	}
+#endif
+	return _plainName ? _plainName : _name;
+}
+
+//--------------------------------------------------------------------------
+/// Long lived addr2line process of a single binary. The process belongs to
+/// the worker thread, jobs are handed over under a mutex and their addresses
+/// streamed to stdin while answers are read back as addr2line flushes them.
+//--------------------------------------------------------------------------
+class Addr2LineWorker : public QThread
+{
+	public:
+		struct Job
+		{
+			uint32_t				m_first;
+			uint32_t				m_last;
+			QByteArray				m_input;		///< One hex address per line
+			rtm_vector<QByteArray>	m_lines;		///< Function and location line per address
+			bool					m_success;
+			bool					m_done;
+		};
+
+		bool		m_busy;			///< Guarded by symbolizer workers mutex
+		uint64_t	m_lastUse;		///< Guarded by symbolizer workers mutex
+
+	private:
+		QString						m_program;
+		rtm_string					m_binary;
+		std::mutex					m_mutex;
+		std::condition_variable		m_condition;
+		Job*						m_job;
+		bool						m_quit;
+
+	public:
+		Addr2LineWorker(const rtm_string& _program, const rtm_string& _binary)
+			: m_busy(false)
+			, m_lastUse(0)
+			, m_program(QString::fromUtf8(_program.c_str()))
+			, m_binary(_binary)
+			, m_job(NULL)
+			, m_quit(false)
+		{
+			start();
+		}
+
+		~Addr2LineWorker()
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_quit = true;
+				m_condition.notify_all();
+			}
+			QThread::wait();
+		}
+
+		const rtm_string& getBinary() const { return m_binary; }
+
+		void submit(Job* _job)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			_job->m_done	= false;
+			_job->m_success	= false;
+			m_job			= _job;
+			m_condition.notify_all();
+		}
+
+		void finish(Job* _job)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [_job] { return _job->m_done; });
+		}
+
+	protected:
+		virtual void run()
+		{
+			QProcess process;
+			const QStringList arguments = QStringList() << "-f" << "-C" << "-e" << QString::fromUtf8(m_binary.c_str());
+			process.setStandardErrorFile(QProcess::nullDevice());
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (;;)
+			{
+				m_condition.wait(lock, [this] { return m_quit || m_job; });
+				if (m_quit)
+					break;
+
+				Job* job = m_job;
+				lock.unlock();
+
+				// started on first job and again if the previous one failed
+				if (process.state() == QProcess::NotRunning)
+				{
+					process.start(m_program, arguments);
+					process.waitForStarted(-1);
+				}
+
+				job->m_success = stream(process, *job);
+				if (!job->m_success)
+				{
+					process.kill();
+					process.waitForFinished(-1);
+				}
+
+				lock.lock();
+				m_job		= NULL;
+				job->m_done	= true;
+				m_condition.notify_all();
+			}
+			lock.unlock();
+
+			if (process.state() == QProcess::NotRunning)
+				return;
+
+			// addr2line exits once stdin is closed
+			process.closeWriteChannel();
+			if (!process.waitForFinished(1000))
+			{
+				process.kill();
+				process.waitForFinished(-1);
+			}
+		}
+
+	private:
+		static bool stream(QProcess& _process, Job& _job)
+		{
+			if (_process.state() != QProcess::Running)
+				return false;
+
+			const uint32_t numLines = (_job.m_last - _job.m_first) * 2;
+			_job.m_lines.clear();
+			_job.m_lines.reserve(numLines);
+
+			// buffered input is written while waiting for output so neither pipe can fill up
+			_process.write(_job.m_input);
+			while (_job.m_lines.size() < numLines)
+			{
+				if (!_process.canReadLine() && !_process.waitForReadyRead(-1))
+					return false;
+
+				while ((_job.m_lines.size() < numLines) && _process.canReadLine())
+					_job.m_lines.push_back(_process.readLine());
+			}
+			return true;
+		}
+};
+
+GNUSymbolizer::~GNUSymbolizer()
+{
+	clear();
+}
+
+void GNUSymbolizer::clear()
+{
+	destroyWorkers();
+
+	for (Module& module : m_modules)
+		delete module.m_elf;
+
+	m_addr2line.clear();
+	m_modules.clear();
+	m_sortedModules.clear();
+}
+
+bool GNUSymbolizer::init(const rdebug::Toolchain& _tc, const char* _executable, const rdebug::ModuleInfo* _modules, uint32_t _numModules)
+{
+	clear();
+
+	if (_tc.m_type != rdebug::Toolchain::GCC)
+		return false;
+
+	// toolchain path may or may not already contain the prefix
+	const QString path = QString::fromUtf8(_tc.m_toolchainPath);
+	const QString candidates[] =
+	{
+		path + QString::fromUtf8(s_addr2lineName),
+		path + QString::fromUtf8(_tc.m_toolchainPrefix) + QString::fromUtf8(s_addr2lineName)
+	};
+
+	for (const QString& candidate : candidates)
+	{
+		if (QFileInfo(candidate).isFile())
+		{
+			m_addr2line = candidate.toUtf8().constData();
+			break;
+		}
+	}
+
+	const QFileInfo executable(QString::fromUtf8(_executable ? _executable : ""));
+
+	m_modules.resize(_numModules);
+	for (uint32_t i=0; i<_numModules; ++i)
+	{
+		const rdebug::ModuleInfo& info = _modules[i];
+		Module& module = m_modules[i];
+
+		const QFileInfo moduleFile(QString::fromUtf8(info.m_modulePath));
+		const QByteArray name = moduleFile.fileName().toUtf8();
+
+		module.m_name			= name.constData();
+		module.m_elf			= NULL;
+		module.m_loadBase		= info.m_baseAddress;
+		module.m_size			= info.m_size;
+		module.m_linkBase		= 0;
+		module.m_nameHash		= hashStr(name.constData());
+		module.m_isMTunerDLL	= moduleFile.fileName().contains("MTunerDLL", Qt::CaseInsensitive);
+
+		// user selected symbol source takes precedence over binary at the captured path
+		QString binary;
+		if (executable.isFile() && (executable.fileName().compare(moduleFile.fileName(), Qt::CaseInsensitive) == 0))
+			binary = executable.absoluteFilePath();
+		else
+		if (moduleFile.isFile())
+			binary = moduleFile.absoluteFilePath();
+
+		if (binary.isEmpty())
+			continue;
+
+		const QByteArray binaryUTF8 = binary.toUtf8();
+		if (getBinaryLinkBase(binaryUTF8.constData(), info.m_baseAddress, module.m_linkBase))
+			module.m_binary = binaryUTF8.constData();
+	}
+
+	// each binary is mapped and indexed on its own thread
+	QtConcurrent::blockingMap(m_modules.begin(), m_modules.end(), [](Module& _module)
+	{
+		if (_module.m_binary.empty())
+			return;
+
+		ELFSymbols* elf = new ELFSymbols();
+		if (elf->load(_module.m_binary.c_str()))
+			_module.m_elf = elf;
+		else
+			delete elf;
+	});
+
+	for (uint32_t i=0; i<_numModules; ++i)
+		if (m_modules[i].m_elf)
+			m_sortedModules.push_back(i);
+
+	std::sort(m_sortedModules.begin(), m_sortedModules.end(), [this](uint32_t _m1, uint32_t _m2)
+	{
+		return m_modules[_m1].m_loadBase < m_modules[_m2].m_loadBase;
+	});
+
+	return !m_addr2line.empty() || !m_sortedModules.empty();
+}
+
+bool GNUSymbolizer::canResolve(int32_t _moduleIndex) const
+{
+	if ((_moduleIndex < 0) || (_moduleIndex >= (int32_t)m_modules.size()))
+		return false;
+
+	const Module& module = m_modules[_moduleIndex];
+	return module.m_elf || (!module.m_binary.empty() && !m_addr2line.empty());
+}
+
+bool GNUSymbolizer::resolve(int32_t _moduleIndex, const uint64_t* _addresses, uint32_t _numAddresses, Symbol* _symbols) const
+{
+	if (!canResolve(_moduleIndex))
+		return false;
+
+	if (!_numAddresses)
+		return true;
+
+	const Module& module = m_modules[_moduleIndex];
+	if (!module.m_elf)
+		return resolveAddr2Line(module, _addresses, _numAddresses, _symbols);
+
+	resolveInProcess(module, _addresses, _numAddresses, _symbols);
+	return true;
+}
+
+bool GNUSymbolizer::getFrame(uint64_t _address, rdebug::StackFrame& _frame) const
+{
+	rtm_vector<uint32_t>::const_iterator it = std::upper_bound(m_sortedModules.begin(), m_sortedModules.end(), _address, [this](uint64_t _addr, uint32_t _module)
+	{
+		return _addr < m_modules[_module].m_loadBase;
+	});
+
+	if (it == m_sortedModules.begin())
+		return false;
+
+	const Module& module = m_modules[*(--it)];
+	if (_address >= module.m_loadBase + module.m_size)
+		return false;
+
+	Symbol symbol;
+	resolveInProcess(module, &_address, 1, &symbol);
+
+	rtm::strlCpy(_frame.m_moduleName,	RTM_NUM_ELEMENTS(_frame.m_moduleName),	module.m_name.c_str());
+	rtm::strlCpy(_frame.m_func,			RTM_NUM_ELEMENTS(_frame.m_func),		symbol.m_func.c_str());
+	rtm::strlCpy(_frame.m_file,			RTM_NUM_ELEMENTS(_frame.m_file),		symbol.m_file.c_str());
+	_frame.m_line = symbol.m_line;
+	return true;
+}
+
+void GNUSymbolizer::resolveInProcess(const Module& _module, const uint64_t* _addresses, uint32_t _numAddresses, Symbol* _symbols) const
+{
+	const uint32_t numBatches = (_numAddresses + MIN_BATCH_SIZE - 1) / MIN_BATCH_SIZE;
+
+	rtm_vector<uint32_t> batches(numBatches);
+	for (uint32_t b=0; b<numBatches; ++b)
+		batches[b] = b;
+
+	// lookups only read the index so batches need no synchronization
+	auto resolveBatch = [&](uint32_t& _batch)
+	{
+		const uint32_t first	= _batch * MIN_BATCH_SIZE;
+		const uint32_t last		= qMin(first + MIN_BATCH_SIZE, _numAddresses);
+
+		for (uint32_t i=first; i<last; ++i)
+		{
+			Symbol& symbol = _symbols[i];
+			symbol.m_isMTunerDLL = _module.m_isMTunerDLL;
+
+			ELFSymbols::Location location;
+			if (!_module.m_elf->find(_addresses[i] - _module.m_loadBase + _module.m_linkBase, location))
+			{
+				// same as addr2line, symbols without a name can not be merged with anything
+				symbol.m_func	= "??";
+				symbol.m_file	= "??";
+				symbol.m_line	= 0;
+				symbol.m_id		= _addresses[i];
+				continue;
+			}
+
+			symbol.m_func	= demangle(location.m_func, location.m_plainFunc);
+			symbol.m_file	= location.m_file;
+			symbol.m_line	= location.m_line;
+			symbol.m_id		= (_module.m_nameHash << 32) | hashStr(symbol.m_func.c_str());
+		}
+	};
+
+	if (numBatches == 1)
+		resolveBatch(batches[0]);
+	else
+		QtConcurrent::blockingMap(batches.begin(), batches.end(), resolveBatch);
+}
+
+bool GNUSymbolizer::resolveAddr2Line(const Module& _module, const uint64_t* _addresses, uint32_t _numAddresses, Symbol* _symbols) const
+{
+	const uint32_t maxWorkers = (uint32_t)qMax(1, QThread::idealThreadCount());
+
+	rtm_vector<Addr2LineWorker*> workers;
+	acquireWorkers(_module, qBound(1U, _numAddresses / MIN_BATCH_SIZE, maxWorkers), workers);
+
+	const uint32_t numWorkers	= (uint32_t)workers.size();
+	const uint32_t batchSize	= (_numAddresses + numWorkers - 1) / numWorkers;
+
+	// batches are handed to worker threads at once and collected in order
+	rtm_vector<Addr2LineWorker::Job> jobs(numWorkers);
+	for (uint32_t w=0; w<numWorkers; ++w)
+	{
+		Addr2LineWorker::Job& job = jobs[w];
+		job.m_first	= qMin(w * batchSize, _numAddresses);
+		job.m_last	= qMin(job.m_first + batchSize, _numAddresses);
+
+		job.m_input.reserve((job.m_last - job.m_first) * 20);
+		for (uint32_t i=job.m_first; i<job.m_last; ++i)
+		{
+			job.m_input += "0x";
+			job.m_input += QByteArray::number((qulonglong)(_addresses[i] - _module.m_loadBase + _module.m_linkBase), 16);
+			job.m_input += '\n';
+		}
+
+		workers[w]->submit(&job);
+	}
+
+	bool success = true;
+	for (uint32_t w=0; w<numWorkers; ++w)
+	{
+		Addr2LineWorker::Job& job = jobs[w];
+		workers[w]->finish(&job);
+
+		if (!job.m_success)
+		{
+			success = false;
+			continue;
+		}
+
+		for (uint32_t i=job.m_first; i<job.m_last; ++i)
+		{
+			Symbol& symbol = _symbols[i];
+			const uint32_t line = (i - job.m_first) * 2;
+			parseAddr2Line(job.m_lines[line], job.m_lines[line + 1], symbol);
+
+			// symbols without a name can not be merged with anything
+			if (symbol.m_func == "??")
+				symbol.m_id = _addresses[i];
+			else
+				symbol.m_id = (_module.m_nameHash << 32) | hashStr(symbol.m_func.c_str());
+
+			symbol.m_isMTunerDLL = _module.m_isMTunerDLL;
+		}
+	}
+
+	releaseWorkers(workers);
+	return success;
+}
+
+//--------------------------------------------------------------------------
+/// Takes up to _count idle workers for the module, waits if all are busy.
+/// Running workers of the same binary are preferred, then new ones while
+/// under the core count, then idle workers of other binaries are restarted.
+//--------------------------------------------------------------------------
+void GNUSymbolizer::acquireWorkers(const Module& _module, uint32_t _count, rtm_vector<Addr2LineWorker*>& _workers) const
+{
+	const uint32_t maxWorkers = (uint32_t)qMax(1, QThread::idealThreadCount());
+
+	std::unique_lock<std::mutex> lock(m_workersMutex);
+	for (;;)
+	{
+		for (Addr2LineWorker* worker : m_workers)
+			if ((_workers.size() < _count) && !worker->m_busy && (worker->getBinary() == _module.m_binary))
+			{
+				worker->m_busy = true;
+				_workers.push_back(worker);
+			}
+
+		while ((_workers.size() < _count) && (m_workers.size() < maxWorkers))
+		{
+			Addr2LineWorker* worker = new Addr2LineWorker(m_addr2line, _module.m_binary);
+			worker->m_busy = true;
+			m_workers.push_back(worker);
+			_workers.push_back(worker);
+		}
+
+		while (_workers.size() < _count)
+		{
+			size_t lru = m_workers.size();
+			for (size_t w=0; w<m_workers.size(); ++w)
+				if (!m_workers[w]->m_busy && ((lru == m_workers.size()) || (m_workers[w]->m_lastUse < m_workers[lru]->m_lastUse)))
+					lru = w;
+
+			if (lru == m_workers.size())
+				break;
+
+			delete m_workers[lru];
+			m_workers[lru] = new Addr2LineWorker(m_addr2line, _module.m_binary);
+			m_workers[lru]->m_busy = true;
+			_workers.push_back(m_workers[lru]);
+		}
+
+		if (!_workers.empty())
+			return;
+
+		m_workerReleased.wait(lock);
+	}
+}
+
+void GNUSymbolizer::releaseWorkers(const rtm_vector<Addr2LineWorker*>& _workers) const
+{
+	std::unique_lock<std::mutex> lock(m_workersMutex);
+	for (Addr2LineWorker* worker : _workers)
+	{
+		worker->m_busy		= false;
+		worker->m_lastUse	= ++m_workerUse;
+	}
+	m_workerReleased.notify_all();
+}
+
+void GNUSymbolizer::destroyWorkers()
+{
+	std::unique_lock<std::mutex> lock(m_workersMutex);
+	for (Addr2LineWorker* worker : m_workers)
+		delete worker;
+	m_workers.clear();
+}
+
+} // namespace rtm
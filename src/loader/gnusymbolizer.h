@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_GNUSYMBOLIZER_H__
+#define __RTM_MTUNER_GNUSYMBOLIZER_H__
+
+#include <condition_variable>
+#include <mutex>
+
+namespace rtm {
+
+class ELFSymbols;
+class Addr2LineWorker;
+
+//--------------------------------------------------------------------------
+/// Batch symbolization for GNU toolchains. ELF modules are resolved in
+/// process from their symbol tables and DWARF line tables, other modules
+/// are split between long lived addr2line processes. There is at most one
+/// process per core, shared by all modules, and batches are streamed to
+/// them over stdin so a process is started once per module, not per batch.
+//--------------------------------------------------------------------------
+class GNUSymbolizer
+{
+	public:
+		enum
+		{
+			MIN_BATCH_SIZE = 1024					///< Smaller batches are not worth another process or thread
+		};
+
+		struct Symbol
+		{
+			uint64_t	m_id;
+			bool		m_isMTunerDLL;
+			rtm_string	m_func;
+			rtm_string	m_file;
+			uint32_t	m_line;
+		};
+
+	private:
+		struct Module
+		{
+			rtm_string	m_binary;					///< Local binary passed to addr2line, empty if module can not be symbolized
+			rtm_string	m_name;
+			ELFSymbols*	m_elf;						///< In process symbols, NULL if binary is not a readable ELF
+			uint64_t	m_loadBase;
+			uint64_t	m_size;
+			uint64_t	m_linkBase;
+			uint64_t	m_nameHash;
+			bool		m_isMTunerDLL;
+		};
+
+		rtm_string				m_addr2line;			///< Empty if toolchain has no addr2line
+		rtm_vector<Module>		m_modules;				///< Same order as capture module infos
+		rtm_vector<uint32_t>	m_sortedModules;		///< Indices of in process modules sorted by load address
+
+		mutable std::mutex						m_workersMutex;
+		mutable std::condition_variable			m_workerReleased;
+		mutable rtm_vector<Addr2LineWorker*>	m_workers;		///< Running addr2line processes, at most one per core
+		mutable uint64_t						m_workerUse;	///< Incremented on each release, orders idle workers by last use
+
+	public:
+		GNUSymbolizer() : m_workerUse(0) {}
+		~GNUSymbolizer();
+
+		/// Returns false if toolchain has neither usable addr2line nor any ELF module that can be read in process
+		bool		init(const rdebug::Toolchain& _tc, const char* _executable, const rdebug::ModuleInfo* _modules, uint32_t _numModules);
+
+		bool		canResolve(int32_t _moduleIndex) const;
+		const char*	getModuleName(int32_t _moduleIndex) const { return m_modules[_moduleIndex].m_name.c_str(); }
+
+		/// Resolves all addresses of a single module, returns false if any of the batches failed
+		bool		resolve(int32_t _moduleIndex, const uint64_t* _addresses, uint32_t _numAddresses, Symbol* _symbols) const;
+
+		/// Resolves a single address of an in process module, returns false for other modules
+		bool		getFrame(uint64_t _address, rdebug::StackFrame& _frame) const;
+
+	private:
+		void		clear();
+		void		resolveInProcess(const Module& _module, const uint64_t* _addresses, uint32_t _numAddresses, Symbol* _symbols) const;
+		bool		resolveAddr2Line(const Module& _module, const uint64_t* _addresses, uint32_t _numAddresses, Symbol* _symbols) const;
+		void		acquireWorkers(const Module& _module, uint32_t _count, rtm_vector<Addr2LineWorker*>& _workers) const;
+		void		releaseWorkers(const rtm_vector<Addr2LineWorker*>& _workers) const;
+		void		destroyWorkers();
+};
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_GNUSYMBOLIZER_H__
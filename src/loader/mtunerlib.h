@@ -49,10 +49,9 @@ struct MemoryOperation
 	MemoryOperation*	m_chainNext;
 	StackTrace*			m_stackTrace;
 	uint64_t			m_operationTime;
-	uint32_t			m_indexMapping;
 	uint32_t			m_allocSize;
 	uint32_t			m_overhead;
-	uint16_t			m_tag;
+	uint32_t			m_tag;					//< Hash of the innermost memory tag
 	uint8_t				m_operationType : 7;
 	uint8_t				m_isValid		: 1;
 	uint8_t				m_alignment;
@@ -197,6 +196,7 @@ struct StackTrace
 	};
 
 	StackTrace**	m_next;
+	uint64_t*		m_moduleMask;		///< One bit per module (index into Capture module infos) present in the trace
 	uint64_t		m_numEntries;
 	int32_t			m_addedToTree[2];
 	uint64_t		m_entries[1];
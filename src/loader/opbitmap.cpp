@@ -0,0 +1,179 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/opbitmap.h>
+
+#include <algorithm>
+
+namespace rtm {
+
+static inline uint32_t opBitmapPopCount(uint64_t _word)
+{
+#if RTM_COMPILER_MSVC
+	return (uint32_t)__popcnt64(_word);
+#else
+	return (uint32_t)__builtin_popcountll(_word);
+#endif
+}
+
+bool OpBitmap::Container::contains(uint16_t _low) const
+{
+	if (isBitset())
+		return (m_bitset[_low >> 6] & (UINT64_C(1) << (_low & 63))) != 0;
+
+	return std::binary_search(m_array.begin(), m_array.end(), _low);
+}
+
+void OpBitmap::Container::convertToBitset()
+{
+	m_bitset.resize(BITSET_NUM_WORDS, 0);
+	for (uint16_t low : m_array)
+		m_bitset[low >> 6] |= UINT64_C(1) << (low & 63);
+	rtm_vector<uint16_t>().swap(m_array);
+}
+
+void OpBitmap::clear()
+{
+	m_containers.clear();
+	m_cardinality = 0;
+}
+
+void OpBitmap::append(uint32_t _index)
+{
+	const uint32_t key = _index >> CHUNK_BITS;
+	const uint16_t low = (uint16_t)(_index & CHUNK_MASK);
+
+	if (m_containers.empty() || (m_containers.back().m_key != key))
+	{
+		RTM_ASSERT(m_containers.empty() || (m_containers.back().m_key < key), "Indices must be appended in increasing order!");
+
+		Container container;
+		container.m_key			= key;
+		container.m_cardinality	= 0;
+		m_containers.emplace_back(container);
+	}
+
+	Container& container = m_containers.back();
+
+	if (container.isBitset())
+		container.m_bitset[low >> 6] |= UINT64_C(1) << (low & 63);
+	else
+	{
+		container.m_array.push_back(low);
+		if (container.m_array.size() > ARRAY_MAX_SIZE)
+			container.convertToBitset();
+	}
+
+	++container.m_cardinality;
+	++m_cardinality;
+}
+
+bool OpBitmap::contains(uint32_t _index) const
+{
+	const uint32_t key = _index >> CHUNK_BITS;
+
+	rtm_vector<Container>::const_iterator it = std::lower_bound(m_containers.begin(), m_containers.end(), key,
+		[](const Container& _container, uint32_t _key) { return _container.m_key < _key; });
+
+	if ((it == m_containers.end()) || (it->m_key != key))
+		return false;
+
+	return it->contains((uint16_t)(_index & CHUNK_MASK));
+}
+
+static void intersectContainers(const OpBitmap::Container& _c1, const OpBitmap::Container& _c2, OpBitmap::Container& _out)
+{
+	if (_c1.isBitset() && _c2.isBitset())
+	{
+		_out.m_bitset.resize(OpBitmap::BITSET_NUM_WORDS);
+		uint32_t cardinality = 0;
+		for (uint32_t w=0; w<OpBitmap::BITSET_NUM_WORDS; ++w)
+		{
+			_out.m_bitset[w] = _c1.m_bitset[w] & _c2.m_bitset[w];
+			cardinality += opBitmapPopCount(_out.m_bitset[w]);
+		}
+		_out.m_cardinality = cardinality;
+
+		// convert back to sorted array if sparse
+		if (cardinality <= OpBitmap::ARRAY_MAX_SIZE)
+		{
+			_out.m_array.reserve(cardinality);
+			for (uint32_t w=0; w<OpBitmap::BITSET_NUM_WORDS; ++w)
+			{
+				uint64_t word = _out.m_bitset[w];
+				while (word)
+				{
+					_out.m_array.push_back((uint16_t)(w*64 + opBitmapCountTrailingZeros(word)));
+					word &= word - 1;
+				}
+			}
+			rtm_vector<uint64_t>().swap(_out.m_bitset);
+		}
+		return;
+	}
+
+	if (!_c1.isBitset() && !_c2.isBitset())
+	{
+		_out.m_array.resize(std::min(_c1.m_array.size(), _c2.m_array.size()));
+		rtm_vector<uint16_t>::iterator end = std::set_intersection(	_c1.m_array.begin(), _c1.m_array.end(),
+																	_c2.m_array.begin(), _c2.m_array.end(),
+																	_out.m_array.begin());
+		_out.m_array.resize(end - _out.m_array.begin());
+		_out.m_cardinality = (uint32_t)_out.m_array.size();
+		return;
+	}
+
+	const OpBitmap::Container& arr = _c1.isBitset() ? _c2 : _c1;
+	const OpBitmap::Container& set = _c1.isBitset() ? _c1 : _c2;
+
+	_out.m_array.reserve(arr.m_array.size());
+	for (uint16_t low : arr.m_array)
+		if (set.contains(low))
+			_out.m_array.push_back(low);
+	_out.m_cardinality = (uint32_t)_out.m_array.size();
+}
+
+void OpBitmap::intersect(const OpBitmap& _bitmap1, const OpBitmap& _bitmap2, OpBitmap& _out)
+{
+	RTM_ASSERT((&_out != &_bitmap1) && (&_out != &_bitmap2), "Output bitmap must not alias the inputs!");
+
+	_out.clear();
+
+	const size_t numContainers1 = _bitmap1.m_containers.size();
+	const size_t numContainers2 = _bitmap2.m_containers.size();
+	size_t idx1 = 0;
+	size_t idx2 = 0;
+
+	while ((idx1 < numContainers1) && (idx2 < numContainers2))
+	{
+		const Container& c1 = _bitmap1.m_containers[idx1];
+		const Container& c2 = _bitmap2.m_containers[idx2];
+
+		if (c1.m_key < c2.m_key)
+			++idx1;
+		else
+		if (c2.m_key < c1.m_key)
+			++idx2;
+		else
+		{
+			Container container;
+			container.m_key			= c1.m_key;
+			container.m_cardinality	= 0;
+			intersectContainers(c1, c2, container);
+
+			if (container.m_cardinality)
+			{
+				_out.m_cardinality += container.m_cardinality;
+				_out.m_containers.emplace_back(std::move(container));
+			}
+
+			++idx1;
+			++idx2;
+		}
+	}
+}
+
+} // namespace rtm
@@ -0,0 +1,127 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_OPBITMAP_H__
+#define __RTM_MTUNER_OPBITMAP_H__
+
+#if RTM_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace rtm {
+
+static inline uint32_t opBitmapCountTrailingZeros(uint64_t _word)
+{
+#if RTM_COMPILER_MSVC
+	unsigned long index;
+	_BitScanForward64(&index, _word);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(_word);
+#endif
+}
+
+//--------------------------------------------------------------------------
+/// Compressed bitmap of memory operation indices. Indices are split into
+/// 64K chunks, each stored as a sorted array when sparse or as a plain
+/// bit set when dense (roaring bitmap layout).
+//--------------------------------------------------------------------------
+class OpBitmap
+{
+	public:
+		enum
+		{
+			CHUNK_BITS			= 16,
+			CHUNK_MASK			= (1 << CHUNK_BITS) - 1,
+			ARRAY_MAX_SIZE		= 4096,					///< Above this cardinality a bit set is smaller
+			BITSET_NUM_WORDS	= (1 << CHUNK_BITS) / 64
+		};
+
+		struct Container
+		{
+			uint32_t				m_key;				///< High bits shared by all indices in the container
+			uint32_t				m_cardinality;
+			rtm_vector<uint16_t>	m_array;			///< Sorted low bits, used for sparse containers
+			rtm_vector<uint64_t>	m_bitset;			///< Used for dense containers
+
+			inline bool isBitset() const { return m_bitset.size() != 0; }
+			bool contains(uint16_t _low) const;
+			void convertToBitset();
+		};
+
+	private:
+		rtm_vector<Container>	m_containers;			///< Sorted by key
+		uint32_t				m_cardinality;
+
+	public:
+		OpBitmap() : m_cardinality(0) {}
+
+		void		clear();
+		void		append(uint32_t _index);			///< Indices must be appended in increasing order
+		bool		contains(uint32_t _index) const;
+		uint32_t	getCardinality() const { return m_cardinality; }
+
+		/// Stores intersection of two bitmaps into output bitmap, output must not alias the inputs
+		static void intersect(const OpBitmap& _bitmap1, const OpBitmap& _bitmap2, OpBitmap& _out);
+
+		/// Calls _func for every index inside [_min, _max] range in increasing order
+		template <typename F>
+		void forEachInRange(uint32_t _min, uint32_t _max, F _func) const;
+};
+
+template <typename F>
+inline void OpBitmap::forEachInRange(uint32_t _min, uint32_t _max, F _func) const
+{
+	const uint32_t minKey = _min >> CHUNK_BITS;
+	const uint32_t maxKey = _max >> CHUNK_BITS;
+
+	const size_t numContainers = m_containers.size();
+	for (size_t c=0; c<numContainers; ++c)
+	{
+		const Container& container = m_containers[c];
+		if (container.m_key < minKey)
+			continue;
+		if (container.m_key > maxKey)
+			break;
+
+		const uint32_t base = container.m_key << CHUNK_BITS;
+
+		if (container.isBitset())
+		{
+			for (uint32_t w=0; w<BITSET_NUM_WORDS; ++w)
+			{
+				uint64_t word = container.m_bitset[w];
+				while (word)
+				{
+					const uint32_t index = base + w*64 + opBitmapCountTrailingZeros(word);
+					word &= word - 1;
+
+					if (index < _min)
+						continue;
+					if (index > _max)
+						return;
+					_func(index);
+				}
+			}
+		}
+		else
+		{
+			const size_t numEntries = container.m_array.size();
+			for (size_t i=0; i<numEntries; ++i)
+			{
+				const uint32_t index = base + container.m_array[i];
+				if (index < _min)
+					continue;
+				if (index > _max)
+					return;
+				_func(index);
+			}
+		}
+	}
+}
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_OPBITMAP_H__
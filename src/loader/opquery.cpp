@@ -0,0 +1,798 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/opquery.h>
+#include <MTuner/src/loader/capture.h>
+#include <MTuner/src/loader/util.h>
+#include <rbase/inc/hash.h>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <ctype.h>
+
+namespace rtm {
+
+/// Maximum number of 'stack contains' patterns in a single query
+static const uint32_t MAX_STACK_PATTERNS = 64;
+
+template <typename T, size_t N>
+static inline uint32_t numElements(T (&)[N])
+{
+	return (uint32_t)N;
+}
+
+static inline bool equalsNoCase(const char* _str1, const char* _str2)
+{
+	while (*_str1 && (tolower((unsigned char)*_str1) == tolower((unsigned char)*_str2)))
+	{
+		++_str1;
+		++_str2;
+	}
+	return tolower((unsigned char)*_str1) == tolower((unsigned char)*_str2);
+}
+
+//--------------------------------------------------------------------------
+/// Operation field accessors, shared by block and single operation paths
+//--------------------------------------------------------------------------
+static inline uint64_t getLifetime(const MemoryOperation* _op)
+{
+	return _op->m_chainNext ? _op->m_chainNext->m_operationTime - _op->m_operationTime : UINT64_MAX;
+}
+
+static inline uint64_t getField(const MemoryOperation* _op, uint32_t _field)
+{
+	switch (_field)
+	{
+		case OpQuery::Size:			return _op->m_allocSize;
+		case OpQuery::Overhead:		return _op->m_overhead;
+		case OpQuery::Alignment:	return _op->m_alignment;
+		case OpQuery::Time:			return _op->m_operationTime;
+		case OpQuery::Lifetime:		return getLifetime(_op);
+		case OpQuery::Thread:		return _op->m_threadID;
+		case OpQuery::Heap:			return _op->m_allocatorHandle;
+		case OpQuery::Tag:			return _op->m_tag;
+		case OpQuery::Type:			return _op->m_operationType;
+		case OpQuery::Leaked:		return isLeaked(_op) ? 1 : 0;
+	};
+	return 0;
+}
+
+template <typename F>
+static inline void gather(MemoryOperation* const* _ops, uint32_t _numOps, uint64_t* _column, F _get)
+{
+	for (uint32_t i=0; i<_numOps; ++i)
+		_column[i] = _get(_ops[i]);
+}
+
+static void gatherColumn(uint32_t _field, MemoryOperation* const* _ops, uint32_t _numOps, uint64_t* _column)
+{
+	switch (_field)
+	{
+		case OpQuery::Size:			gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return (uint64_t)_op->m_allocSize; }); break;
+		case OpQuery::Overhead:		gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return (uint64_t)_op->m_overhead; }); break;
+		case OpQuery::Alignment:	gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return (uint64_t)_op->m_alignment; }); break;
+		case OpQuery::Time:			gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return _op->m_operationTime; }); break;
+		case OpQuery::Lifetime:		gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return getLifetime(_op); }); break;
+		case OpQuery::Thread:		gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return _op->m_threadID; }); break;
+		case OpQuery::Heap:			gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return _op->m_allocatorHandle; }); break;
+		case OpQuery::Tag:			gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return (uint64_t)_op->m_tag; }); break;
+		case OpQuery::Type:			gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return (uint64_t)_op->m_operationType; }); break;
+		case OpQuery::Leaked:		gather(_ops, _numOps, _column, [](const MemoryOperation* _op) { return (uint64_t)(isLeaked(_op) ? 1 : 0); }); break;
+	};
+}
+
+//--------------------------------------------------------------------------
+/// Evaluates comparison over a column, loops are kept branch free so they vectorize
+//--------------------------------------------------------------------------
+static void compareColumn(const OpQuery::Instruction& _ins, const uint64_t* _values, const uint64_t* _column, uint32_t _numOps, uint8_t* _out)
+{
+	const uint64_t value	= _ins.m_value;
+	const uint64_t value2	= _ins.m_value2;
+
+	switch (_ins.m_code)
+	{
+		case OpQuery::Less:			for (uint32_t i=0; i<_numOps; ++i) _out[i] = _column[i] <  value; break;
+		case OpQuery::LessEqual:	for (uint32_t i=0; i<_numOps; ++i) _out[i] = _column[i] <= value; break;
+		case OpQuery::Greater:		for (uint32_t i=0; i<_numOps; ++i) _out[i] = _column[i] >  value; break;
+		case OpQuery::GreaterEqual:	for (uint32_t i=0; i<_numOps; ++i) _out[i] = _column[i] >= value; break;
+		case OpQuery::Equal:		for (uint32_t i=0; i<_numOps; ++i) _out[i] = _column[i] == value; break;
+		case OpQuery::NotEqual:		for (uint32_t i=0; i<_numOps; ++i) _out[i] = _column[i] != value; break;
+		case OpQuery::Between:		for (uint32_t i=0; i<_numOps; ++i) _out[i] = (_column[i] >= value) & (_column[i] <= value2); break;
+
+		case OpQuery::In:
+			memset(_out, 0, _numOps);
+			for (uint32_t v=0; v<_ins.m_count; ++v)
+			{
+				const uint64_t listValue = _values[_ins.m_index + v];
+				for (uint32_t i=0; i<_numOps; ++i)
+					_out[i] |= _column[i] == listValue;
+			}
+			break;
+	};
+}
+
+static inline bool compareValue(const OpQuery::Instruction& _ins, const uint64_t* _values, uint64_t _value)
+{
+	switch (_ins.m_code)
+	{
+		case OpQuery::Less:			return _value <  _ins.m_value;
+		case OpQuery::LessEqual:	return _value <= _ins.m_value;
+		case OpQuery::Greater:		return _value >  _ins.m_value;
+		case OpQuery::GreaterEqual:	return _value >= _ins.m_value;
+		case OpQuery::Equal:		return _value == _ins.m_value;
+		case OpQuery::NotEqual:		return _value != _ins.m_value;
+		case OpQuery::Between:		return (_value >= _ins.m_value) && (_value <= _ins.m_value2);
+		case OpQuery::In:
+			for (uint32_t v=0; v<_ins.m_count; ++v)
+				if (_values[_ins.m_index + v] == _value)
+					return true;
+			return false;
+	};
+	return false;
+}
+
+//--------------------------------------------------------------------------
+/// Case insensitive match with '*' and '?' wildcards
+//--------------------------------------------------------------------------
+static bool wildcardMatch(const char* _pattern, const char* _str)
+{
+	const char* starPattern	= NULL;
+	const char* starStr		= NULL;
+
+	while (*_str)
+	{
+		if ((*_pattern == '?') || ((*_pattern != '*') && (tolower((unsigned char)*_pattern) == tolower((unsigned char)*_str))))
+		{
+			++_pattern;
+			++_str;
+		}
+		else
+		if (*_pattern == '*')
+		{
+			starPattern	= _pattern++;
+			starStr		= _str;
+		}
+		else
+		if (starPattern)
+		{
+			_pattern	= starPattern + 1;
+			_str		= ++starStr;
+		}
+		else
+			return false;
+	}
+
+	while (*_pattern == '*')
+		++_pattern;
+
+	return *_pattern == '\0';
+}
+
+//--------------------------------------------------------------------------
+/// Recursive descent query parser emitting postfix instructions
+//--------------------------------------------------------------------------
+struct QueryParser
+{
+	enum TokenType
+	{
+		TokenEnd,
+		TokenIdentifier,
+		TokenNumber,
+		TokenString,
+		TokenSymbol
+	};
+
+	const char*							m_text;
+	const char*							m_pos;
+	TokenType							m_type;
+	const char*							m_tokenStart;
+	uint32_t							m_tokenLength;
+	uint64_t							m_integer;
+	double								m_number;
+	bool								m_isInteger;
+	rtm_string							m_string;
+	rtm_string&							m_error;
+	rtm_vector<OpQuery::Instruction>&	m_program;
+	rtm_vector<uint64_t>&				m_values;
+	rtm_vector<rtm_string>&				m_patterns;
+
+	QueryParser(const char* _text, rtm_string& _error, rtm_vector<OpQuery::Instruction>& _program, rtm_vector<uint64_t>& _values, rtm_vector<rtm_string>& _patterns)
+		: m_text(_text)
+		, m_pos(_text)
+		, m_type(TokenEnd)
+		, m_tokenStart(_text)
+		, m_tokenLength(0)
+		, m_integer(0)
+		, m_number(0.0)
+		, m_isInteger(false)
+		, m_error(_error)
+		, m_program(_program)
+		, m_values(_values)
+		, m_patterns(_patterns)
+	{
+	}
+
+	bool fail(const char* _message)
+	{
+		char position[32];
+		sprintf(position, " (at character %d)", (int)(m_tokenStart - m_text) + 1);
+		m_error = _message;
+		m_error += position;
+		return false;
+	}
+
+	bool next()
+	{
+		while (isspace((unsigned char)*m_pos))
+			++m_pos;
+
+		m_tokenStart	= m_pos;
+		m_tokenLength	= 0;
+
+		const char c = *m_pos;
+
+		if (c == '\0')
+		{
+			m_type = TokenEnd;
+			return true;
+		}
+
+		if (isalpha((unsigned char)c) || (c == '_'))
+		{
+			while (isalnum((unsigned char)*m_pos) || (*m_pos == '_'))
+				++m_pos;
+			m_type = TokenIdentifier;
+		}
+		else
+		if (isdigit((unsigned char)c) || ((c == '.') && isdigit((unsigned char)m_pos[1])))
+		{
+			char* end;
+			if ((c == '0') && ((m_pos[1] == 'x') || (m_pos[1] == 'X')))
+			{
+				m_integer	= strtoull(m_pos, &end, 16);
+				m_number	= (double)m_integer;
+				m_isInteger	= true;
+			}
+			else
+			{
+				m_number	= strtod(m_pos, &end);
+				m_integer	= strtoull(m_pos, NULL, 10);
+				m_isInteger	= strcspn(m_pos, ".eE") >= (size_t)(end - m_pos);
+			}
+			m_pos	= end;
+			m_type	= TokenNumber;
+		}
+		else
+		if ((c == '"') || (c == '\''))
+		{
+			const char* end = strchr(m_pos + 1, c);
+			if (!end)
+				return fail("Unterminated string");
+			m_string.assign(m_pos + 1, end - m_pos - 1);
+			m_pos	= end + 1;
+			m_type	= TokenString;
+		}
+		else
+		{
+			static const char* symbols[] = { "<=", ">=", "==", "!=", "<", ">", "=", "(", ")", "," };
+			for (const char* symbol : symbols)
+			{
+				const size_t len = strlen(symbol);
+				if (strncmp(m_pos, symbol, len) == 0)
+				{
+					m_pos	+= len;
+					m_type	= TokenSymbol;
+					break;
+				}
+			}
+
+			if (m_pos == m_tokenStart)
+				return fail("Unexpected character");
+		}
+
+		m_tokenLength = (uint32_t)(m_pos - m_tokenStart);
+		return true;
+	}
+
+	bool is(const char* _token) const
+	{
+		if ((m_type != TokenIdentifier) && (m_type != TokenSymbol))
+			return false;
+
+		const size_t len = strlen(_token);
+		if (len != m_tokenLength)
+			return false;
+
+		for (size_t i=0; i<len; ++i)
+			if (tolower((unsigned char)m_tokenStart[i]) != _token[i])
+				return false;
+
+		return true;
+	}
+
+	bool expect(const char* _token, const char* _message)
+	{
+		if (!is(_token))
+			return fail(_message);
+		return next();
+	}
+
+	void addInstruction(uint8_t _code, uint8_t _field = OpQuery::NumFields, uint64_t _value = 0, uint64_t _value2 = 0, uint32_t _index = 0, uint32_t _count = 0)
+	{
+		OpQuery::Instruction ins;
+		ins.m_code		= _code;
+		ins.m_field		= _field;
+		ins.m_index		= _index;
+		ins.m_count		= _count;
+		ins.m_value		= _value;
+		ins.m_value2	= _value2;
+		m_program.push_back(ins);
+	}
+
+	bool parseQuery()
+	{
+		if (!parseAnd())
+			return false;
+
+		while (is("or"))
+		{
+			if (!next() || !parseAnd())
+				return false;
+			addInstruction(OpQuery::Or);
+		}
+		return true;
+	}
+
+	bool parseAnd()
+	{
+		if (!parseTerm())
+			return false;
+
+		while (is("and"))
+		{
+			if (!next() || !parseTerm())
+				return false;
+			addInstruction(OpQuery::And);
+		}
+		return true;
+	}
+
+	bool parseField(uint8_t& _field)
+	{
+		static const char* fields[] = { "size", "overhead", "alignment", "time", "lifetime", "thread", "heap", "tag", "type" };
+		for (uint8_t f=0; f<numElements(fields); ++f)
+			if (is(fields[f]))
+			{
+				_field = f;
+				return next();
+			}
+
+		return fail("Expected field name (size, overhead, alignment, time, lifetime, thread, heap, tag or type)");
+	}
+
+	bool parseUnit(const char* const* _units, const double* _scales, uint32_t _numUnits, double& _scale)
+	{
+		for (uint32_t u=0; u<_numUnits; ++u)
+			if (is(_units[u]))
+			{
+				_scale = _scales[u];
+				return next();
+			}
+		return true;
+	}
+
+	bool parseValue(uint8_t _field, uint64_t& _value)
+	{
+		switch (_field)
+		{
+			case OpQuery::Size:
+			case OpQuery::Overhead:
+			case OpQuery::Alignment:
+				{
+					if (m_type != TokenNumber)
+						return fail("Expected size");
+
+					static const char*	units[]		= { "b", "kb", "mb", "gb" };
+					static const double	scales[]	= { 1.0, 1024.0, 1024.0*1024.0, 1024.0*1024.0*1024.0 };
+
+					const double number = m_number;
+					double scale = 1.0;
+					if (!next() || !parseUnit(units, scales, numElements(units), scale))
+						return false;
+
+					_value = (uint64_t)(number * scale + 0.5);
+					return true;
+				}
+
+			case OpQuery::Time:
+			case OpQuery::Lifetime:
+				{
+					if (m_type != TokenNumber)
+						return fail("Expected time");
+
+					// kept in nanoseconds until bound to capture CPU frequency
+					static const char*	units[]		= { "ns", "us", "ms", "s" };
+					static const double	scales[]	= { 1.0, 1000.0, 1000.0*1000.0, 1000.0*1000.0*1000.0 };
+
+					const double number = m_number;
+					double scale = 1000.0*1000.0*1000.0;
+					if (!next() || !parseUnit(units, scales, numElements(units), scale))
+						return false;
+
+					_value = (uint64_t)(number * scale + 0.5);
+					return true;
+				}
+
+			case OpQuery::Thread:
+			case OpQuery::Heap:
+				if ((m_type != TokenNumber) || !m_isInteger)
+					return fail("Expected integer value");
+				_value = m_integer;
+				return next();
+
+			case OpQuery::Tag:
+				if (m_type == TokenString)
+					_value = hashStr(m_string.c_str());
+				else
+				if ((m_type == TokenNumber) && m_isInteger)
+					_value = m_integer;
+				else
+					return fail("Expected tag name");
+				return next();
+
+			case OpQuery::Type:
+				{
+					static const char* types[] = { "alloc", "alloc_aligned", "calloc", "free", "realloc", "realloc_aligned" };
+					static const uint64_t codes[] = {	rmem::LogMarkers::OpAlloc,
+														rmem::LogMarkers::OpAllocAligned,
+														rmem::LogMarkers::OpCalloc,
+														rmem::LogMarkers::OpFree,
+														rmem::LogMarkers::OpRealloc,
+														rmem::LogMarkers::OpReallocAligned };
+
+					const rtm_string name = (m_type == TokenString) ? m_string : rtm_string(m_tokenStart, m_tokenLength);
+					for (uint32_t t=0; t<numElements(types); ++t)
+						if (equalsNoCase(name.c_str(), types[t]))
+						{
+							_value = codes[t];
+							return next();
+						}
+
+					return fail("Expected operation type (alloc, alloc_aligned, calloc, free, realloc or realloc_aligned)");
+				}
+		};
+
+		return fail("Field has no value");
+	}
+
+	bool parseTerm()
+	{
+		if (is("not"))
+		{
+			if (!next() || !parseTerm())
+				return false;
+			addInstruction(OpQuery::Not);
+			return true;
+		}
+
+		if (is("("))
+		{
+			if (!next() || !parseQuery())
+				return false;
+			return expect(")", "Expected ')'");
+		}
+
+		if (is("leaked"))
+		{
+			addInstruction(OpQuery::NotEqual, OpQuery::Leaked, 0);
+			return next();
+		}
+
+		if (is("stack"))
+		{
+			if (!next() || !expect("contains", "Expected 'contains'"))
+				return false;
+
+			if (m_type != TokenString)
+				return fail("Expected function name pattern string");
+
+			if (m_patterns.size() == MAX_STACK_PATTERNS)
+				return fail("Too many stack patterns");
+
+			// a pattern without wildcards matches any part of function name
+			rtm_string pattern = m_string;
+			if (pattern.find_first_of("*?") == rtm_string::npos)
+				pattern = "*" + pattern + "*";
+
+			addInstruction(OpQuery::Contains, OpQuery::Stack, 0, 0, (uint32_t)m_patterns.size());
+			m_patterns.push_back(pattern);
+			return next();
+		}
+
+		uint8_t field;
+		if (!parseField(field))
+			return false;
+
+		if (is("between"))
+		{
+			uint64_t minValue, maxValue;
+			if (!next() || !parseValue(field, minValue) ||
+				!expect("and", "Expected 'and'") || !parseValue(field, maxValue))
+				return false;
+
+			addInstruction(OpQuery::Between, field, minValue, maxValue);
+			return true;
+		}
+
+		if (is("in"))
+		{
+			if (!next() || !expect("(", "Expected '('"))
+				return false;
+
+			const uint32_t index = (uint32_t)m_values.size();
+			for (;;)
+			{
+				uint64_t value;
+				if (!parseValue(field, value))
+					return false;
+				m_values.push_back(value);
+
+				if (!is(","))
+					break;
+				if (!next())
+					return false;
+			}
+
+			if (!expect(")", "Expected ')'"))
+				return false;
+
+			addInstruction(OpQuery::In, field, 0, 0, index, (uint32_t)m_values.size() - index);
+			return true;
+		}
+
+		static const char*		compares[]	= { "<", "<=", ">", ">=", "=", "==", "!=" };
+		static const uint8_t	codes[]		= { OpQuery::Less, OpQuery::LessEqual, OpQuery::Greater, OpQuery::GreaterEqual, OpQuery::Equal, OpQuery::Equal, OpQuery::NotEqual };
+
+		for (uint32_t c=0; c<numElements(compares); ++c)
+			if (is(compares[c]))
+			{
+				uint64_t value;
+				if (!next() || !parseValue(field, value))
+					return false;
+
+				addInstruction(codes[c], field, value);
+				return true;
+			}
+
+		return fail("Expected comparison, 'between' or 'in'");
+	}
+};
+
+//--------------------------------------------------------------------------
+/// Compiles query text to predicate program
+//--------------------------------------------------------------------------
+bool OpQuery::compile(const char* _query, rtm_string& _error)
+{
+	m_text = _query;
+	m_program.clear();
+	m_values.clear();
+	m_patterns.clear();
+	m_patternTraces.clear();
+	m_matches.clear();
+
+	QueryParser parser(_query, _error, m_program, m_values, m_patterns);
+
+	if (!parser.next())
+		return false;
+
+	if (parser.m_type == QueryParser::TokenEnd)
+		return parser.fail("Query is empty");
+
+	if (!parser.parseQuery())
+		return false;
+
+	if (parser.m_type != QueryParser::TokenEnd)
+		return parser.fail("Unexpected input after the end of query");
+
+	// intermediate results are kept in fixed size buffers during evaluation
+	uint32_t depth = 0;
+	for (const Instruction& ins : m_program)
+	{
+		if ((ins.m_code == And) || (ins.m_code == Or))
+			--depth;
+		else
+		if (ins.m_code != Not)
+			++depth;
+
+		if (depth > MAX_DEPTH)
+		{
+			_error = "Query is too complex";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/// Binds query values to capture data
+//--------------------------------------------------------------------------
+bool OpQuery::bind(uint64_t _CPUFrequency, SymbolIndex& _symbolIndex, Capture* _capture, uintptr_t _symResolver,
+				   const std::atomic<uint32_t>* _version, uint32_t _expectedVersion)
+{
+	const double clocksPerNs = double(_CPUFrequency) / (1000.0*1000.0*1000.0);
+
+	for (Instruction& ins : m_program)
+	{
+		if ((ins.m_field != Time) && (ins.m_field != Lifetime))
+			continue;
+
+		if (ins.m_code == In)
+		{
+			for (uint32_t v=0; v<ins.m_count; ++v)
+				m_values[ins.m_index + v] = (uint64_t)(double(m_values[ins.m_index + v]) * clocksPerNs);
+		}
+		else
+		{
+			ins.m_value		= (uint64_t)(double(ins.m_value) * clocksPerNs);
+			ins.m_value2	= (uint64_t)(double(ins.m_value2) * clocksPerNs);
+		}
+	}
+
+	m_patternTraces.clear();
+	m_patternTraces.resize(m_patterns.size());
+
+	if (m_patterns.empty() || !_symResolver)
+		return true;
+
+	// names are resolved once per capture, index gives stack traces containing each symbol
+	if (!_symbolIndex.resolveNames(_capture, _symResolver, _version, _expectedVersion))
+		return false;
+
+	const uint32_t numSymbols = _symbolIndex.getNumSymbols();
+	for (uint32_t s=0; s<numSymbols; ++s)
+	{
+		const SymbolIndex::Entry& entry = _symbolIndex.getEntry(s);
+
+		for (size_t p=0; p<m_patterns.size(); ++p)
+			if (wildcardMatch(m_patterns[p].c_str(), entry.m_name.c_str()))
+				m_patternTraces[p].insert(m_patternTraces[p].end(), entry.m_stackTraces.begin(), entry.m_stackTraces.end());
+	}
+
+	// stack trace containing several matching symbols is added once per symbol
+	for (rtm_vector<StackTrace*>& traces : m_patternTraces)
+	{
+		std::sort(traces.begin(), traces.end());
+		traces.erase(std::unique(traces.begin(), traces.end()), traces.end());
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------
+/// Runs the program over all operations in blocks, on multiple threads
+//--------------------------------------------------------------------------
+void OpQuery::evaluate(const rtm_vector<MemoryOperation*>& _operations)
+{
+	m_matches.clear();
+
+	const uint32_t numOps = (uint32_t)_operations.size();
+	if (!numOps)
+		return;
+
+	rtm_vector<uint8_t> result(numOps);
+
+	const uint32_t numBlocks = (numOps + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	rtm_vector<uint32_t> blocks(numBlocks);
+	for (uint32_t b=0; b<numBlocks; ++b)
+		blocks[b] = b;
+
+	QtConcurrent::blockingMap(blocks.begin(), blocks.end(), [this, &_operations, &result, numOps](uint32_t& _block)
+	{
+		const uint32_t start = _block * BLOCK_SIZE;
+		evaluateBlock(&_operations[start], qMin((uint32_t)BLOCK_SIZE, numOps - start), &result[start]);
+	});
+
+	for (uint32_t i=0; i<numOps; ++i)
+		if (result[i])
+			m_matches.append(i);
+}
+
+void OpQuery::evaluateBlock(MemoryOperation* const* _ops, uint32_t _numOps, uint8_t* _result) const
+{
+	uint64_t	column[BLOCK_SIZE];
+	uint8_t		stack[MAX_DEPTH][BLOCK_SIZE];
+	uint32_t	top = 0;
+
+	const uint64_t* values = m_values.data();
+
+	for (const Instruction& ins : m_program)
+	{
+		switch (ins.m_code)
+		{
+			case And:
+				{
+					--top;
+					uint8_t* a = stack[top-1];
+					const uint8_t* b = stack[top];
+					for (uint32_t i=0; i<_numOps; ++i)
+						a[i] &= b[i];
+				}
+				break;
+
+			case Or:
+				{
+					--top;
+					uint8_t* a = stack[top-1];
+					const uint8_t* b = stack[top];
+					for (uint32_t i=0; i<_numOps; ++i)
+						a[i] |= b[i];
+				}
+				break;
+
+			case Not:
+				{
+					uint8_t* a = stack[top-1];
+					for (uint32_t i=0; i<_numOps; ++i)
+						a[i] ^= 1;
+				}
+				break;
+
+			case Contains:
+				{
+					uint8_t* out = stack[top++];
+					for (uint32_t i=0; i<_numOps; ++i)
+						out[i] = stackMatches(ins.m_index, _ops[i]->m_stackTrace) ? 1 : 0;
+				}
+				break;
+
+			default:
+				gatherColumn(ins.m_field, _ops, _numOps, column);
+				compareColumn(ins, values, column, _numOps, stack[top++]);
+				break;
+		};
+	}
+
+	RTM_ASSERT(top == 1, "Invalid query program!");
+	memcpy(_result, stack[0], _numOps);
+}
+
+//--------------------------------------------------------------------------
+/// Evaluates the program for a single operation
+//--------------------------------------------------------------------------
+bool OpQuery::matches(const MemoryOperation* _op) const
+{
+	bool		stack[MAX_DEPTH];
+	uint32_t	top = 0;
+
+	const uint64_t* values = m_values.data();
+
+	for (const Instruction& ins : m_program)
+	{
+		switch (ins.m_code)
+		{
+			case And:		--top; stack[top-1] = stack[top-1] && stack[top];	break;
+			case Or:		--top; stack[top-1] = stack[top-1] || stack[top];	break;
+			case Not:		stack[top-1] = !stack[top-1];						break;
+			case Contains:	stack[top++] = stackMatches(ins.m_index, _op->m_stackTrace); break;
+			default:		stack[top++] = compareValue(ins, values, getField(_op, ins.m_field)); break;
+		};
+	}
+
+	RTM_ASSERT(top == 1, "Invalid query program!");
+	return stack[0];
+}
+
+bool OpQuery::stackMatches(uint32_t _pattern, const StackTrace* _trace) const
+{
+	if (_pattern >= m_patternTraces.size())
+		return false;
+
+	const rtm_vector<StackTrace*>& traces = m_patternTraces[_pattern];
+	return std::binary_search(traces.begin(), traces.end(), _trace);
+}
+
+} // namespace rtm
@@ -0,0 +1,120 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_OPQUERY_H__
+#define __RTM_MTUNER_OPQUERY_H__
+
+#include <MTuner/src/loader/opbitmap.h>
+#include <MTuner/src/loader/symbolindex.h>
+
+#include <atomic>
+
+namespace rtm {
+
+class Capture;
+
+//--------------------------------------------------------------------------
+/// Memory operation query compiled to a postfix predicate program.
+///
+/// Syntax:
+///   query  := term { ('and' | 'or') term }       'and' binds tighter than 'or'
+///   term   := 'not' term | '(' query ')' | 'leaked'
+///           | field cmp value
+///           | field 'between' value 'and' value
+///           | field 'in' '(' value { ',' value } ')'
+///           | 'stack' 'contains' string
+///   field  := size | overhead | alignment | time | lifetime | thread | heap | tag | type
+///   cmp    := '<' | '<=' | '>' | '>=' | '=' | '==' | '!='
+///
+/// Sizes accept b/kb/mb/gb units, times accept ns/us/ms/s units (seconds
+/// by default). Stack patterns match function names, '*' and '?' are
+/// wildcards and a pattern without wildcards matches any part of a name.
+///
+/// Example: size between 64 and 4kb and lifetime < 1ms and stack contains "Json*"
+//--------------------------------------------------------------------------
+class OpQuery
+{
+	public:
+		enum Field
+		{
+			Size,
+			Overhead,
+			Alignment,
+			Time,
+			Lifetime,					///< Time until block is freed or reallocated, maximum for live blocks
+			Thread,
+			Heap,
+			Tag,
+			Type,
+			Leaked,
+			Stack,
+
+			NumFields
+		};
+
+		enum Code
+		{
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual,
+			Equal,
+			NotEqual,
+			Between,
+			In,
+			Contains,
+			And,
+			Or,
+			Not
+		};
+
+		enum
+		{
+			BLOCK_SIZE	= 1024,			///< Operations evaluated together by a single program pass
+			MAX_DEPTH	= 16			///< Maximum number of intermediate results
+		};
+
+		struct Instruction
+		{
+			uint8_t		m_code;
+			uint8_t		m_field;
+			uint32_t	m_index;		///< First value in m_values for In, pattern index for Contains
+			uint32_t	m_count;		///< Number of values for In
+			uint64_t	m_value;
+			uint64_t	m_value2;		///< Upper bound for Between
+		};
+
+	private:
+		rtm_string						m_text;
+		rtm_vector<Instruction>			m_program;
+		rtm_vector<uint64_t>			m_values;
+		rtm_vector<rtm_string>			m_patterns;
+		rtm_vector<rtm_vector<StackTrace*> > m_patternTraces;	///< Sorted stack traces matching each pattern
+		OpBitmap						m_matches;
+
+	public:
+		/// Parses the query, on failure returns false and describes the problem in _error
+		bool				compile(const char* _query, rtm_string& _error);
+
+		/// Converts time values to clocks and resolves stack patterns to stack traces using the symbol index.
+		/// Returns false if *_version stops matching _expectedVersion, query is left partially bound then.
+		bool				bind(uint64_t _CPUFrequency, SymbolIndex& _symbolIndex, Capture* _capture, uintptr_t _symResolver,
+							     const std::atomic<uint32_t>* _version = NULL, uint32_t _expectedVersion = 0);
+
+		/// Stores indices of all matching operations, see getMatches
+		void				evaluate(const rtm_vector<MemoryOperation*>& _operations);
+
+		bool				matches(const MemoryOperation* _op) const;
+		const OpBitmap&		getMatches() const { return m_matches; }
+		const rtm_string&	getText() const { return m_text; }
+
+	private:
+		void				evaluateBlock(MemoryOperation* const* _ops, uint32_t _numOps, uint8_t* _result) const;
+		bool				stackMatches(uint32_t _pattern, const StackTrace* _trace) const;
+};
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_OPQUERY_H__
@@ -0,0 +1,245 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/radixsort.h>
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QThread>
+
+#include <algorithm>
+
+namespace rtm {
+
+enum
+{
+	RADIX_BITS				= 8,
+	RADIX_BUCKETS			= 1 << RADIX_BITS,
+	WINDOW_BITS				= 32,
+	WINDOW_PASSES			= WINDOW_BITS / RADIX_BITS,
+	MIN_ITEMS_PER_CHUNK		= 64*1024
+};
+
+struct RadixChunk
+{
+	uint32_t	m_first;
+	uint32_t	m_last;
+	uint32_t	m_offsets[RADIX_BUCKETS];	///< Histogram, then scatter position of each bucket
+	uint64_t	m_orKeys;					///< Bits set in any key of the chunk
+	uint64_t	m_andKeys;					///< Bits set in all keys of the chunk
+};
+
+struct KeyChunk
+{
+	uint32_t				m_first;
+	uint32_t				m_last;
+	rtm_vector<uint32_t>	m_top;		///< Heap of best items, worst one at the front
+};
+
+static inline uint32_t getDigit(uint64_t _key, uint32_t _pass)
+{
+	return (uint32_t)(_key >> (_pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+static uint64_t getStoredKey(const void* _keys, uint32_t _index)
+{
+	return ((const uint64_t*)_keys)[_index];
+}
+
+template <typename Chunk>
+static void splitChunks(rtm_vector<Chunk>& _chunks, uint32_t _count)
+{
+	const uint32_t maxChunks	= (uint32_t)qMax(1, QThread::idealThreadCount());
+	const uint32_t numChunks	= qBound(1U, _count / MIN_ITEMS_PER_CHUNK, maxChunks);
+	const uint32_t chunkSize	= (_count + numChunks - 1) / numChunks;
+
+	_chunks.resize(numChunks);
+	for (uint32_t c=0; c<numChunks; ++c)
+	{
+		_chunks[c].m_first	= c * chunkSize;
+		_chunks[c].m_last	= qMin(_count, (c + 1) * chunkSize);
+	}
+}
+
+void radixSort(uint32_t* _indices, const uint64_t* _keys, uint32_t _count)
+{
+	radixSort(_indices, _count, getStoredKey, _keys);
+}
+
+void extractKeys(uint64_t* _keys, uint32_t _count, RadixKeyFunc _key, const void* _data)
+{
+	rtm_vector<KeyChunk> chunks;
+	splitChunks(chunks, _count);
+
+	QtConcurrent::blockingMap(chunks.begin(), chunks.end(), [_keys, _key, _data](KeyChunk& _chunk)
+	{
+		for (uint32_t i=_chunk.m_first; i<_chunk.m_last; ++i)
+			_keys[i] = _key(_data, i);
+	});
+}
+
+uint32_t sortTopKeys(uint32_t* _indices, uint32_t _numIndices, const uint64_t* _keys, uint32_t _count, bool _descending)
+{
+	const uint32_t numTop = qMin(_numIndices, _count);
+	if (!numTop)
+		return 0;
+
+	// equal keys keep item order, reversed when descending
+	auto before = [_keys, _descending](uint32_t _i1, uint32_t _i2)
+	{
+		const uint64_t k1 = _keys[_i1];
+		const uint64_t k2 = _keys[_i2];
+		if (k1 != k2)
+			return _descending ? (k1 > k2) : (k1 < k2);
+		return _descending ? (_i1 > _i2) : (_i1 < _i2);
+	};
+
+	rtm_vector<KeyChunk> chunks;
+	splitChunks(chunks, _count);
+
+	QtConcurrent::blockingMap(chunks.begin(), chunks.end(), [numTop, &before](KeyChunk& _chunk)
+	{
+		rtm_vector<uint32_t>& top = _chunk.m_top;
+		top.reserve(numTop);
+		for (uint32_t i=_chunk.m_first; i<_chunk.m_last; ++i)
+		{
+			if (top.size() < numTop)
+			{
+				top.push_back(i);
+				std::push_heap(top.begin(), top.end(), before);
+			}
+			else
+			if (before(i, top.front()))
+			{
+				std::pop_heap(top.begin(), top.end(), before);
+				top.back() = i;
+				std::push_heap(top.begin(), top.end(), before);
+			}
+		}
+	});
+
+	rtm_vector<uint32_t> candidates;
+	for (const KeyChunk& chunk : chunks)
+		candidates.insert(candidates.end(), chunk.m_top.begin(), chunk.m_top.end());
+
+	std::partial_sort(candidates.begin(), candidates.begin() + numTop, candidates.end(), before);
+	memcpy(_indices, candidates.data(), sizeof(uint32_t) * numTop);
+	return numTop;
+}
+
+//--------------------------------------------------------------------------
+/// Sorts items with 32bit key window above the item index, stable as index
+/// bits never take part. Returns buffer holding the sorted items.
+//--------------------------------------------------------------------------
+static uint64_t* sortWindow(rtm_vector<RadixChunk>& _chunks, uint64_t* _items, uint64_t* _scratch, uint32_t _varyingBits)
+{
+	uint64_t* src = _items;
+	uint64_t* dst = _scratch;
+
+	for (uint32_t pass=0; pass<WINDOW_PASSES; ++pass)
+	{
+		if (getDigit(_varyingBits, pass) == 0)
+			continue;
+
+		const uint32_t digit = WINDOW_BITS / RADIX_BITS + pass;
+
+		QtConcurrent::blockingMap(_chunks.begin(), _chunks.end(), [src, digit](RadixChunk& _chunk)
+		{
+			memset(_chunk.m_offsets, 0, sizeof(_chunk.m_offsets));
+			for (uint32_t i=_chunk.m_first; i<_chunk.m_last; ++i)
+				++_chunk.m_offsets[getDigit(src[i], digit)];
+		});
+
+		// bucket major, chunk minor keeps the sort stable
+		uint32_t offset = 0;
+		for (uint32_t b=0; b<RADIX_BUCKETS; ++b)
+			for (RadixChunk& chunk : _chunks)
+			{
+				const uint32_t count = chunk.m_offsets[b];
+				chunk.m_offsets[b] = offset;
+				offset += count;
+			}
+
+		QtConcurrent::blockingMap(_chunks.begin(), _chunks.end(), [src, dst, digit](RadixChunk& _chunk)
+		{
+			for (uint32_t i=_chunk.m_first; i<_chunk.m_last; ++i)
+				dst[_chunk.m_offsets[getDigit(src[i], digit)]++] = src[i];
+		});
+
+		qSwap(src, dst);
+	}
+
+	return src;
+}
+
+void radixSort(uint32_t* _indices, uint32_t _count, RadixKeyFunc _key, const void* _data)
+{
+	if (!_count)
+		return;
+
+	rtm_vector<RadixChunk> chunks;
+	splitChunks(chunks, _count);
+
+	QtConcurrent::blockingMap(chunks.begin(), chunks.end(), [_indices, _key, _data](RadixChunk& _chunk)
+	{
+		uint64_t orKeys		= 0;
+		uint64_t andKeys	= ~0ULL;
+		for (uint32_t i=_chunk.m_first; i<_chunk.m_last; ++i)
+		{
+			const uint64_t key = _key(_data, i);
+			orKeys	|= key;
+			andKeys	&= key;
+			_indices[i] = i;
+		}
+		_chunk.m_orKeys		= orKeys;
+		_chunk.m_andKeys	= andKeys;
+	});
+
+	uint64_t orKeys		= 0;
+	uint64_t andKeys	= ~0ULL;
+	for (const RadixChunk& chunk : chunks)
+	{
+		orKeys	|= chunk.m_orKeys;
+		andKeys	&= chunk.m_andKeys;
+	}
+
+	// bits that are the same in all keys never change the order
+	const uint64_t varyingBits = orKeys & ~andKeys;
+	if (!varyingBits)
+		return;
+
+	uint32_t shift = 0;
+	while (getDigit(varyingBits >> shift, 0) == 0)
+		shift += RADIX_BITS;
+
+	// Key bits are sorted in 32bit windows packed with the item index into a
+	// single word, so only two word buffers are needed. Each window is packed
+	// in order left by the previous one, LSD order across windows keeps the
+	// sort correct. Most columns vary in fewer than 32 bits and need one window.
+	rtm_vector<uint64_t> items(_count);
+	rtm_vector<uint64_t> scratch(_count);
+
+	for (; (shift < 64) && (varyingBits >> shift); shift += WINDOW_BITS)
+	{
+		uint64_t* src = items.data();
+		QtConcurrent::blockingMap(chunks.begin(), chunks.end(), [src, _indices, _key, _data, shift](RadixChunk& _chunk)
+		{
+			for (uint32_t i=_chunk.m_first; i<_chunk.m_last; ++i)
+			{
+				const uint32_t index = _indices[i];
+				src[i] = ((_key(_data, index) >> shift) << WINDOW_BITS) | index;
+			}
+		});
+
+		const uint64_t* sorted = sortWindow(chunks, src, scratch.data(), (uint32_t)(varyingBits >> shift));
+
+		QtConcurrent::blockingMap(chunks.begin(), chunks.end(), [sorted, _indices](RadixChunk& _chunk)
+		{
+			for (uint32_t i=_chunk.m_first; i<_chunk.m_last; ++i)
+				_indices[i] = (uint32_t)sorted[i];
+		});
+	}
+}
+
+} // namespace rtm
@@ -0,0 +1,58 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_RADIXSORT_H__
+#define __RTM_MTUNER_RADIXSORT_H__
+
+namespace rtm {
+
+//--------------------------------------------------------------------------
+/// Returns sort key of item at _index, keys are compared as unsigned
+//--------------------------------------------------------------------------
+typedef uint64_t (*RadixKeyFunc)(const void* _data, uint32_t _index);
+
+//--------------------------------------------------------------------------
+/// Stable ascending LSD radix sort of item indices by 64bit keys. Varying
+/// key bits are sorted in 32bit windows packed with the item index, so
+/// temporary memory is two 64bit words per item. Histograms and scatter run
+/// in parallel on chunks of the array and byte passes with the same digit
+/// for all keys are skipped. Keys are read once per window plus once up
+/// front, in item order for the first window only.
+/// On return _indices holds item indices 0.._count-1 in sorted order.
+//--------------------------------------------------------------------------
+void radixSort(uint32_t* _indices, uint32_t _count, RadixKeyFunc _key, const void* _data);
+
+/// Same as above with keys extracted beforehand, _keys[i] is the key of item i
+void radixSort(uint32_t* _indices, const uint64_t* _keys, uint32_t _count);
+
+/// Extracts keys of all items in parallel
+void extractKeys(uint64_t* _keys, uint32_t _count, RadixKeyFunc _key, const void* _data);
+
+//--------------------------------------------------------------------------
+/// Selects first _numIndices items of the stable sort by _keys (ascending)
+/// or of its reverse (descending) without sorting the rest. Chunks keep a
+/// bounded heap of best items in parallel, candidates are merged at the end.
+/// Returns number of indices written.
+//--------------------------------------------------------------------------
+uint32_t sortTopKeys(uint32_t* _indices, uint32_t _numIndices, const uint64_t* _keys, uint32_t _count, bool _descending);
+
+/// Key of a signed value that sorts as unsigned
+static inline uint64_t radixKeySigned(int64_t _value)
+{
+	return (uint64_t)_value ^ 0x8000000000000000ULL;
+}
+
+/// Key of a non negative ratio, bit pattern of a positive double is monotonic
+static inline uint64_t radixKeyRatio(int64_t _value, int64_t _total)
+{
+	const double ratio = _total ? double(_value) / double(_total) : 0.0;
+	uint64_t key;
+	memcpy(&key, &ratio, sizeof(key));
+	return ratio > 0.0 ? key : 0;
+}
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_RADIXSORT_H__
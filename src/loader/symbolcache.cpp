@@ -0,0 +1,327 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/symbolcache.h>
+#include <MTuner/src/loader/binaryinfo.h>
+#include <rbase/inc/hash.h>
+#include <QtConcurrent/QtConcurrent>
+#include <QtCore/QDataStream>
+#include <QtCore/QSaveFile>
+
+#include <algorithm>
+
+namespace rtm {
+
+/// Upper limits used to reject corrupted cache files
+static const uint32_t MAX_CACHE_STRINGS	= 64*1024*1024;
+static const uint32_t MAX_CACHE_SYMBOLS	= 64*1024*1024;
+
+uint32_t SymbolCache::Module::addString(const char* _string)
+{
+	// colliding strings take the next free key, lookup follows the same keys
+	uint32_t key = hashStr(_string);
+	StringMap::iterator it = m_stringMap.find(key);
+	while (it != m_stringMap.end())
+	{
+		if (m_strings[it->second] == _string)
+			return it->second;
+		it = m_stringMap.find(++key);
+	}
+
+	const uint32_t index = (uint32_t)m_strings.size();
+	m_strings.push_back(_string);
+	m_stringMap[key] = index;
+	return index;
+}
+
+SymbolCache::~SymbolCache()
+{
+	clear();
+}
+
+void SymbolCache::clear()
+{
+	for (Module* module : m_modules)
+		delete module;
+	m_modules.clear();
+}
+
+void SymbolCache::init(const char* _cacheDir, const char* _symbolSource, const rdebug::ModuleInfo* _modules, uint32_t _numModules)
+{
+	clear();
+
+	const QString cacheDir = QString::fromUtf8(_cacheDir);
+	const bool validDir = QDir().mkpath(cacheDir);
+
+	for (uint32_t i=0; i<_numModules; ++i)
+	{
+		const rdebug::ModuleInfo& info = _modules[i];
+
+		Module* module = new Module();
+		module->m_baseAddress	= info.m_baseAddress;
+		module->m_size			= info.m_size;
+		module->m_enabled		= false;
+		module->m_dirty			= false;
+		module->m_moduleName	= module->addString("");
+		m_modules.push_back(module);
+
+		QFileInfo fileInfo(QString::fromUtf8(info.m_modulePath));
+		if (!validDir || !fileInfo.isFile())
+			continue;
+
+		const QString key = QString("%1|%2|%3|%4|%5|%6")
+								.arg(fileInfo.absoluteFilePath())
+								.arg(info.m_size)
+								.arg(fileInfo.size())
+								.arg(fileInfo.lastModified().toMSecsSinceEpoch())
+								.arg(QString::fromUtf8(getBinaryBuildID(info.m_modulePath).c_str()))
+								.arg(QString::fromUtf8(_symbolSource));
+
+		const QByteArray keyUTF8 = key.toUtf8();
+		const QByteArray keyHash = QCryptographicHash::hash(keyUTF8, QCryptographicHash::Sha1).toHex();
+
+		module->m_key		= keyUTF8.constData();
+		module->m_cacheFile	= (cacheDir + "/" + fileInfo.fileName() + "_" + QString::fromLatin1(keyHash) + ".symcache").toUtf8().constData();
+		module->m_enabled	= true;
+	}
+
+	std::sort(m_modules.begin(), m_modules.end(), [](const Module* _m1, const Module* _m2)
+	{
+		return _m1->m_baseAddress < _m2->m_baseAddress;
+	});
+
+	QtConcurrent::blockingMap(m_modules.begin(), m_modules.end(), [this](Module* _module)
+	{
+		if (_module->m_enabled)
+			load(*_module);
+	});
+}
+
+void SymbolCache::save()
+{
+	QtConcurrent::blockingMap(m_modules.begin(), m_modules.end(), [this](Module* _module)
+	{
+		std::lock_guard<std::mutex> lock(_module->m_mutex);
+		if (_module->m_enabled && _module->m_dirty && save(*_module))
+			_module->m_dirty = false;
+	});
+}
+
+uint64_t SymbolCache::getAddressID(uintptr_t _symResolver, uint64_t _address, bool* _isMTunerDLL)
+{
+	Module* module = findModule(_address);
+	if (!module)
+		return rdebug::symbolResolverGetAddressID(_symResolver, _address, _isMTunerDLL);
+
+	const uint64_t offset = _address - module->m_baseAddress;
+
+	{
+		std::lock_guard<std::mutex> lock(module->m_mutex);
+		Module::SymbolMap::const_iterator it = module->m_symbols.find(offset);
+		if ((it != module->m_symbols.end()) && (it->second.m_flags & HasID))
+		{
+			if (_isMTunerDLL)
+				*_isMTunerDLL = (it->second.m_flags & IsMTunerDLL) != 0;
+			return it->second.m_id;
+		}
+	}
+
+	bool isMTunerDLL = false;
+	const uint64_t id = rdebug::symbolResolverGetAddressID(_symResolver, _address, &isMTunerDLL);
+	if (_isMTunerDLL)
+		*_isMTunerDLL = isMTunerDLL;
+
+	std::lock_guard<std::mutex> lock(module->m_mutex);
+	Symbol& symbol = module->m_symbols[offset];
+	symbol.m_id		= id;
+	symbol.m_flags	|= HasID | (isMTunerDLL ? IsMTunerDLL : 0);
+	module->m_dirty	= true;
+
+	return id;
+}
+
+void SymbolCache::getFrame(uintptr_t _symResolver, uint64_t _address, rdebug::StackFrame* _frame)
+{
+	Module* module = findModule(_address);
+	if (!module)
+	{
+		rdebug::symbolResolverGetFrame(_symResolver, _address, _frame);
+		return;
+	}
+
+	const uint64_t offset = _address - module->m_baseAddress;
+
+	{
+		std::lock_guard<std::mutex> lock(module->m_mutex);
+		Module::SymbolMap::const_iterator it = module->m_symbols.find(offset);
+		if ((it != module->m_symbols.end()) && (it->second.m_flags & HasFrame))
+		{
+			const Symbol& symbol = it->second;
+			rtm::strlCpy(_frame->m_moduleName,	RTM_NUM_ELEMENTS(_frame->m_moduleName),	module->m_strings[module->m_moduleName].c_str());
+			rtm::strlCpy(_frame->m_func,		RTM_NUM_ELEMENTS(_frame->m_func),		module->m_strings[symbol.m_func].c_str());
+			rtm::strlCpy(_frame->m_file,		RTM_NUM_ELEMENTS(_frame->m_file),		module->m_strings[symbol.m_file].c_str());
+			_frame->m_line = symbol.m_line;
+			return;
+		}
+	}
+
+	rdebug::symbolResolverGetFrame(_symResolver, _address, _frame);
+
+	std::lock_guard<std::mutex> lock(module->m_mutex);
+	Symbol& symbol = module->m_symbols[offset];
+	symbol.m_func			= module->addString(_frame->m_func);
+	symbol.m_file			= module->addString(_frame->m_file);
+	symbol.m_line			= _frame->m_line;
+	symbol.m_flags			|= HasFrame;
+	module->m_moduleName	= module->addString(_frame->m_moduleName);
+	module->m_dirty			= true;
+}
+
+bool SymbolCache::findAddressID(uint64_t _address, uint64_t& _id, bool& _isMTunerDLL)
+{
+	Module* module = findModule(_address);
+	if (!module)
+		return false;
+
+	std::lock_guard<std::mutex> lock(module->m_mutex);
+	Module::SymbolMap::const_iterator it = module->m_symbols.find(_address - module->m_baseAddress);
+	if ((it == module->m_symbols.end()) || !(it->second.m_flags & HasID))
+		return false;
+
+	_id				= it->second.m_id;
+	_isMTunerDLL	= (it->second.m_flags & IsMTunerDLL) != 0;
+	return true;
+}
+
+void SymbolCache::addSymbol(uint64_t _address, uint64_t _id, bool _isMTunerDLL, const char* _moduleName, const char* _func, const char* _file, uint32_t _line)
+{
+	Module* module = findModule(_address);
+	if (!module)
+		return;
+
+	std::lock_guard<std::mutex> lock(module->m_mutex);
+	Symbol& symbol = module->m_symbols[_address - module->m_baseAddress];
+	symbol.m_id				= _id;
+	symbol.m_func			= module->addString(_func);
+	symbol.m_file			= module->addString(_file);
+	symbol.m_line			= _line;
+	symbol.m_flags			= HasID | HasFrame | (_isMTunerDLL ? IsMTunerDLL : 0);
+	module->m_moduleName	= module->addString(_moduleName);
+	module->m_dirty			= true;
+}
+
+SymbolCache::Module* SymbolCache::findModule(uint64_t _address) const
+{
+	rtm_vector<Module*>::const_iterator it = std::upper_bound(m_modules.begin(), m_modules.end(), _address, [](uint64_t _addr, const Module* _module)
+	{
+		return _addr < _module->m_baseAddress;
+	});
+
+	if (it == m_modules.begin())
+		return NULL;
+
+	Module* module = *(--it);
+	if ((_address >= module->m_baseAddress + module->m_size) || !module->m_enabled)
+		return NULL;
+
+	return module;
+}
+
+bool SymbolCache::load(Module& _module)
+{
+	QFile file(QString::fromUtf8(_module.m_cacheFile.c_str()));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream stream(&file);
+
+	quint32 magic, version;
+	QByteArray key;
+	stream >> magic >> version >> key;
+	if ((magic != FILE_MAGIC) || (version != FILE_VERSION) || (key != QByteArray(_module.m_key.c_str())))
+		return false;
+
+	quint32 numStrings;
+	stream >> numStrings;
+	if (numStrings > MAX_CACHE_STRINGS)
+		return false;
+
+	rtm_vector<rtm_string> strings;
+	strings.reserve(numStrings);
+	for (quint32 i=0; i<numStrings; ++i)
+	{
+		QByteArray string;
+		stream >> string;
+		strings.push_back(string.constData());
+	}
+
+	quint32 moduleName, numSymbols;
+	stream >> moduleName >> numSymbols;
+	if ((moduleName >= numStrings) || (numSymbols > MAX_CACHE_SYMBOLS) || (stream.status() != QDataStream::Ok))
+		return false;
+
+	Module::SymbolMap symbols;
+	symbols.reserve(numSymbols);
+	for (quint32 i=0; i<numSymbols; ++i)
+	{
+		quint64 offset, id;
+		quint32 func, fileName, line, flags;
+		stream >> offset >> id >> func >> fileName >> line >> flags;
+
+		if ((func >= numStrings) || (fileName >= numStrings))
+			return false;
+
+		Symbol& symbol = symbols[offset];
+		symbol.m_id		= id;
+		symbol.m_func	= func;
+		symbol.m_file	= fileName;
+		symbol.m_line	= line;
+		symbol.m_flags	= flags;
+	}
+
+	if (stream.status() != QDataStream::Ok)
+		return false;
+
+	_module.m_strings.clear();
+	_module.m_stringMap.clear();
+	for (const rtm_string& string : strings)
+		_module.addString(string.c_str());
+
+	// strings are unique in the file so indices are preserved
+	if (_module.m_strings.size() != strings.size())
+		return false;
+
+	_module.m_moduleName	= moduleName;
+	_module.m_symbols		= std::move(symbols);
+	return true;
+}
+
+bool SymbolCache::save(Module& _module)
+{
+	QSaveFile file(QString::fromUtf8(_module.m_cacheFile.c_str()));
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	QDataStream stream(&file);
+
+	stream << (quint32)FILE_MAGIC << (quint32)FILE_VERSION << QByteArray(_module.m_key.c_str());
+
+	stream << (quint32)_module.m_strings.size();
+	for (const rtm_string& string : _module.m_strings)
+		stream << QByteArray(string.c_str());
+
+	stream << (quint32)_module.m_moduleName << (quint32)_module.m_symbols.size();
+	for (const Module::SymbolMap::value_type& entry : _module.m_symbols)
+	{
+		const Symbol& symbol = entry.second;
+		stream	<< (quint64)entry.first << (quint64)symbol.m_id
+				<< (quint32)symbol.m_func << (quint32)symbol.m_file << (quint32)symbol.m_line << (quint32)symbol.m_flags;
+	}
+
+	return file.commit();
+}
+
+} // namespace rtm
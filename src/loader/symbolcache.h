@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_SYMBOLCACHE_H__
+#define __RTM_MTUNER_SYMBOLCACHE_H__
+
+#include <mutex>
+
+namespace rtm {
+
+//--------------------------------------------------------------------------
+/// Persistent cache of symbol resolver results. Each module gets its own
+/// cache file keyed by module path, size, time stamp and build ID so that
+/// captures of the same build skip symbolization on later opens. Modules
+/// whose binary can not be found locally are always passed to the resolver.
+//--------------------------------------------------------------------------
+class SymbolCache
+{
+	public:
+		enum
+		{
+			FILE_MAGIC		= 0x4353544d,		///< 'MTSC'
+			FILE_VERSION	= 1
+		};
+
+		enum Flags
+		{
+			HasID			= 1,
+			HasFrame		= 2,
+			IsMTunerDLL		= 4
+		};
+
+		struct Symbol
+		{
+			uint64_t	m_id;
+			uint32_t	m_func;					///< Index into module string table
+			uint32_t	m_file;					///< Index into module string table
+			uint32_t	m_line;
+			uint32_t	m_flags;
+		};
+
+		struct Module
+		{
+			typedef rtm_unordered_map<uint64_t, Symbol>		SymbolMap;
+			typedef rtm_unordered_map<uint32_t, uint32_t>	StringMap;
+
+			std::mutex				m_mutex;
+			uint64_t				m_baseAddress;
+			uint64_t				m_size;
+			bool					m_enabled;		///< Module identity is known
+			bool					m_dirty;
+			rtm_string				m_key;			///< Module identity
+			rtm_string				m_cacheFile;
+			uint32_t				m_moduleName;	///< Index into string table
+			SymbolMap				m_symbols;		///< Module relative offset to symbol
+			rtm_vector<rtm_string>	m_strings;
+			StringMap				m_stringMap;		///< String hash, probed linearly on collision, to index into string table
+
+			uint32_t addString(const char* _string);
+		};
+
+	private:
+		rtm_vector<Module*>		m_modules;				///< Sorted by base address
+
+	public:
+		SymbolCache() {}
+		~SymbolCache();
+
+		/// Loads existing cache files of all modules from given directory, symbol source
+		/// describes resolver setup (symbol paths, toolchain) and is part of the cache key
+		void		init(const char* _cacheDir, const char* _symbolSource, const rdebug::ModuleInfo* _modules, uint32_t _numModules);
+
+		/// Writes cache files of modified modules
+		void		save();
+
+		/// Same as rdebug::symbolResolverGetAddressID, resolver is used only on cache miss
+		uint64_t	getAddressID(uintptr_t _symResolver, uint64_t _address, bool* _isMTunerDLL);
+
+		/// Same as rdebug::symbolResolverGetFrame, resolver is used only on cache miss
+		void		getFrame(uintptr_t _symResolver, uint64_t _address, rdebug::StackFrame* _frame);
+
+		/// Returns false if symbol ID of the address is not cached
+		bool		findAddressID(uint64_t _address, uint64_t& _id, bool& _isMTunerDLL);
+
+		/// Stores symbol resolved outside of symbol resolver
+		void		addSymbol(uint64_t _address, uint64_t _id, bool _isMTunerDLL, const char* _moduleName, const char* _func, const char* _file, uint32_t _line);
+
+	private:
+		Module*		findModule(uint64_t _address) const;
+		void		clear();
+		bool		load(Module& _module);
+		bool		save(Module& _module);
+};
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_SYMBOLCACHE_H__
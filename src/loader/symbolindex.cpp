@@ -0,0 +1,71 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/symbolindex.h>
+#include <MTuner/src/loader/capture.h>
+
+namespace rtm {
+
+void SymbolIndex::clear()
+{
+	std::lock_guard<std::mutex> lock(m_resolveMutex);
+	m_entries.clear();
+	m_numResolved = 0;
+}
+
+void SymbolIndex::build(const rtm_vector<StackTrace*>& _stackTraces)
+{
+	clear();
+
+	rtm_unordered_map<uint64_t, uint32_t> entryMap;		// symbol ID to index in m_entries
+	for (StackTrace* st : _stackTraces)
+	{
+		const uint32_t numFrames = (uint32_t)st->m_numEntries;
+		for (uint32_t i=0; i<numFrames; ++i)
+		{
+			const uint64_t symbolID = st->m_entries[numFrames + i];
+
+			rtm_unordered_map<uint64_t, uint32_t>::iterator it = entryMap.find(symbolID);
+			if (it == entryMap.end())
+			{
+				it = entryMap.insert(std::make_pair(symbolID, (uint32_t)m_entries.size())).first;
+
+				Entry entry;
+				entry.m_symbolID	= symbolID;
+				entry.m_address		= st->m_entries[i];
+				m_entries.emplace_back(std::move(entry));
+			}
+
+			// recursive functions appear multiple times in the same stack trace
+			rtm_vector<StackTrace*>& traces = m_entries[it->second].m_stackTraces;
+			if (traces.empty() || (traces.back() != st))
+				traces.push_back(st);
+		}
+	}
+}
+
+bool SymbolIndex::resolveNames(Capture* _capture, uintptr_t _symResolver, const std::atomic<uint32_t>* _version, uint32_t _expectedVersion)
+{
+	std::lock_guard<std::mutex> lock(m_resolveMutex);
+
+	const uint32_t numSymbols = (uint32_t)m_entries.size();
+	for (; m_numResolved<numSymbols; ++m_numResolved)
+	{
+		// resolving can take a while in lazy symbol mode, stop if a newer request came in
+		if (_version && ((m_numResolved & 1023) == 0) && (_version->load(std::memory_order_relaxed) != _expectedVersion))
+			return false;
+
+		Entry& entry = m_entries[m_numResolved];
+
+		rdebug::StackFrame frame;
+		_capture->getStackFrame(_symResolver, entry.m_address, frame);
+		entry.m_name = frame.m_func;
+	}
+
+	return true;
+}
+
+} // namespace rtm
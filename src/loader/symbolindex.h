@@ -0,0 +1,56 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_SYMBOLINDEX_H__
+#define __RTM_MTUNER_SYMBOLINDEX_H__
+
+#include <atomic>
+#include <mutex>
+
+namespace rtm {
+
+class Capture;
+
+//--------------------------------------------------------------------------
+/// Inverted index from resolved symbol ID to unique stack traces that
+/// contain the symbol. Operation groups are keyed by stack trace so the
+/// index also leads to all operations passing through a function. Symbol
+/// names are resolved once, on first use, and kept for later queries.
+//--------------------------------------------------------------------------
+class SymbolIndex
+{
+	public:
+		struct Entry
+		{
+			uint64_t				m_symbolID;
+			uint64_t				m_address;			///< First address resolved to the symbol, used to get symbol name
+			rtm_string				m_name;				///< Valid once resolveNames reached the entry
+			rtm_vector<StackTrace*>	m_stackTraces;		///< Unique, in order of first use
+		};
+
+	private:
+		rtm_vector<Entry>						m_entries;
+		uint32_t								m_numResolved;	///< Entries with resolved name, resolving resumes from here
+		std::mutex								m_resolveMutex;
+
+	public:
+		SymbolIndex() : m_numResolved(0) {}
+
+		void			clear();
+
+		/// Stack trace symbol IDs must be resolved before building
+		void			build(const rtm_vector<StackTrace*>& _stackTraces);
+
+		uint32_t		getNumSymbols() const { return (uint32_t)m_entries.size(); }
+		const Entry&	getEntry(uint32_t _index) const { return m_entries[_index]; }
+
+		/// Resolves names of entries not resolved by an earlier call, safe from any thread.
+		/// Returns false if *_version stops matching _expectedVersion, remaining names are resolved next time.
+		bool			resolveNames(Capture* _capture, uintptr_t _symResolver, const std::atomic<uint32_t>* _version = NULL, uint32_t _expectedVersion = 0);
+};
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_SYMBOLINDEX_H__
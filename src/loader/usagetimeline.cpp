@@ -0,0 +1,213 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/loader/usagetimeline.h>
+
+#include <algorithm>
+
+namespace rtm {
+
+UsageTimeline::UsageTimeline()
+	: m_minTime(0)
+	, m_maxTime(0)
+{
+}
+
+void UsageTimeline::begin(uint64_t _minTime, uint64_t _maxTime)
+{
+	clear();
+	m_minTime = _minTime;
+	m_maxTime = qMax(_minTime, _maxTime);
+}
+
+void UsageTimeline::add(uint64_t _key, uint64_t _time, int64_t _usage, int64_t _live)
+{
+	rtm_unordered_map<uint64_t, uint32_t>::iterator it = m_seriesMap.find(_key);
+	if (it == m_seriesMap.end())
+	{
+		it = m_seriesMap.emplace(_key, (uint32_t)m_series.size()).first;
+		m_series.emplace_back();
+
+		Series& series = m_series.back();
+		series.m_key		= _key;
+		series.m_peakUsage	= 0;
+		series.m_peakLive	= 0;
+		series.m_usage		= 0;
+		series.m_live		= 0;
+		series.m_firstLevel	= 0;
+	}
+
+	Series& series = m_series[it->second];
+	const uint64_t prevUsage	= (uint64_t)qMax(series.m_usage, INT64_C(0));
+	const uint64_t prevLive		= (uint64_t)qMax(series.m_live, INT64_C(0));
+
+	series.m_usage	+= _usage;
+	series.m_live	+= _live;
+
+	const uint64_t usage	= (uint64_t)qMax(series.m_usage, INT64_C(0));
+	const uint64_t live		= (uint64_t)qMax(series.m_live, INT64_C(0));
+
+	series.m_peakUsage	= qMax(series.m_peakUsage, usage);
+	series.m_peakLive	= qMax(series.m_peakLive, live);
+
+	// a new bucket starts from the value carried over from previous one
+	const uint32_t index = getBucket(_time);
+	rtm_vector<Bucket>& buckets = series.m_levels[0];
+	if (buckets.empty() || (buckets.back().m_index != index))
+	{
+		Bucket bucket;
+		bucket.m_index		= index;
+		bucket.m_minUsage	= prevUsage;
+		bucket.m_maxUsage	= prevUsage;
+		bucket.m_minLive	= prevLive;
+		bucket.m_maxLive	= prevLive;
+		buckets.push_back(bucket);
+	}
+
+	Bucket& bucket = buckets.back();
+	bucket.m_minUsage	= qMin(bucket.m_minUsage, usage);
+	bucket.m_maxUsage	= qMax(bucket.m_maxUsage, usage);
+	bucket.m_lastUsage	= usage;
+	bucket.m_minLive	= qMin(bucket.m_minLive, live);
+	bucket.m_maxLive	= qMax(bucket.m_maxLive, live);
+	bucket.m_lastLive	= live;
+}
+
+static inline bool sortSeries(const UsageTimeline::Series& _s1, const UsageTimeline::Series& _s2)
+{
+	return _s1.m_peakUsage > _s2.m_peakUsage;
+}
+
+void UsageTimeline::end()
+{
+	std::sort(m_series.begin(), m_series.end(), sortSeries);
+
+	for (size_t s=0; s<m_series.size(); ++s)
+	{
+		Series& series = m_series[s];
+		series.m_firstLevel = s < MAX_DETAILED_SERIES ? 0 : COARSE_LEVEL;
+
+		for (uint32_t level=1; level<NUM_LEVELS; ++level)
+		{
+			rtm_vector<Bucket>& src = series.m_levels[level - 1];
+			rtm_vector<Bucket>& dst = series.m_levels[level];
+
+			for (size_t i=0; i<src.size(); ++i)
+			{
+				const uint32_t index = src[i].m_index >> 1;
+				if (dst.empty() || (dst.back().m_index != index))
+				{
+					dst.push_back(src[i]);
+					dst.back().m_index = index;
+					continue;
+				}
+
+				Bucket& bucket = dst.back();
+				bucket.m_minUsage	= qMin(bucket.m_minUsage, src[i].m_minUsage);
+				bucket.m_maxUsage	= qMax(bucket.m_maxUsage, src[i].m_maxUsage);
+				bucket.m_lastUsage	= src[i].m_lastUsage;
+				bucket.m_minLive	= qMin(bucket.m_minLive, src[i].m_minLive);
+				bucket.m_maxLive	= qMax(bucket.m_maxLive, src[i].m_maxLive);
+				bucket.m_lastLive	= src[i].m_lastLive;
+			}
+
+			dst.shrink_to_fit();
+			if (level - 1 < series.m_firstLevel)
+				rtm_vector<Bucket>().swap(src);
+		}
+	}
+
+	m_seriesMap.clear();
+	for (size_t s=0; s<m_series.size(); ++s)
+		m_seriesMap[m_series[s].m_key] = (uint32_t)s;
+}
+
+void UsageTimeline::clear()
+{
+	m_minTime = 0;
+	m_maxTime = 0;
+	m_series.clear();
+	m_seriesMap.clear();
+}
+
+const UsageTimeline::Series* UsageTimeline::findSeries(uint64_t _key) const
+{
+	rtm_unordered_map<uint64_t, uint32_t>::const_iterator it = m_seriesMap.find(_key);
+	return it == m_seriesMap.end() ? NULL : &m_series[it->second];
+}
+
+uint32_t UsageTimeline::getBucket(uint64_t _time) const
+{
+	if (m_maxTime == m_minTime)
+		return 0;
+
+	const uint64_t time = qBound(m_minTime, _time, m_maxTime);
+	const double offset = double(time - m_minTime) / double(m_maxTime - m_minTime);
+	return qMin(uint32_t(offset * NUM_BUCKETS), uint32_t(NUM_BUCKETS - 1));
+}
+
+uint32_t UsageTimeline::getLevel(double _duration) const
+{
+	const double bucketDuration = double(m_maxTime - m_minTime) / double(NUM_BUCKETS);
+
+	uint32_t level = 0;
+	double duration = bucketDuration * 2.0;
+	while ((level < NUM_LEVELS - 1) && (duration <= _duration))
+	{
+		++level;
+		duration *= 2.0;
+	}
+	return level;
+}
+
+void UsageTimeline::getRange(const Series& _series, uint32_t _level, uint32_t _first, uint32_t _last, size_t& _cursor, Range& _range) const
+{
+	const uint32_t level = qMax(_level, _series.m_firstLevel);
+	_first	>>= level - _level;
+	_last	>>= level - _level;
+
+	const rtm_vector<Bucket>& buckets = _series.m_levels[level];
+	const size_t numBuckets = buckets.size();
+
+	while ((_cursor < numBuckets) && (buckets[_cursor].m_index < _first))
+		++_cursor;
+
+	// value at the start of the range is carried over from the last change before it
+	const uint64_t usage	= _cursor ? buckets[_cursor - 1].m_lastUsage : 0;
+	const uint64_t live		= _cursor ? buckets[_cursor - 1].m_lastLive : 0;
+	_range.m_minUsage	= usage;
+	_range.m_maxUsage	= usage;
+	_range.m_minLive	= live;
+	_range.m_maxLive	= live;
+
+	for (size_t i=_cursor; (i<numBuckets) && (buckets[i].m_index <= _last); ++i)
+	{
+		const Bucket& bucket = buckets[i];
+		_range.m_minUsage	= qMin(_range.m_minUsage, bucket.m_minUsage);
+		_range.m_maxUsage	= qMax(_range.m_maxUsage, bucket.m_maxUsage);
+		_range.m_minLive	= qMin(_range.m_minLive, bucket.m_minLive);
+		_range.m_maxLive	= qMax(_range.m_maxLive, bucket.m_maxLive);
+	}
+}
+
+void UsageTimeline::getRanges(const Series& _series, uint64_t _minTime, uint64_t _maxTime, uint32_t _count, Range* _ranges) const
+{
+	if (!_count || (_maxTime < _minTime))
+		return;
+
+	const double sliceDuration	= double(_maxTime - _minTime) / double(_count);
+	const uint32_t level		= getLevel(sliceDuration);
+
+	size_t cursor = 0;
+	for (uint32_t i=0; i<_count; ++i)
+	{
+		const uint64_t t0 = _minTime + uint64_t(sliceDuration * i);
+		const uint64_t t1 = _minTime + uint64_t(sliceDuration * (i + 1));
+		getRange(_series, level, getBucket(t0) >> level, getBucket(t1) >> level, cursor, _ranges[i]);
+	}
+}
+
+} // namespace rtm
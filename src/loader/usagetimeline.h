@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef __RTM_MTUNER_USAGETIMELINE_H__
+#define __RTM_MTUNER_USAGETIMELINE_H__
+
+#include <MTuner/src/loader/mtunerlib.h>
+
+namespace rtm {
+
+//--------------------------------------------------------------------------
+/// Memory usage and live blocks over time for a set of keys (threads, heaps,
+/// tags). Capture time range is split into NUM_BUCKETS buckets, each series
+/// stores min, max and last value only for buckets it changed in. Coarser
+/// levels merge pairs of buckets, so any time range maps to a few buckets.
+/// Only series with the highest peaks keep all levels, the rest keep levels
+/// from COARSE_LEVEL up so memory doesn't grow with every thread or tag.
+//--------------------------------------------------------------------------
+class UsageTimeline
+{
+	public:
+		enum
+		{
+			NUM_LEVELS			= 17,
+			NUM_BUCKETS			= 1 << (NUM_LEVELS - 1),
+			MAX_DETAILED_SERIES	= 16,
+			COARSE_LEVEL		= 6
+		};
+
+		struct Bucket
+		{
+			uint32_t	m_index;
+			uint64_t	m_minUsage;
+			uint64_t	m_maxUsage;
+			uint64_t	m_lastUsage;
+			uint64_t	m_minLive;
+			uint64_t	m_maxLive;
+			uint64_t	m_lastLive;
+		};
+
+		struct Series
+		{
+			uint64_t			m_key;
+			uint64_t			m_peakUsage;
+			uint64_t			m_peakLive;
+			int64_t				m_usage;				///< Current value while building
+			int64_t				m_live;					///< Current value while building
+			uint32_t			m_firstLevel;			///< Finest level kept once built
+			rtm_vector<Bucket>	m_levels[NUM_LEVELS];
+		};
+
+		struct Range
+		{
+			uint64_t	m_minUsage;
+			uint64_t	m_maxUsage;
+			uint64_t	m_minLive;
+			uint64_t	m_maxLive;
+		};
+
+	private:
+		uint64_t								m_minTime;
+		uint64_t								m_maxTime;
+		rtm_vector<Series>						m_series;		///< Sorted by peak usage once built
+		rtm_unordered_map<uint64_t, uint32_t>	m_seriesMap;
+
+	public:
+		UsageTimeline();
+
+		void					begin(uint64_t _minTime, uint64_t _maxTime);
+		void					add(uint64_t _key, uint64_t _time, int64_t _usage, int64_t _live);
+		void					end();
+		void					clear();
+
+		/// Accounts a memory operation, freed memory is taken from the key of the operation that allocated it
+		template <typename KeyFn>
+		void					addOperation(const MemoryOperation* _op, KeyFn _key);
+
+		bool					isEmpty() const { return m_series.empty(); }
+		const rtm_vector<Series>& getSeries() const { return m_series; }
+		const Series*			findSeries(uint64_t _key) const;
+
+		/// Returns bucket containing the time at finest level
+		uint32_t				getBucket(uint64_t _time) const;
+
+		/// Returns coarsest level with buckets not longer than given duration
+		uint32_t				getLevel(double _duration) const;
+
+		/// Gets value range of a series over buckets [_first, _last] of a level. Cursor is
+		/// an index into the level kept between calls with increasing buckets, start at 0.
+		/// Levels finer than the first level of the series are read from the first level.
+		void					getRange(const Series& _series, uint32_t _level, uint32_t _first, uint32_t _last, size_t& _cursor, Range& _range) const;
+
+		/// Gets value ranges of a series for _count equal slices of time range, one per pixel column usually
+		void					getRanges(const Series& _series, uint64_t _minTime, uint64_t _maxTime, uint32_t _count, Range* _ranges) const;
+};
+
+template <typename KeyFn>
+inline void UsageTimeline::addOperation(const MemoryOperation* _op, KeyFn _key)
+{
+	const MemoryOperation* prevOp = _op->m_chainPrev;
+	const uint64_t time = _op->m_operationTime;
+
+	switch (_op->m_operationType)
+	{
+	case rmem::LogMarkers::OpAlloc:
+	case rmem::LogMarkers::OpCalloc:
+	case rmem::LogMarkers::OpAllocAligned:
+		add(_key(_op), time, _op->m_allocSize, 1);
+		break;
+
+	case rmem::LogMarkers::OpRealloc:
+	case rmem::LogMarkers::OpReallocAligned:
+		{
+			const uint64_t key = _key(_op);
+			const int64_t live = (prevOp || _op->m_pointer) ? 1 : 0;
+
+			// block staying with the same key is a single change, not a drop and a rise
+			if (prevOp && (_key(prevOp) == key))
+				add(key, time, (int64_t)_op->m_allocSize - (int64_t)prevOp->m_allocSize, live - 1);
+			else
+			{
+				if (prevOp)
+					add(_key(prevOp), time, -(int64_t)prevOp->m_allocSize, -1);
+				add(key, time, _op->m_allocSize, live);
+			}
+		}
+		break;
+
+	case rmem::LogMarkers::OpFree:
+		add(_key(prevOp ? prevOp : _op), time, -(int64_t)_op->m_allocSize, -1);
+		break;
+	};
+}
+
+} // namespace rtm
+
+#endif // __RTM_MTUNER_USAGETIMELINE_H__
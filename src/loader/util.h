@@ -30,6 +30,15 @@ static inline bool isInvalid(MemoryOperation* _op)
 	return _op->m_isValid == 0;
 }
 
+/// Returns true if operation does not free the memory block
+static inline bool isLeaked(const MemoryOperation* _op)
+{
+	bool isFreed = _op->m_operationType == rmem::LogMarkers::OpFree;
+	isFreed = isFreed || ((_op->m_operationType == rmem::LogMarkers::OpRealloc) && (_op->m_allocSize == 0));
+	isFreed = isFreed || ((_op->m_operationType == rmem::LogMarkers::OpReallocAligned) && (_op->m_allocSize == 0));
+	return !isFreed;
+}
+
 //--------------------------------------------------------------------------
 /// Returns the index of the histogram bin based on allocation size
 //--------------------------------------------------------------------------
@@ -184,6 +184,18 @@ MTuner::MTuner(QWidget* _parent, Qt::WindowFlags _flags) :
 	spacerWidget->setVisible(true);
 	ui.toolBar->addWidget(spacerWidget);
 
+	m_queryEdit = new QLineEdit(this);
+	m_queryEdit->setPlaceholderText(tr("Query, e.g. size > 1kb and stack contains \"Json\""));
+	m_queryEdit->setToolTip(tr("Filter operations by query, press Enter to apply\n"
+		"Fields: size, overhead, alignment, time, lifetime, thread, heap, tag, type\n"
+		"Conditions: < <= > >= = != between..and, in (..), leaked, stack contains \"name\"\n"
+		"Combine with and, or, not and parentheses"));
+	m_queryEdit->setMinimumWidth(320);
+	m_queryEdit->setClearButtonEnabled(true);
+	m_queryEdit->setEnabled(false);
+	connect(m_queryEdit, SIGNAL(returnPressed()), this, SLOT(queryEntered()));
+	ui.toolBar->addWidget(m_queryEdit);
+
 	connect(ui.action_Save_capture_window_layout, SIGNAL(triggered(bool)), this, SLOT(saveCaptureWindowLayout()));
 	ui.action_Save_capture_window_layout->setEnabled(false);
 
@@ -391,6 +403,28 @@ void MTuner::heapSelected(uint64_t _handle)
 	}
 }
 
+void MTuner::threadSelected(uint64_t _threadID)
+{
+	BinLoaderView* view = m_centralWidget->getCurrentView();
+	CaptureContext* ctx = view ? view->getContext() : NULL;
+	if (!ctx)
+		return;
+
+	if (_threadID)
+		ctx->m_capture->selectThread(_threadID);
+	else
+		ctx->m_capture->deselectThread();
+
+	m_histogramWidget->updateUI();
+	m_stats->updateUI();
+
+	if (view->getFilteringEnabled())
+		view->updateFilteredData();
+	else
+	if (_threadID)
+		setFilteringState(true, true);
+}
+
 void MTuner::moduleSelected(void* _module)
 {
 	BinLoaderView* view = m_centralWidget->getCurrentView();
@@ -403,6 +437,29 @@ void MTuner::moduleSelected(void* _module)
 	}
 }
 
+void MTuner::queryEntered()
+{
+	BinLoaderView* view = m_centralWidget->getCurrentView();
+	CaptureContext* ctx = view ? view->getContext() : NULL;
+	if (!ctx)
+		return;
+
+	QByteArray query = m_queryEdit->text().trimmed().toUtf8();
+
+	rtm_string error;
+	if (!ctx->m_capture->setQuery(query.constData(), ctx->m_symbolResolver, error))
+	{
+		setStatusBarText(tr("Invalid query") + ": " + QString::fromUtf8(error.c_str()));
+		return;
+	}
+
+	if (view->getFilteringEnabled())
+		view->updateFilteredData();
+	else
+	if (query.size())
+		setFilteringState(true, true);
+}
+
 void MTuner::graphModified()
 {
 	BinLoaderView* view = m_centralWidget->getCurrentView();
@@ -538,6 +595,7 @@ void MTuner::setupDockWindows()
 	connect(graphWidget,SIGNAL(snapshotSelected()), m_stats, SLOT(updateUI()));
 	connect(graphWidget,SIGNAL(minMaxChanged()), this, SLOT(graphModified()));
 	connect(graphWidget,SIGNAL(snapshotSelected()), this, SLOT(graphModified()));
+	connect(graphWidget,SIGNAL(threadSelected(uint64_t)), this, SLOT(threadSelected(uint64_t)));
 
 	connect(graphWidget,SIGNAL(snapshotSelected()), m_centralWidget, SLOT(updateFilterDataIfNeeded()));
 	connect(m_histogramWidget,SIGNAL(binClicked()), m_centralWidget, SLOT(updateFilterDataIfNeeded()));
@@ -573,6 +631,9 @@ void MTuner::setWidgetSources(CaptureContext* _context)
 		graphWidget->setMaxTime(binView->getMaxTime());
 	}
 
+	m_queryEdit->setText(ctx ? QString::fromUtf8(ctx->m_capture->getQuery()) : QString());
+	m_queryEdit->setEnabled(ctx != 0);
+
 	emit binLoaded(binView != NULL);
 }
 
@@ -788,6 +849,7 @@ void MTuner::readSettings()
 	bool symReg = false;
 	symReg = settings.value("SymRegistry").toBool();
 	m_symbolStore->setChecked(symReg);
+	ui.action_Lazy_symbols->setChecked(settings.value("LazySymbols").toBool());
 
 	// projects
 	m_projectsManager->loadSettings(settings);
@@ -852,6 +914,7 @@ void MTuner::writeSettings()
 	settings.setValue("SymLocalStore", m_symbolStore->getLocalStore());
 	settings.setValue("SymPublicStore", m_symbolStore->getPublicStore());
 	settings.setValue("SymRegistry", m_symbolStore->isRegistryChecked());
+	settings.setValue("LazySymbols", ui.action_Lazy_symbols->isChecked());
 
 	// projects
 	m_projectsManager->saveSettings(settings);
@@ -920,8 +983,12 @@ void MTuner::openFileFromPath(const QString& _file)
 			// if not a windows toolchain - locate the executable
 			setupLoaderToolchain(ctx, _file, m_gccSetup, m_fileDialog, this, symStore);
 
+			ctx->m_capture->setLazySymbols(ui.action_Lazy_symbols->isChecked());
 			ctx->m_capture->buildAnalyzeData(ctx->m_symbolResolver);
 
+			if (ctx->m_capture->getLazySymbols())
+				ctx->startPrefetching();
+
 			QString ld(tr("Loaded "));
 
 			statusBar()->showMessage(ld + QString::fromUtf8(fn.c_str()),3000);
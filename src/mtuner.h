@@ -76,6 +76,7 @@ private:
 	DockWidget*				m_modulesDock;
 	QProgressBar*			m_loadingProgressBar;
 	QLabel*					m_statusBarRedDot;
+	QLineEdit*				m_queryEdit;
 	CentralWidget*			m_centralWidget;
 	QFileDialog*			m_fileDialog;
 
@@ -124,8 +125,10 @@ public Q_SLOTS:
 	void about();
 
 	void heapSelected(uint64_t);
+	void threadSelected(uint64_t);
 	void moduleSelected(void*);
 	void graphModified();
+	void queryEntered();
 	void setWidgetSources(CaptureContext* _binView);
 
 	void suicide();
@@ -151,6 +151,10 @@ int handleCommandLine(int argc, char const* argv[])
 			"               128 and 256 will be included.\n"
 			"   -ts [TIME]  Set start (minimum) time for operation filtering\n"
 			"   -te [TIME]  Set end (maximum) time for operation filtering\n"
+			"   -q [QUERY]  Filter operations by query, for example:\n"
+			"               \"size between 64 and 4kb and lifetime < 1ms\"\n"
+			"               Fields: size, overhead, alignment, time, lifetime,\n"
+			"               thread, heap, tag, type, leaked, stack contains \"NAME\"\n"
 			"   -ss         Sort memory operations by size\n"
 			"   -sc         Sort memory operations by count\n"
 			"   -st         Sort memory operations by size*count\n"
@@ -203,6 +207,7 @@ int handleCommandLine(int argc, char const* argv[])
 			rtm::Console::info("\n"
 			"Examples:\n"
 			"   MTuner.com: -l -xml -tag \"Tag name\" -h 256 -i \"Capture.MTuner\" -o \"Log.xml\"\n"
+			"   MTuner.com: -q \"size > 1mb and stack contains \\\"Json*\\\"\" -i \"Capture.MTuner\" -o \"Log.txt\"\n"
 			"   MTuner.com: -p \"D:\\Project Dir\\bin\\ProjectExe.exe\"\n"
 		);
 		
@@ -301,6 +306,10 @@ int handleCommandLine(int argc, char const* argv[])
 		enableFiltering = true;
 	}
 
+	const char* query = NULL;
+	if (cmdLine.getArg('q', query))
+		enableFiltering = true;
+
 	bool leakedOnly = cmdLine.hasArg("l");
 	enableFiltering = enableFiltering || leakedOnly;
 
@@ -350,9 +359,20 @@ int handleCommandLine(int argc, char const* argv[])
 						err("ERROR: minimum time must be smaller than maximum time!");
 
 					context.m_capture->setSnapshot(minTimeFilter, maxTimeFilter);
-					rtm::Console::debug("Calculating filtered info...\n");
-					context.m_capture->setFilteringEnabled(true);
 				}
+
+				if (query)
+				{
+					rtm_string queryError;
+					if (!context.m_capture->setQuery(query, context.m_symbolResolver, queryError))
+					{
+						queryError = "ERROR: Invalid query, " + queryError + "!";
+						err(queryError.c_str());
+					}
+				}
+
+				rtm::Console::debug("Calculating filtered info...\n");
+				context.m_capture->setFilteringEnabled(true);
 			}
 
 			rtm::eGroupSort sorting = rtm::GROUP_SORT_SIZE;
@@ -13,7 +13,10 @@ OperationSearch::OperationSearch(QWidget* _parent, Qt::WindowFlags _flags)	:
 
 	m_buttonPrev	= findChild<QPushButton*>("buttonPrev");
 	m_buttonNext	= findChild<QPushButton*>("buttonNext");
+	m_buttonBlock	= findChild<QPushButton*>("buttonBlock");
 	m_buttonSearch	= findChild<QToolButton*>("buttonSearch");
+	m_buttonSearchPrev	= findChild<QToolButton*>("buttonSearchPrev");
+	m_matchesOnly	= findChild<QCheckBox*>("checkBoxMatches");
 	m_address		= findChild<QLineEdit*>("lineEditAddress");
 	m_searchAddress	= findChild<QLineEdit*>("lineEditSearch");
 	m_searchType	= findChild<QComboBox*>("comboBox");
@@ -24,6 +27,9 @@ OperationSearch::OperationSearch(QWidget* _parent, Qt::WindowFlags _flags)	:
 	connect(m_buttonNext, SIGNAL(clicked()), this, SIGNAL(findNext()));
 	connect(m_searchAddress, SIGNAL(textChanged(const QString&)), this, SLOT(searchStringChanged(const QString&)));
 	connect(m_buttonSearch, SIGNAL(clicked()), this, SLOT(search()));
+	connect(m_buttonSearchPrev, SIGNAL(clicked()), this, SLOT(searchPrev()));
+	connect(m_buttonBlock, SIGNAL(clicked()), this, SLOT(showBlock()));
+	connect(m_matchesOnly, SIGNAL(toggled(bool)), this, SLOT(matchesToggled(bool)));
 	connect(m_searchType, SIGNAL(activated(int)), this, SLOT(searchTypeChanged(int)));
 }
 
@@ -60,32 +66,104 @@ void OperationSearch::setAddress(uint64_t _address)
 	hex = "0x" + hex;
 	m_address->setText(hex);
 	m_address->setEnabled(true);
+	m_buttonBlock->setEnabled(true);
 }
 
 void OperationSearch::search()
 {
-	if (m_searchType->currentIndex()==0)
-	{
-		uint64_t address = m_searchAddress->text().toULongLong(0,16);
-		emit searchByAddress(address);
-	}
+	emitSearch(true);
+}
+
+void OperationSearch::searchPrev()
+{
+	emitSearch(false);
+}
+
+void OperationSearch::showBlock()
+{
+	m_searchType->setCurrentIndex(0);
+	searchTypeChanged(0);
+	m_searchAddress->setText(m_address->text());
+
+	if (m_matchesOnly->isChecked())
+		matchesToggled(true);
 	else
-	{
-		uint64_t size = m_searchAddress->text().toULongLong(0,10);
-		emit searchBySize(size);
-	}
+		m_matchesOnly->setChecked(true);
 }
 
-void OperationSearch::searchTypeChanged(int _type)
+void OperationSearch::matchesToggled(bool _checked)
 {
-	if (_type==0)
-		m_searchAddress->setValidator(new QRegularExpressionValidator(QRegularExpression("0x?[0-9A-Fa-f]{1,16}")));
+	int key;
+	uint64_t minValue, maxValue;
+	if (getSearch(key, minValue, maxValue))
+		emit showMatches(key, minValue, maxValue, _checked);
 	else
-		m_searchAddress->setValidator(new QRegularExpressionValidator(QRegularExpression("[0-9]{1,16}")));
+		emit showMatches(SearchKey::Address, 0, 0, false);
+}
+
+void OperationSearch::searchTypeChanged(int _type)
+{
+	switch (_type)
+	{
+		case 0:	 m_searchAddress->setValidator(new QRegularExpressionValidator(QRegularExpression("0x?[0-9A-Fa-f]{1,16}"))); break;
+		case 1:	 m_searchAddress->setValidator(new QRegularExpressionValidator(QRegularExpression("[0-9]{1,16}"))); break;
+		default: m_searchAddress->setValidator(new QRegularExpressionValidator(QRegularExpression("0x?[0-9A-Fa-f]{1,16}-0x?[0-9A-Fa-f]{1,16}"))); break;
+	};
 	m_searchAddress->setText("");
 }
 
 void OperationSearch::searchStringChanged(const QString& _text)
 {
 	m_buttonSearch->setEnabled(_text.length()!=0);
+	m_buttonSearchPrev->setEnabled(_text.length()!=0);
+}
+
+//--------------------------------------------------------------------------
+/// Address range is entered as 'first-last', both ends are inclusive
+//--------------------------------------------------------------------------
+bool OperationSearch::getSearch(int& _key, uint64_t& _min, uint64_t& _max) const
+{
+	const QString text = m_searchAddress->text();
+	bool ok = false;
+
+	switch (m_searchType->currentIndex())
+	{
+		case 0:
+			_key = SearchKey::Address;
+			_min = _max = text.toULongLong(&ok, 16);
+			return ok;
+
+		case 1:
+			_key = SearchKey::Size;
+			_min = _max = text.toULongLong(&ok, 10);
+			return ok;
+
+		default:
+			{
+				const QStringList range = text.split('-');
+				if (range.size() != 2)
+					return false;
+
+				bool okMax = false;
+				_key = SearchKey::Address;
+				_min = range[0].toULongLong(&ok, 16);
+				_max = range[1].toULongLong(&okMax, 16);
+				if (_min > _max)
+					qSwap(_min, _max);
+				return ok && okMax;
+			}
+	};
+}
+
+void OperationSearch::emitSearch(bool _next)
+{
+	int key;
+	uint64_t minValue, maxValue;
+	if (!getSearch(key, minValue, maxValue))
+		return;
+
+	if (m_matchesOnly->isChecked())
+		emit showMatches(key, minValue, maxValue, true);
+
+	emit search(key, minValue, maxValue, _next);
 }
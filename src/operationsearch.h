@@ -12,9 +12,25 @@ class OperationSearch : public QWidget
 {
 	Q_OBJECT
 
+public:
+	struct SearchKey
+	{
+		enum Enum
+		{
+			Address,
+			Size,
+
+			Count
+		};
+	};
+
+private:
 	QPushButton*	m_buttonPrev;
 	QPushButton*	m_buttonNext;
+	QPushButton*	m_buttonBlock;
 	QToolButton*	m_buttonSearch;
+	QToolButton*	m_buttonSearchPrev;
+	QCheckBox*		m_matchesOnly;
 	QLineEdit*		m_address;
 	QLineEdit*		m_searchAddress;
 	QComboBox*		m_searchType;
@@ -28,17 +44,24 @@ public:
 	void setAddress(uint64_t _address);
 
 Q_SIGNALS:
-	void searchByAddress(uint64_t);
-	void searchBySize(uint64_t);
+	/// Key is one of SearchKey values, values in [_min, _max] match
+	void search(int _key, uint64_t _min, uint64_t _max, bool _next);
+	void showMatches(int _key, uint64_t _min, uint64_t _max, bool _show);
 	void findPrev();
 	void findNext();
 
 public Q_SLOTS:
 	void search();
+	void searchPrev();
+	void showBlock();
+	void matchesToggled(bool);
 	void searchTypeChanged(int);
 	void searchStringChanged(const QString&);
 
 private:
+	bool getSearch(int& _key, uint64_t& _min, uint64_t& _max) const;
+	void emitSearch(bool _next);
+
 	Ui::OperationSearchWidget ui;
 };
 
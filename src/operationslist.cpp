@@ -7,26 +7,10 @@
 #include <MTuner/src/operationslist.h>
 #include <MTuner/src/bigtable.h>
 #include <MTuner/src/capturecontext.h>
+#include <MTuner/src/loader/radixsort.h>
+#include <QtConcurrent/QtConcurrent>
 
-
-#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
-#pragma warning(push)
-#pragma warning(disable: 4211)	// nonstandard extension used: redefined extern to static
-static bool __uncaught_exception() { return true; }
-#pragma warning(pop)
-#include <ppl.h>
-
-#define RTM_PARALLEL_FOR_EACH	Concurrency::parallel_for_each
-#define RTM_PARALLEL_SORT		Concurrency::parallel_sort
-//radixsort
-#endif // RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
-
-#if RTM_COMPILER_GCC
-#include <parallel/algorithm>
-
-#define RTM_PARALLEL_FOR_EACH	__gnu_parallel::for_each
-#define RTM_PARALLEL_SORT		__gnu_parallel::sort
-#endif // RTM_COMPILER_GCC
+#include <numeric>
 
 struct Mapping
 {
@@ -50,22 +34,65 @@ struct OperationColumn
 	};
 };
 
+struct SearchIndex
+{
+	rtm_vector<uint32_t>	m_positions;		///< Positions in current order sorted by key, equal keys by position
+	bool					m_valid;
+};
+
+struct SearchResult
+{
+	int						m_key;
+	uint64_t				m_min;
+	uint64_t				m_max;
+	rtm_vector<uint32_t>	m_positions;		///< Ascending positions of matching operations
+	bool					m_valid;
+};
+
+//--------------------------------------------------------------------------
+/// Keys are extracted on the GUI thread, the job never touches operations
+/// so filtered data can be swapped while it runs.
+//--------------------------------------------------------------------------
+struct SortJob
+{
+	rtm_vector<uint64_t>	m_keys;
+	rtm_vector<uint32_t>	m_sortedIndex;
+	uint32_t				m_column;
+	uint32_t				m_version;
+};
+
 class OperationTableSource : public BigTableSource
 {
+	public:
+		enum
+		{
+			TOP_ROWS		= 1024,				///< Rows served from partial sort while full sort runs
+			INVALID_INDEX	= 0xffffffff
+		};
+
 	private:
 		CaptureContext*	m_context;
 		OperationsList*	m_list;
 		uint32_t		m_numColumns;
 		uint32_t		m_numRows;
-		Mapping			m_mapping;
+		Mapping			m_mapping;				///< View private order, operations are never modified
+		uint32_t		m_mappingColumn;		///< Column m_mapping is sorted by
+		rtm_vector<uint32_t>	m_positions;	///< Inverse of m_mapping, built on first use
+		rtm_vector<uint32_t>	m_topRows;		///< First rows in display order until sort job is done
 		uint32_t		m_currentColumn;
 		bool			m_valid;
 		Qt::SortOrder	m_sortOrder;
 		const rtm_vector<rtm::MemoryOperation*>*	m_allOps;
+		SearchIndex		m_searchIndex[OperationSearch::SearchKey::Count];
+		SearchResult	m_matches;
+		bool			m_showMatches;
+		SortJob*		m_sortJob;				///< Running job
+		SortJob*		m_pendingJob;			///< Started once running job is done
+		uint32_t		m_sortVersion;
 
 	public:
 		OperationTableSource(CaptureContext* _context, bool _valid, OperationsList* _list);
-		virtual ~OperationTableSource() {}
+		virtual ~OperationTableSource();
 
 		void prepareData();
 
@@ -77,122 +104,114 @@ class OperationTableSource : public BigTableSource
 		virtual uint32_t	getItemIndex(void* _item);
 		virtual void 		sortColumn(uint32_t _columnIndex, Qt::SortOrder _sortOrder);
 
-		void* FindNextByAddress(uint64_t _address, uint32_t _startIndex);
-		void* FindNextBySize(uint64_t _size, uint32_t _startIndex);
+		bool	sortFinished();
+
+		void*	find(int _key, uint64_t _min, uint64_t _max, uint32_t _row, bool _next);
+		void	showMatches(int _key, uint64_t _min, uint64_t _max, bool _show);
 
 		void saveState(QSettings& _settings);
-};
 
-struct pSetIndex
-{
-	const rtm_vector<uint32_t>* m_Indices;
-	pSetIndex(const rtm_vector<uint32_t>& _indices) : m_Indices(&_indices) {}
-	inline void operator()(uint32_t& _index) const
-	{
-		uint32_t idx = &_index - &((*m_Indices)[0]);
-		_index = idx;
-	}
+	private:
+		bool				isSorting() const { return m_mappingColumn != m_currentColumn; }
+		uint32_t			getRowCount() const { return m_showMatches ? (uint32_t)m_matches.m_positions.size() : m_numRows; }
+		void				selectTopRows(const rtm_vector<uint64_t>& _keys);
+		void				startSort(SortJob* _job);
+		uint32_t			getOpIndex(uint32_t _row) const;
+		uint32_t			findOpIndex(const rtm::MemoryOperation* _op) const;
+		uint32_t			getPosition(uint32_t _row) const;
+		void				invalidateSearch();
+		const SearchResult&	getMatches(int _key, uint64_t _min, uint64_t _max);
 };
 
-// ThreadID
-struct pSortThreadID
+static inline const rtm::MemoryOperation* getOp(const void* _ops, uint32_t _index)
 {
-	const rtm_vector<rtm::MemoryOperation*>* m_allOps;
-	pSortThreadID(const rtm_vector<rtm::MemoryOperation*>* _ops) : m_allOps(_ops) {}
-
-	inline uint64_t operator()(const uint32_t _val1, const uint32_t _val2) const 
-	{
-		return m_allOps->operator[](_val1)->m_threadID < m_allOps->operator[](_val2)->m_threadID; 
-	}
-};
+	return (*(const rtm_vector<rtm::MemoryOperation*>*)_ops)[_index];
+}
 
-// Heap
-struct pSortHeap
+static uint64_t sortKeyThreadID(const void* _ops, uint32_t _index)
 {
-	const rtm_vector<rtm::MemoryOperation*>* m_allOps;
-	pSortHeap(const rtm_vector<rtm::MemoryOperation*>* _ops) : m_allOps(_ops) {}
-
-	inline uint64_t operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		return m_allOps->operator[](_val1)->m_allocatorHandle < m_allOps->operator[](_val2)->m_allocatorHandle; 
-	}
-};
+	return getOp(_ops, _index)->m_threadID;
+}
 
-// Address
-struct pSortAddress
+static uint64_t sortKeyHeap(const void* _ops, uint32_t _index)
 {
-	const rtm_vector<rtm::MemoryOperation*>* m_allOps;
-	pSortAddress(const rtm_vector<rtm::MemoryOperation*>* _ops) : m_allOps(_ops) {}
-
-	inline uint64_t operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		return m_allOps->operator[](_val1)->m_pointer < m_allOps->operator[](_val2)->m_pointer; 
-	}
-};
+	return getOp(_ops, _index)->m_allocatorHandle;
+}
 
-// Type
-struct pSortOpType
+static uint64_t sortKeyAddress(const void* _ops, uint32_t _index)
 {
-	const rtm_vector<rtm::MemoryOperation*>* m_allOps;
-	pSortOpType(const rtm_vector<rtm::MemoryOperation*>* _ops) : m_allOps(_ops) {}
-
-	inline uint8_t operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		return m_allOps->operator[](_val1)->m_operationType < m_allOps->operator[](_val2)->m_operationType;
-	}
-};
+	return getOp(_ops, _index)->m_pointer;
+}
 
-// Size
-struct pSortOpSize
+static uint64_t sortKeyType(const void* _ops, uint32_t _index)
 {
-	const rtm_vector<rtm::MemoryOperation*>* m_allOps;
-	pSortOpSize(const rtm_vector<rtm::MemoryOperation*>* _ops) : m_allOps(_ops) {}
+	return getOp(_ops, _index)->m_operationType;
+}
 
-	inline uint32_t operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		return m_allOps->operator[](_val1)->m_allocSize < m_allOps->operator[](_val2)->m_allocSize;
-	}
-};
+static uint64_t sortKeySize(const void* _ops, uint32_t _index)
+{
+	return getOp(_ops, _index)->m_allocSize;
+}
 
-// Alignment
-struct pSortOpAlignment
+static uint64_t sortKeyAlignment(const void* _ops, uint32_t _index)
 {
-	const rtm_vector<rtm::MemoryOperation*>* m_allOps;
-	pSortOpAlignment(const rtm_vector<rtm::MemoryOperation*>* _ops) : m_allOps(_ops) {}
+	return getOp(_ops, _index)->m_alignment;
+}
 
-	inline uint32_t operator()(const uint32_t _val1, const uint32_t _val2) const
-	{
-		return m_allOps->operator[](_val1)->m_alignment < m_allOps->operator[](_val2)->m_alignment;
-	}
+/// Operations are stored in time order, time column is the identity order
+static const rtm::RadixKeyFunc s_sortKeys[OperationColumn::Count] =
+{
+	sortKeyThreadID,
+	sortKeyHeap,
+	sortKeyAddress,
+	sortKeyType,
+	sortKeySize,
+	sortKeyAlignment,
+	NULL
 };
 
-struct pSetOpMappings
+static uint64_t searchKeyAddress(const void* _mapping, uint32_t _position)
 {
-	const rtm_vector<rtm::MemoryOperation*>* m_allOps;
-	const Mapping* m_mapping;
+	const Mapping* mapping = (const Mapping*)_mapping;
+	return (*mapping->m_allOps)[mapping->m_sortedIndex[_position]]->m_pointer;
+}
 
-	pSetOpMappings(const rtm_vector<rtm::MemoryOperation*>* _ops, const Mapping& _mapping) :
-		m_allOps(_ops), m_mapping(&_mapping)
-	{}
+static uint64_t searchKeySize(const void* _mapping, uint32_t _position)
+{
+	const Mapping* mapping = (const Mapping*)_mapping;
+	return (*mapping->m_allOps)[mapping->m_sortedIndex[_position]]->m_allocSize;
+}
 
-	inline void operator()(const uint32_t _index) const
-	{
-		uint32_t idx = m_mapping->m_sortedIndex[_index];
-		rtm::MemoryOperation* op = (*m_allOps)[idx];
-		op->m_indexMapping = _index;
-	}
+static const rtm::RadixKeyFunc s_searchKeys[OperationSearch::SearchKey::Count] =
+{
+	searchKeyAddress,
+	searchKeySize
 };
 
 OperationTableSource::OperationTableSource(CaptureContext* _context, bool _valid, OperationsList* _list)
 	: m_context(_context)
 	, m_list(_list)
+	, m_currentColumn(OperationColumn::Time)
 	, m_valid(_valid)
+	, m_sortOrder(Qt::AscendingOrder)
+	, m_showMatches(false)
+	, m_sortJob(NULL)
+	, m_pendingJob(NULL)
+	, m_sortVersion(0)
 {
 	m_numColumns	= OperationColumn::Count;
 	m_context		= _context;
+	m_matches.m_valid = false;
 	prepareData();
 }
 
+OperationTableSource::~OperationTableSource()
+{
+	// list waits for the running job before deleting the source
+	delete m_sortJob;
+	delete m_pendingJob;
+}
+
 void OperationTableSource::prepareData()
 {
 	bool filterEnabled = m_list->getFilteringState();
@@ -201,22 +220,21 @@ void OperationTableSource::prepareData()
 													: filterEnabled ? m_context->m_capture->getMemoryOpsFiltered() : m_context->m_capture->getMemoryOps();
 
 	m_numRows		= (uint32_t)_ops.size();
-	m_sortOrder		= Qt::AscendingOrder;
 	m_allOps		= &_ops;
 
-	// init index arrays for columns
-	const uint32_t numItems = m_numRows;
-
-	m_mapping.m_sortedIndex.resize(numItems);
+	m_mapping.m_sortedIndex.resize(m_numRows);
 	m_mapping.m_allOps = m_allOps;
-
-	pSetIndex psSetIdx(m_mapping.m_sortedIndex);
-	RTM_PARALLEL_FOR_EACH(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psSetIdx);
-
-	pSetOpMappings psMap(m_allOps, m_mapping);
-	RTM_PARALLEL_FOR_EACH(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psMap);
-
+	std::iota(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), 0);
+	m_mappingColumn = OperationColumn::Time;
+	m_positions.clear();
+	m_topRows.clear();
+	invalidateSearch();
+
+	// running job sorts operations that are gone, re-sort current column
+	++m_sortVersion;
+	const uint32_t column = m_currentColumn;
 	m_currentColumn = OperationColumn::Time;
+	sortColumn(column, m_sortOrder);
 }
 
 QStringList	OperationTableSource::getHeaderInfo(int32_t& _sortColumn, Qt::SortOrder& _sortOrder, QList<int>& _widths)
@@ -239,7 +257,7 @@ QStringList	OperationTableSource::getHeaderInfo(int32_t& _sortColumn, Qt::SortOr
 
 uint32_t OperationTableSource::getNumberOfRows()
 {
-	return m_numRows;
+	return getRowCount();
 }
 
 static bool isLeakedBlock(const rtm::MemoryOperation* _op)
@@ -264,12 +282,11 @@ static bool isLeakedBlock(const rtm::MemoryOperation* _op)
 QString getTimeString(float _time, uint64_t* _msec = 0);
 QString OperationTableSource::getItem(uint32_t _index, int32_t _column, QColor* _color, bool* _setColor)
 {
-	uint32_t index = _index;
-	if (m_sortOrder == Qt::DescendingOrder)
-		index = m_numRows - index - 1;
+	const uint32_t idx = getOpIndex(_index);
+	if (idx == INVALID_INDEX)
+		return (_column == 0) ? QObject::tr("Sorting...") : QString();
 
-	uint32_t idx = m_mapping.m_sortedIndex[index];
-	const rtm::MemoryOperation* op = m_mapping.m_allOps->operator[](idx);
+	const rtm::MemoryOperation* op = (*m_allOps)[idx];
 
 	bool leaked = isLeakedBlock(op);
 	if (_color)
@@ -332,16 +349,17 @@ QString OperationTableSource::getItem(uint32_t _index, int32_t _column, QColor*
 	return "";
 }
 
+
 void OperationTableSource::getItem(uint32_t _index, void** _pointer)
 {
 	if (_index == -1)
 		return;
 
-	uint32_t index = _index;
-	if (m_sortOrder == Qt::DescendingOrder)
-		index = m_numRows - index - 1;
-	uint32_t idx = m_mapping.m_sortedIndex[index];
-	const rtm::MemoryOperation* op = m_mapping.m_allOps->operator[](idx);
+	const uint32_t idx = getOpIndex(_index);
+	if (idx == INVALID_INDEX)
+		return;
+
+	const rtm::MemoryOperation* op = (*m_allOps)[idx];
 	*_pointer = (void*)(op);
 }
 
@@ -360,100 +378,276 @@ Qt::AlignmentFlag OperationTableSource::getAlignment(uint32_t _index)
 
 uint32_t OperationTableSource::getItemIndex(void* _item)
 {
-	uint32_t index = ((rtm::MemoryOperation*)_item)->m_indexMapping;
+	const uint32_t opIndex = findOpIndex((const rtm::MemoryOperation*)_item);
+	if (opIndex == INVALID_INDEX)
+		return INVALID_INDEX;
+
+	if (isSorting() && !m_showMatches)
+	{
+		rtm_vector<uint32_t>::const_iterator it = std::find(m_topRows.begin(), m_topRows.end(), opIndex);
+		return it == m_topRows.end() ? INVALID_INDEX : (uint32_t)(it - m_topRows.begin());
+	}
+
+	if (m_positions.empty())
+	{
+		m_positions.resize(m_numRows);
+		for (uint32_t i=0; i<m_numRows; ++i)
+			m_positions[m_mapping.m_sortedIndex[i]] = i;
+	}
+
+	uint32_t index = m_positions[opIndex];
+
+	if (m_showMatches)
+	{
+		const rtm_vector<uint32_t>& positions = m_matches.m_positions;
+		rtm_vector<uint32_t>::const_iterator it = std::lower_bound(positions.begin(), positions.end(), index);
+		if ((it == positions.end()) || (*it != index))
+			return INVALID_INDEX;
+		index = (uint32_t)(it - positions.begin());
+	}
+
 	if (m_sortOrder == Qt::DescendingOrder)
-		index = m_numRows - index - 1;
+		index = getNumberOfRows() - index - 1;
 	return index;
 }
 
+//--------------------------------------------------------------------------
+/// Sorting is split in two steps, first rows are selected immediately and
+/// the full order is computed by a background job. Reversing the order of
+/// the sorted column needs no sorting at all.
+//--------------------------------------------------------------------------
 void OperationTableSource::sortColumn(uint32_t _columnIndex, Qt::SortOrder _sortOrder)
 {
-	pSetIndex psSetIdx(m_mapping.m_sortedIndex);
-	RTM_PARALLEL_FOR_EACH(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psSetIdx);
+	const bool sameColumn = (_columnIndex == m_currentColumn);
 
-	switch (_columnIndex)
+	m_currentColumn	= _columnIndex;
+	m_sortOrder		= _sortOrder;
+
+	if (sameColumn)
 	{
-		case OperationColumn::ThreadID:
-		{
-			pSortThreadID psThreadID(m_allOps);
-			RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psThreadID);
-		}
-		break;
-			
-		case OperationColumn::Heap:
-		{
-			pSortHeap psHeap(m_allOps);
-			RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psHeap);
-		}
-		break;
-			
-		case OperationColumn::Address:
-		{
-			pSortAddress psAddress(m_allOps);
-			RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psAddress);
-		}
-		break;
+		// latest job already sorts this column, only first rows change
+		SortJob* job = m_pendingJob ? m_pendingJob : m_sortJob;
+		if (isSorting() && job)
+			selectTopRows(job->m_keys);
+		return;
+	}
 
-		case OperationColumn::Type:
-		{
-			pSortOpType psType(m_allOps);
-			RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psType );
-		}
-		break;
+	++m_sortVersion;
+	m_topRows.clear();
 
-		case OperationColumn::Size:
-		{
-			pSortOpSize psSize(m_allOps);
-			RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psSize );
-		}
-		break;
+	if (_columnIndex == m_mappingColumn)
+		return;
 
-		case OperationColumn::Alignment:
+	if (!s_sortKeys[_columnIndex])
+	{
+		std::iota(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), 0);
+		m_mappingColumn = _columnIndex;
+		m_positions.clear();
+		invalidateSearch();
+		return;
+	}
+
+	SortJob* job = new SortJob;
+	job->m_column	= _columnIndex;
+	job->m_version	= m_sortVersion;
+	job->m_keys.resize(m_numRows);
+	rtm::extractKeys(job->m_keys.data(), m_numRows, s_sortKeys[_columnIndex], m_allOps);
+
+	selectTopRows(job->m_keys);
+	startSort(job);
+}
+
+void OperationTableSource::selectTopRows(const rtm_vector<uint64_t>& _keys)
+{
+	m_topRows.resize(TOP_ROWS);
+	m_topRows.resize(rtm::sortTopKeys(m_topRows.data(), TOP_ROWS, _keys.data(), (uint32_t)_keys.size(), m_sortOrder == Qt::DescendingOrder));
+}
+
+void OperationTableSource::startSort(SortJob* _job)
+{
+	QFutureWatcher<void>* watcher = m_list->getSortWatcher();
+	if (watcher->isRunning())
+	{
+		delete m_pendingJob;
+		m_pendingJob = _job;
+		return;
+	}
+
+	m_sortJob = _job;
+	watcher->setFuture(QtConcurrent::run([_job]()
+	{
+		_job->m_sortedIndex.resize(_job->m_keys.size());
+		rtm::radixSort(_job->m_sortedIndex.data(), _job->m_keys.data(), (uint32_t)_job->m_keys.size());
+	}));
+}
+
+//--------------------------------------------------------------------------
+/// Called on the GUI thread, returns true if the view order has changed
+//--------------------------------------------------------------------------
+bool OperationTableSource::sortFinished()
+{
+	SortJob* job = m_sortJob;
+	m_sortJob = NULL;
+
+	bool applied = false;
+	if (job && (job->m_version == m_sortVersion))
+	{
+		m_mapping.m_sortedIndex.swap(job->m_sortedIndex);
+		m_mappingColumn = job->m_column;
+		m_topRows.clear();
+		m_positions.clear();
+		invalidateSearch();
+		applied = true;
+	}
+	delete job;
+
+	if (m_pendingJob)
+	{
+		SortJob* pending = m_pendingJob;
+		m_pendingJob = NULL;
+
+		if (pending->m_version == m_sortVersion)
+			startSort(pending);
+		else
+			delete pending;
+	}
+
+	return applied;
+}
+
+//--------------------------------------------------------------------------
+/// Finds closest matching operation after (or before) the given row in the
+/// display order, 0xffffffff row starts from the first (or last) one.
+//--------------------------------------------------------------------------
+void* OperationTableSource::find(int _key, uint64_t _min, uint64_t _max, uint32_t _row, bool _next)
+{
+	// search runs on the previous order until the sort job is done
+	if (isSorting())
+		_row = INVALID_INDEX;
+
+	const rtm_vector<uint32_t>& positions = getMatches(_key, _min, _max).m_positions;
+	if (positions.empty())
+		return NULL;
+
+	// rows run backwards through positions in descending order
+	const bool forward = (_next == (m_sortOrder == Qt::AscendingOrder));
+
+	uint32_t position;
+	if (_row == INVALID_INDEX)
+		position = forward ? positions.front() : positions.back();
+	else
+	{
+		const uint32_t current = getPosition(_row);
+		if (forward)
 		{
-			pSortOpAlignment psAlignment(m_allOps);
-			RTM_PARALLEL_SORT(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psAlignment );
+			rtm_vector<uint32_t>::const_iterator it = std::upper_bound(positions.begin(), positions.end(), current);
+			if (it == positions.end())
+				return NULL;
+			position = *it;
 		}
-		break;
-
-		case OperationColumn::Time:
+		else
 		{
+			rtm_vector<uint32_t>::const_iterator it = std::lower_bound(positions.begin(), positions.end(), current);
+			if (it == positions.begin())
+				return NULL;
+			position = *(it - 1);
 		}
-		break;
-	};
+	}
 
-	pSetOpMappings psMap(m_allOps, m_mapping);
-	RTM_PARALLEL_FOR_EACH(m_mapping.m_sortedIndex.begin(), m_mapping.m_sortedIndex.end(), psMap);
+	return (*m_allOps)[m_mapping.m_sortedIndex[position]];
+}
 
-	m_currentColumn	= _columnIndex;
-	m_sortOrder		= _sortOrder;
+void OperationTableSource::showMatches(int _key, uint64_t _min, uint64_t _max, bool _show)
+{
+	if (_show)
+		getMatches(_key, _min, _max);
+	m_showMatches = _show;
 }
 
-void* OperationTableSource::FindNextByAddress(uint64_t _address, uint32_t _startIndex)
+//--------------------------------------------------------------------------
+/// Returns index of operation shown in a row, INVALID_INDEX if not sorted yet
+//--------------------------------------------------------------------------
+uint32_t OperationTableSource::getOpIndex(uint32_t _row) const
 {
-	uint32_t numItems = (uint32_t)m_mapping.m_sortedIndex.size();
-	for (uint32_t i=_startIndex+1; i<numItems; ++i)
+	if (isSorting() && !m_showMatches)
 	{
-		uint32_t index = m_mapping.m_sortedIndex[i];
-		rtm::MemoryOperation* op = m_allOps->operator[](index);
-		if (op->m_pointer == _address)
-			return op;
+		if (_row < m_topRows.size())
+			return m_topRows[_row];
+		return INVALID_INDEX;
 	}
 
-	return NULL;
+	return m_mapping.m_sortedIndex[getPosition(_row)];
+}
+
+//--------------------------------------------------------------------------
+/// Operations are in time order, only ones with equal time are compared
+//--------------------------------------------------------------------------
+uint32_t OperationTableSource::findOpIndex(const rtm::MemoryOperation* _op) const
+{
+	rtm_vector<rtm::MemoryOperation*>::const_iterator it = std::lower_bound(m_allOps->begin(), m_allOps->end(), _op->m_operationTime,
+		[](const rtm::MemoryOperation* _o, uint64_t _time) { return _o->m_operationTime < _time; });
+
+	for (; (it != m_allOps->end()) && ((*it)->m_operationTime == _op->m_operationTime); ++it)
+		if (*it == _op)
+			return (uint32_t)(it - m_allOps->begin());
+
+	return INVALID_INDEX;
 }
 
-void* OperationTableSource::FindNextBySize(uint64_t _size, uint32_t _startIndex)
+uint32_t OperationTableSource::getPosition(uint32_t _row) const
 {
-	uint32_t numItems = (uint32_t)m_mapping.m_sortedIndex.size();
-	for (uint32_t i=_startIndex+1; i<numItems; ++i)
+	uint32_t index = _row;
+	if (m_sortOrder == Qt::DescendingOrder)
+		index = getRowCount() - index - 1;
+	return m_showMatches ? m_matches.m_positions[index] : index;
+}
+
+//--------------------------------------------------------------------------
+/// Indices are built for the current order on first search
+//--------------------------------------------------------------------------
+void OperationTableSource::invalidateSearch()
+{
+	for (SearchIndex& index : m_searchIndex)
+		index.m_valid = false;
+	m_matches.m_valid = false;
+
+	if (m_showMatches)
+		getMatches(m_matches.m_key, m_matches.m_min, m_matches.m_max);
+}
+
+const SearchResult& OperationTableSource::getMatches(int _key, uint64_t _min, uint64_t _max)
+{
+	if (m_matches.m_valid && (m_matches.m_key == _key) && (m_matches.m_min == _min) && (m_matches.m_max == _max))
+		return m_matches;
+
+	SearchIndex& index = m_searchIndex[_key];
+	if (!index.m_valid)
 	{
-		uint32_t index = m_mapping.m_sortedIndex[i];
-		rtm::MemoryOperation* op = m_allOps->operator[](index);
-		if (op->m_allocSize == _size)
-			return op;
+		index.m_positions.resize(m_numRows);
+		rtm::radixSort(index.m_positions.data(), m_numRows, s_searchKeys[_key], &m_mapping);
+		index.m_valid = true;
 	}
 
-	return NULL;
+	const rtm::RadixKeyFunc getKey = s_searchKeys[_key];
+	const Mapping* mapping = &m_mapping;
+
+	rtm_vector<uint32_t>::const_iterator first = std::lower_bound(index.m_positions.begin(), index.m_positions.end(), _min,
+		[getKey, mapping](uint32_t _position, uint64_t _value) { return getKey(mapping, _position) < _value; });
+
+	rtm_vector<uint32_t>::const_iterator last = std::upper_bound(first, index.m_positions.cend(), _max,
+		[getKey, mapping](uint64_t _value, uint32_t _position) { return _value < getKey(mapping, _position); });
+
+	m_matches.m_positions.assign(first, last);
+
+	// equal keys are already in position order
+	if (_min != _max)
+		std::sort(m_matches.m_positions.begin(), m_matches.m_positions.end());
+
+	m_matches.m_key		= _key;
+	m_matches.m_min		= _min;
+	m_matches.m_max		= _max;
+	m_matches.m_valid	= true;
+	return m_matches;
 }
 
 void OperationTableSource::saveState(QSettings& _settings)
@@ -476,15 +670,17 @@ OperationsList::OperationsList(QWidget* _parent, Qt::WindowFlags _flags) :
 	m_operationSearch = findChild<OperationSearch*>("operationSearchWidget");
 
 	connect(m_operationList, SIGNAL(itemSelected(void*)), this, SLOT(selectionChanged(void*)));
+	connect(&m_sortWatcher, SIGNAL(finished()), this, SLOT(sortFinished()));
 
 	connect(m_operationSearch, SIGNAL(findPrev()), this, SLOT(selectPrevious()));
 	connect(m_operationSearch, SIGNAL(findNext()), this, SLOT(selectNext()));
-	connect(m_operationSearch, SIGNAL(searchByAddress(uint64_t)), this, SLOT(selectNextByAddress(uint64_t)));
-	connect(m_operationSearch, SIGNAL(searchBySize(uint64_t)), this, SLOT(selectNextBySize(uint64_t)));
+	connect(m_operationSearch, SIGNAL(search(int,uint64_t,uint64_t,bool)), this, SLOT(search(int,uint64_t,uint64_t,bool)));
+	connect(m_operationSearch, SIGNAL(showMatches(int,uint64_t,uint64_t,bool)), this, SLOT(showMatches(int,uint64_t,uint64_t,bool)));
 }
 
 OperationsList::~OperationsList()
 {
+	m_sortWatcher.waitForFinished();
 	delete m_tableSource;
 }
 
@@ -498,6 +694,9 @@ void OperationsList::changeEvent(QEvent* _event)
 void OperationsList::setContext(CaptureContext* _context, bool _valid)
 {
 	m_context = _context;
+
+	m_sortWatcher.waitForFinished();
+	delete m_tableSource;
 	m_tableSource = new OperationTableSource(_context, _valid, this);
 	m_operationList->setSource(m_tableSource);
 
@@ -568,6 +767,12 @@ void OperationsList::selectionChanged(void* _item)
 	emit highlightTime(m_currentItem->m_operationTime);
 }
 
+void OperationsList::sortFinished()
+{
+	if (m_tableSource && m_tableSource->sortFinished())
+		m_operationList->updateTable();
+}
+
 void OperationsList::selectPrevious()
 {
 	m_operationList->select(m_currentItem->m_chainPrev);
@@ -578,19 +783,13 @@ void OperationsList::selectNext()
 	m_operationList->select(m_currentItem->m_chainNext);
 }
 
-void OperationsList::selectNextByAddress(uint64_t _address)
+void OperationsList::search(int _key, uint64_t _min, uint64_t _max, bool _next)
 {
-	void* item = NULL;
+	uint32_t row = 0xffffffff;
 	if (m_currentItem)
-	{
-		uint32_t index = m_tableSource->getItemIndex(m_currentItem);
-		item = m_tableSource->FindNextByAddress(_address,index);
-	}
-	else
-	{
-		item = m_tableSource->FindNextByAddress(_address,0);
-	}
+		row = m_tableSource->getItemIndex(m_currentItem);
 
+	void* item = m_tableSource->find(_key, _min, _max, row, _next);
 	if (item)
 	{
 		m_operationList->select(item);
@@ -598,22 +797,11 @@ void OperationsList::selectNextByAddress(uint64_t _address)
 	}
 }
 
-void OperationsList::selectNextBySize(uint64_t _size)
+void OperationsList::showMatches(int _key, uint64_t _min, uint64_t _max, bool _show)
 {
-	void* item = NULL;
-	if (m_currentItem)
-	{
-		uint32_t index = m_tableSource->getItemIndex(m_currentItem);
-		item = m_tableSource->FindNextBySize(_size,index);
-	}
-	else
-	{
-		item = m_tableSource->FindNextBySize(_size,0);
-	}
+	m_tableSource->showMatches(_key, _min, _max, _show);
+	m_operationList->resetView();
 
-	if (item)
-	{
-		m_operationList->select(item);
-		selectionChanged(item);
-	}
+	if (m_currentItem && (m_tableSource->getItemIndex(m_currentItem) != 0xffffffff))
+		m_operationList->select(m_currentItem);
 }
@@ -7,6 +7,7 @@
 #define RTM_MTUNER_OPERATIONSLIST_H
 
 #include <MTuner/.qt/qt_ui/operationslist_ui.h>
+#include <QtCore/QFutureWatcher>
 
 struct CaptureContext;
 class OperationTableSource;
@@ -22,6 +23,7 @@ private:
 	OperationTableSource*	m_tableSource;
 	rtm::MemoryOperation*	m_currentItem;
 	bool					m_enableFiltering;
+	QFutureWatcher<void>	m_sortWatcher;
 
 	int						m_savedColumn;
 	Qt::SortOrder			m_savedOrder;
@@ -38,6 +40,7 @@ public:
 	void setFilteringState(bool _state);
 	bool getFilteringState() const;
 	void setSearchVisible(bool _visible) { m_operationSearch->setVisible(_visible);  }
+	QFutureWatcher<void>* getSortWatcher() { return &m_sortWatcher; }
 
 	void loadState(QSettings& _settings, const QString& _name, bool _resetGeometry);
 	void saveState(QSettings& _settings);
@@ -48,10 +51,11 @@ Q_SIGNALS:
 
 public Q_SLOTS:
 	void selectionChanged(void*);
+	void sortFinished();
 	void selectPrevious();
 	void selectNext();
-	void selectNextByAddress(uint64_t);
-	void selectNextBySize(uint64_t);
+	void search(int _key, uint64_t _min, uint64_t _max, bool _next);
+	void showMatches(int _key, uint64_t _min, uint64_t _max, bool _show);
 
 private:
 	Ui::OperationsListWidget ui;
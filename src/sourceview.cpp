@@ -10,6 +10,8 @@
 #include <MTuner/src/external_editor.h>
 #include <MTuner/src/capturecontext.h>
 
+#include <limits.h>
+
 SourceView::SourceView(QWidget* _parent) : 
 	QPlainTextEdit(_parent)
 {
@@ -20,6 +22,7 @@ SourceView::SourceView(QWidget* _parent) :
 	m_openInEditorAction	= NULL;
 	m_editorDialog			= NULL;
 	m_context				= NULL;
+	m_tabWidth				= 4;
 
 	connect(this, SIGNAL(blockCountChanged(int)), this, SLOT(updateLineNumberAreaWidth(int)));
 	connect(this, SIGNAL(updateRequest(QRect,int)), this, SLOT(updateLineNumberArea(QRect,int)));
@@ -34,12 +37,15 @@ SourceView::SourceView(QWidget* _parent) :
 
 	setFont(font);
 	lineNumberArea->setFont(font);
-	setReadOnly(true);
-	setWordWrapMode(QTextOption::NoWrap);
 	setCenterOnScroll(true);
-	setTabWidth(4);
 
-	new Highlighter(document());
+	// default document is owned by the editor and gets deleted once another one is set
+	m_emptyDocument = new QTextDocument(this);
+	m_emptyDocument->setDocumentLayout(new QPlainTextDocumentLayout(m_emptyDocument));
+	m_emptyDocument->setDefaultFont(font);
+	showDocument(m_emptyDocument);
+
+	m_highlighter = new Highlighter(this);
 
 	createCustomContextMenu();
 }
@@ -75,6 +81,7 @@ int SourceView::lineNumberAreaWidth()
 
 void SourceView::setTabWidth(int _width)
 {
+	m_tabWidth = _width;
 	setTabStopDistance(fontMetrics().horizontalAdvance(QLatin1Char(' ')) * _width);
 }
 
@@ -113,49 +120,120 @@ void SourceView::updateLineNumberArea(const QRect& _rect, int _dy)
 		updateLineNumberAreaWidth(0);
 }
 
+//--------------------------------------------------------------------------
+/// Returns absolute path of the source file, relative paths are looked up
+/// in the symbol store directory. Lookups are remembered, failed ones too.
+//--------------------------------------------------------------------------
+QString SourceView::resolvePath(const QString& _file)
+{
+	QString symDir;
+	if (m_context)
+		symDir = QString::fromUtf8(m_context->getSymbolStoreDir().c_str());
+
+	const QString key = symDir + QLatin1Char('\n') + _file;
+	QHash<QString, QString>::const_iterator it = m_resolvedPaths.constFind(key);
+	if (it != m_resolvedPaths.constEnd())
+		return it.value();
+
+	QString path;
+	QFileInfo info(_file);
+	if (info.isFile())
+		path = info.absoluteFilePath();
+	else
+	if (m_context)
+	{
+		QFileInfo infoRel(QDir(symDir), _file);
+		if (infoRel.isFile())
+			path = infoRel.absoluteFilePath();
+	}
+
+	m_resolvedPaths.insert(key, path);
+	return path;
+}
+
+//--------------------------------------------------------------------------
+/// Returns loaded document of a source file, files are read memory mapped
+/// when possible and kept loaded (with their highlighting) in LRU order.
+//--------------------------------------------------------------------------
+QTextDocument* SourceView::getDocument(const QString& _path)
+{
+	for (int i=0; i<m_documents.size(); ++i)
+	{
+		if (m_documents[i].m_path == _path)
+		{
+			if (i)
+				m_documents.move(i, 0);
+			return m_documents[0].m_document;
+		}
+	}
+
+	QFile file(_path);
+	if (!file.open(QFile::ReadOnly))
+		return NULL;
+
+	QString text;
+	const qint64 size = file.size();
+	uchar* data = ((size > 0) && (size < INT_MAX)) ? file.map(0, size) : NULL;
+	if (data)
+	{
+		text = QString::fromUtf8((const char*)data, (int)size);
+		file.unmap(data);
+	}
+	else
+		text = QString::fromUtf8(file.readAll());
+	file.close();
+
+	text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+
+	QTextDocument* doc = new QTextDocument(this);
+	doc->setDocumentLayout(new QPlainTextDocumentLayout(doc));
+	doc->setDefaultFont(font());
+	doc->setPlainText(text);
+	doc->setUndoRedoEnabled(false);
+
+	SourceDocument sourceDoc;
+	sourceDoc.m_path		= _path;
+	sourceDoc.m_document	= doc;
+	m_documents.prepend(sourceDoc);
+
+	while (m_documents.size() > MAX_CACHED_DOCUMENTS)
+		delete m_documents.takeLast().m_document;
+
+	return doc;
+}
+
+void SourceView::showDocument(QTextDocument* _document)
+{
+	if (document() == _document)
+		return;
+
+	// wrap mode and tab stops are options of the document, not the editor
+	setDocument(_document);
+	setReadOnly(true);
+	setWordWrapMode(QTextOption::NoWrap);
+	setTabWidth(m_tabWidth);
+	updateLineNumberAreaWidth(0);
+}
+
 void SourceView::openFile(const QString& _file, int _row, int _col)
 {
 	RTM_UNUSED(_col);
-	QFile file(_file);
-	if (file.open(QFile::ReadOnly | QFile::Text))
+
+	const QString path = _file.isEmpty() ? QString() : resolvePath(_file);
+	QTextDocument* doc = path.isEmpty() ? NULL : getDocument(path);
+	if (doc)
 	{
-		m_currentFile = _file;
+		m_currentFile = path;
 		m_currentLine = _row;
-		setPlainText(file.readAll());
+		showDocument(doc);
 		m_openInEditorAction->setEnabled(true);
-		file.close();
 	}
 	else
 	{
-		bool set = false;
-		if (m_context)
-		{
-			QString symDir(QString::fromUtf8(m_context->getSymbolStoreDir().c_str()));
-			QDir symD = symDir;
-
-			QFileInfo info(symD, _file);
-			if (info.exists())
-			{
-				QFile fileRel(info.absoluteFilePath());
-				if (fileRel.open(QFile::ReadOnly | QFile::Text))
-				{
-					m_currentFile = info.absoluteFilePath();
-					m_currentLine = _row;
-					setPlainText(fileRel.readAll());
-					m_openInEditorAction->setEnabled(true);
-					fileRel.close();
-					set = true;
-				}
-			}
-		}
-
-		if (!set)
-		{
-			m_currentFile = "";
-			m_currentLine = -1;
-			setPlainText("");
-			m_openInEditorAction->setEnabled(false);
-		}
+		m_currentFile = "";
+		m_currentLine = -1;
+		showDocument(m_emptyDocument);
+		m_openInEditorAction->setEnabled(false);
 	}
 
 	if (m_currentLine != -1)
@@ -193,6 +271,26 @@ void SourceView::resizeEvent(QResizeEvent* _event)
 	lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
 }
 
+void SourceView::paintEvent(QPaintEvent* _event)
+{
+	highlightVisibleBlocks();
+	QPlainTextEdit::paintEvent(_event);
+}
+
+void SourceView::highlightVisibleBlocks()
+{
+	QTextBlock block = firstVisibleBlock();
+	qreal top = blockBoundingGeometry(block).translated(contentOffset()).top();
+	const int bottom = viewport()->rect().bottom();
+
+	while (block.isValid() && (top <= bottom))
+	{
+		m_highlighter->highlightBlock(block);
+		top += blockBoundingRect(block).height();
+		block = block.next();
+	}
+}
+
 void SourceView::highlightCurrentLine()
 {
 	QList<QTextEdit::ExtraSelection> extraSelections;
@@ -15,20 +15,37 @@ class QWidget;
 
 class LineNumberArea;
 class ExternalEditor;
+class Highlighter;
 struct CaptureContext;
 
 class SourceView : public QPlainTextEdit
 {
 	Q_OBJECT
 
-	QString			m_currentFile;
-	int				m_currentLine;
-	QMenu*			m_contextMenu;
-	QAction*		m_tabWidthAction4;
-	QAction*		m_tabWidthAction8;
-	QAction*		m_openInEditorAction;
-	ExternalEditor*	m_editorDialog;
-	CaptureContext*	m_context;
+	enum
+	{
+		MAX_CACHED_DOCUMENTS = 16
+	};
+
+	struct SourceDocument
+	{
+		QString			m_path;
+		QTextDocument*	m_document;
+	};
+
+	QString					m_currentFile;
+	int						m_currentLine;
+	int						m_tabWidth;
+	QMenu*					m_contextMenu;
+	QAction*				m_tabWidthAction4;
+	QAction*				m_tabWidthAction8;
+	QAction*				m_openInEditorAction;
+	ExternalEditor*			m_editorDialog;
+	CaptureContext*			m_context;
+	Highlighter*			m_highlighter;
+	QTextDocument*			m_emptyDocument;
+	QList<SourceDocument>	m_documents;		///< Loaded files, most recently used first
+	QHash<QString, QString>	m_resolvedPaths;	///< Resolved path per requested file, empty if not found
 
 public:
 	SourceView(QWidget* _parent = 0);
@@ -38,12 +55,17 @@ public:
 	int  lineNumberAreaWidth();
 	void setTabWidth(int _width);
 	void setEditorDialog(ExternalEditor* _editor) { m_editorDialog = _editor; }
-	void setContext(CaptureContext* _context) { m_context = _context; }
+	void setContext(CaptureContext* _context) { m_context = _context; m_resolvedPaths.clear(); }
 
 protected:
 	void contextMenuEvent(QContextMenuEvent* _event);
 	void resizeEvent(QResizeEvent* _event);
+	void paintEvent(QPaintEvent* _event);
 	void createCustomContextMenu();
+	QString resolvePath(const QString& _file);
+	QTextDocument* getDocument(const QString& _path);
+	void showDocument(QTextDocument* _document);
+	void highlightVisibleBlocks();
 
 private Q_SLOTS:
 	void updateLineNumberAreaWidth(int _newBlockCount);
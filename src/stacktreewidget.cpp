@@ -6,6 +6,7 @@
 #include <MTuner_pch.h>
 #include <MTuner/src/stacktreewidget.h>
 #include <MTuner/src/capturecontext.h>
+#include <QtConcurrent/QtConcurrent>
 
 struct Header
 {
@@ -26,10 +27,26 @@ struct Header
 class TreeItem
 {
 public:
+	enum
+	{
+		NODE_ORDER		= -1
+	};
+
+	/// Row order of children for one sort column and direction
+	struct Ordering
+	{
+		int						m_key;
+		rtm_vector<uint32_t>	m_order;		///< Row to index into children
+	};
+
 	TreeItem(CaptureContext* _context, const rtm::StackTraceTree* _tree, TreeItem* _parent, const rtm::StackTraceTree* _root, int _depth);
 	~TreeItem();
 
 	void appendChild(TreeItem* _child);
+	void populate();
+	void resolve() const;
+	void setOrdering(int _key);
+	int  getOrderingKey() const { return m_ordering == NODE_ORDER ? (int)NODE_ORDER : m_orderings[m_ordering].m_key; }
 
 	TreeItem*			child(int _row);
 	int					childCount() const;
@@ -42,6 +59,16 @@ public:
 		return m_tree->m_stackTraceList;
 	}
 	int					depth() const { return m_depth; }
+	uint64_t			getAddress() const
+	{
+		return m_tree->m_stackTraceList->m_entries[m_tree->m_stackTraceList->m_numEntries - m_depth];
+	}
+	const rtm::StackTraceTree* node() const
+	{
+		// root item has no node of its own, its children are top level nodes
+		return m_parent ? m_tree : m_root;
+	}
+	bool				canFetchMore() const { return !m_populated && !node()->m_children.empty(); }
 
 	int							m_depth;
 	rtm_vector<TreeItem*>		m_children;
@@ -54,6 +81,14 @@ public:
 	mutable QString				m_func;
 	mutable int					m_line;
 	mutable bool				m_resolved;
+	bool						m_populated;	///< Items for child nodes are created on first expand
+	bool						m_expanded;
+	int							m_row;
+	int							m_ordering;		///< Index into orderings, NODE_ORDER if children are not sorted
+	rtm_vector<Ordering>		m_orderings;	///< Cached, tree does not change during lifetime of the model
+
+private:
+	void sortRows(Ordering& _ordering);
 };
 
 
@@ -69,20 +104,6 @@ static inline bool sortTreeFunc_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_func > _in2->m_func;
 }
 
-void sortTreeCol_Func_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeFunc_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Func_asc(item);
-}
-
-void sortTreeCol_Func_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeFunc_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Func_des(item);
-}
-
 // SORTING by module
 
 static inline bool sortTreeModule_asc(TreeItem* _in1, TreeItem* _in2)
@@ -95,20 +116,6 @@ static inline bool sortTreeModule_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_module > _in2->m_module;
 }
 
-void sortTreeCol_Module_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeModule_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Module_asc(item);
-}
-
-void sortTreeCol_Module_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeModule_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Module_des(item);
-}
-
 // SORTING by usage
 
 static inline bool sortTreeUsage_asc(TreeItem* _in1, TreeItem* _in2)
@@ -121,20 +128,6 @@ static inline bool sortTreeUsage_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_tree->m_memUsage > _in2->m_tree->m_memUsage;
 }
 
-void sortTreeCol_Usage_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeUsage_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Usage_asc(item);
-}
-
-void sortTreeCol_Usage_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeUsage_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Usage_des(item);
-}
-
 // SORTING by peak allocs
 static inline bool sortTreeAllocs_asc(TreeItem* _in1, TreeItem* _in2)
 {
@@ -146,20 +139,6 @@ static inline bool sortTreeAllocs_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_tree->m_opCount[rtm::StackTraceTree::Alloc] > _in2->m_tree->m_opCount[rtm::StackTraceTree::Alloc];
 }
 
-void sortTreeCol_Allocs_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeAllocs_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Allocs_asc(item);
-}
-
-void sortTreeCol_Allocs_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeAllocs_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Allocs_des(item);
-}
-
 // SORTING by peak frees
 static inline bool sortTreeFrees_asc(TreeItem* _in1, TreeItem* _in2)
 {
@@ -171,20 +150,6 @@ static inline bool sortTreeFrees_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_tree->m_opCount[rtm::StackTraceTree::Free] > _in2->m_tree->m_opCount[rtm::StackTraceTree::Free];
 }
 
-void sortTreeCol_Frees_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeFrees_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Frees_asc(item);
-}
-
-void sortTreeCol_Frees_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeFrees_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Frees_des(item);
-}
-
 // SORTING by peak reallocs
 static inline bool sortTreeReallocs_asc(TreeItem* _in1, TreeItem* _in2)
 {
@@ -196,20 +161,6 @@ static inline bool sortTreeReallocs_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_tree->m_opCount[rtm::StackTraceTree::Realloc] > _in2->m_tree->m_opCount[rtm::StackTraceTree::Realloc];
 }
 
-void sortTreeCol_Reallocs_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeReallocs_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Reallocs_asc(item);
-}
-
-void sortTreeCol_Reallocs_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeReallocs_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Reallocs_des(item);
-}
-
 // SORTING by peak usage
 
 static inline bool sortTreeUsagePeak_asc(TreeItem* _in1, TreeItem* _in2)
@@ -222,20 +173,6 @@ static inline bool sortTreeUsagePeak_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_tree->m_memUsagePeak > _in2->m_tree->m_memUsagePeak;
 }
 
-void sortTreeCol_PeakUsage_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeUsagePeak_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_PeakUsage_asc(item);
-}
-
-void sortTreeCol_PeakUsage_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeUsagePeak_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_PeakUsage_des(item);
-}
-
 // SORTING by file
 
 static inline bool sortTreeFile_asc(TreeItem* _in1, TreeItem* _in2)
@@ -248,20 +185,6 @@ static inline bool sortTreeFile_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_file > _in2->m_file;
 }
 
-void sortTreeCol_File_asc(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeFile_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_File_asc(item);
-}
-
-void sortTreeCol_File_des(TreeItem* _item)
-{
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeFile_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_File_des(item);
-}
-
 // SORTING by line
 
 static inline bool sortTreeLine_asc(TreeItem* _in1, TreeItem* _in2)
@@ -274,23 +197,40 @@ static inline bool sortTreeLine_des(TreeItem* _in1, TreeItem* _in2)
 	return _in1->m_line > _in2->m_line;
 }
 
-void sortTreeCol_Line_asc(TreeItem* _item)
+typedef bool (*TreeItemCompare)(TreeItem*, TreeItem*);
+
+static inline int getSortKey(int _column, Qt::SortOrder _order)
 {
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeLine_asc);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Line_asc(item);
+	if (_column < 0)
+		return TreeItem::NODE_ORDER;
+	return _column * 2 + (_order == Qt::DescendingOrder ? 1 : 0);
 }
 
-void sortTreeCol_Line_des(TreeItem* _item)
+static TreeItemCompare getSortCompare(int _key)
 {
-	std::sort(_item->m_children.begin(), _item->m_children.end(), sortTreeLine_des);
-	for (TreeItem* item : _item->m_children)
-		sortTreeCol_Line_des(item);
+	const bool asc = (_key & 1) == 0;
+	switch (_key / 2)
+	{
+		case Header::Name:		return asc ? sortTreeFunc_asc		: sortTreeFunc_des;
+		case Header::Module:	return asc ? sortTreeModule_asc		: sortTreeModule_des;
+		case Header::Usage:		return asc ? sortTreeUsage_asc		: sortTreeUsage_des;
+		case Header::PeakUsage:	return asc ? sortTreeUsagePeak_asc	: sortTreeUsagePeak_des;
+		case Header::Allocs:	return asc ? sortTreeAllocs_asc		: sortTreeAllocs_des;
+		case Header::Frees:		return asc ? sortTreeFrees_asc		: sortTreeFrees_des;
+		case Header::Reallocs:	return asc ? sortTreeReallocs_asc	: sortTreeReallocs_des;
+		case Header::File:		return asc ? sortTreeFile_asc		: sortTreeFile_des;
+		case Header::Line:		return asc ? sortTreeLine_asc		: sortTreeLine_des;
+	};
+	return 0;
 }
 
 TreeItem::TreeItem(CaptureContext* _context, const rtm::StackTraceTree* _tree, TreeItem* _parent, const rtm::StackTraceTree* _root, int _depth)
 {
 	m_resolved	= false;
+	m_populated	= false;
+	m_expanded	= false;
+	m_row		= 0;
+	m_ordering	= NODE_ORDER;
 	m_context	= _context;
 	m_tree		= _tree;
 	m_root		= _root;
@@ -309,12 +249,112 @@ TreeItem::~TreeItem()
 
 void TreeItem::appendChild(TreeItem* _item)
 {
+	_item->m_row = (int)m_children.size();
 	m_children.push_back(_item);
 }
 
+void TreeItem::populate()
+{
+	const rtm::StackTraceTree::ChildNodes& children = node()->m_children;
+	m_children.reserve(children.size());
+	for (const rtm::StackTraceTree& child : children)
+		new TreeItem(m_context, &child, this, m_root, m_depth + 1);
+
+	m_populated = true;
+}
+
+void TreeItem::resolve() const
+{
+	if (m_resolved)
+		return;
+
+	rdebug::StackFrame frame;
+	m_context->resolveStackFrame(getAddress(), frame);
+
+	QString file = QString::fromUtf8(frame.m_file);
+
+	QString srcpath = QDir(file).path();
+	if (!QDir::isRelativePath(srcpath))
+		m_file = QDir(srcpath).absolutePath();
+	else
+		m_file = srcpath;
+
+	m_module	= QString::fromUtf8(frame.m_moduleName);
+	m_func		= QString::fromUtf8(frame.m_func);
+	m_line		= frame.m_line;
+	m_resolved	= true;
+}
+
+//--------------------------------------------------------------------------
+/// Orders children by sort key, orderings are computed once per key
+//--------------------------------------------------------------------------
+void TreeItem::setOrdering(int _key)
+{
+	m_ordering = NODE_ORDER;
+	if (_key != NODE_ORDER)
+	{
+		for (size_t i=0; i<m_orderings.size(); ++i)
+			if (m_orderings[i].m_key == _key)
+				m_ordering = (int)i;
+
+		if (m_ordering == NODE_ORDER)
+		{
+			const uint32_t numChildren = (uint32_t)m_children.size();
+
+			Ordering ordering;
+			ordering.m_key = _key;
+			ordering.m_order.resize(numChildren);
+			for (uint32_t i=0; i<numChildren; ++i)
+				ordering.m_order[i] = i;
+
+			sortRows(ordering);
+
+			m_ordering = (int)m_orderings.size();
+			m_orderings.push_back(std::move(ordering));
+		}
+	}
+
+	const uint32_t numChildren = (uint32_t)m_children.size();
+	for (uint32_t i=0; i<numChildren; ++i)
+		m_children[m_ordering == NODE_ORDER ? i : m_orderings[m_ordering].m_order[i]]->m_row = (int)i;
+}
+
+//--------------------------------------------------------------------------
+/// Sorts all rows by the ordering key
+//--------------------------------------------------------------------------
+void TreeItem::sortRows(Ordering& _ordering)
+{
+	const TreeItemCompare compare = getSortCompare(_ordering.m_key);
+	const int column = _ordering.m_key / 2;
+
+	// Text order depends on every row so all rows need resolved symbols. Rows
+	// resolved earlier are skipped and the rest are resolved concurrently,
+	// numeric columns resolve nothing.
+	if ((column == Header::Name) || (column == Header::Module) || (column == Header::File) || (column == Header::Line))
+	{
+		rtm_vector<TreeItem*> unresolved;
+		for (TreeItem* child : m_children)
+			if (!child->m_resolved)
+				unresolved.push_back(child);
+
+		QtConcurrent::blockingMap(unresolved.begin(), unresolved.end(), [](TreeItem* _item)
+		{
+			_item->resolve();
+		});
+	}
+
+	std::sort(_ordering.m_order.begin(), _ordering.m_order.end(), [this, compare](uint32_t _c1, uint32_t _c2)
+	{
+		return compare(m_children[_c1], m_children[_c2]);
+	});
+}
+
 TreeItem *TreeItem::child(int _row)
 {
-	return m_children[_row];
+	if (m_ordering == NODE_ORDER)
+		return m_children[_row];
+
+	return m_children[m_orderings[m_ordering].m_order[_row]];
 }
 
 int TreeItem::childCount() const
@@ -371,24 +411,7 @@ QVariant TreeItem::data(int _column) const
 	}
 	else
 	{
-		if (!m_resolved)
-		{
-			rdebug::StackFrame frame;
-			m_context->resolveStackFrame(m_tree->m_stackTraceList->m_entries[m_tree->m_stackTraceList->m_numEntries - m_depth], frame);
-
-			QString file = QString::fromUtf8(frame.m_file);
-
-			QString srcpath = QDir(file).path();
-			if (!QDir::isRelativePath(srcpath))
-				m_file = QDir(srcpath).absolutePath();
-			else
-				m_file = srcpath;
-
-			m_module	= QString::fromUtf8(frame.m_moduleName);
-			m_func		= QString::fromUtf8(frame.m_func);
-			m_line		= frame.m_line;
-			m_resolved	= true;
-		}
+		resolve();
 
 		switch (_column)
 		{
@@ -413,15 +436,7 @@ TreeItem* TreeItem::parent()
 
 int TreeItem::row() const
 {
-	if (m_parent)
-	{
-		const size_t children = m_parent->m_children.size();
-		for (size_t i=0; i<children; ++i)
-			if (m_parent->m_children[i] == this)
-				return (int)i;
-	}
-
-	return 0;
+	return m_row;
 }
 
 void ProgressBarDelegate::paint(QPainter* _painter, const QStyleOptionViewItem& _option, const QModelIndex& _index) const
@@ -488,10 +503,13 @@ QSize ProgressBarDelegate::sizeHint(const QStyleOptionViewItem& _option, const Q
 	return QStyledItemDelegate::sizeHint(_option, _index);
 }
 
-TreeModel::TreeModel(CaptureContext* _context, QObject* _parent) :
+TreeModel::TreeModel(CaptureContext* _context, bool _filtered, QObject* _parent) :
 	QAbstractItemModel(_parent)
 {
-	m_context = _context;
+	m_context		= _context;
+	m_filtered		= _filtered;
+	m_savedColumn	= -1;
+	m_savedOrder	= Qt::DescendingOrder;
 	updateData();
 }
 
@@ -510,75 +528,70 @@ int TreeModel::columnCount(const QModelIndex& _parent) const
 		return m_rootItem->columnCount();
 }
 
+//--------------------------------------------------------------------------
+/// Only expanded nodes are sorted, collapsed ones are sorted when expanded
+//--------------------------------------------------------------------------
 void TreeModel::sort(int _column, Qt::SortOrder _order)
 {
-	switch (_column)
-	{
-	case Header::Name:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_Func_asc(m_rootItem);
-			else
-				sortTreeCol_Func_des(m_rootItem);
-			break;
-
-	case Header::Module:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_Module_asc(m_rootItem);
-			else
-				sortTreeCol_Module_des(m_rootItem);
-			break;
-
-	case Header::Usage:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_Usage_asc(m_rootItem);
-			else
-				sortTreeCol_Usage_des(m_rootItem);
-			break;
-
-	case Header::Allocs:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_Allocs_asc(m_rootItem);
-			else
-				sortTreeCol_Allocs_des(m_rootItem);
-			break;
-
-	case Header::Frees:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_Frees_asc(m_rootItem);
-			else
-				sortTreeCol_Frees_des(m_rootItem);
-			break;
-
-	case Header::Reallocs:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_Reallocs_asc(m_rootItem);
-			else
-				sortTreeCol_Reallocs_des(m_rootItem);
-			break;
-
-	case Header::PeakUsage:	if (_order == Qt::AscendingOrder)
-				sortTreeCol_PeakUsage_asc(m_rootItem);
-			else
-				sortTreeCol_PeakUsage_des(m_rootItem);
-			break;
-
-	case Header::File:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_File_asc(m_rootItem);
-			else
-				sortTreeCol_File_des(m_rootItem);
-			break;
-
-	case Header::Line:
-			if (_order == Qt::AscendingOrder)
-				sortTreeCol_Line_asc(m_rootItem);
-			else
-				sortTreeCol_Line_des(m_rootItem);
-			break;
-	};
-
 	m_savedColumn	= _column;
 	m_savedOrder	= _order;
+
+	emit layoutAboutToBeChanged();
+	sortExpanded(m_rootItem, getSortKey(_column, _order));
+	updatePersistentIndexes();
+	emit layoutChanged();
+}
+
+void TreeModel::setExpanded(const QModelIndex& _index, bool _expanded)
+{
+	if (!_index.isValid())
+		return;
+
+	TreeItem* item = static_cast<TreeItem*>(_index.internalPointer());
+	item->m_expanded = _expanded;
+
+	if (!_expanded || !item->m_populated)
+		return;
+
+	// descendants that stayed expanded while collapsed missed sort changes too
+	const int key = getSortKey(m_savedColumn, m_savedOrder);
+	QList<QPersistentModelIndex> parents;
+	collectUnsorted(item, key, parents);
+	if (parents.isEmpty())
+		return;
+
+	emit layoutAboutToBeChanged(parents);
+	sortExpanded(item, key);
+	updatePersistentIndexes();
+	emit layoutChanged(parents);
+}
+
+void TreeModel::collectUnsorted(TreeItem* _item, int _key, QList<QPersistentModelIndex>& _parents)
+{
+	if (_item->getOrderingKey() != _key)
+		_parents << QPersistentModelIndex(createIndex(_item->row(), 0, _item));
+
+	for (TreeItem* child : _item->m_children)
+		if (child->m_populated && child->m_expanded)
+			collectUnsorted(child, _key, _parents);
+}
+
+void TreeModel::sortExpanded(TreeItem* _item, int _key)
+{
+	_item->setOrdering(_key);
+	for (TreeItem* child : _item->m_children)
+		if (child->m_populated && child->m_expanded)
+			sortExpanded(child, _key);
+}
+
+void TreeModel::updatePersistentIndexes()
+{
+	const QModelIndexList indexes = persistentIndexList();
+	for (const QModelIndex& index : indexes)
+	{
+		TreeItem* item = static_cast<TreeItem*>(index.internalPointer());
+		changePersistentIndex(index, createIndex(item->row(), index.column(), item));
+	}
 }
 
 QVariant TreeModel::data(const QModelIndex& _index, int _role) const
@@ -643,6 +656,33 @@ QModelIndex TreeModel::parent(const QModelIndex& _index) const
 	return createIndex(parentItem->row(), 0, parentItem);
 }
 
+bool TreeModel::hasChildren(const QModelIndex& _parent) const
+{
+	if (_parent.column() > 0)
+		return false;
+
+	const TreeItem* parentItem = _parent.isValid() ? static_cast<TreeItem*>(_parent.internalPointer()) : m_rootItem;
+	return !parentItem->node()->m_children.empty();
+}
+
+bool TreeModel::canFetchMore(const QModelIndex& _parent) const
+{
+	const TreeItem* parentItem = _parent.isValid() ? static_cast<TreeItem*>(_parent.internalPointer()) : m_rootItem;
+	return parentItem->canFetchMore();
+}
+
+void TreeModel::fetchMore(const QModelIndex& _parent)
+{
+	TreeItem* parentItem = _parent.isValid() ? static_cast<TreeItem*>(_parent.internalPointer()) : m_rootItem;
+	if (!parentItem->canFetchMore())
+		return;
+
+	beginInsertRows(_parent, 0, (int)parentItem->node()->m_children.size() - 1);
+	parentItem->populate();
+	parentItem->setOrdering(getSortKey(m_savedColumn, m_savedOrder));
+	endInsertRows();
+}
+
 int TreeModel::rowCount(const QModelIndex& _parent) const
 {
 	TreeItem *parentItem;
@@ -661,31 +701,15 @@ void TreeModel::updateData()
 {
 	const rtm::StackTraceTree*	tree = 0;
 
-	if (m_context->m_capture->getFilteringEnabled())
+	if (m_filtered)
 		tree = &m_context->m_capture->getStackTraceTreeFiltered();
 	else
 		tree = &m_context->m_capture->getStackTraceTree();
 
+	// only top level items are created, deeper levels are created by fetchMore when expanded
 	m_rootItem = new TreeItem(m_context, 0, 0, tree, 0);
-
-	if (m_context->m_capture->getFilteringEnabled())
-		setupModelData(m_context->m_capture->getStackTraceTreeFiltered(), m_rootItem, tree, 1);
-	else
-		setupModelData(m_context->m_capture->getStackTraceTree(), m_rootItem, tree, 1);
-}
-
-void TreeModel::setupModelData(const rtm::StackTraceTree& _tree, TreeItem* _parent, const rtm::StackTraceTree* _root, int _depth)
-{
-	rtm::StackTraceTree::ChildNodes::const_iterator it  = _tree.m_children.begin();
-	rtm::StackTraceTree::ChildNodes::const_iterator end = _tree.m_children.end();
-	while (it != end)
-	{
-		const rtm::StackTraceTree& tree = *it;
-
-		TreeItem* treeItem = new TreeItem(m_context, &tree, _parent, _root, _depth);
-		setupModelData(tree, treeItem, _root, _depth+1);
-		++it;
-	}
+	m_rootItem->m_expanded = true;
+	m_rootItem->populate();
 }
 
 StackTreeWidget::StackTreeWidget(QWidget* _parent, Qt::WindowFlags _flags) :
@@ -698,6 +722,9 @@ StackTreeWidget::StackTreeWidget(QWidget* _parent, Qt::WindowFlags _flags) :
 	m_enableFiltering		= false;
 	m_tree					= findChild<QTreeView*>("treeWidget");
 	m_tree->setItemDelegate( new ProgressBarDelegate() );
+
+	connect(m_tree, SIGNAL(expanded(const QModelIndex&)), this, SLOT(rowExpanded(const QModelIndex&)));
+	connect(m_tree, SIGNAL(collapsed(const QModelIndex&)), this, SLOT(rowCollapsed(const QModelIndex&)));
 }
 
 StackTreeWidget::~StackTreeWidget()
@@ -768,7 +795,7 @@ bool StackTreeWidget::getFilteringState() const
 
 void StackTreeWidget::setupTree()
 {
-	TreeModel* model = new TreeModel(m_context);
+	TreeModel* model = new TreeModel(m_context, m_enableFiltering);
 	m_tree->setModel(model);
 
 	if (!m_headerStateRestored)
@@ -788,6 +815,34 @@ void StackTreeWidget::setupTree()
 	m_tree->setUniformRowHeights(true);
 }
 
+//--------------------------------------------------------------------------
+/// Children of the expanded row are shown now, their children are next
+//--------------------------------------------------------------------------
+void StackTreeWidget::rowExpanded(const QModelIndex& _index)
+{
+	TreeItem* item = static_cast<TreeItem*>(_index.internalPointer());
+	if (!item || !m_context)
+		return;
+
+	// sort column may have changed while the row was collapsed
+	((TreeModel*)m_tree->model())->setExpanded(_index, true);
+
+	// grandchildren have no items yet, addresses are read from the tree nodes
+	const int depth = item->depth() + 2;
+
+	rtm_vector<uint64_t> addresses;
+	for (const rtm::StackTraceTree& child : item->node()->m_children)
+		for (const rtm::StackTraceTree& grandChild : child.m_children)
+			addresses.push_back(grandChild.m_stackTraceList->m_entries[grandChild.m_stackTraceList->m_numEntries - depth]);
+
+	m_context->prefetchFrames(addresses.data(), (uint32_t)addresses.size());
+}
+
+void StackTreeWidget::rowCollapsed(const QModelIndex& _index)
+{
+	((TreeModel*)m_tree->model())->setExpanded(_index, false);
+}
+
 void StackTreeWidget::rowClicked(const QModelIndex& _index)
 {
 	TreeItem *item = static_cast<TreeItem*>(_index.internalPointer());
@@ -18,12 +18,13 @@ class TreeModel : public QAbstractItemModel
 private:
 	CaptureContext*	m_context;
 	TreeItem*		m_rootItem;
+	bool			m_filtered;
 
 public:
 	int				m_savedColumn;
 	Qt::SortOrder	m_savedOrder;
 
-	TreeModel(CaptureContext* _context, QObject* _parent = 0);
+	TreeModel(CaptureContext* _context, bool _filtered, QObject* _parent = 0);
 	~TreeModel();
 
 	QVariant		data(const QModelIndex& _index, int _role) const;
@@ -32,13 +33,21 @@ public:
 	QModelIndex		index(int _row, int _column, const QModelIndex& _parent = QModelIndex()) const;
 	QModelIndex		parent(const QModelIndex& _index) const;
 	int				rowCount(const QModelIndex& _parent = QModelIndex()) const;
+	bool			hasChildren(const QModelIndex& _parent = QModelIndex()) const;
+	bool			canFetchMore(const QModelIndex& _parent) const;
+	void			fetchMore(const QModelIndex& _parent);
 	int				columnCount(const QModelIndex& _parent = QModelIndex()) const;
     void			sort(int _column, Qt::SortOrder _order);
 
 	void updateData();
 
+	/// Called by the view, children of expanded rows are kept in current sort order
+	void setExpanded(const QModelIndex& _index, bool _expanded);
+
 private:
-	void setupModelData(const rtm::StackTraceTree& _tree, TreeItem* _parent,const rtm::StackTraceTree* _root, int _depth);
+	void sortExpanded(TreeItem* _item, int _key);
+	void collectUnsorted(TreeItem* _item, int _key, QList<QPersistentModelIndex>& _parents);
+	void updatePersistentIndexes();
 };
 
 class ProgressBarDelegate : public QStyledItemDelegate
@@ -84,6 +93,8 @@ public:
 
 public Q_SLOTS:
 	void rowClicked(const QModelIndex&);
+	void rowExpanded(const QModelIndex&);
+	void rowCollapsed(const QModelIndex&);
 
 Q_SIGNALS:
 	void setStackTrace(rtm::StackTrace**, int);
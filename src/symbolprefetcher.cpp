@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <MTuner_pch.h>
+#include <MTuner/src/symbolprefetcher.h>
+#include <MTuner/src/capturecontext.h>
+
+#include <algorithm>
+
+SymbolPrefetcher::SymbolPrefetcher(CaptureContext* _context)
+{
+	m_context	= _context;
+	m_stop		= false;
+}
+
+SymbolPrefetcher::~SymbolPrefetcher()
+{
+	stop();
+}
+
+void SymbolPrefetcher::prefetch(const uint64_t* _addresses, uint32_t _numAddresses, Priority _priority)
+{
+	QMutexLocker lock(&m_mutex);
+
+	rtm_vector<uint64_t>& queue = m_queues[_priority];
+
+	// rows that scrolled out of view are not worth resolving first anymore
+	if (_priority == Visible)
+		queue.clear();
+
+	rtm_vector<uint64_t> addresses(_addresses, _addresses + _numAddresses);
+	queue.insert(queue.end(), addresses.rbegin(), addresses.rend());
+
+	m_wakeUp.wakeOne();
+}
+
+//--------------------------------------------------------------------------
+/// Queues frames of the largest groups, these are the first ones users look at
+//--------------------------------------------------------------------------
+void SymbolPrefetcher::prefetchTopGroups()
+{
+	const rtm::MemoryGroupsHashType& groups = m_context->m_capture->getMemoryGroups();
+
+	rtm_vector<const rtm::MemoryOperationGroup*> topGroups;
+	topGroups.reserve(groups.size());
+	for (const rtm::MemoryGroupsHashType::value_type& group : groups)
+		if (!group.second.m_operations.empty())
+			topGroups.push_back(&group.second);
+
+	const size_t numTopGroups = qMin(topGroups.size(), (size_t)MAX_TOP_GROUPS);
+	std::partial_sort(topGroups.begin(), topGroups.begin() + numTopGroups, topGroups.end(), [](const rtm::MemoryOperationGroup* _g1, const rtm::MemoryOperationGroup* _g2)
+	{
+		return _g1->m_peakSize > _g2->m_peakSize;
+	});
+
+	rtm_vector<uint64_t> addresses;
+	for (size_t i=0; i<numTopGroups; ++i)
+	{
+		const rtm::StackTrace* trace = topGroups[i]->m_operations[0]->m_stackTrace;
+		addresses.insert(addresses.end(), trace->m_entries, trace->m_entries + trace->m_numEntries);
+	}
+
+	prefetch(addresses.data(), (uint32_t)addresses.size(), Background);
+}
+
+void SymbolPrefetcher::stop()
+{
+	{
+		QMutexLocker lock(&m_mutex);
+		m_stop = true;
+		m_wakeUp.wakeAll();
+	}
+
+	wait();
+}
+
+void SymbolPrefetcher::run()
+{
+	for (;;)
+	{
+		uint64_t address;
+		{
+			QMutexLocker lock(&m_mutex);
+			while (!m_stop && m_queues[Visible].empty() && m_queues[Background].empty())
+				m_wakeUp.wait(&m_mutex);
+
+			if (m_stop)
+				return;
+
+			rtm_vector<uint64_t>& queue = m_queues[Visible].empty() ? m_queues[Background] : m_queues[Visible];
+			address = queue.back();
+			queue.pop_back();
+		}
+
+		// many stack traces share frames, the frame cache already knows which ones are resolved
+		if (m_context->m_capture->isStackFrameCached(address))
+			continue;
+
+		rdebug::StackFrame frame;
+		m_context->resolveStackFrame(address, frame);
+	}
+}
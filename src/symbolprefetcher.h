@@ -0,0 +1,56 @@
+//--------------------------------------------------------------------------//
+/// Copyright (c) 2019 by Milos Tosic. All Rights Reserved.                ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_MTUNER_SYMBOLPREFETCHER_H
+#define RTM_MTUNER_SYMBOLPREFETCHER_H
+
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+struct CaptureContext;
+
+//--------------------------------------------------------------------------
+/// Resolves stack frames ahead of the views when symbols are loaded lazily.
+/// Frames of visible rows go first, frames of the largest groups fill the
+/// idle time. Results are not kept here, resolving a frame fills the symbol
+/// caches that views read from.
+//--------------------------------------------------------------------------
+class SymbolPrefetcher : public QThread
+{
+public:
+	enum Priority
+	{
+		Visible,								///< Replaces previous visible request
+		Background,
+
+		NumPriorities
+	};
+
+	enum
+	{
+		MAX_TOP_GROUPS = 4096					///< Groups prefetched in the background, by peak size
+	};
+
+private:
+	CaptureContext*						m_context;
+	QMutex								m_mutex;
+	QWaitCondition						m_wakeUp;
+	rtm_vector<uint64_t>				m_queues[NumPriorities];	///< Reversed, consumed from the back
+	bool								m_stop;
+
+public:
+	SymbolPrefetcher(CaptureContext* _context);
+	virtual ~SymbolPrefetcher();
+
+	void	prefetch(const uint64_t* _addresses, uint32_t _numAddresses, Priority _priority);
+	void	prefetchTopGroups();
+	void	stop();
+
+protected:
+	virtual void run();
+};
+
+#endif // RTM_MTUNER_SYMBOLPREFETCHER_H
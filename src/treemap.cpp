@@ -45,8 +45,7 @@ void TreeMapWidget::setContext(CaptureContext* _context)
 
 void TreeMapWidget::setFilteringState(bool _state)
 {
-	RTM_UNUSED(_state);
-	m_graphicsView->setMapType(m_graphicsView->getMapType());
+	m_graphicsView->setFilteringState(_state);
 }
 
 void TreeMapWidget::treeMapTypeChanged(int _type)
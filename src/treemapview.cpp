@@ -7,8 +7,9 @@
 #include <MTuner/src/treemapview.h>
 #include <MTuner/src/treemap.h>
 #include <MTuner/src/capturecontext.h>
+#include <QtConcurrent/QtConcurrent>
 
-uint64_t getTotalMem(rtm_vector<TreeMapNode>& _items, int _start, int _end)
+static uint64_t getTotalMem(const rtm_vector<TreeMapNode>& _items, int _start, int _end)
 {
 	uint64_t sum = 0;
 	for (int i=_start; i<=_end; ++i)
@@ -16,7 +17,7 @@ uint64_t getTotalMem(rtm_vector<TreeMapNode>& _items, int _start, int _end)
 	return sum;
 }
 
-void sliceLayout(rtm_vector<TreeMapNode>& _items, int _start, int _end, QRectF& _rect)
+static void sliceLayout(rtm_vector<TreeMapNode>& _items, int _start, int _end, QRectF& _rect)
 {
 	double total = getTotalMem(_items, _start, _end);
 	double a = 0.0;
@@ -76,72 +77,141 @@ static inline bool sortMapItems(const TreeMapNode& _in1, const TreeMapNode& _in2
 	return _in1.m_size > _in2.m_size;
 }
 
-void squaredLayout(rtm_vector<TreeMapNode>& _aitems, int _start, int _end, QRectF& _rect)
+//--------------------------------------------------------------------------
+/// Squarified layout, each step slices off one row and continues with the
+/// remaining rectangle so it is written as a loop rather than recursion.
+/// Remaining total is updated incrementally instead of summed every step.
+//--------------------------------------------------------------------------
+static void squaredLayout(rtm_vector<TreeMapNode>& _aitems, int _start, int _end, QRectF _rect)
 {
-	if (_start > _end)
-		return;
+	double dblTotal = getTotalMem(_aitems, _start, _end);
 
-	if (_end - _start < 2)
+	while (_start <= _end)
 	{
-		sliceLayout(_aitems, _start, _end, _rect);
-		return;
-	}
-	
-	double x = _rect.left();
-	double y = _rect.top();
-	double w = _rect.right() - _rect.left();
-	double h = _rect.bottom() - _rect.top();
-	double dblTotal = getTotalMem(_aitems, _start, _end);
+		if (_end - _start < 2)
+		{
+			sliceLayout(_aitems, _start, _end, _rect);
+			return;
+		}
 
-	if (dblTotal == 0.0)
-		return;
+		double x = _rect.left();
+		double y = _rect.top();
+		double w = _rect.right() - _rect.left();
+		double h = _rect.bottom() - _rect.top();
 
-	int iMid = _start;
-	double a = double(_aitems[_start].m_size) / dblTotal;
-	double b = a;
+		if (dblTotal == 0.0)
+			return;
+
+		int iMid = _start;
+		double a = double(_aitems[_start].m_size) / dblTotal;
+		double b = a;
+
+		const bool vertical = w < h;
+		const double longSide	= vertical ? h : w;
+		const double shortSide	= vertical ? w : h;
 
-	if (w < h)
-	{
 		while (iMid < _end)
 		{
-			double dblAspect = getNormAspect(h, w, a, b);
+			double dblAspect = getNormAspect(longSide, shortSide, a, b);
 			double q = double(_aitems[iMid + 1].m_size) / dblTotal;
-			if (getNormAspect(h, w, a, b + q) > dblAspect)
+			if (getNormAspect(longSide, shortSide, a, b + q) > dblAspect)
 				break;
 			b += q;
 			++iMid;
 		}
-		QRectF rcSliced( x, y, w, h*b );
-		QRectF rcSquared( x, y+h*b, w, h*(1.0-b) );
+
+		QRectF rcSliced = vertical ? QRectF(x, y, w, h*b) : QRectF(x, y, w*b, h);
 		sliceLayout(_aitems, _start, iMid, rcSliced);
-		squaredLayout(_aitems, iMid + 1, _end, rcSquared);
+
+		dblTotal -= getTotalMem(_aitems, _start, iMid);
+		_rect = vertical ? QRectF(x, y+h*b, w, h*(1.0-b)) : QRectF(x + w*b, y, w*(1.0-b), h);
+		_start = iMid + 1;
 	}
-	else
+}
+
+bool TreeMapLayout::matches(uint32_t _type, uint32_t _version, const QRectF& _rect) const
+{
+	return (m_type == _type) && (m_version == _version) && (m_rect == _rect);
+}
+
+void TreeMapLayout::compute()
+{
+	std::sort(m_nodes.begin(), m_nodes.end(), sortMapItems);
+
+	// cells under a pixel can't be seen or clicked, merge them into one
+	const double total = (double)getTotalMem(m_nodes, 0, (int)m_nodes.size() - 1);
+	const double area = m_rect.width() * m_rect.height();
+	if ((total > 0.0) && (area > 0.0))
 	{
-		while (iMid < _end)
+		const double minSize = total / area;
+		size_t firstSmall = m_nodes.size();
+		while ((firstSmall > 0) && (double(m_nodes[firstSmall - 1].m_size) < minSize))
+			--firstSmall;
+
+		if (m_nodes.size() - firstSmall > 1)
 		{
-			double dblAspect = getNormAspect(w, h, a, b);
-			double q = double(_aitems[iMid + 1].m_size) / dblTotal;
-			if (getNormAspect(w, h, a, b + q) > dblAspect)
-				break;
-			b += q;
-			++iMid;
+			TreeMapNode merged;
+			for (size_t i=firstSmall; i<m_nodes.size(); ++i)
+			{
+				const TreeMapNode& node = m_nodes[i];
+				merged.m_size		+= node.m_size;
+				merged.m_allocs		+= node.m_allocs;
+				merged.m_reallocs	+= node.m_reallocs;
+				merged.m_frees		+= node.m_frees;
+				merged.m_merged		+= 1;
+			}
+
+			m_nodes.resize(firstSmall);
+			m_nodes.insert(std::upper_bound(m_nodes.begin(), m_nodes.end(), merged, sortMapItems), merged);
 		}
-		QRectF rcSlice( x, y, w*b, h );
-		QRectF rcSquared( x + w*b, y, w*(1.0-b), h );
-		sliceLayout(_aitems, _start, iMid, rcSlice);
-		squaredLayout(_aitems, iMid + 1, _end, rcSquared);
 	}
+
+	squaredLayout(m_nodes, 0, (int)m_nodes.size() - 1, m_rect);
+
+	m_gridWidth		= qMax(1, (int)std::ceil(m_rect.width() / GRID_CELL_PIXELS));
+	m_gridHeight	= qMax(1, (int)std::ceil(m_rect.height() / GRID_CELL_PIXELS));
+	m_grid.resize(m_gridWidth * m_gridHeight);
+
+	for (size_t i=0; i<m_nodes.size(); ++i)
+	{
+		const QRectF& rect = m_nodes[i].m_rect;
+		const int x0 = qBound(0, int((rect.left()	- m_rect.left()) / GRID_CELL_PIXELS), m_gridWidth - 1);
+		const int x1 = qBound(0, int((rect.right()	- m_rect.left()) / GRID_CELL_PIXELS), m_gridWidth - 1);
+		const int y0 = qBound(0, int((rect.top()	- m_rect.top()) / GRID_CELL_PIXELS), m_gridHeight - 1);
+		const int y1 = qBound(0, int((rect.bottom()	- m_rect.top()) / GRID_CELL_PIXELS), m_gridHeight - 1);
+
+		for (int y=y0; y<=y1; ++y)
+			for (int x=x0; x<=x1; ++x)
+				m_grid[y * m_gridWidth + x].push_back((uint32_t)i);
+	}
+}
+
+TreeMapNode* TreeMapLayout::find(const QPointF& _point)
+{
+	if (!m_rect.contains(_point))
+		return NULL;
+
+	const int x = qBound(0, int((_point.x() - m_rect.left()) / GRID_CELL_PIXELS), m_gridWidth - 1);
+	const int y = qBound(0, int((_point.y() - m_rect.top()) / GRID_CELL_PIXELS), m_gridHeight - 1);
+
+	const rtm_vector<uint32_t>& cell = m_grid[y * m_gridWidth + x];
+	for (size_t i=0; i<cell.size(); ++i)
+	{
+		if (m_nodes[cell[i]].m_rect.contains(_point))
+			return &m_nodes[cell[i]];
+	}
+
+	return NULL;
 }
 
-static inline uint64_t getNodeValueByType(TreeMapNode& _tree, uint32_t _type)
+static inline uint64_t getNodeValueByType(rtm::StackTraceTree* _tree, uint32_t _type)
 {
 	switch (_type)
 	{
-		case 0: return _tree.m_tree->m_memUsage;
-		case 1: return _tree.m_tree->m_memUsagePeak;
-		case 2: return _tree.m_tree->m_overhead;
-		case 3: return _tree.m_tree->m_overheadPeak;
+		case 0: return _tree->m_memUsage;
+		case 1: return _tree->m_memUsagePeak;
+		case 2: return _tree->m_overhead;
+		case 3: return _tree->m_overheadPeak;
 	};
 	return 0;
 }
@@ -150,9 +220,14 @@ TreeMapView::TreeMapView(QWidget* _parent) :
 	QGraphicsView(_parent)
 {
 	m_context		= NULL;
+	m_layout		= NULL;
+	m_job			= NULL;
+	m_version		= 0;
 	m_highlightNode	= NULL;
 	m_lastClick		= 0;
 	m_mapType		= 0;
+	m_enableFiltering	= false;
+	m_item			= NULL;
 	m_scene			= new QGraphicsScene(this);
     m_scene->setItemIndexMethod(QGraphicsScene::NoIndex);
 	m_timer.start();
@@ -163,48 +238,81 @@ TreeMapView::TreeMapView(QWidget* _parent) :
 	setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     scale(qreal(1.0), qreal(1.0));
 	setMouseTracking(true);
+
+	connect(&m_watcher, SIGNAL(finished()), this, SLOT(layoutFinished()));
+}
+
+TreeMapView::~TreeMapView()
+{
+	m_watcher.waitForFinished();
+	delete m_job;
+	clearLayouts();
 }
 
 void TreeMapView::setContext(CaptureContext* _context)
 {
 	m_context = _context;
-	buildTree();
+	clearLayouts();
+	invalidateScene();
+}
+
+void TreeMapView::setFilteringState(bool _state)
+{
+	m_enableFiltering = _state;
+	clearLayouts();
+	invalidateScene();
 }
 
 void TreeMapView::setMapType(uint32_t _type)
 {
 	m_mapType = _type;
-	m_tree.clear();
-	buildTree();
-	m_item->redraw();
 	invalidateScene();
 }
 
-TreeMapNode* TreeMapView::findNode(QPoint& _point)
+TreeMapNode* TreeMapView::findNode(const QPointF& _point)
 {
-	for (size_t i=0; i<m_tree.size(); ++i)
+	return m_layout ? m_layout->find(_point) : NULL;
+}
+
+const TreeMapLayout* TreeMapView::getLayout(const QRectF& _rect)
+{
+	if (m_layout && m_layout->matches(m_mapType, m_version, _rect))
+		return m_layout;
+
+	for (size_t i=0; i<m_layouts.size(); ++i)
 	{
-		if (m_tree[i].m_rect.contains(_point))
-			return &m_tree[i];
+		TreeMapLayout* layout = m_layouts[i];
+		if (layout->matches(m_mapType, m_version, _rect))
+		{
+			m_layouts.erase(m_layouts.begin() + i);
+			m_layouts.insert(m_layouts.begin(), layout);
+			setLayout(layout);
+			return m_layout;
+		}
 	}
 
-	return NULL;
+	m_requestedRect = _rect;
+	if (!m_watcher.isRunning())
+		startLayout();
+
+	// keep showing the previous layout until the new one is ready
+	return m_layout;
 }
 
-void TreeMapView::buildTreeRecurse(rtm::StackTraceTree* _tree)
+void TreeMapView::collectLeaves(rtm::StackTraceTree* _tree, rtm_vector<TreeMapNode>& _nodes)
 {
 	if (_tree->m_children.size() == 0)
 	{
 		TreeMapNode node;
 
 		node.m_tree		= _tree;
-		node.m_text		= "";
-		node.m_size		= getNodeValueByType( node, m_mapType );
-		node.m_allocs	= node.m_tree->m_opCount[rtm::StackTraceTree::Alloc];
-		node.m_reallocs	= node.m_tree->m_opCount[rtm::StackTraceTree::Realloc];
-		node.m_frees	= node.m_tree->m_opCount[rtm::StackTraceTree::Free];
+		node.m_size		= getNodeValueByType(_tree, m_mapType);
+		node.m_allocs	= _tree->m_opCount[rtm::StackTraceTree::Alloc];
+		node.m_reallocs	= _tree->m_opCount[rtm::StackTraceTree::Realloc];
+		node.m_frees	= _tree->m_opCount[rtm::StackTraceTree::Free];
 
-		m_tree.push_back(node);
+		if (node.m_size)
+			_nodes.push_back(node);
 	}
 
 	rtm::StackTraceTree::ChildNodes& children = _tree->m_children;
@@ -212,23 +320,76 @@ void TreeMapView::buildTreeRecurse(rtm::StackTraceTree* _tree)
 	rtm::StackTraceTree::ChildNodes::iterator end = children.end();
 	while (it != end)
 	{
-		buildTreeRecurse(&*it);
+		collectLeaves(&*it, _nodes);
 		++it;
 	}
 }
 
-void TreeMapView::buildTree()
+void TreeMapView::startLayout()
 {
-	m_tree.clear();
 	if (!(m_context && m_context->m_capture))
 		return;
 
-	bool filtered = m_context->m_capture->getFilteringEnabled();
-	const rtm::StackTraceTree& tree = filtered ? m_context->m_capture->getStackTraceTreeFiltered() : m_context->m_capture->getStackTraceTree();
-	rtm::StackTraceTree* rootNode = const_cast<rtm::StackTraceTree*>(&tree);
-	
-	buildTreeRecurse(rootNode);
-	std::sort(m_tree.begin(), m_tree.end(), sortMapItems);
+	// tree is swapped on filtering change so leaves are gathered here, background job only lays them out
+	TreeMapLayout* layout = new TreeMapLayout();
+	layout->m_type		= m_mapType;
+	layout->m_version	= m_version;
+	layout->m_rect		= m_requestedRect;
+
+	const rtm::StackTraceTree& tree = m_enableFiltering ? m_context->m_capture->getStackTraceTreeFiltered() : m_context->m_capture->getStackTraceTree();
+	collectLeaves(const_cast<rtm::StackTraceTree*>(&tree), layout->m_nodes);
+
+	m_job = layout;
+	m_watcher.setFuture(QtConcurrent::run([layout]()
+	{
+		layout->compute();
+	}));
+}
+
+void TreeMapView::layoutFinished()
+{
+	TreeMapLayout* layout = m_job;
+	m_job = NULL;
+
+	if (!layout)
+		return;
+
+	if (layout->m_version != m_version)
+	{
+		delete layout;
+	}
+	else
+	{
+		m_layouts.insert(m_layouts.begin(), layout);
+		if (m_layouts.size() > MAX_CACHED_LAYOUTS)
+		{
+			delete m_layouts.back();
+			m_layouts.pop_back();
+		}
+		setLayout(layout);
+	}
+
+	// repaint requests a new layout if the view changed in the meantime
+	invalidateScene();
+}
+
+void TreeMapView::setLayout(TreeMapLayout* _layout)
+{
+	if (m_layout == _layout)
+		return;
+
+	m_layout		= _layout;
+	m_highlightNode	= NULL;
+}
+
+void TreeMapView::clearLayouts()
+{
+	++m_version;
+	for (size_t i=0; i<m_layouts.size(); ++i)
+		delete m_layouts[i];
+	m_layouts.clear();
+	m_layout		= NULL;
+	m_highlightNode	= NULL;
 }
 
 void TreeMapView::resizeEvent(QResizeEvent* _event)
@@ -244,10 +405,7 @@ void TreeMapView::mousePressEvent(QMouseEvent* _event)
 
 void TreeMapView::mouseMoveEvent(QMouseEvent* _event)
 {
-	QPointF scenePos = mapToScene(_event->pos());
-	QPoint p(scenePos.x(), scenePos.y());
-		
-	TreeMapNode* tt = findNode(p);
+	TreeMapNode* tt = findNode(mapToScene(_event->pos()));
 
 	if (m_highlightNode != tt)
 	{
@@ -259,13 +417,15 @@ void TreeMapView::mouseMoveEvent(QMouseEvent* _event)
 	{
 		QLocale locale;
 		QPoint globalPos = mapToGlobal(_event->pos());
+		QString footer = tt->m_merged	? QObject::tr("Merged call stacks: ") + locale.toString(tt->m_merged)
+										: QObject::tr("Click to see call stack");
 
 		QToolTip::showText(globalPos,	QObject::tr("Total size: ") + locale.toString(qulonglong(tt->m_size)) + QString("\n----------------\n") +
 										QObject::tr("Operations: ") + locale.toString(qulonglong(tt->m_allocs + tt->m_reallocs + tt->m_frees)) + QString("\n") +
 										QObject::tr("    Allocs: ") + locale.toString(qulonglong(tt->m_allocs)) + QString("\n") +
 										QObject::tr("  Reallocs: ") + locale.toString(qulonglong(tt->m_reallocs)) + QString("\n") +
 										QObject::tr("     Frees: ") + locale.toString(qulonglong(tt->m_frees)) + QString("\n----------------\n") +
-										QObject::tr("Click to see call stack") + tt->m_text, this);
+										footer + tt->m_text, this);
 		QGraphicsView::mouseMoveEvent(_event);
 		return;
 	}
@@ -279,7 +439,7 @@ void TreeMapView::mouseReleaseEvent(QMouseEvent* _event)
 {
 	if (_event->button() == Qt::LeftButton)
 	{
-		if (m_highlightNode)
+		if (m_highlightNode && m_highlightNode->m_tree)
 		{
 			rtm::StackTrace** trace = &m_highlightNode->m_tree->m_stackTraceList;
 			emit setStackTrace(trace, 1);
@@ -302,17 +462,11 @@ void TreeMapView::leaveEvent(QEvent*)
 
 TreeMapGraphicsItem::TreeMapGraphicsItem(TreeMapView* _treeView, CaptureContext* _context)
 {
-	m_oldRect				= QRectF(0,0,0,0);
 	m_treeView				= _treeView;
 	m_context				= _context;
 	_treeView->setItem(this);
 }
 
-void TreeMapGraphicsItem::redraw()
-{
-	m_oldRect = QRectF(0,0,0,0);
-}
-
 QRectF TreeMapGraphicsItem::boundingRect() const
 {
 	QSizeF sz = m_treeView->size();
@@ -326,7 +480,7 @@ QPainterPath TreeMapGraphicsItem::shape() const
     return path;
 }
 
-static inline void drawBlockText(const QString& _text, QPainter* _painter, int _fontHeight, int _fontWidths[17], QRectF& _rect, bool _highlight)
+static inline void drawBlockText(const QString& _text, QPainter* _painter, int _fontHeight, int _fontWidths[17], const QRectF& _rect, bool _highlight)
 {
 	if (_highlight)
 		_painter->setPen(Qt::black);
@@ -345,15 +499,14 @@ void TreeMapGraphicsItem::paint(QPainter* _painter, const QStyleOptionGraphicsIt
 {
 	RTM_UNUSED(_item);
 	RTM_UNUSED(_widget);
-	rtm_vector<TreeMapNode>& tree = m_treeView->getTree();
 
 	QSize s = m_treeView->size();
 	QRectF rect = m_treeView->mapToScene(QRect(0,0,s.width(),s.height())).boundingRect();
-	if (m_oldRect != rect)
-	{
-		squaredLayout(tree, 0, (int)tree.size()-1, rect);
-		m_oldRect = rect;
-	}
+	const TreeMapLayout* layout = m_treeView->getLayout(rect);
+	if (!layout)
+		return;
+
+	const rtm_vector<TreeMapNode>& tree = layout->m_nodes;
 
 	_painter->setPen(QPen(Qt::black, 1.0, Qt::SolidLine));
 
@@ -362,14 +515,14 @@ void TreeMapGraphicsItem::paint(QPainter* _painter, const QStyleOptionGraphicsIt
 	_painter->setPen(QPen(Qt::black, 1.0, Qt::SolidLine));
 
 	QVector<QRectF> rects;
-	rects.resize((int)tree.size());
+	rects.reserve((int)tree.size());
 
 	QColor c1(50, 150, 170, 131);
 	QColor c2(50, 150, 170, 111);
 
 	for (size_t i=0; i<tree.size(); ++i)
 	{
-		TreeMapNode& info = tree[i];
+		const TreeMapNode& info = tree[i];
 		if (&info == highlight)
 			continue;
 		rects.push_back(info.m_rect);
@@ -415,11 +568,8 @@ void TreeMapGraphicsItem::paint(QPainter* _painter, const QStyleOptionGraphicsIt
 
 	for (size_t i=0; i<tree.size(); ++i)
 	{
-		TreeMapNode& info = tree[i];
-		if (info.m_tree->m_children.empty())
-		{
-			QLocale locale;
-			drawBlockText(locale.toString(qulonglong(info.m_size)), _painter, fontHeight, textWidth, info.m_rect, &info == highlight);
-		}
+		const TreeMapNode& info = tree[i];
+		QLocale locale;
+		drawBlockText(locale.toString(qulonglong(info.m_size)), _painter, fontHeight, textWidth, info.m_rect, &info == highlight);
 	}
 }
@@ -6,6 +6,8 @@
 #ifndef RTM_MTUNER_TREEMAPVIEW_H
 #define RTM_MTUNER_TREEMAPVIEW_H
 
+#include <QtCore/QFutureWatcher>
+
 class TreeMapWidget;
 class TreeMapGraphicsItem;
 struct CaptureContext;
@@ -18,43 +20,86 @@ struct TreeMapNode
 	uint64_t				m_allocs;	///< Number of allocations
 	uint64_t				m_reallocs;	///< Number of reallocations
 	uint64_t				m_frees;	///< Number of frees
-	rtm::StackTraceTree*	m_tree;		///< Pointer to the actual stact trace tree node, used to resolve symbols
+	uint32_t				m_merged;	///< Number of cells merged into this one, 0 for a single stack trace
+	rtm::StackTraceTree*	m_tree;		///< Pointer to the actual stact trace tree node, used to resolve symbols, NULL if merged
 	
 	TreeMapNode()
 		: m_size(0)
 		, m_allocs(0)
 		, m_reallocs(0)
 		, m_frees(0)
+		, m_merged(0)
 		, m_tree(NULL)
 	{}
 	
 	void reset() { m_text.clear(); }
 };
 
+//--------------------------------------------------------------------------
+/// Squarified layout of all leaves for one map type, data version and scene
+/// rectangle. Cells smaller than a pixel are merged into a single cell and
+/// a grid of cell lists is used for hit testing.
+//--------------------------------------------------------------------------
+struct TreeMapLayout
+{
+	enum
+	{
+		GRID_CELL_PIXELS = 32
+	};
+
+	uint32_t							m_type;
+	uint32_t							m_version;
+	QRectF								m_rect;
+	rtm_vector<TreeMapNode>				m_nodes;
+	rtm_vector<rtm_vector<uint32_t>>	m_grid;			///< Indices of nodes overlapping each grid cell
+	int									m_gridWidth;
+	int									m_gridHeight;
+
+	bool			matches(uint32_t _type, uint32_t _version, const QRectF& _rect) const;
+	void			compute();
+	TreeMapNode*	find(const QPointF& _point);
+};
+
 class TreeMapView : public QGraphicsView
 {
 	Q_OBJECT
 
+public:
+	enum
+	{
+		MAX_CACHED_LAYOUTS = 8
+	};
+
 private:
 	QGraphicsScene*					m_scene;
 	CaptureContext*					m_context;
-	rtm_vector<TreeMapNode>			m_tree;
+	rtm_vector<TreeMapLayout*>		m_layouts;		///< Layouts of current data, most recently used first
+	TreeMapLayout*					m_layout;		///< Shown layout
+	TreeMapLayout*					m_job;			///< Layout being computed in background
+	QFutureWatcher<void>			m_watcher;
+	QRectF							m_requestedRect;
+	uint32_t						m_version;		///< Incremented when tree data changes
 	TreeMapNode*					m_highlightNode;
 	QElapsedTimer					m_timer;
 	qint64							m_lastClick;
 	uint32_t						m_mapType;
+	bool							m_enableFiltering;	///< Filtered data is built and applied
 	TreeMapGraphicsItem*			m_item;
 
 public:
 	TreeMapView(QWidget* _parent = 0);
+	virtual ~TreeMapView();
 
 	void						setItem(TreeMapGraphicsItem* _item) { m_item = _item; }
 	void						setContext(CaptureContext* _context);
+	void						setFilteringState(bool _state);
 	void						setMapType(uint32_t _type);
 	uint32_t					getMapType() const { return m_mapType; }
-	TreeMapNode*				findNode(QPoint& _point);
+	TreeMapNode*				findNode(const QPointF& _point);
 	inline TreeMapNode*			getHighlightNode() { return m_highlightNode; }
-	rtm_vector<TreeMapNode>&	getTree() { return m_tree; }
+
+	/// Returns layout for the rectangle, last shown one while it is being computed
+	const TreeMapLayout*		getLayout(const QRectF& _rect);
 	
 	/// QWidget
 	void resizeEvent(QResizeEvent* _event);
@@ -66,22 +111,25 @@ public:
 Q_SIGNALS:
 	void setStackTrace(rtm::StackTrace**, int);
 
+private Q_SLOTS:
+	void layoutFinished();
+
 private:
-	void buildTreeRecurse(rtm::StackTraceTree* _tree);
-	void buildTree();
+	void collectLeaves(rtm::StackTraceTree* _tree, rtm_vector<TreeMapNode>& _nodes);
+	void startLayout();
+	void setLayout(TreeMapLayout* _layout);
+	void clearLayouts();
 };
 
 class TreeMapGraphicsItem : public QGraphicsItem
 {
 private:
-	QRectF			m_oldRect;
 	TreeMapView*	m_treeView;
 	CaptureContext*	m_context;
 
 public:
 	TreeMapGraphicsItem(TreeMapView* _treeView, CaptureContext* _context);
 
-	void redraw();
 	void parentResized() { prepareGeometryChange(); }
 
 	/// QWidget